@@ -49,8 +49,11 @@ bool CCmdLineParser::parse(int argc,
                            std::string& persistFileName,
                            bool& isPersistFileNamedPipe,
                            bool& isPersistInForeground,
+                           bool& isPersistInBinaryFormat,
+                           std::size_t& maxDeltaSnapshots,
                            std::size_t& maxAnomalyRecords,
                            bool& memoryUsage,
+                           std::size_t& numberThreads,
                            bool& validElasticLicenseKeyConfirmed) {
     try {
         boost::program_options::options_description desc(DESCRIPTION);
@@ -95,12 +98,17 @@ bool CCmdLineParser::parse(int argc,
                     "Optional file to persist state to - not present means no state persistence")
             ("persistIsPipe", "Specified persist file is a named pipe")
             ("persistInForeground", "Persistence occurs in the foreground. Defaults to background persistence.")
+            ("persistInBinaryFormat", "Persist state in a compact binary format. Defaults to JSON. State in either format can be restored.")
+            ("maxDeltaSnapshots", boost::program_options::value<std::size_t>(),
+                    "Optional maximum number of consecutive background snapshots which only contain the models that changed since the previous snapshot. Defaults to 0, i.e. every snapshot is complete.")
             ("bucketPersistInterval", boost::program_options::value<std::size_t>(),
                     "Optional number of buckets after which to periodically persist model state.")
             ("maxAnomalyRecords", boost::program_options::value<std::size_t>(),
                     "The maximum number of records to be outputted for each bucket. Defaults to 100, a value 0 removes the limit.")
             ("memoryUsage",
                     "Log the model memory usage at the end of the job")
+            ("numberThreads", boost::program_options::value<std::size_t>(),
+                    "Optional number of threads used to parse input, add records to and compute results for different detectors. Defaults to 1.")
             ("validElasticLicenseKeyConfirmed", boost::program_options::value<bool>(),
                     "Confirmation that a valid Elastic license key is in use.")
             ;
@@ -191,12 +199,21 @@ bool CCmdLineParser::parse(int argc,
         if (vm.count("persistInForeground") > 0) {
             isPersistInForeground = true;
         }
+        if (vm.count("persistInBinaryFormat") > 0) {
+            isPersistInBinaryFormat = true;
+        }
+        if (vm.count("maxDeltaSnapshots") > 0) {
+            maxDeltaSnapshots = vm["maxDeltaSnapshots"].as<std::size_t>();
+        }
         if (vm.count("maxAnomalyRecords") > 0) {
             maxAnomalyRecords = vm["maxAnomalyRecords"].as<std::size_t>();
         }
         if (vm.count("memoryUsage") > 0) {
             memoryUsage = true;
         }
+        if (vm.count("numberThreads") > 0) {
+            numberThreads = vm["numberThreads"].as<std::size_t>();
+        }
         if (vm.count("validElasticLicenseKeyConfirmed") > 0) {
             validElasticLicenseKeyConfirmed =
                 vm["validElasticLicenseKeyConfirmed"].as<bool>();
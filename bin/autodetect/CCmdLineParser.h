@@ -61,8 +61,11 @@ public:
                       std::string& persistFileName,
                       bool& isPersistFileNamedPipe,
                       bool& isPersistInForeground,
+                      bool& isPersistInBinaryFormat,
+                      std::size_t& maxDeltaSnapshots,
                       std::size_t& maxAnomalyRecords,
                       bool& memoryUsage,
+                      std::size_t& numberThreads,
                       bool& validElasticLicenseKeyConfirmed);
 
 private:
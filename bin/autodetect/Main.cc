@@ -26,6 +26,7 @@
 #include <core/CProcessPriority.h>
 #include <core/CProgramCounters.h>
 #include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 #include <core/CoreTypes.h>
 
 #include <ver/CBuildInfo.h>
@@ -44,6 +45,7 @@
 #include <api/CLengthEncodedInputParser.h>
 #include <api/CModelSnapshotJsonWriter.h>
 #include <api/CPersistenceManager.h>
+#include <api/CPipelinedInputParser.h>
 #include <api/CSingleStreamDataAdder.h>
 #include <api/CSingleStreamSearcher.h>
 #include <api/CStateRestoreStreamFilter.h>
@@ -112,8 +114,11 @@ int main(int argc, char** argv) {
     std::string persistFileName;
     bool isPersistFileNamedPipe{false};
     bool isPersistInForeground{false};
+    bool isPersistInBinaryFormat{false};
+    std::size_t maxDeltaSnapshots{0};
     std::size_t maxAnomalyRecords{100};
     bool memoryUsage{false};
+    std::size_t numberThreads{1};
     bool validElasticLicenseKeyConfirmed{false};
     if (ml::autodetect::CCmdLineParser::parse(
             argc, argv, configFile, filtersConfigFile, eventsConfigFile,
@@ -122,7 +127,8 @@ int main(int argc, char** argv) {
             namedPipeConnectTimeout, inputFileName, isInputFileNamedPipe, outputFileName,
             isOutputFileNamedPipe, restoreFileName, isRestoreFileNamedPipe,
             persistFileName, isPersistFileNamedPipe, isPersistInForeground,
-            maxAnomalyRecords, memoryUsage, validElasticLicenseKeyConfirmed) == false) {
+            isPersistInBinaryFormat, maxDeltaSnapshots, maxAnomalyRecords, memoryUsage,
+            numberThreads, validElasticLicenseKeyConfirmed) == false) {
         return EXIT_FAILURE;
     }
 
@@ -165,6 +171,10 @@ int main(int argc, char** argv) {
 
     ml::seccomp::CSystemCallFilter::installSystemCallFilter();
 
+    if (numberThreads > 1) {
+        ml::core::startDefaultAsyncExecutor(numberThreads);
+    }
+
     if (ioMgr.initIo() == false) {
         LOG_FATAL(<< "Failed to initialise IO");
         return EXIT_FAILURE;
@@ -264,6 +274,15 @@ int main(int argc, char** argv) {
             mutableFields, ioMgr.inputStream(), delimiter);
     }()};
 
+    // If we have more than one thread parse the input on its own thread.
+    const InputParserCUPtr pipelinedInputParser{
+        [numberThreads, &inputParser]() -> InputParserCUPtr {
+            if (numberThreads > 1) {
+                return std::make_unique<ml::api::CPipelinedInputParser>(*inputParser);
+            }
+            return nullptr;
+        }()};
+
     const std::string jobId{jobConfig.jobId()};
     ml::core::CJsonOutputStreamWrapper wrappedOutputStream{ioMgr.outputStream()};
     ml::api::CModelSnapshotJsonWriter modelSnapshotWriter{jobId, wrappedOutputStream};
@@ -281,6 +300,8 @@ int main(int argc, char** argv) {
                              jobConfig.dataDescription().timeField(),
                              timeFormat,
                              maxAnomalyRecords};
+    job.persistInBinaryFormat(isPersistInBinaryFormat);
+    job.maxDeltaSnapshots(maxDeltaSnapshots);
 
     if (!quantilesStateFile.empty()) {
         if (job.initNormalizer(quantilesStateFile) == false) {
@@ -321,8 +342,10 @@ int main(int argc, char** argv) {
     }
 
     // The skeleton avoids the need to duplicate a lot of boilerplate code
-    ml::api::CCmdSkeleton skeleton{restoreSearcher.get(), persister.get(),
-                                   *inputParser, *firstProcessor};
+    ml::api::CCmdSkeleton skeleton{
+        restoreSearcher.get(), persister.get(),
+        pipelinedInputParser != nullptr ? *pipelinedInputParser : *inputParser,
+        *firstProcessor};
     if (skeleton.ioLoop() == false) {
         LOG_FATAL(<< "ML anomaly detector job failed");
         return EXIT_FAILURE;
@@ -0,0 +1,139 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include "CBenchmarkInstrumentation.h"
+
+#include <algorithm>
+
+#ifndef Windows
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+namespace ml {
+namespace boosted_tree_benchmark {
+namespace {
+const double NANOSECONDS_PER_MILLISECOND{1e6};
+}
+
+CBenchmarkInstrumentation::CBenchmarkInstrumentation(std::size_t numberThreads)
+    : m_NumberThreads{std::max(numberThreads, std::size_t{1})} {
+}
+
+void CBenchmarkInstrumentation::updateMemoryUsage(std::int64_t delta) {
+    std::int64_t memory{m_AccountedMemory.fetch_add(delta) + delta};
+    std::int64_t peak{m_PeakAccountedMemory.load()};
+    while (memory > peak && m_PeakAccountedMemory.compare_exchange_weak(peak, memory) == false) {
+    }
+}
+
+void CBenchmarkInstrumentation::startNewProgressMonitoredTask(const std::string& task) {
+    // Some stages are restarted when they are resumed so don't split a phase
+    // which is already running.
+    if (m_InPhase == false || m_Phases.back().s_Name != task) {
+        this->startPhase(task);
+    }
+}
+
+void CBenchmarkInstrumentation::startPhase(const std::string& name) {
+    this->stopPhase();
+    SPhase phase;
+    phase.s_Name = name;
+    phase.s_StartWallTime = m_Clock.nanoseconds();
+    phase.s_StartCpuTime = processCpuTime();
+    m_PeakAccountedMemory.store(m_AccountedMemory.load());
+    m_Phases.push_back(std::move(phase));
+    m_InPhase = true;
+}
+
+void CBenchmarkInstrumentation::stopPhase() {
+    if (m_InPhase) {
+        auto& phase = m_Phases.back();
+        phase.s_EndWallTime = m_Clock.nanoseconds();
+        phase.s_EndCpuTime = processCpuTime();
+        phase.s_PeakAccountedMemory = m_PeakAccountedMemory.load();
+        phase.s_PeakResidentSetSize = processPeakResidentSetSize();
+        m_InPhase = false;
+    }
+}
+
+double CBenchmarkInstrumentation::totalWallTimeMs() const {
+    double result{0.0};
+    for (const auto& phase : m_Phases) {
+        result += phase.wallTimeMs();
+    }
+    return result;
+}
+
+double CBenchmarkInstrumentation::totalCpuTimeMs() const {
+    double result{0.0};
+    for (const auto& phase : m_Phases) {
+        result += phase.cpuTimeMs();
+    }
+    return result;
+}
+
+std::int64_t CBenchmarkInstrumentation::peakAccountedMemory() const {
+    std::int64_t result{0};
+    for (const auto& phase : m_Phases) {
+        result = std::max(result, phase.s_PeakAccountedMemory);
+    }
+    return result;
+}
+
+std::uint64_t CBenchmarkInstrumentation::processCpuTime() {
+#ifdef Windows
+    return 0;
+#else
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    auto toNanoseconds = [](const struct timeval& time) {
+        return static_cast<std::uint64_t>(time.tv_sec) * 1000000000 +
+               static_cast<std::uint64_t>(time.tv_usec) * 1000;
+    };
+    return toNanoseconds(usage.ru_utime) + toNanoseconds(usage.ru_stime);
+#endif
+}
+
+std::uint64_t CBenchmarkInstrumentation::processPeakResidentSetSize() {
+#ifdef Windows
+    return 0;
+#else
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef MacOSX
+    // Reported in bytes.
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    // Reported in kilobytes.
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double CBenchmarkInstrumentation::SPhase::wallTimeMs() const {
+    return static_cast<double>(s_EndWallTime - s_StartWallTime) / NANOSECONDS_PER_MILLISECOND;
+}
+
+double CBenchmarkInstrumentation::SPhase::cpuTimeMs() const {
+    return static_cast<double>(s_EndCpuTime - s_StartCpuTime) / NANOSECONDS_PER_MILLISECOND;
+}
+
+double CBenchmarkInstrumentation::SPhase::threadUtilisation(std::size_t numberThreads) const {
+    double wallTime{this->wallTimeMs()};
+    return wallTime > 0.0 ? this->cpuTimeMs() / (wallTime * static_cast<double>(numberThreads))
+                          : 0.0;
+}
+}
+}
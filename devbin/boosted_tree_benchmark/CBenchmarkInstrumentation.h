@@ -0,0 +1,141 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_boosted_tree_benchmark_CBenchmarkInstrumentation_h
+#define INCLUDED_ml_boosted_tree_benchmark_CBenchmarkInstrumentation_h
+
+#include <core/CMonotonicTime.h>
+
+#include <maths/analytics/CDataFrameAnalysisInstrumentationInterface.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ml {
+namespace boosted_tree_benchmark {
+
+//! \brief
+//! Instrumentation which splits a boosted tree run into timed phases.
+//!
+//! DESCRIPTION:\n
+//! The boosted tree code starts a new progress monitored task at each
+//! major stage of training, i.e. feature selection and encoding, coarse
+//! hyperparameter search, fine tuning and final training. This uses those
+//! notifications to delimit phases. Phases which don't have a task, such
+//! as prediction and SHAP, can be delimited explicitly with startPhase.
+//!
+//! For each phase we record the wall time, the process CPU time, the peak
+//! memory reported by the analysis' own accounting and the peak resident
+//! set size of the process. The thread utilisation is the CPU time divided
+//! by the wall time multiplied by the number of threads.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Memory updates can arrive from any training thread so the current and
+//! peak usage are atomics. Phase transitions only happen on the thread
+//! which drives training.
+//!
+//! The process CPU time and resident set size are not available on Windows
+//! and are reported as zero there.
+//!
+class CBenchmarkInstrumentation final
+    : public maths::analytics::CDataFrameTrainBoostedTreeInstrumentationInterface {
+public:
+    explicit CBenchmarkInstrumentation(std::size_t numberThreads);
+
+    //! \name Instrumentation Interface
+    //@{
+    void updateMemoryUsage(std::int64_t delta) override;
+    void startNewProgressMonitoredTask(const std::string& task) override;
+    void updateProgress(double) override {}
+    void flush(const std::string& /* tag */) override {}
+    void type(EStatsType /* type */) override {}
+    void iteration(std::size_t /* iteration */) override {}
+    void iterationTime(std::uint64_t /* delta */) override {}
+    void lossType(const std::string& /* lossType */) override {}
+    void lossValues(std::size_t /* fold */, TDoubleVec&& /* lossValues */) override {}
+    SHyperparameters& hyperparameters() override { return m_Hyperparameters; }
+    //@}
+
+    //! End the current phase, if any, and start one called \p name.
+    void startPhase(const std::string& name);
+
+    //! End the current phase.
+    void stopPhase();
+
+    //! Write the phases recorded so far as a JSON array to \p writer.
+    template<typename WRITER>
+    void writePhases(WRITER& writer) const {
+        writer.StartArray();
+        for (const auto& phase : m_Phases) {
+            writer.StartObject();
+            writer.Key("phase");
+            writer.String(phase.s_Name);
+            writer.Key("wall_time_ms");
+            writer.Double(phase.wallTimeMs());
+            writer.Key("cpu_time_ms");
+            writer.Double(phase.cpuTimeMs());
+            writer.Key("thread_utilisation");
+            writer.Double(phase.threadUtilisation(m_NumberThreads));
+            writer.Key("peak_accounted_memory_bytes");
+            writer.Int64(phase.s_PeakAccountedMemory);
+            writer.Key("peak_resident_set_size_bytes");
+            writer.Uint64(phase.s_PeakResidentSetSize);
+            writer.EndObject();
+        }
+        writer.EndArray();
+    }
+
+    //! Get the total wall time of all phases in milliseconds.
+    double totalWallTimeMs() const;
+
+    //! Get the total CPU time of all phases in milliseconds.
+    double totalCpuTimeMs() const;
+
+    //! Get the peak accounted memory over all phases.
+    std::int64_t peakAccountedMemory() const;
+
+    //! Get the process CPU time in nanoseconds.
+    static std::uint64_t processCpuTime();
+
+    //! Get the peak resident set size of the process in bytes.
+    static std::uint64_t processPeakResidentSetSize();
+
+private:
+    struct SPhase {
+        double wallTimeMs() const;
+        double cpuTimeMs() const;
+        double threadUtilisation(std::size_t numberThreads) const;
+
+        std::string s_Name;
+        std::uint64_t s_StartWallTime{0};
+        std::uint64_t s_EndWallTime{0};
+        std::uint64_t s_StartCpuTime{0};
+        std::uint64_t s_EndCpuTime{0};
+        std::int64_t s_PeakAccountedMemory{0};
+        std::uint64_t s_PeakResidentSetSize{0};
+    };
+    using TPhaseVec = std::vector<SPhase>;
+
+private:
+    std::size_t m_NumberThreads;
+    core::CMonotonicTime m_Clock;
+    bool m_InPhase{false};
+    TPhaseVec m_Phases;
+    std::atomic<std::int64_t> m_AccountedMemory{0};
+    std::atomic<std::int64_t> m_PeakAccountedMemory{0};
+    SHyperparameters m_Hyperparameters;
+};
+}
+}
+
+#endif // INCLUDED_ml_boosted_tree_benchmark_CBenchmarkInstrumentation_h
@@ -0,0 +1,129 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include "CCmdLineParser.h"
+
+#include <ver/CBuildInfo.h>
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+namespace ml {
+namespace boosted_tree_benchmark {
+
+const std::string CCmdLineParser::DESCRIPTION = "Usage: boosted_tree_benchmark [options]\n"
+                                                "Options:";
+
+bool CCmdLineParser::parse(int argc,
+                           const char* const* argv,
+                           std::string& problemType,
+                           std::size_t& numberRows,
+                           std::size_t& numberNumericColumns,
+                           std::size_t& numberCategoricalColumns,
+                           std::size_t& cardinality,
+                           std::size_t& numberClasses,
+                           std::size_t& numberThreads,
+                           std::size_t& maximumNumberTrees,
+                           std::size_t& numberTopShapValues,
+                           std::uint64_t& seed,
+                           std::string& outputFileName) {
+    try {
+        boost::program_options::options_description desc(DESCRIPTION);
+        // clang-format off
+        desc.add_options()
+            ("help", "Display this information and exit")
+            ("version", "Display version information and exit")
+            ("type", boost::program_options::value<std::string>()->default_value("regression"),
+             "The problem type [regression|binary|multiclass]")
+            ("rows", boost::program_options::value<std::size_t>()->default_value(10000),
+             "The number of rows to generate")
+            ("numericColumns", boost::program_options::value<std::size_t>()->default_value(10),
+             "The number of numeric feature columns to generate")
+            ("categoricalColumns", boost::program_options::value<std::size_t>()->default_value(2),
+             "The number of categorical feature columns to generate")
+            ("cardinality", boost::program_options::value<std::size_t>()->default_value(20),
+             "The number of distinct categories in each categorical feature column")
+            ("classes", boost::program_options::value<std::size_t>()->default_value(5),
+             "The number of classes for multiclass classification")
+            ("threads", boost::program_options::value<std::size_t>()->default_value(1),
+             "The number of threads to use for training and inference")
+            ("maxTrees", boost::program_options::value<std::size_t>()->default_value(0),
+             "Optional upper bound on the number of trees - zero means choose automatically")
+            ("topShapValues", boost::program_options::value<std::size_t>()->default_value(5),
+             "The number of SHAP values to compute per row - zero means skip SHAP")
+            ("seed", boost::program_options::value<std::uint64_t>()->default_value(0),
+             "The seed for the synthetic data generator")
+            ("output", boost::program_options::value<std::string>(),
+             "Optional file to write the timing report to - not present means write to STDOUT")
+        ;
+        // clang-format on
+
+        boost::program_options::variables_map vm;
+        boost::program_options::parsed_options parsed =
+            boost::program_options::command_line_parser(argc, argv)
+                .options(desc)
+                .allow_unregistered()
+                .run();
+        boost::program_options::store(parsed, vm);
+
+        if (vm.count("help") > 0) {
+            std::cerr << desc << std::endl;
+            return false;
+        }
+        if (vm.count("version") > 0) {
+            std::cerr << ver::CBuildInfo::fullInfo() << std::endl;
+            return false;
+        }
+        problemType = vm["type"].as<std::string>();
+        if (problemType != "regression" && problemType != "binary" &&
+            problemType != "multiclass") {
+            std::cerr << "Unknown problem type \"" << problemType
+                      << "\". Must be one of regression, binary or multiclass." << std::endl;
+            return false;
+        }
+        numberRows = vm["rows"].as<std::size_t>();
+        numberNumericColumns = vm["numericColumns"].as<std::size_t>();
+        numberCategoricalColumns = vm["categoricalColumns"].as<std::size_t>();
+        cardinality = vm["cardinality"].as<std::size_t>();
+        numberClasses = vm["classes"].as<std::size_t>();
+        numberThreads = vm["threads"].as<std::size_t>();
+        maximumNumberTrees = vm["maxTrees"].as<std::size_t>();
+        numberTopShapValues = vm["topShapValues"].as<std::size_t>();
+        seed = vm["seed"].as<std::uint64_t>();
+        if (vm.count("output") > 0) {
+            outputFileName = vm["output"].as<std::string>();
+        }
+        if (numberRows == 0 || numberNumericColumns + numberCategoricalColumns == 0) {
+            std::cerr << "At least one row and one feature column are required" << std::endl;
+            return false;
+        }
+        if (numberCategoricalColumns > 0 && cardinality < 2) {
+            std::cerr << "Categorical columns need a cardinality of at least two" << std::endl;
+            return false;
+        }
+        if (problemType == "multiclass" && numberClasses < 3) {
+            std::cerr << "Multiclass classification needs at least three classes" << std::endl;
+            return false;
+        }
+        if (numberThreads == 0) {
+            std::cerr << "At least one thread is required" << std::endl;
+            return false;
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << "Error processing command line: " << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+}
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_boosted_tree_benchmark_CCmdLineParser_h
+#define INCLUDED_ml_boosted_tree_benchmark_CCmdLineParser_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ml {
+namespace boosted_tree_benchmark {
+
+//! \brief
+//! Very simple command line parser.
+//!
+//! DESCRIPTION:\n
+//! Very simple command line parser.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Put in a class rather than main to allow testing.
+//!
+class CCmdLineParser {
+public:
+    //! Parse the arguments and return options if appropriate.  Unnamed
+    //! options are ignored.
+    static bool parse(int argc,
+                      const char* const* argv,
+                      std::string& problemType,
+                      std::size_t& numberRows,
+                      std::size_t& numberNumericColumns,
+                      std::size_t& numberCategoricalColumns,
+                      std::size_t& cardinality,
+                      std::size_t& numberClasses,
+                      std::size_t& numberThreads,
+                      std::size_t& maximumNumberTrees,
+                      std::size_t& numberTopShapValues,
+                      std::uint64_t& seed,
+                      std::string& outputFileName);
+
+private:
+    static const std::string DESCRIPTION;
+};
+}
+}
+
+#endif // INCLUDED_ml_boosted_tree_benchmark_CCmdLineParser_h
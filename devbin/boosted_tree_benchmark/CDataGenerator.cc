@@ -0,0 +1,129 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include "CDataGenerator.h"
+
+#include <core/CDataFrame.h>
+
+#include <maths/common/CSampling.h>
+#include <maths/common/CTools.h>
+#include <maths/common/CToolsDetail.h>
+
+#include <algorithm>
+
+namespace ml {
+namespace boosted_tree_benchmark {
+namespace {
+const double NOISE_VARIANCE{0.25};
+}
+
+CDataGenerator::CDataGenerator(EProblemType type,
+                               std::size_t numberNumericColumns,
+                               std::size_t numberCategoricalColumns,
+                               std::size_t cardinality,
+                               std::size_t numberClasses,
+                               std::uint64_t seed)
+    : m_Type{type}, m_NumberNumericColumns{numberNumericColumns},
+      m_NumberCategoricalColumns{numberCategoricalColumns}, m_Cardinality{cardinality},
+      m_NumberClasses{type == E_Regression
+                          ? 0
+                          : (type == E_BinaryClassification ? 2 : numberClasses)},
+      m_Rng{seed} {
+
+    std::size_t numberFunctions{std::max(m_NumberClasses, std::size_t{1})};
+    m_Weights.resize(numberFunctions);
+    m_CategoryOffsets.resize(numberFunctions);
+    for (std::size_t k = 0; k < numberFunctions; ++k) {
+        maths::common::CSampling::uniformSample(m_Rng, -1.0, 1.0,
+                                                m_NumberNumericColumns, m_Weights[k]);
+        m_CategoryOffsets[k].resize(m_NumberCategoricalColumns);
+        for (auto& offsets : m_CategoryOffsets[k]) {
+            maths::common::CSampling::uniformSample(m_Rng, -2.0, 2.0, m_Cardinality, offsets);
+        }
+    }
+}
+
+CDataGenerator::TDataFrameUPtr CDataGenerator::generate(std::size_t numberRows) {
+
+    std::size_t numberColumns{this->numberColumns()};
+    std::size_t numberFeatures{numberColumns - 1};
+
+    auto frame = core::makeMainStorageDataFrame(numberColumns, numberRows).first;
+    frame->categoricalColumns(this->categoricalColumns());
+
+    TDoubleVec features(numberFeatures);
+    for (std::size_t i = 0; i < numberRows; ++i) {
+        for (std::size_t j = 0; j < m_NumberNumericColumns; ++j) {
+            features[j] = maths::common::CSampling::uniformSample(m_Rng, -2.0, 2.0);
+        }
+        for (std::size_t j = m_NumberNumericColumns; j < numberFeatures; ++j) {
+            features[j] = static_cast<double>(
+                maths::common::CSampling::uniformSample(m_Rng, std::size_t{0}, m_Cardinality));
+        }
+        double target{this->target(features)};
+        frame->writeRow([&](core::CDataFrame::TFloatVecItr column, std::int32_t&) {
+            for (std::size_t j = 0; j < numberFeatures; ++j, ++column) {
+                *column = features[j];
+            }
+            *column = target;
+        });
+    }
+    frame->finishWritingRows();
+
+    return frame;
+}
+
+std::size_t CDataGenerator::numberColumns() const {
+    return m_NumberNumericColumns + m_NumberCategoricalColumns + 1;
+}
+
+std::size_t CDataGenerator::dependentVariable() const {
+    return this->numberColumns() - 1;
+}
+
+std::size_t CDataGenerator::numberClasses() const {
+    return m_NumberClasses;
+}
+
+double CDataGenerator::target(const TDoubleVec& features) {
+    if (m_Type == E_Regression) {
+        return this->logit(0, features) +
+               maths::common::CSampling::normalSample(m_Rng, 0.0, NOISE_VARIANCE);
+    }
+    m_Probabilities.resize(m_NumberClasses);
+    for (std::size_t k = 0; k < m_NumberClasses; ++k) {
+        m_Probabilities[k] = this->logit(k, features);
+    }
+    maths::common::CTools::inplaceSoftmax(m_Probabilities);
+    return static_cast<double>(
+        maths::common::CSampling::categoricalSample(m_Rng, m_Probabilities));
+}
+
+double CDataGenerator::logit(std::size_t k, const TDoubleVec& features) const {
+    double result{0.0};
+    for (std::size_t j = 0; j < m_NumberNumericColumns; ++j) {
+        result += m_Weights[k][j] * features[j];
+    }
+    for (std::size_t j = 0; j < m_NumberCategoricalColumns; ++j) {
+        auto category = static_cast<std::size_t>(features[m_NumberNumericColumns + j]);
+        result += m_CategoryOffsets[k][j][category];
+    }
+    return result;
+}
+
+CDataGenerator::TBoolVec CDataGenerator::categoricalColumns() const {
+    TBoolVec result(this->numberColumns(), false);
+    std::fill_n(result.begin() + static_cast<std::ptrdiff_t>(m_NumberNumericColumns),
+                m_NumberCategoricalColumns, true);
+    result.back() = m_Type != E_Regression;
+    return result;
+}
+}
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_boosted_tree_benchmark_CDataGenerator_h
+#define INCLUDED_ml_boosted_tree_benchmark_CDataGenerator_h
+
+#include <maths/common/CPRNG.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ml {
+namespace core {
+class CDataFrame;
+}
+namespace boosted_tree_benchmark {
+
+//! \brief
+//! Generates synthetic data frames for benchmarking boosted tree training.
+//!
+//! DESCRIPTION:\n
+//! The frame comprises the numeric feature columns, followed by the
+//! categorical feature columns, followed by the target column. Numeric
+//! features are uniform on [-2, 2] and categorical features are uniform
+//! on the categories.
+//!
+//! For regression the target is a random linear function of the numeric
+//! features plus a random offset per category plus Gaussian noise. For
+//! classification each class' logit is generated in the same way and the
+//! class is sampled from the softmax of the logits.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! All the random parameters of the target function are chosen on
+//! construction so calls to generate with the same seed and dimensions
+//! produce identical frames.
+//!
+class CDataGenerator {
+public:
+    using TBoolVec = std::vector<bool>;
+    using TDoubleVec = std::vector<double>;
+    using TDoubleVecVec = std::vector<TDoubleVec>;
+    using TDoubleVecVecVec = std::vector<TDoubleVecVec>;
+    using TDataFrameUPtr = std::unique_ptr<core::CDataFrame>;
+
+    enum EProblemType {
+        E_Regression,
+        E_BinaryClassification,
+        E_MulticlassClassification
+    };
+
+public:
+    CDataGenerator(EProblemType type,
+                   std::size_t numberNumericColumns,
+                   std::size_t numberCategoricalColumns,
+                   std::size_t cardinality,
+                   std::size_t numberClasses,
+                   std::uint64_t seed);
+
+    //! Generate a frame with \p numberRows rows.
+    TDataFrameUPtr generate(std::size_t numberRows);
+
+    //! Get the total number of columns including the target.
+    std::size_t numberColumns() const;
+
+    //! Get the index of the target column.
+    std::size_t dependentVariable() const;
+
+    //! Get the number of distinct target values, which is zero for regression.
+    std::size_t numberClasses() const;
+
+private:
+    double target(const TDoubleVec& features);
+    double logit(std::size_t k, const TDoubleVec& features) const;
+    TBoolVec categoricalColumns() const;
+
+private:
+    EProblemType m_Type;
+    std::size_t m_NumberNumericColumns;
+    std::size_t m_NumberCategoricalColumns;
+    std::size_t m_Cardinality;
+    std::size_t m_NumberClasses;
+    maths::common::CPRNG::CXorOShiro128Plus m_Rng;
+    //! The weight of each numeric feature per class.
+    TDoubleVecVec m_Weights;
+    //! The offset of each category of each categorical feature per class.
+    TDoubleVecVecVec m_CategoryOffsets;
+    //! Scratch space for the class probabilities.
+    TDoubleVec m_Probabilities;
+};
+}
+}
+
+#endif // INCLUDED_ml_boosted_tree_benchmark_CDataGenerator_h
@@ -0,0 +1,207 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+//! \brief
+//! Benchmark boosted tree training, inference and SHAP on synthetic data.
+//!
+//! DESCRIPTION:\n
+//! Generates a regression, binary or multiclass classification data frame
+//! with the requested dimensions and cardinality, trains a boosted tree on
+//! it, computes predictions and SHAP values and writes wall time, CPU time,
+//! peak memory and thread utilisation for each phase as JSON.
+//!
+//! For example:
+//! \code
+//! boosted_tree_benchmark --type=multiclass --rows=100000 --numericColumns=20
+//!                        --categoricalColumns=5 --cardinality=50 --classes=5
+//!                        --threads=4
+//! \endcode
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! The training phases are delimited by the progress monitored tasks which
+//! the boosted tree code starts so they match the phases reported to users.
+//! Feature selection and category encoding happen in a single task.
+//!
+#include <core/CDataFrame.h>
+#include <core/CLogger.h>
+#include <core/CRapidJsonPrettyWriter.h>
+#include <core/Concurrency.h>
+
+#include <maths/analytics/CBoostedTree.h>
+#include <maths/analytics/CBoostedTreeFactory.h>
+#include <maths/analytics/CBoostedTreeLoss.h>
+#include <maths/analytics/CTreeShapFeatureImportance.h>
+
+#include "CBenchmarkInstrumentation.h"
+#include "CCmdLineParser.h"
+#include "CDataGenerator.h"
+
+#include <rapidjson/ostreamwrapper.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <stdlib.h>
+
+namespace {
+using TLossFunctionUPtr = ml::maths::analytics::CBoostedTreeFactory::TLossFunctionUPtr;
+using TRowItr = ml::core::CDataFrame::TRowItr;
+using TProblemType = ml::boosted_tree_benchmark::CDataGenerator::EProblemType;
+
+const std::string DATA_GENERATION{"data_generation"};
+const std::string PREDICTION{"prediction"};
+const std::string SHAP{"shap"};
+
+TProblemType problemType(const std::string& type) {
+    if (type == "binary") {
+        return TProblemType::E_BinaryClassification;
+    }
+    if (type == "multiclass") {
+        return TProblemType::E_MulticlassClassification;
+    }
+    return TProblemType::E_Regression;
+}
+
+TLossFunctionUPtr lossFunction(TProblemType type, std::size_t numberClasses) {
+    switch (type) {
+    case TProblemType::E_Regression:
+        return std::make_unique<ml::maths::analytics::boosted_tree::CMse>();
+    case TProblemType::E_BinaryClassification:
+        return std::make_unique<ml::maths::analytics::boosted_tree::CBinomialLogisticLoss>();
+    case TProblemType::E_MulticlassClassification:
+        return std::make_unique<ml::maths::analytics::boosted_tree::CMultinomialLogisticLoss>(
+            numberClasses);
+    }
+    return nullptr;
+}
+}
+
+int main(int argc, char** argv) {
+
+    // Read command line options
+    std::string type;
+    std::size_t numberRows{0};
+    std::size_t numberNumericColumns{0};
+    std::size_t numberCategoricalColumns{0};
+    std::size_t cardinality{0};
+    std::size_t numberClasses{0};
+    std::size_t numberThreads{1};
+    std::size_t maximumNumberTrees{0};
+    std::size_t numberTopShapValues{0};
+    std::uint64_t seed{0};
+    std::string outputFileName;
+    if (ml::boosted_tree_benchmark::CCmdLineParser::parse(
+            argc, argv, type, numberRows, numberNumericColumns, numberCategoricalColumns,
+            cardinality, numberClasses, numberThreads, maximumNumberTrees,
+            numberTopShapValues, seed, outputFileName) == false) {
+        return EXIT_FAILURE;
+    }
+
+    // Training logs progress at debug level which would distort the timings.
+    ml::core::CLogger::instance().setLoggingLevel(ml::core::CLogger::E_Warn);
+
+    if (numberThreads > 1) {
+        ml::core::startDefaultAsyncExecutor(numberThreads);
+    }
+
+    ml::boosted_tree_benchmark::CBenchmarkInstrumentation instrumentation{numberThreads};
+
+    instrumentation.startPhase(DATA_GENERATION);
+    ml::boosted_tree_benchmark::CDataGenerator generator{
+        problemType(type), numberNumericColumns, numberCategoricalColumns,
+        cardinality,       numberClasses,        seed};
+    auto frame = generator.generate(numberRows);
+    instrumentation.stopPhase();
+
+    auto factory = ml::maths::analytics::CBoostedTreeFactory::constructFromParameters(
+        numberThreads, lossFunction(problemType(type), generator.numberClasses()));
+    factory.analysisInstrumentation(instrumentation).numberTopShapValues(numberTopShapValues);
+    if (maximumNumberTrees > 0) {
+        factory.maximumNumberTrees(maximumNumberTrees);
+    }
+
+    // The training phases are started by the factory and the tree themselves.
+    auto tree = factory.buildForTrain(*frame, generator.dependentVariable());
+    tree->train();
+
+    instrumentation.startPhase(PREDICTION);
+    tree->predict();
+    instrumentation.stopPhase();
+
+    std::size_t numberShapRows{0};
+    auto* shap = tree->shap();
+    if (shap != nullptr) {
+        instrumentation.startPhase(SHAP);
+        frame->readRows(1, [&](const TRowItr& beginRows, const TRowItr& endRows) {
+            for (auto row = beginRows; row != endRows; ++row) {
+                shap->shap(*row, [&](const auto&, const auto&, const auto&) {
+                    ++numberShapRows;
+                });
+            }
+        });
+        instrumentation.stopPhase();
+    }
+
+    std::ofstream outputFile;
+    if (outputFileName.empty() == false) {
+        outputFile.open(outputFileName);
+        if (outputFile.is_open() == false) {
+            LOG_FATAL(<< "Failed to open output file '" << outputFileName << "'");
+            return EXIT_FAILURE;
+        }
+    }
+    rapidjson::OStreamWrapper outputStream{outputFileName.empty() ? std::cout : outputFile};
+    ml::core::CRapidJsonPrettyWriter<rapidjson::OStreamWrapper> writer{outputStream};
+
+    writer.StartObject();
+    writer.Key("configuration");
+    writer.StartObject();
+    writer.Key("type");
+    writer.String(type);
+    writer.Key("rows");
+    writer.Uint64(numberRows);
+    writer.Key("numeric_columns");
+    writer.Uint64(numberNumericColumns);
+    writer.Key("categorical_columns");
+    writer.Uint64(numberCategoricalColumns);
+    writer.Key("cardinality");
+    writer.Uint64(cardinality);
+    writer.Key("classes");
+    writer.Uint64(generator.numberClasses());
+    writer.Key("threads");
+    writer.Uint64(numberThreads);
+    writer.Key("seed");
+    writer.Uint64(seed);
+    writer.EndObject();
+    writer.Key("number_trees");
+    writer.Uint64(tree->trainedModel().size());
+    writer.Key("number_shap_rows");
+    writer.Uint64(numberShapRows);
+    writer.Key("phases");
+    instrumentation.writePhases(writer);
+    writer.Key("total_wall_time_ms");
+    writer.Double(instrumentation.totalWallTimeMs());
+    writer.Key("total_cpu_time_ms");
+    writer.Double(instrumentation.totalCpuTimeMs());
+    writer.Key("peak_accounted_memory_bytes");
+    writer.Int64(instrumentation.peakAccountedMemory());
+    writer.Key("peak_resident_set_size_bytes");
+    writer.Uint64(ml::boosted_tree_benchmark::CBenchmarkInstrumentation::processPeakResidentSetSize());
+    writer.EndObject();
+    (outputFileName.empty() ? std::cout : outputFile) << std::endl;
+
+    if (numberThreads > 1) {
+        ml::core::stopDefaultAsyncExecutor();
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -137,6 +137,7 @@ public:
         core_t::TTime s_LatestRecordTime;
         core_t::TTime s_LastResultsTime;
         TKeyCRefAnomalyDetectorPtrPrVec s_Detectors;
+        std::size_t s_CopyNumber{0};
     };
 
     using TBackgroundPersistArgsPtr = std::shared_ptr<SBackgroundPersistArgs>;
@@ -167,6 +168,19 @@ public:
     bool restoreState(core::CDataSearcher& restoreSearcher,
                       core_t::TTime& completeToTime) override;
 
+    //! Set whether to persist state in the compact binary format rather than
+    //! JSON. State in either format can be restored.
+    void persistInBinaryFormat(bool binary);
+
+    //! Set the maximum number of consecutive periodic background snapshots
+    //! which only contain the person models which have changed since the
+    //! previous snapshot. Zero means every snapshot is complete.
+    //!
+    //! A delta snapshot records the ID of the previous snapshot in the chain
+    //! and is restored from a stream containing it followed by each of the
+    //! older snapshots back to the last full snapshot, newest first.
+    void maxDeltaSnapshots(std::size_t maxDeltas);
+
     //! Persist state in the foreground. As this blocks the current thread of execution
     //! it should only be called in special circumstances, e.g. at job close, where it won't impact job analysis.
     bool persistStateInForeground(core::CDataAdder& persister,
@@ -229,6 +243,20 @@ private:
     //! Write out interim results for the bucket starting at \p bucketStartTime.
     void outputInterimResults(core_t::TTime bucketStartTime);
 
+    //! Build the results of \p detectors for the bucket starting at
+    //! \p bucketStartTime concurrently if this is possible.
+    //!
+    //! The results of each detector are built separately and merged into
+    //! \p results in the order of \p detectors, so they are identical to
+    //! building them sequentially.
+    //!
+    //! \return True if the results were built and false if the detectors'
+    //! results must be built sequentially.
+    bool buildResultsConcurrently(bool interim,
+                                  core_t::TTime bucketStartTime,
+                                  const TKeyCRefAnomalyDetectorPtrPrVec& detectors,
+                                  model::CHierarchicalResults& results) const;
+
     //! Helper function for outputResults.
     //! \p processingTime is the processing time of the bucket
     void writeOutResults(bool interim,
@@ -239,20 +267,36 @@ private:
     //! Reset buckets in the range specified by the control message.
     void resetBuckets(const std::string& controlMessage);
 
-    //! Attempt to restore the detectors
+    //! Attempt to restore the detectors from one snapshot.
+    //!
+    //! \param[in] isNewest True if this is the newest snapshot in a chain
+    //! of delta snapshots. Only detectors are restored from older snapshots.
+    //! \param[out] olderSnapshots Set to the number of older snapshots which
+    //! must be restored if the newest snapshot is a delta.
     bool restoreState(core::CStateRestoreTraverser& traverser,
                       core_t::TTime& completeToTime,
-                      std::size_t& numDetectors);
+                      std::size_t& numDetectors,
+                      bool isNewest,
+                      std::size_t& olderSnapshots);
 
     //! Attempt to restore one detector from an already-created traverser.
-    bool restoreSingleDetector(core::CStateRestoreTraverser& traverser);
+    //! If \p isOlder is true this is only used to restore the models missing
+    //! from the detector restored from a newer snapshot.
+    bool restoreSingleDetector(bool isOlder, core::CStateRestoreTraverser& traverser);
 
     //! Restore the detector identified by \p key and \p partitionFieldValue
     //! from \p traverser.
+    //!
+    //! If more than one thread is available the detector's state is copied
+    //! and it is restored later by restorePendingDetectors.
     bool restoreDetectorState(const model::CSearchKey& key,
                               const std::string& partitionFieldValue,
                               core::CStateRestoreTraverser& traverser);
 
+    //! Concurrently restore the detectors whose state has been copied by
+    //! restoreDetectorState.
+    bool restorePendingDetectors();
+
     //! Persist current state in the background
     bool backgroundPersistState();
 
@@ -263,7 +307,9 @@ private:
     //! This function is called from the persistence manager when foreground persistence is triggered
     bool runForegroundPersist(core::CDataAdder& persister);
 
-    //! Persist the detectors to a stream.
+    //! Persist the detectors to a stream. If \p delta is true the snapshot
+    //! only contains the person models which have changed since the previous
+    //! snapshot.
     bool persistCopiedState(const std::string& description,
                             const std::string& snapshotId,
                             core_t::TTime snapshotTimestamp,
@@ -275,6 +321,7 @@ private:
                             const std::string& normalizerState,
                             core_t::TTime latestRecordTime,
                             core_t::TTime lastResultsTime,
+                            bool delta,
                             core::CDataAdder& persister);
 
     //! Persist current state due to the periodic persistence being triggered.
@@ -386,6 +433,20 @@ private:
                    core_t::TTime time,
                    const TStrStrUMap& dataRowFields);
 
+    //! Extract the required fields from \p dataRowFields and buffer the new
+    //! record for \p detector in the shard of \p partitionFieldValue.
+    void bufferRecord(const TAnomalyDetectorPtr& detector,
+                      const std::string& partitionFieldValue,
+                      core_t::TTime time,
+                      const TStrStrUMap& dataRowFields);
+
+    //! Add all buffered records to their detectors.
+    //!
+    //! This must be called before anything reads or modifies the detectors'
+    //! state, i.e. before results are output, before handling any control
+    //! message and before persisting or pruning.
+    void flushRecordShards();
+
     //! Parses a control message requesting that model state be persisted.
     //! Extracts optional arguments to be used for persistence.
     static bool parsePersistControlMessageArgs(const std::string& controlMessageArgs,
@@ -419,6 +480,27 @@ protected:
     //! be pruned, i.e. those which are so old as to be effectively dead.
     void pruneAllModels(std::size_t buckets = 0);
 
+private:
+    //! \brief A record buffered for adding to a detector.
+    struct SBufferedRecord {
+        model::CAnomalyDetector* s_Detector;
+        core_t::TTime s_Time;
+        TStrVec s_FieldValues;
+        //! The field values which are missing from the record.
+        std::vector<bool> s_Missing;
+    };
+    using TBufferedRecordVec = std::vector<SBufferedRecord>;
+    using TBufferedRecordVecVec = std::vector<TBufferedRecordVec>;
+
+    //! \brief The copied state of a detector waiting to be restored.
+    struct SPendingDetectorRestore {
+        model::CAnomalyDetector* s_Detector;
+        std::string s_Description;
+        std::string s_PartitionFieldValue;
+        std::string s_State;
+    };
+    using TPendingDetectorRestoreVec = std::vector<SPendingDetectorRestore>;
+
 private:
     //! The job ID
     std::string m_JobId;
@@ -454,6 +536,23 @@ private:
     //! Map of objects to provide the inner workings
     TKeyAnomalyDetectorPtrUMap m_Detectors;
 
+    //! The records waiting to be added to their detectors by shard. These
+    //! are only used if there are partition fields and more than one thread
+    //! is available. Records are assigned to shards by their partition field
+    //! values so each detector's records are all added by the same thread,
+    //! in the order they were received.
+    TBufferedRecordVecVec m_RecordShards;
+
+    //! The total number of buffered records.
+    std::size_t m_NumberBufferedRecords{0};
+
+    //! The detectors whose state has been read but not yet restored. These
+    //! are only used if more than one thread is available.
+    TPendingDetectorRestoreVec m_PendingDetectorRestores;
+
+    //! The total size of the state of the pending detectors.
+    std::size_t m_PendingDetectorRestoreBytes{0};
+
     //! The end time of the last bucket out of latency window we've seen
     core_t::TTime m_LastFinalisedBucketEndTime;
 
@@ -467,6 +566,30 @@ private:
     //! is not required, for example in unit tests.
     CPersistenceManager* m_PersistenceManager;
 
+    //! If true state is persisted in the binary format.
+    bool m_PersistInBinaryFormat{false};
+
+    //! The maximum number of consecutive delta snapshots.
+    std::size_t m_MaxDeltaSnapshots{0};
+
+    //! The number of times the detectors have been copied for background
+    //! persistence.
+    std::size_t m_NumberPersistCopies{0};
+
+    //! \name Delta Snapshots
+    //! These are only used by background persistence which never runs
+    //! concurrently with itself.
+    //@{
+    //! The number of delta snapshots since the last full snapshot.
+    std::size_t m_NumberDeltaSnapshots{0};
+
+    //! The ID of the last snapshot or empty if it failed.
+    std::string m_LastSnapshotId;
+
+    //! The number of the copy of the detectors which was last persisted.
+    std::size_t m_LastPersistedCopyNumber{0};
+    //@}
+
     //! If we haven't output quantiles for this long due to a big anomaly
     //! we'll output them to reflect decay.  Non-positive values mean never.
     core_t::TTime m_MaxQuantileInterval;
@@ -64,7 +64,11 @@ namespace api {
 //! Executes forecast jobs async to the main thread
 //!
 //! IMPLEMENTATION DECISIONS:\n
-//! Uses only 1 thread as worker.
+//! Uses a small pool of worker threads so that forecast requests can run
+//! concurrently. Within a forecast the models are forecast in batches, in
+//! parallel on the default async executor, and the results of each batch
+//! are written in order. So the output of a forecast doesn't depend on the
+//! number of threads.
 //!
 //! The forecast runs in parallel to the main thread, this has
 //! various consequences:
@@ -75,7 +79,9 @@ namespace api {
 //! For the same reason, any field values are copied as they might get
 //! pruned in the main thread.
 //! Cloning also happens beforehand as the forecast job might hang in
-//! the queue for a while
+//! the queue for a while. The clones are snapshots which share the state
+//! that forecasting only reads with the live models, so this is cheap and
+//! the memory checks use the size of the snapshots.
 class API_EXPORT CForecastRunner final : private core::CNonCopyable {
 public:
     //! max open forecast requests
@@ -138,14 +144,17 @@ public:
     using TStrUSet = boost::unordered_set<std::string>;
 
 public:
-    //! Initialize and start the forecast runner thread
+    //! Initialize and start the forecast runner threads
     //! \p jobId The job ID
     //! \p strmOut The output stream to write forecast results to
+    //! \p numberWorkers The number of forecasts which can run concurrently.
+    //! This is capped at MAX_FORECAST_JOBS_IN_QUEUE.
     CForecastRunner(const std::string& jobId,
                     core::CJsonOutputStreamWrapper& strmOut,
-                    model::CResourceMonitor& resourceMonitor);
+                    model::CResourceMonitor& resourceMonitor,
+                    std::size_t numberWorkers = 1);
 
-    //! Destructor, cancels all queued forecast requests, finishes a running forecast.
+    //! Destructor, cancels all queued forecast requests, finishes running forecasts.
     //! To finish all remaining forecasts call finishForecasts() first.
     ~CForecastRunner();
 
@@ -242,6 +251,12 @@ private:
     //! The worker loop
     void forecastWorker();
 
+    //! Run the forecast \p forecastJob
+    void runForecast(SForecast& forecastJob);
+
+    //! Get the memory used by models of \p forecastJob held in memory
+    static std::size_t inMemoryModelUsage(const SForecast& forecastJob);
+
     //! Check for new jobs, blocks while waiting
     bool tryGetJob(SForecast& forecastJob);
 
@@ -284,8 +299,8 @@ private:
     //! note: we use the resource monitor only for checks at the moment
     model::CResourceMonitor& m_ResourceMonitor;
 
-    //! thread for the worker
-    std::thread m_Worker;
+    //! threads for the workers
+    std::vector<std::thread> m_Workers;
 
     //! indicator for worker
     std::atomic_bool m_Shutdown;
@@ -293,6 +308,10 @@ private:
     //! The 'queue' of forecast jobs to be executed
     std::list<SForecast> m_ForecastJobs;
 
+    //! The memory used by the models of queued and running forecasts which
+    //! are held in memory (guarded by m_Mutex)
+    std::size_t m_InMemoryModelUsage{0};
+
     //! Mutex
     std::mutex m_Mutex;
 
@@ -68,6 +68,9 @@ public:
     //! Get field names
     const TStrVec& fieldNames() const;
 
+    //! Get the names of the fields the record handler may mutate.
+    const TStrVec& mutableFieldNames() const;
+
     //! Read records from the stream.  The supplied reader function is called
     //! once per record.  If the supplied reader function returns false, reading
     //! will stop.  This method keeps reading until it reaches the end of the
@@ -44,6 +44,9 @@ public:
         std::string s_NormalizerState;
         core_t::TTime s_LatestRecordTime;
         core_t::TTime s_LatestFinalResultTime;
+        //! The ID of the previous snapshot if this is a delta snapshot,
+        //! otherwise empty.
+        std::string s_PreviousSnapshotId;
     };
 
 public:
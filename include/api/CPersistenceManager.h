@@ -27,6 +27,7 @@ namespace CPersistenceManagerTest {
 class CTestFixture;
 struct testCategorizationOnlyPersist;
 struct testBackgroundPersistCategorizationConsistency;
+struct testDeltaSnapshots;
 }
 
 namespace ml {
@@ -229,6 +230,7 @@ private:
     friend class CPersistenceManagerTest::CTestFixture;
     friend struct CPersistenceManagerTest::testCategorizationOnlyPersist;
     friend struct CPersistenceManagerTest::testBackgroundPersistCategorizationConsistency;
+    friend struct CPersistenceManagerTest::testDeltaSnapshots;
 };
 }
 }
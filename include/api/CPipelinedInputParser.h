@@ -0,0 +1,105 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_api_CPipelinedInputParser_h
+#define INCLUDED_ml_api_CPipelinedInputParser_h
+
+#include <core/CConcurrentQueue.h>
+
+#include <api/CInputParser.h>
+#include <api/ImportExport.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ml {
+namespace api {
+
+//! \brief
+//! Parses input on a separate thread to the one handling the records.
+//!
+//! DESCRIPTION:\n
+//! Wraps another input parser which is run on a producer thread. Each record
+//! it reads is copied into a buffer which is queued for the reader function
+//! to handle on the calling thread. This means parsing the input and handling
+//! the records can use two cores.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! There are a fixed number of record buffers, which are recycled once each
+//! record has been handled. If they are all in use the producer waits, so the
+//! memory used is bounded if the reader function is slower than the parser.
+//!
+//! Records, including control messages, are handled in exactly the order they
+//! are read so flush acknowledgements are unaffected.
+//!
+//! Mutable fields are registered against each buffer immediately before it is
+//! passed to the reader function because the buffer changes for every record.
+//!
+//! The wrapped parser must outlive objects of this class.
+//!
+class API_EXPORT CPipelinedInputParser : public CInputParser {
+public:
+    //! The number of records which can be buffered.
+    static constexpr std::size_t NUMBER_BUFFERS{512};
+
+public:
+    explicit CPipelinedInputParser(CInputParser& parser);
+
+    // Bring the other overloads into scope
+    using CInputParser::readStreamIntoMaps;
+    using CInputParser::readStreamIntoVecs;
+
+    //! Read records from the wrapped parser on a separate thread passing
+    //! them to \p readerFunc on this thread.
+    bool readStreamIntoMaps(const TMapReaderFunc& readerFunc,
+                            const TRegisterMutableFieldFunc& registerFunc) override;
+
+    //! Read records from the wrapped parser on a separate thread passing
+    //! them to \p readerFunc on this thread.
+    bool readStreamIntoVecs(const TVecReaderFunc& readerFunc,
+                            const TRegisterMutableFieldFunc& registerFunc) override;
+
+private:
+    //! \brief A buffer for a single record.
+    struct SRecord {
+        TStrStrUMap s_Fields;
+        TStrVec s_FieldNames;
+        TStrVec s_FieldValues;
+    };
+    using TRecordUPtr = std::unique_ptr<SRecord>;
+    using TRecordQueue = core::CConcurrentQueue<TRecordUPtr, NUMBER_BUFFERS + 1>;
+    using TFillRecordFunc = std::function<void(SRecord&)>;
+    using TQueueRecordFunc = std::function<bool(const TFillRecordFunc&)>;
+    using TProducerFunc = std::function<bool(const TQueueRecordFunc&)>;
+    using TConsumerFunc = std::function<bool(SRecord&)>;
+
+private:
+    //! Run \p producer on a separate thread passing each record it queues
+    //! to \p consumer on this thread.
+    bool pipeline(const TProducerFunc& producer, const TConsumerFunc& consumer);
+
+private:
+    //! The parser which reads the input.
+    CInputParser& m_Parser;
+
+    //! Records waiting to be handled. A null record marks the end of input.
+    TRecordQueue m_ReadyRecords;
+
+    //! Buffers which are free to be reused.
+    TRecordQueue m_FreeRecords;
+
+    //! Set if the reader function asked to stop reading.
+    std::atomic<bool> m_Stop{false};
+};
+}
+}
+
+#endif // INCLUDED_ml_api_CPipelinedInputParser_h
@@ -0,0 +1,117 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_core_CBinaryStatePersistInserter_h
+#define INCLUDED_ml_core_CBinaryStatePersistInserter_h
+
+#include <core/CStatePersistInserter.h>
+#include <core/ImportExport.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace ml {
+namespace core {
+
+//! \brief
+//! For persisting state in a compact binary format.
+//!
+//! DESCRIPTION:\n
+//! Concrete implementation of the CStatePersistInserter interface that
+//! persists state as a sequence of tokens. Each token is a single byte
+//! type followed by a tag, which is its length as a varint followed by
+//! its characters, and then the value. Strings are length prefixed,
+//! integers are varints (zig-zag encoded if signed) and floating point
+//! values are the raw little endian IEEE754 bytes. Levels are delimited
+//! by start and end tokens.
+//!
+//! The state starts with a marker comprising a byte which can't start a
+//! JSON document, followed by "ml" and the format version. This lets the
+//! format be detected on restore, see CBinaryStateRestoreTraverser.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! This avoids formatting and parsing numbers as decimal text, which is
+//! the dominant cost persisting and restoring large models.
+//!
+//! Values stored with reduced precision, or which are exactly representable
+//! as a float, use four bytes.
+//!
+//! Output is buffered and written to the stream in large blocks.
+//!
+class CORE_EXPORT CBinaryStatePersistInserter : public CStatePersistInserter {
+public:
+    //! The token types.
+    enum EToken : std::uint8_t {
+        E_EndLevel = 0,
+        E_StartLevel = 1,
+        E_String = 2,
+        E_Double = 3,
+        E_Float = 4,
+        E_Signed = 5,
+        E_Unsigned = 6
+    };
+
+    //! The marker at the start of the state.
+    static const std::string MARKER;
+    //! The current format version.
+    static constexpr std::uint8_t VERSION{1};
+
+public:
+    explicit CBinaryStatePersistInserter(std::ostream& outputStream);
+
+    //! Destructor ends the root level and flushes
+    ~CBinaryStatePersistInserter() override;
+
+    //! Store a name/value
+    void insertValue(const std::string& name, const std::string& value) override;
+
+    //! Store a floating point number with a given level of precision
+    void insertValue(const std::string& name, double value, CIEEE754::EPrecision precision) override;
+
+    // Bring extra base class overloads into scope
+    using CStatePersistInserter::insertValue;
+
+    //! Flush the underlying output stream
+    void flush();
+
+protected:
+    //! Start a new level with the given name
+    void newLevel(const std::string& name) override;
+
+    //! End the current level
+    void endLevel() override;
+
+    //! Store a double as its raw bytes.
+    void insertDouble(const std::string& name, double value) override;
+
+    //! Store a signed integer as a zig-zag encoded varint.
+    void insertSigned(const std::string& name, std::int64_t value) override;
+
+    //! Store an unsigned integer as a varint.
+    void insertUnsigned(const std::string& name, std::uint64_t value) override;
+
+private:
+    void writeToken(EToken token, const std::string& name);
+    void writeVarint(std::uint64_t value);
+    void writeLittleEndian(std::uint64_t bits, std::size_t bytes);
+    void writeIfFull();
+
+private:
+    //! The stream to which state is written.
+    std::ostream& m_OutputStream;
+
+    //! Buffers output between writes to the stream.
+    std::string m_Buffer;
+};
+}
+}
+
+#endif // INCLUDED_ml_core_CBinaryStatePersistInserter_h
@@ -0,0 +1,141 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_core_CBinaryStateRestoreTraverser_h
+#define INCLUDED_ml_core_CBinaryStateRestoreTraverser_h
+
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CStateRestoreTraverser.h>
+#include <core/ImportExport.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ml {
+namespace core {
+
+//! \brief
+//! For restoring state in the binary format.
+//!
+//! DESCRIPTION:\n
+//! Concrete implementation of the CStateRestoreTraverser interface that
+//! restores state written by CBinaryStatePersistInserter.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Input is streaming and read in large blocks.
+//!
+//! Numeric values are only converted to strings if they are requested via
+//! value(). Restore code which uses valueAs reads them directly.
+//!
+//! When traversal ascends before the end of a level, or moves past an
+//! element which has a sub-level, the skipped tokens are read and discarded.
+//!
+class CORE_EXPORT CBinaryStateRestoreTraverser : public CStateRestoreTraverser {
+public:
+    using TStateRestoreTraverserUPtr = std::unique_ptr<CStateRestoreTraverser>;
+
+public:
+    explicit CBinaryStateRestoreTraverser(std::istream& inputStream);
+
+    //! Check if \p inputStream contains state in the binary format. This
+    //! only peeks at the first character so doesn't consume any input.
+    static bool isBinaryFormat(std::istream& inputStream);
+
+    //! Create a traverser for the format of the state in \p inputStream.
+    static TStateRestoreTraverserUPtr makeTraverser(std::istream& inputStream);
+
+    //! Navigate to the next element at the current level, or return false
+    //! if there isn't one
+    bool next() override;
+
+    //! Does the current element have a sub-level?
+    bool hasSubLevel() const override;
+
+    //! Get the name of the current element - the returned reference is only
+    //! valid for as long as the traverser is pointing at the same element
+    const std::string& name() const override;
+
+    //! Get the value of the current element - the returned reference is
+    //! only valid for as long as the traverser is pointing at the same
+    //! element
+    const std::string& value() const override;
+
+    //! Get the value of the current element if it is a number.
+    TNumericValue numericValue() const override;
+
+    //! Is the traverser at the end of the inputstream?
+    bool isEof() const override;
+
+protected:
+    //! Navigate to the start of the sub-level of the current element, or
+    //! return false if there isn't one
+    bool descend() override;
+
+    //! Navigate to the element of the level above from which descend() was
+    //! called, or return false if there isn't a level above
+    bool ascend() override;
+
+private:
+    using EToken = CBinaryStatePersistInserter::EToken;
+    using TStrVec = std::vector<std::string>;
+
+    //! \brief The current element.
+    struct SElement {
+        EToken s_Type{CBinaryStatePersistInserter::E_EndLevel};
+        std::string s_Name;
+        std::string s_Value;
+        TNumericValue s_Number;
+        //! True if s_Value holds the value.
+        bool s_HaveValue{true};
+    };
+
+private:
+    //! Check the marker and read the first element.
+    bool start();
+
+    //! Read the next token into the current element. Returns false if
+    //! it is the end of the level or the input is bad.
+    bool readElement();
+
+    //! Skip to the end of the level of the current element.
+    bool skipLevel();
+
+    bool readByte(std::uint8_t& byte);
+    bool readBytes(std::size_t n, std::string& result);
+    bool readVarint(std::uint64_t& result);
+    bool readLittleEndian(std::size_t bytes, std::uint64_t& result);
+    bool fill();
+    bool fail(const std::string& reason);
+
+private:
+    //! The stream from which state is read.
+    std::istream& m_InputStream;
+
+    //! Buffers input between reads from the stream.
+    std::vector<char> m_Buffer;
+    std::size_t m_Position{0};
+    std::size_t m_End{0};
+
+    //! Set once the marker has been read.
+    bool m_Started{false};
+
+    //! The current element.
+    mutable SElement m_Current;
+
+    //! The names of the elements whose sub-levels are being traversed.
+    TStrVec m_Parents;
+};
+}
+}
+
+#endif // INCLUDED_ml_core_CBinaryStateRestoreTraverser_h
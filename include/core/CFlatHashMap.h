@@ -0,0 +1,457 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#ifndef INCLUDED_ml_core_CFlatHashMap_h
+#define INCLUDED_ml_core_CFlatHashMap_h
+
+#include <core/CMemoryDefStd.h>
+#include <core/CMemoryUsage.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace ml {
+namespace core {
+
+//! \brief An open addressing hash map which stores its values inline.
+//!
+//! DESCRIPTION:\n
+//! A hash map with a subset of the boost::unordered_map interface which
+//! stores its (key, value) pairs in a single contiguous array. This avoids
+//! a heap allocation per insert and keeps lookups for small keys in one or
+//! two cache lines, which matters for maps which are updated for every
+//! record, such as the per bucket counts in the data gatherers.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! The table size is a power of two and collisions are resolved by linear
+//! probing. Each slot has a control byte which is either empty, deleted or
+//! holds the low seven bits of the key's hash, so most probes which miss
+//! never compare keys. Hashes are mixed with a multiplicative hash before
+//! taking the top bits, because boost::hash is the identity for integers.
+//!
+//! Erasing leaves a tombstone so erasing while iterating visits every
+//! element once. Tombstones are reused by inserts and are dropped when the
+//! table is rehashed.
+//!
+//! An empty map has no storage so it is cheap to keep many of them, for
+//! example one per bucket per influencer. The memory used is accounted
+//! for by core::memory::dynamicSize via the memoryUsage member.
+//!
+//! Keys and values must be default constructible and move assignable. As
+//! with boost::container::flat_map the value type is std::pair<K, V> and
+//! the key must not be modified through an iterator. Any insert can
+//! invalidate iterators and references.
+template<typename K, typename V, typename H = boost::hash<K>, typename P = std::equal_to<K>>
+class CFlatHashMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = H;
+    using key_equal = P;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    using TUInt8Vec = std::vector<std::uint8_t>;
+    using TValueVec = std::vector<value_type>;
+
+    //! \brief Iterates over the occupied slots.
+    template<bool CONST>
+    class CIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename CFlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<CONST, const value_type*, value_type*>;
+        using reference = std::conditional_t<CONST, const value_type&, value_type&>;
+        using TMapPtr = std::conditional_t<CONST, const CFlatHashMap*, CFlatHashMap*>;
+
+    public:
+        CIterator() = default;
+        CIterator(TMapPtr map, std::size_t slot) : m_Map{map}, m_Slot{slot} {
+            this->skipUnoccupied();
+        }
+        //! Converts an iterator to a const_iterator.
+        template<bool OTHER_CONST, typename = std::enable_if_t<CONST && !OTHER_CONST>>
+        CIterator(const CIterator<OTHER_CONST>& other)
+            : m_Map{other.m_Map}, m_Slot{other.m_Slot} {}
+
+        reference operator*() const { return m_Map->m_Values[m_Slot]; }
+        pointer operator->() const { return &m_Map->m_Values[m_Slot]; }
+
+        CIterator& operator++() {
+            ++m_Slot;
+            this->skipUnoccupied();
+            return *this;
+        }
+        CIterator operator++(int) {
+            CIterator result{*this};
+            ++(*this);
+            return result;
+        }
+
+        bool operator==(const CIterator& rhs) const {
+            return m_Slot == rhs.m_Slot;
+        }
+        bool operator!=(const CIterator& rhs) const {
+            return m_Slot != rhs.m_Slot;
+        }
+
+    private:
+        void skipUnoccupied() {
+            std::size_t n{m_Map->m_Control.size()};
+            while (m_Slot < n && isFull(m_Map->m_Control[m_Slot]) == false) {
+                ++m_Slot;
+            }
+        }
+
+    private:
+        TMapPtr m_Map = nullptr;
+        std::size_t m_Slot = 0;
+
+        template<bool>
+        friend class CIterator;
+        friend class CFlatHashMap;
+    };
+
+public:
+    using iterator = CIterator<false>;
+    using const_iterator = CIterator<true>;
+
+public:
+    CFlatHashMap() = default;
+    explicit CFlatHashMap(std::size_t n) { this->reserve(n); }
+
+    //! \name Iteration
+    //@{
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, m_Control.size()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, m_Control.size()}; }
+    const_iterator cbegin() const { return this->begin(); }
+    const_iterator cend() const { return this->end(); }
+    //@}
+
+    //! \name Capacity
+    //@{
+    bool empty() const { return m_Size == 0; }
+    std::size_t size() const { return m_Size; }
+    //! Get the number of slots in the table.
+    std::size_t capacity() const { return m_Control.size(); }
+    //! Get the number of bytes used for each slot in the table.
+    static constexpr std::size_t slotSize() {
+        return sizeof(value_type) + sizeof(std::uint8_t);
+    }
+    //@}
+
+    //! \name Lookup
+    //@{
+    iterator find(const K& key) { return {this, this->findSlot(key)}; }
+    const_iterator find(const K& key) const {
+        return {this, this->findSlot(key)};
+    }
+    std::size_t count(const K& key) const {
+        return this->findSlot(key) == m_Control.size() ? 0 : 1;
+    }
+    //! Get the value for \p key, inserting a default value if it is missing.
+    V& operator[](const K& key) { return this->emplace(key).first->second; }
+    //@}
+
+    //! \name Modifiers
+    //@{
+    //! Insert \p key with a value constructed from \p args if it is missing.
+    //!
+    //! \note The value is only constructed if \p key is missing, i.e. this
+    //! has the semantics of std::map::try_emplace.
+    template<typename... ARGS>
+    std::pair<iterator, bool> emplace(const K& key, ARGS&&... args) {
+        std::uint64_t hash{mix(m_Hasher(key))};
+        std::size_t slot{this->findSlot(key, hash)};
+        if (slot != m_Control.size()) {
+            return {iterator{this, slot}, false};
+        }
+        slot = this->insertSlot(hash);
+        m_Values[slot].first = key;
+        m_Values[slot].second = V(std::forward<ARGS>(args)...);
+        return {iterator{this, slot}, true};
+    }
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return this->emplace(value.first, value.second);
+    }
+    //! Erase the element at \p i.
+    //!
+    //! \return An iterator to the element after \p i.
+    iterator erase(const_iterator i) {
+        this->eraseSlot(i.m_Slot);
+        return {this, i.m_Slot + 1};
+    }
+    //! Erase \p key if it is present.
+    std::size_t erase(const K& key) {
+        std::size_t slot{this->findSlot(key)};
+        if (slot == m_Control.size()) {
+            return 0;
+        }
+        this->eraseSlot(slot);
+        return 1;
+    }
+    //! Remove all elements but retain the table.
+    void clear() {
+        if constexpr (std::is_trivially_destructible<value_type>::value) {
+            // Stale values hold no resources and are overwritten when
+            // their slot is next used.
+            std::fill(m_Control.begin(), m_Control.end(), EMPTY);
+        } else {
+            for (std::size_t i = 0; i < m_Control.size(); ++i) {
+                if (m_Control[i] != EMPTY) {
+                    m_Control[i] = EMPTY;
+                    m_Values[i] = value_type{};
+                }
+            }
+        }
+        m_Size = 0;
+        m_Deleted = 0;
+    }
+    //! Remove all elements so the map can be reused for similar data.
+    //!
+    //! This retains the table unless it is more than twice the size needed
+    //! for the elements it held, so maps which are refilled with roughly
+    //! the same number of elements, such as per bucket data, don't allocate
+    //! but a one off spike doesn't pin memory.
+    void recycle() {
+        if (m_Control.size() > 2 * minimumCapacity(m_Size)) {
+            TUInt8Vec{}.swap(m_Control);
+            TValueVec{}.swap(m_Values);
+            m_Size = 0;
+            m_Deleted = 0;
+            m_Shift = 64;
+        } else {
+            this->clear();
+        }
+    }
+    //! Make sure \p n elements can be stored without rehashing.
+    void reserve(std::size_t n) {
+        std::size_t capacity{this->minimumCapacity(n)};
+        if (capacity > m_Control.size()) {
+            this->rehash(capacity);
+        }
+    }
+    void swap(CFlatHashMap& other) noexcept {
+        std::swap(m_Control, other.m_Control);
+        std::swap(m_Values, other.m_Values);
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Deleted, other.m_Deleted);
+        std::swap(m_Shift, other.m_Shift);
+        std::swap(m_Hasher, other.m_Hasher);
+        std::swap(m_Equal, other.m_Equal);
+    }
+    //@}
+
+    //! Debug the memory used by this object.
+    void debugMemoryUsage(const CMemoryUsage::TMemoryUsagePtr& mem) const {
+        std::string name{"CFlatHashMap::"};
+        name += typeid(value_type).name();
+        std::size_t table{this->tableMemoryUsage()};
+        mem->setName(CMemoryUsage::SMemoryUsage{name, table, table - m_Size * slotSize()});
+        if constexpr (memory_detail::SDynamicSizeAlwaysZero<value_type>::value() == false) {
+            for (const auto& value : *this) {
+                memory_debug::dynamicSize("value", value, mem);
+            }
+        }
+    }
+
+    //! Get the memory used by this object.
+    std::size_t memoryUsage() const {
+        return memory::elementDynamicSize(*this) + this->tableMemoryUsage();
+    }
+
+    //! Check if two maps contain the same (key, value) pairs.
+    bool operator==(const CFlatHashMap& rhs) const {
+        if (m_Size != rhs.m_Size) {
+            return false;
+        }
+        for (const auto& value : *this) {
+            auto i = rhs.find(value.first);
+            if (i == rhs.end() || (i->second == value.second) == false) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const CFlatHashMap& rhs) const {
+        return (*this == rhs) == false;
+    }
+
+private:
+    //! \name Control Byte Values
+    //@{
+    static constexpr std::uint8_t EMPTY{0x00};
+    static constexpr std::uint8_t DELETED{0x01};
+    static constexpr std::uint8_t FULL{0x80};
+    //@}
+    //! The smallest non-empty table.
+    static constexpr std::size_t MINIMUM_CAPACITY{8};
+
+private:
+    static bool isFull(std::uint8_t control) { return (control & FULL) != 0; }
+
+    //! Spread the bits of \p hash over the high bits.
+    static std::uint64_t mix(std::size_t hash) {
+        return static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15;
+    }
+
+    //! Get the control byte for \p hash.
+    static std::uint8_t control(std::uint64_t hash) {
+        return static_cast<std::uint8_t>(FULL | (hash & 0x7F));
+    }
+
+    //! Get the slot at which to start probing for \p hash.
+    std::size_t home(std::uint64_t hash) const {
+        return static_cast<std::size_t>(hash >> m_Shift);
+    }
+
+    //! Get the bytes allocated for the table.
+    //!
+    //! \note This can exceed capacity() * slotSize() because assigning a
+    //! smaller map reuses the table's storage.
+    std::size_t tableMemoryUsage() const {
+        return m_Control.capacity() * sizeof(std::uint8_t) +
+               m_Values.capacity() * sizeof(value_type);
+    }
+
+    //! Get the smallest table which can store \p n elements.
+    static std::size_t minimumCapacity(std::size_t n) {
+        if (n == 0) {
+            return 0;
+        }
+        std::size_t result{MINIMUM_CAPACITY};
+        while (maxLoad(result) < n) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    //! The maximum number of occupied or deleted slots for \p capacity.
+    static std::size_t maxLoad(std::size_t capacity) {
+        return capacity - capacity / 8;
+    }
+
+    std::size_t findSlot(const K& key) const {
+        return this->findSlot(key, m_Control.empty() ? 0 : mix(m_Hasher(key)));
+    }
+
+    //! Get the slot containing \p key or capacity() if it is missing.
+    std::size_t findSlot(const K& key, std::uint64_t hash) const {
+        std::size_t n{m_Control.size()};
+        if (m_Size == 0) {
+            return n;
+        }
+        std::uint8_t target{control(hash)};
+        std::size_t mask{n - 1};
+        for (std::size_t i = this->home(hash), probes = 0; probes < n;
+             i = (i + 1) & mask, ++probes) {
+            std::uint8_t current{m_Control[i]};
+            if (current == EMPTY) {
+                break;
+            }
+            if (current == target && m_Equal(m_Values[i].first, key)) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    //! Get a free slot for a key with \p hash, which must be missing.
+    std::size_t insertSlot(std::uint64_t hash) {
+        if (m_Size + m_Deleted + 1 > maxLoad(m_Control.size())) {
+            // Only grow if dropping the tombstones would still leave the
+            // table more than three quarters full.
+            std::size_t capacity{std::max(m_Control.size(), MINIMUM_CAPACITY)};
+            if (4 * (m_Size + 1) > 3 * maxLoad(capacity)) {
+                capacity *= 2;
+            }
+            this->rehash(capacity);
+        }
+        std::size_t mask{m_Control.size() - 1};
+        std::size_t i{this->home(hash)};
+        while (isFull(m_Control[i])) {
+            i = (i + 1) & mask;
+        }
+        if (m_Control[i] == DELETED) {
+            --m_Deleted;
+        }
+        m_Control[i] = control(hash);
+        ++m_Size;
+        return i;
+    }
+
+    void eraseSlot(std::size_t slot) {
+        m_Control[slot] = DELETED;
+        m_Values[slot] = value_type{};
+        --m_Size;
+        ++m_Deleted;
+    }
+
+    //! Move the elements to a table with \p capacity slots.
+    void rehash(std::size_t capacity) {
+        TUInt8Vec control(capacity, EMPTY);
+        TValueVec values(capacity);
+        control.swap(m_Control);
+        values.swap(m_Values);
+        m_Deleted = 0;
+        m_Shift = 64;
+        for (std::size_t n = capacity; n > 1; n /= 2) {
+            --m_Shift;
+        }
+        std::size_t mask{capacity - 1};
+        for (std::size_t i = 0; i < control.size(); ++i) {
+            if (isFull(control[i])) {
+                std::uint64_t hash{mix(m_Hasher(values[i].first))};
+                std::size_t j{this->home(hash)};
+                while (m_Control[j] != EMPTY) {
+                    j = (j + 1) & mask;
+                }
+                m_Control[j] = control[i];
+                m_Values[j] = std::move(values[i]);
+            }
+        }
+    }
+
+private:
+    //! The control byte for each slot.
+    TUInt8Vec m_Control;
+    //! The (key, value) pair for each slot.
+    TValueVec m_Values;
+    //! The number of elements.
+    std::size_t m_Size = 0;
+    //! The number of tombstones.
+    std::size_t m_Deleted = 0;
+    //! The shift which maps a mixed hash to a slot.
+    int m_Shift = 64;
+    hasher m_Hasher;
+    key_equal m_Equal;
+};
+}
+}
+
+#endif // INCLUDED_ml_core_CFlatHashMap_h
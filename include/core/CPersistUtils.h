@@ -741,8 +741,14 @@ class CPersisterImpl<BasicPersist> {
 public:
     template<typename T>
     static void dispatch(const std::string& tag, const T& t, CStatePersistInserter& inserter) {
-        CPersistUtils::CBuiltinToString toString(CPersistUtils::PAIR_DELIMITER);
-        inserter.insertValue(tag, toString(t));
+        if constexpr (std::is_same_v<T, double>) {
+            inserter.insertValue(tag, t, CIEEE754::E_DoublePrecision);
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) >= sizeof(int)) {
+            inserter.insertValue(tag, t);
+        } else {
+            CPersistUtils::CBuiltinToString toString(CPersistUtils::PAIR_DELIMITER);
+            inserter.insertValue(tag, toString(t));
+        }
     }
 
     template<typename A, typename B>
@@ -937,8 +943,13 @@ public:
     template<typename T>
     static bool dispatch(const std::string& tag, T& t, CStateRestoreTraverser& traverser) {
         if (traverser.name() == tag) {
-            CPersistUtils::CBuiltinFromString stringFunc{CPersistUtils::PAIR_DELIMITER};
-            return stringFunc(traverser.value(), t);
+            if constexpr (std::is_same_v<T, double> ||
+                          (std::is_integral_v<T> && sizeof(T) >= sizeof(int))) {
+                return traverser.valueAs(t);
+            } else {
+                CPersistUtils::CBuiltinFromString stringFunc{CPersistUtils::PAIR_DELIMITER};
+                return stringFunc(traverser.value(), t);
+            }
         }
         return true;
     }
@@ -15,8 +15,10 @@
 #include <core/CStringUtils.h>
 #include <core/ImportExport.h>
 
+#include <cstdint>
 #include <ostream>
 #include <string>
+#include <type_traits>
 
 namespace ml {
 namespace core {
@@ -113,7 +115,9 @@ using TPersistenceTag = CPersistenceTag;
 //! IMPLEMENTATION DECISIONS:\n
 //! Not copyable.
 //!
-//! All values are stored as strings.
+//! By default all values are stored as strings. Implementations can store
+//! numeric values directly by overriding insertDouble, insertSigned,
+//! insertUnsigned and the overload which takes a precision.
 //!
 class CORE_EXPORT CStatePersistInserter : private CNonCopyable {
 public:
@@ -131,7 +135,17 @@ public:
     //! Store an arbitrary type that can be converted to a string
     template<typename TYPE>
     void insertValue(const std::string& name, const TYPE& value) {
-        this->insertValue(name, CStringUtils::typeToString(value));
+        if constexpr (std::is_same_v<TYPE, double>) {
+            this->insertDouble(name, value);
+        } else if constexpr (isInteger<TYPE>()) {
+            if constexpr (std::is_signed_v<TYPE>) {
+                this->insertSigned(name, static_cast<std::int64_t>(value));
+            } else {
+                this->insertUnsigned(name, static_cast<std::uint64_t>(value));
+            }
+        } else {
+            this->insertValue(name, CStringUtils::typeToString(value));
+        }
     }
 
     //! Store an arbitrary type that can be converted to a string
@@ -142,7 +156,8 @@ public:
     }
 
     //! Store a floating point number with a given level of precision
-    void insertValue(const std::string& name, double value, CIEEE754::EPrecision precision);
+    virtual void
+    insertValue(const std::string& name, double value, CIEEE754::EPrecision precision);
 
     //! Store a floating point number with a given level of precision
     //! with choice of tag format
@@ -175,6 +190,25 @@ protected:
     //! End the current level
     virtual void endLevel() = 0;
 
+    //! Store a double which was passed without a precision.
+    virtual void insertDouble(const std::string& name, double value);
+
+    //! Store a signed integer.
+    virtual void insertSigned(const std::string& name, std::int64_t value);
+
+    //! Store an unsigned integer.
+    virtual void insertUnsigned(const std::string& name, std::uint64_t value);
+
+private:
+    //! Check if \p T is an integer type which isn't a character or boolean.
+    template<typename T>
+    static constexpr bool isInteger() {
+        return std::is_integral_v<T> && std::is_same_v<T, bool> == false &&
+               std::is_same_v<T, char> == false &&
+               std::is_same_v<T, signed char> == false &&
+               std::is_same_v<T, unsigned char> == false;
+    }
+
 private:
     //! Class to implement RAII for moving to the next level
     class CORE_EXPORT CAutoLevel : private CNonCopyable {
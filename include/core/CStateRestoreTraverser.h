@@ -12,11 +12,15 @@
 #define INCLUDED_ml_core_CStateRestoreTraverser_h
 
 #include <core/CLogger.h>
+#include <core/CStringUtils.h>
 
 #include <core/ImportExport.h>
 
+#include <cstdint>
 #include <exception>
 #include <string>
+#include <type_traits>
+#include <variant>
 
 namespace ml {
 namespace core {
@@ -40,9 +44,14 @@ namespace core {
 //! that the next() method returns false when the end of a particular
 //! sub-level is reached.
 //!
-//! All values are returned as strings.
+//! All values are available as strings. Formats which store numeric values
+//! directly can also return them via numericValue so that valueAs avoids
+//! converting them to and from strings.
 //!
 class CORE_EXPORT CStateRestoreTraverser {
+public:
+    using TNumericValue = std::variant<std::monostate, double, std::int64_t, std::uint64_t>;
+
 public:
     CStateRestoreTraverser();
 
@@ -91,6 +100,33 @@ public:
     //! element
     virtual const std::string& value() const = 0;
 
+    //! Get the value of the current element if it was stored as a number.
+    //! The default is for all values to be stored as strings.
+    virtual TNumericValue numericValue() const { return {}; }
+
+    //! Convert the value of the current element to \p target.
+    //!
+    //! \note Numeric values are read directly if the format stores them.
+    template<typename T>
+    bool valueAs(T& target) const {
+        if constexpr (isNumeric<T>()) {
+            TNumericValue number{this->numericValue()};
+            if (const auto* value = std::get_if<std::int64_t>(&number)) {
+                return numericCast(*value, target);
+            }
+            if (const auto* value = std::get_if<std::uint64_t>(&number)) {
+                return numericCast(*value, target);
+            }
+            if constexpr (std::is_floating_point_v<T>) {
+                if (const auto* value = std::get_if<double>(&number)) {
+                    target = static_cast<T>(*value);
+                    return true;
+                }
+            }
+        }
+        return CStringUtils::stringToType(this->value(), target);
+    }
+
     //! Has the end of the inputstream been reached?
     virtual bool isEof() const = 0;
 
@@ -110,6 +146,39 @@ protected:
     //! called, or return false if there isn't a level above
     virtual bool ascend() = 0;
 
+private:
+    //! Check if \p T is a numeric type which isn't a character or boolean.
+    template<typename T>
+    static constexpr bool isNumeric() {
+        return std::is_arithmetic_v<T> && std::is_same_v<T, bool> == false &&
+               std::is_same_v<T, char> == false &&
+               std::is_same_v<T, signed char> == false &&
+               std::is_same_v<T, unsigned char> == false;
+    }
+
+    //! Convert \p value to \p target checking it is in range.
+    template<typename U, typename T>
+    static bool numericCast(U value, T& target) {
+        T result{static_cast<T>(value)};
+        if constexpr (std::is_integral_v<T>) {
+            if (isNegative(result) != isNegative(value) ||
+                static_cast<U>(result) != value) {
+                LOG_ERROR(<< "Value " << value << " is out of range");
+                return false;
+            }
+        }
+        target = result;
+        return true;
+    }
+
+    template<typename T>
+    static bool isNegative(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return value < T{0};
+        }
+        return false;
+    }
+
 private:
     //! Class to implement RAII for traversing the next level down
     class CORE_EXPORT CAutoLevel {
@@ -57,7 +57,7 @@ namespace core {
 
 #define RESTORE_BUILT_IN(tag, target)                                                  \
     if (name == tag) {                                                                 \
-        if (core::CStringUtils::stringToType(traverser.value(), target) == false) {    \
+        if (traverser.valueAs(target) == false) {                                      \
             if (traverser.value().empty()) {                                           \
                 LOG_ERROR(<< "Failed to restore " #tag);                               \
             } else {                                                                   \
@@ -71,7 +71,7 @@ namespace core {
 #define RESTORE_BOOL(tag, target)                                                      \
     if (name == tag) {                                                                 \
         int value;                                                                     \
-        if (core::CStringUtils::stringToType(traverser.value(), value) == false) {     \
+        if (traverser.valueAs(value) == false) {                                       \
             if (traverser.value().empty()) {                                           \
                 LOG_ERROR(<< "Failed to restore " #tag);                               \
             } else {                                                                   \
@@ -86,7 +86,7 @@ namespace core {
 #define RESTORE_ENUM(tag, target, enumtype)                                            \
     if (name == tag) {                                                                 \
         int value;                                                                     \
-        if (core::CStringUtils::stringToType(traverser.value(), value) == false) {     \
+        if (traverser.valueAs(value) == false) {                                       \
             if (traverser.value().empty()) {                                           \
                 LOG_ERROR(<< "Failed to restore " #tag);                               \
             } else {                                                                   \
@@ -21,6 +21,7 @@
 #include <maths/analytics/ImportExport.h>
 
 #include <maths/common/CBasicStatistics.h>
+#include <maths/common/CHnsw.h>
 #include <maths/common/CKdTree.h>
 #include <maths/common/CLinearAlgebraShims.h>
 #include <maths/common/COrthogonaliser.h>
@@ -59,8 +60,13 @@ template<typename POINT, typename NEAREST_NEIGHBOURS>
 class CNearestNeighbourMethod {
 public:
     using TPointVec = std::vector<POINT>;
+    using TPointVecVec = std::vector<TPointVec>;
     using TMatrix = typename common::SConformableMatrix<POINT>::Type;
 
+public:
+    //! The number of points whose nearest neighbours are looked up together.
+    static constexpr std::size_t QUERY_BLOCK_SIZE{64};
+
 public:
     CNearestNeighbourMethod(bool computeFeatureInfluence,
                             std::size_t k,
@@ -90,12 +96,21 @@ public:
 
         // We call add exactly once for each point. Scores is presized
         // so any writes to it are safe.
+        //
+        // The nearest neighbour queries are issued in blocks since batched
+        // queries share working space.
         TDouble1VecVec2Vec scores(this->numberMethods(), TDouble1VecVec(numberScores));
+        std::size_t numberBlocks{(points.size() + QUERY_BLOCK_SIZE - 1) / QUERY_BLOCK_SIZE};
         core::parallel_for_each(
-            points.begin(), points.end(),
-            [&, neighbours = TPointVec{} ](const POINT& point) mutable {
-                m_Lookup.nearestNeighbours(m_K + 1, point, neighbours);
-                this->add(point, projection, eps, neighbours, scores);
+            std::size_t{0}, numberBlocks,
+            [&, neighbours = TPointVecVec{} ](std::size_t block) mutable {
+                auto begin = points.begin() + block * QUERY_BLOCK_SIZE;
+                auto end = points.begin() +
+                           std::min((block + 1) * QUERY_BLOCK_SIZE, points.size());
+                m_Lookup.nearestNeighbours(m_K + 1, begin, end, neighbours);
+                for (std::size_t i = 0; begin != end; ++begin, ++i) {
+                    this->add(*begin, projection, eps, neighbours[i], scores);
+                }
             },
             [this](double fractionalProgress) {
                 this->recordProgress(fractionalProgress);
@@ -174,6 +189,17 @@ private:
 };
 
 //! \brief Computes the local outlier factor score.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Points which aren't in the nearest neighbour lookup are never neighbours
+//! of other points. Provided the local reachability densities of the lookup
+//! points are already known, their scores only depend on their own neighbours.
+//! In this case we stream them: for each point we keep only its mean
+//! reachability distance and the mean local reachability density of its
+//! neighbours rather than its neighbour list, local reachability density and
+//! the densities for each perturbed coordinate. This means the memory used
+//! to score a partition of the data doesn't depend on k or the number of
+//! feature influences.
 template<typename POINT, typename NEAREST_NEIGHBOURS>
 class CLof final : public CNearestNeighbourMethod<POINT, NEAREST_NEIGHBOURS> {
 public:
@@ -203,13 +229,16 @@ public:
             m_LrdAtEps.resize(m_NumberInfluences * m_StartAddresses);
             m_LrdAtEps.shrink_to_fit();
         }
+        m_QueryState.clear();
+        m_QueryState.shrink_to_fit();
     }
 
     std::size_t staticSize() const override { return sizeof(*this); }
 
     std::size_t memoryUsage() const override {
         return core::memory::dynamicSize(m_KDistances) +
-               core::memory::dynamicSize(m_Lrd) + core::memory::dynamicSize(m_LrdAtEps);
+               core::memory::dynamicSize(m_Lrd) + core::memory::dynamicSize(m_LrdAtEps) +
+               core::memory::dynamicSize(m_QueryState);
     }
 
     static std::size_t estimateOwnMemoryOverhead(bool computeFeatureInfluence,
@@ -221,6 +250,10 @@ public:
                 (computeFeatureInfluence ? dimension + 1 : 1) * sizeof(TCoordinate));
     }
 
+    static std::size_t estimateOwnMemoryOverheadForQueries(std::size_t numberPoints) {
+        return 2 * numberPoints * sizeof(double);
+    }
+
 private:
     void setup(const TPointVec& points, const TMatrix& projection) override {
 
@@ -233,10 +266,29 @@ private:
         m_StartAddresses = minmax.first->annotation();
         m_EndAddresses = minmax.second->annotation() + 1;
 
+        std::size_t k{this->k()};
+
+        // We can stream the points if none are in the lookup and we've already
+        // computed the local reachability densities of all the lookup points.
+        m_StreamQueries = m_StartAddresses >= this->n() && this->n() > 0 &&
+                          m_Lrd.size() >= this->n() &&
+                          std::none_of(m_Lrd.begin(), m_Lrd.begin() + this->n(),
+                                       [](const auto& lrd) {
+                                           return lrd == UNSET_DISTANCE;
+                                       });
+        if (m_StreamQueries) {
+            m_KDistances.resize(k * m_StartAddresses, {std::uint32_t{0}, UNSET_DISTANCE});
+            m_Lrd.resize(m_StartAddresses, UNSET_DISTANCE);
+            if (this->computeFeatureInfluence()) {
+                m_LrdAtEps.resize(m_NumberInfluences * m_StartAddresses, UNSET_DISTANCE);
+            }
+            m_QueryState.assign(2 * (m_EndAddresses - m_StartAddresses), 0.0);
+            return;
+        }
+
         // In the following, we first shrink then grow to ensure we overwrite
         // values in the range [start addresses, end addresses).
 
-        std::size_t k{this->k()};
         m_KDistances.resize(k * m_StartAddresses, {std::uint32_t{0}, UNSET_DISTANCE});
         m_KDistances.resize(k * m_EndAddresses, {std::uint32_t{0}, UNSET_DISTANCE});
         m_Lrd.resize(m_StartAddresses, UNSET_DISTANCE);
@@ -249,10 +301,14 @@ private:
 
     void add(const POINT& point, const TMatrix&, double, const TPointVec& neighbours, TDouble1VecVec&) override {
         // This is called exactly once for each point therefore an element
-        // of m_KDistances is only ever written by one thread.
+        // of m_KDistances or m_QueryState is only ever written by one thread.
         if (neighbours.size() < 2) {
             return;
         }
+        if (m_StreamQueries) {
+            this->addQuery(point, neighbours);
+            return;
+        }
         std::size_t i{point.annotation()};
         std::size_t a(point == neighbours[0] ? 1 : 0);
         std::size_t b{std::min(this->k() + a - 1, neighbours.size() + a - 2)};
@@ -268,12 +324,99 @@ private:
                  const TMatrix& projection,
                  double eps,
                  TDouble1VecVec& scores) override {
+        if (m_StreamQueries) {
+            this->computeQueryLocalOutlierFactors(points, projection, eps, scores);
+            return;
+        }
         this->computeLocalReachabilityDistances(points, projection, eps);
         this->computeLocalOutlierFactors(points, eps, scores);
     }
 
     std::string name() const override { return "lof"; }
 
+    void addQuery(const POINT& point, const TPointVec& neighbours) {
+        std::size_t a(point == neighbours[0] ? 1 : 0);
+        std::size_t b{std::min(this->k() + a - 1, neighbours.size() + a - 2)};
+        TMeanAccumulator reachability;
+        TMeanAccumulator neighbourhoodLrd;
+        for (std::size_t j = a; j <= b; ++j) {
+            TUInt32CoordinatePr neighbour{
+                static_cast<std::uint32_t>(neighbours[j].annotation()),
+                common::las::distance(point, neighbours[j])};
+            reachability.add(this->reachabilityDistance(neighbour));
+            neighbourhoodLrd.add(m_Lrd[index(neighbour)]);
+        }
+        std::size_t i{this->queryStateIndex(point.annotation())};
+        m_QueryState[i] = common::CBasicStatistics::mean(reachability);
+        m_QueryState[i + 1] = common::CBasicStatistics::mean(neighbourhoodLrd);
+    }
+
+    void computeQueryLocalOutlierFactors(const TPointVec& points,
+                                         const TMatrix& projection,
+                                         double eps,
+                                         TDouble1VecVec& scores) {
+
+        // This matches computeLocalReachabilityDistances followed by
+        // computeLocalOutlierFactors, but only needs the state of each
+        // point and its neighbours in the lookup.
+
+        using TMinAccumulator = common::CBasicStatistics::SMin<double>::TAccumulator;
+
+        TMinAccumulator min;
+        for (std::size_t i = 0; i < m_QueryState.size(); i += 2) {
+            if (m_QueryState[i] > 0.0) {
+                min.add(m_QueryState[i]);
+            }
+        }
+
+        core::parallel_for_each(
+            points.begin(), points.end(),
+            [&, neighbours = TPointVec{} ](const POINT& point) mutable {
+
+                std::size_t i{point.annotation()};
+                double reachability{m_QueryState[this->queryStateIndex(i)]};
+                double neighbourhoodLrd{m_QueryState[this->queryStateIndex(i) + 1]};
+
+                TCoordinate lrd(reachability > 0.0
+                                    ? 1.0 / reachability
+                                    : (min.count() > 0 ? 2.0 / min[0]
+                                                       : static_cast<double>(UNSET_DISTANCE)));
+
+                scores[i].resize(eps > 0.0 && this->computeFeatureInfluence()
+                                     ? m_NumberInfluences + 1
+                                     : 1);
+                scores[i][0] = neighbourhoodLrd / lrd;
+
+                if (scores[i].size() == 1) {
+                    return;
+                }
+
+                // We need to look up the nearest neighbours again since we
+                // don't retain them.
+                this->lookup().nearestNeighbours(this->k() + 1, point, neighbours);
+                if (neighbours.size() < 2) {
+                    for (std::size_t j = 1; j < scores[i].size(); ++j) {
+                        scores[i][j] = neighbourhoodLrd / UNSET_DISTANCE;
+                    }
+                    return;
+                }
+                std::size_t a(point == neighbours[0] ? 1 : 0);
+                std::size_t b{std::min(this->k() + a - 1, neighbours.size() + a - 2)};
+                for (std::size_t k = 0; k < m_NumberInfluences; ++k) {
+                    TMeanAccumulator reachability_;
+                    for (std::size_t j = a; j <= b; ++j) {
+                        reachability_.add(this->reachabilityDistance(
+                            {neighbours[j].annotation(),
+                             distanceAtEps(projection, k, eps, point, neighbours[j])}));
+                    }
+                    TCoordinate lrdAtEps(
+                        1.0 / std::max(common::CBasicStatistics::mean(reachability_),
+                                       min[0] / 2.0));
+                    scores[i][k + 1] = neighbourhoodLrd / lrdAtEps;
+                }
+            });
+    }
+
     void computeLocalReachabilityDistances(const TPointVec& points,
                                            const TMatrix& projection,
                                            double eps) {
@@ -387,6 +530,9 @@ private:
     std::size_t epsLrdIndex(std::size_t index, std::size_t coordinate) const {
         return index * m_NumberInfluences + coordinate;
     }
+    std::size_t queryStateIndex(std::size_t index) const {
+        return 2 * (index - m_StartAddresses);
+    }
 
     static std::size_t index(const TUInt32CoordinatePr& neighbour) {
         return neighbour.first;
@@ -419,6 +565,12 @@ private:
     // The epsilon local reachability distances are stored flattened:
     // [coordinates of 0, coordinates of 2, ...].
     TCoordinateVec m_LrdAtEps;
+    // True if the points being scored are streamed, see the class comment.
+    bool m_StreamQueries{false};
+    // The mean reachability distance and mean neighbourhood local reachability
+    // density of each streamed point are stored flattened:
+    // [reachability of start, lrd of start, reachability of start + 1, ...].
+    TDoubleVec m_QueryState;
 };
 
 template<typename POINT, typename NEAREST_NEIGHBOURS>
@@ -684,6 +836,9 @@ public:
     static const std::string COMPUTING_OUTLIERS;
     //! Used to compute numeric derivative for influence.
     static constexpr double EPS{0.01};
+    //! The minimum dimension for which we use approximate nearest neighbour
+    //! search. Below this k-d trees are efficient and exact.
+    static constexpr std::size_t MINIMUM_DIMENSION_FOR_APPROXIMATE_SEARCH{16};
 
     //! The outlier detection methods which are available.
     enum EMethod {
@@ -710,6 +865,9 @@ public:
         bool s_ComputeFeatureInfluence;
         //! The fraction of true outliers among the points.
         double s_OutlierFraction;
+        //! If true reduce the dimension of the points using a random projection
+        //! if this approximately preserves the distances between them.
+        bool s_ReduceDimension;
     };
 
 public:
@@ -741,6 +899,12 @@ public:
     //! Return string representation of the \p method.
     static const std::string& print(EMethod method);
 
+    //! Check if we should use approximate nearest neighbour search for points
+    //! with \p dimension.
+    static bool useApproximateNearestNeighbours(std::size_t dimension) {
+        return dimension >= MINIMUM_DIMENSION_FOR_APPROXIMATE_SEARCH;
+    }
+
     //! \name Test Interface
     //@{
     //! Compute the normalized LOF scores for \p points.
@@ -800,31 +964,46 @@ private:
                                                    std::size_t dimension);
 
     //! Compute normalised outlier scores for a specified method.
+    //!
+    //! This uses exact nearest neighbour search for low dimensional points
+    //! and approximate search for high dimensional points where k-d trees
+    //! degenerate to brute force.
     template<template<typename, typename> class METHOD, typename POINT>
     static void compute(std::size_t k, std::vector<POINT> points, TDoubleVec& scores) {
         using TPoint = TAnnotatedPoint<POINT>;
-        using TMethod = METHOD<TPoint, common::CKdTree<TPoint>>;
-        using TMatrix = typename common::SConformableMatrix<TPoint>::Type;
 
         if (points.size() > 0) {
             auto annotatedPoints = annotate(std::move(points));
-            common::CKdTree<TAnnotatedPoint<POINT>> lookup;
-            lookup.reserve(points.size());
-            lookup.build(annotatedPoints);
-
-            TMethod scorer{false, k, noopRecordProgress, std::move(lookup)};
-            TMatrix projection{common::SIdentity<TMatrix>::get(
-                common::las::dimension(annotatedPoints[0]))};
-            auto scores_ = scorer.run(annotatedPoints, projection, EPS,
-                                      annotatedPoints.size());
-
-            scores.resize(scores_[0].size());
-            for (std::size_t i = 0; i < scores.size(); ++i) {
-                scores[i] = scores_[0][i][0];
+            if (useApproximateNearestNeighbours(
+                    common::las::dimension(annotatedPoints[0]))) {
+                computeUsing<METHOD, common::CHnsw<TPoint>>(k, annotatedPoints, scores);
+            } else {
+                computeUsing<METHOD, common::CKdTree<TPoint>>(k, annotatedPoints, scores);
             }
         }
     }
 
+    //! Compute normalised outlier scores for a specified method using the
+    //! nearest neighbours lookup LOOKUP.
+    template<template<typename, typename> class METHOD, typename LOOKUP, typename POINT>
+    static void computeUsing(std::size_t k, std::vector<POINT>& points, TDoubleVec& scores) {
+        using TMethod = METHOD<POINT, LOOKUP>;
+        using TMatrix = typename common::SConformableMatrix<POINT>::Type;
+
+        LOOKUP lookup;
+        lookup.reserve(points.size());
+        lookup.build(points);
+
+        TMethod scorer{false, k, noopRecordProgress, std::move(lookup)};
+        TMatrix projection{common::SIdentity<TMatrix>::get(common::las::dimension(points[0]))};
+        auto scores_ = scorer.run(points, projection, EPS, points.size());
+
+        scores.resize(scores_[0].size());
+        for (std::size_t i = 0; i < scores.size(); ++i) {
+            scores[i] = scores_[0][i][0];
+        }
+    }
+
     //! Create points annotated with their index in \p points.
     template<typename POINT>
     static std::vector<TAnnotatedPoint<POINT>> annotate(std::vector<POINT> points) {
@@ -0,0 +1,515 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#ifndef INCLUDED_ml_maths_common_CHnsw_h
+#define INCLUDED_ml_maths_common_CHnsw_h
+
+#include <core/CLogger.h>
+#include <core/CMemoryDec.h>
+#include <core/Concurrency.h>
+#include <core/UnwrapRef.h>
+
+#include <maths/common/CLinearAlgebraShims.h>
+#include <maths/common/CPRNG.h>
+#include <maths/common/CSampling.h>
+#include <maths/common/CTypeTraits.h>
+
+#include <boost/unordered_set.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ml {
+namespace maths {
+namespace common {
+
+//! \brief A hierarchical navigable small world graph for approximate
+//! nearest neighbour search.
+//!
+//! DESCRIPTION:\n
+//! \see https://arxiv.org/abs/1603.09320
+//!
+//! The points are arranged in a hierarchy of proximity graphs. Each point
+//! is assigned a random top layer, with exponentially decaying probability
+//! of being present in higher layers, and is linked to (a diverse subset
+//! of) its nearest neighbours in each layer it is present. Queries descend
+//! greedily from the sparse top layer and finish with a beam search in the
+//! bottom layer. The query cost is roughly logarithmic in the number of
+//! points and, unlike a k-d tree, degrades gracefully with dimension.
+//!
+//! This has the same interface as CKdTree so it can be used as the nearest
+//! neighbours lookup of any algorithm which accepts that.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! The graph is built once up front. Points are inserted in fixed size
+//! batches: the searches for the candidate neighbours of the points in a
+//! batch are run in parallel against the graph as it was at the start of
+//! the batch and the links are then added sequentially. Since the batch
+//! searches miss other points in the same batch, these are added to the
+//! candidates by brute force when linking. This makes the graph (and so
+//! query results) independent of the number of threads used to build it.
+//!
+//! The layer of each point is sampled using a generator with a fixed seed
+//! so builds are reproducible.
+//!
+//! The POINT type has the same requirements as for CKdTree.
+template<typename POINT>
+class CHnsw {
+public:
+    using TPoint =
+        typename std::remove_const<typename core::unwrap_reference<POINT>::type>::type;
+    using TPointVec = std::vector<POINT>;
+    using TPointVecVec = std::vector<TPointVec>;
+    using TCoordinate = typename SCoordinate<TPoint>::Type;
+    using TCoordinatePrecise = typename SPromoted<TCoordinate>::Type;
+
+public:
+    //! The default maximum number of links per point in the upper layers.
+    static constexpr std::size_t DEFAULT_MAXIMUM_DEGREE{16};
+    //! The default beam width used when building the graph.
+    static constexpr std::size_t DEFAULT_EF_CONSTRUCTION{100};
+    //! The default beam width used for queries.
+    static constexpr std::size_t DEFAULT_EF_SEARCH{64};
+    //! The number of points inserted in each batch.
+    static constexpr std::size_t INSERT_BATCH_SIZE{256};
+    //! The maximum number of layers.
+    static constexpr std::size_t MAXIMUM_NUMBER_LAYERS{16};
+
+public:
+    explicit CHnsw(std::size_t maximumDegree = DEFAULT_MAXIMUM_DEGREE,
+                   std::size_t efConstruction = DEFAULT_EF_CONSTRUCTION,
+                   std::size_t efSearch = DEFAULT_EF_SEARCH)
+        : m_MaximumDegree{std::max(maximumDegree, std::size_t{2})},
+          m_EfConstruction{std::max(efConstruction, m_MaximumDegree)},
+          m_EfSearch{std::max(efSearch, std::size_t{1})} {}
+
+    //! Reserve space for \p n points.
+    void reserve(std::size_t n) {
+        m_Points.reserve(n);
+        m_Links.reserve(n);
+    }
+
+    //! Build the graph on the collection of points \p points.
+    //!
+    //! \note Unlike CKdTree the order of \p points is preserved.
+    void build(const TPointVec& points) {
+        m_Points.assign(points.begin(), points.end());
+        this->buildGraph();
+    }
+
+    //! Build the graph on the collection of points \p points.
+    //!
+    //! \note The \p points are moved into place.
+    void build(TPointVec&& points) {
+        m_Points = std::move(points);
+        this->buildGraph();
+    }
+
+    //! Get the number of points in the graph.
+    std::size_t size() const { return m_Points.size(); }
+
+    //! Set the beam width used for queries.
+    //!
+    //! Larger values increase recall at the cost of slower queries.
+    void efSearch(std::size_t ef) { m_EfSearch = std::max(ef, std::size_t{1}); }
+
+    //! Get the (approximate) nearest \p n neighbours of \p point.
+    //!
+    //! The neighbours are sorted in order of increasing distance.
+    void nearestNeighbours(std::size_t n, const TPoint& point, TPointVec& result) const {
+
+        result.clear();
+
+        if (n == 0 || m_Points.empty()) {
+            return;
+        }
+
+        if (n >= m_Points.size()) {
+            TDistanceIndexPrVec neighbours;
+            neighbours.reserve(m_Points.size());
+            for (std::size_t i = 0; i < m_Points.size(); ++i) {
+                neighbours.emplace_back(this->distance(point, i),
+                                        static_cast<std::uint32_t>(i));
+            }
+            std::sort(neighbours.begin(), neighbours.end());
+            this->copyPoints(neighbours, n, result);
+            return;
+        }
+
+        std::uint32_t entry{m_EntryPoint};
+        TCoordinatePrecise distanceToEntry{this->distance(point, entry)};
+        for (std::size_t layer = m_TopLayer; layer > 0; --layer) {
+            this->greedySearch(point, layer, entry, distanceToEntry);
+        }
+        auto neighbours = this->searchLayer(point, 0, entry, distanceToEntry,
+                                            std::max(m_EfSearch, n));
+        this->copyPoints(neighbours, n, result);
+    }
+
+    //! Get the (approximate) nearest \p n neighbours of each of \p points.
+    //!
+    //! The queries are run in parallel using the default async executor.
+    void nearestNeighbours(std::size_t n, const TPointVec& points, TPointVecVec& result) const {
+        result.assign(points.size(), TPointVec{});
+        core::parallel_for_each(0, points.size(), [&](std::size_t i) {
+            this->nearestNeighbours(n, core::unwrap_ref(points[i]), result[i]);
+        });
+    }
+
+    //! Get the (approximate) nearest \p n neighbours of each point in the
+    //! range [\p begin, \p end).
+    //!
+    //! This has the same semantics as the CKdTree batch query.
+    template<typename ITR>
+    void nearestNeighbours(std::size_t n, ITR begin, ITR end, TPointVecVec& result) const {
+        result.resize(static_cast<std::size_t>(std::distance(begin, end)));
+        for (std::size_t i = 0; begin != end; ++begin, ++i) {
+            this->nearestNeighbours(n, core::unwrap_ref(*begin), result[i]);
+        }
+    }
+
+    //! Get an iterator over the points in the graph.
+    typename TPointVec::const_iterator begin() const {
+        return m_Points.begin();
+    }
+
+    //! Get an iterator to the end of the points in the graph.
+    typename TPointVec::const_iterator end() const { return m_Points.end(); }
+
+    //! Check the graph invariants.
+    bool checkInvariants() const {
+        if (m_Links.size() != m_Points.size()) {
+            LOG_ERROR(<< "# points = " << m_Points.size() << ", # links = " << m_Links.size());
+            return false;
+        }
+        for (std::size_t i = 0; i < m_Links.size(); ++i) {
+            if (m_Links[i].empty() || m_Links[i].size() > MAXIMUM_NUMBER_LAYERS) {
+                LOG_ERROR(<< "point " << i << " # layers = " << m_Links[i].size());
+                return false;
+            }
+            for (std::size_t layer = 0; layer < m_Links[i].size(); ++layer) {
+                const auto& links = m_Links[i][layer];
+                if (links.size() > this->maximumDegree(layer)) {
+                    LOG_ERROR(<< "point " << i << " layer " << layer
+                              << " degree = " << links.size());
+                    return false;
+                }
+                for (auto j : links) {
+                    if (j == i || j >= m_Links.size() || m_Links[j].size() <= layer) {
+                        LOG_ERROR(<< "point " << i << " layer " << layer
+                                  << " bad link to " << j);
+                        return false;
+                    }
+                }
+            }
+        }
+        if (m_Points.size() > 0 && m_Links[m_EntryPoint].size() != m_TopLayer + 1) {
+            LOG_ERROR(<< "entry point " << m_EntryPoint << " not in top layer " << m_TopLayer);
+            return false;
+        }
+        return true;
+    }
+
+    //! Get the memory used by this object.
+    std::size_t memoryUsage() const {
+        return core::memory::dynamicSize(m_Points) + core::memory::dynamicSize(m_Links);
+    }
+
+    //! Estimate the amount of memory the graph will use.
+    //!
+    //! \param[in] numberPoints The number of points it will hold.
+    //! \param[in] dimension The dimension of points it will hold.
+    //! \param[in] maximumDegree The maximum number of links per point.
+    static std::size_t estimateMemoryUsage(std::size_t numberPoints,
+                                           std::size_t dimension,
+                                           std::size_t maximumDegree = DEFAULT_MAXIMUM_DEGREE) {
+        // Each point is in the bottom layer, with up to twice the maximum
+        // degree, and the expected number of upper layers it is in is less
+        // than 1 / (maximum degree - 1) which we round up to one layer.
+        std::size_t pointMemory{sizeof(POINT) + las::estimateMemoryUsage<POINT>(dimension)};
+        std::size_t linksMemory{sizeof(TUInt32VecVec) + 2 * sizeof(TUInt32Vec) +
+                                3 * maximumDegree * sizeof(std::uint32_t)};
+        return numberPoints * (pointMemory + linksMemory);
+    }
+
+private:
+    using TUInt32Vec = std::vector<std::uint32_t>;
+    using TUInt32VecVec = std::vector<TUInt32Vec>;
+    using TUInt32VecVecVec = std::vector<TUInt32VecVec>;
+    using TDistanceIndexPr = std::pair<TCoordinatePrecise, std::uint32_t>;
+    using TDistanceIndexPrVec = std::vector<TDistanceIndexPr>;
+    using TDistanceIndexPrVecVec = std::vector<TDistanceIndexPrVec>;
+    using TDistanceIndexPrVecVecVec = std::vector<TDistanceIndexPrVecVec>;
+    using TUInt32USet = boost::unordered_set<std::uint32_t>;
+
+private:
+    //! Get the maximum number of links a point can have in \p layer.
+    std::size_t maximumDegree(std::size_t layer) const {
+        return layer == 0 ? 2 * m_MaximumDegree : m_MaximumDegree;
+    }
+
+    //! Get the distance between \p point and the i'th point in the graph.
+    TCoordinatePrecise distance(const TPoint& point, std::size_t i) const {
+        return las::distance(point, core::unwrap_ref(m_Points[i]));
+    }
+
+    //! Get the distance between the i'th and j'th point in the graph.
+    TCoordinatePrecise distanceBetween(std::size_t i, std::size_t j) const {
+        return las::distance(core::unwrap_ref(m_Points[i]), core::unwrap_ref(m_Points[j]));
+    }
+
+    //! Build the graph on m_Points.
+    void buildGraph() {
+
+        m_Links.clear();
+        m_EntryPoint = 0;
+        m_TopLayer = 0;
+
+        std::size_t n{m_Points.size()};
+        if (n == 0) {
+            return;
+        }
+
+        // Sample the top layer of each point. The probability a point is in
+        // layer l is proportional to M^(-l) for maximum degree M.
+        CPRNG::CXorOShiro128Plus rng;
+        double scale{1.0 / std::log(static_cast<double>(m_MaximumDegree))};
+        m_Links.resize(n);
+        for (auto& links : m_Links) {
+            double u{1.0 - CSampling::uniformSample(rng, 0.0, 1.0)};
+            auto layers = static_cast<std::size_t>(-std::log(u) * scale) + 1;
+            links.resize(std::min(layers, MAXIMUM_NUMBER_LAYERS));
+        }
+
+        m_TopLayer = m_Links[0].size() - 1;
+
+        TDistanceIndexPrVecVecVec candidates;
+        for (std::size_t begin = 1; begin < n; begin += INSERT_BATCH_SIZE) {
+            std::size_t end{std::min(begin + INSERT_BATCH_SIZE, n)};
+
+            // The graph is only read here so the searches are thread safe.
+            candidates.assign(end - begin, TDistanceIndexPrVecVec{});
+            core::parallel_for_each(begin, end, [&](std::size_t i) {
+                candidates[i - begin] = this->searchForInsert(i);
+            });
+
+            for (std::size_t i = begin; i < end; ++i) {
+                this->insert(i, begin, candidates[i - begin]);
+            }
+        }
+    }
+
+    //! Find the candidate neighbours of the i'th point in each of its layers
+    //! in the current graph.
+    TDistanceIndexPrVecVec searchForInsert(std::size_t i) const {
+
+        const TPoint& point{core::unwrap_ref(m_Points[i])};
+        std::size_t top{m_Links[i].size() - 1};
+
+        TDistanceIndexPrVecVec result(top + 1);
+
+        std::uint32_t entry{m_EntryPoint};
+        TCoordinatePrecise distanceToEntry{this->distance(point, entry)};
+        for (std::size_t layer = m_TopLayer; layer > top; --layer) {
+            this->greedySearch(point, layer, entry, distanceToEntry);
+        }
+        for (std::size_t layer = std::min(top, m_TopLayer) + 1; layer > 0; --layer) {
+            result[layer - 1] = this->searchLayer(point, layer - 1, entry,
+                                                  distanceToEntry, m_EfConstruction);
+            entry = result[layer - 1][0].second;
+            distanceToEntry = result[layer - 1][0].first;
+        }
+
+        return result;
+    }
+
+    //! Link the i'th point into the graph.
+    void insert(std::size_t i, std::size_t batchBegin, TDistanceIndexPrVecVec& candidates) {
+
+        for (std::size_t layer = 0; layer < m_Links[i].size(); ++layer) {
+            auto& layerCandidates = candidates[layer];
+
+            // Add the points from this batch which have already been linked.
+            for (std::size_t j = batchBegin; j < i; ++j) {
+                if (m_Links[j].size() > layer) {
+                    layerCandidates.emplace_back(this->distanceBetween(i, j),
+                                                 static_cast<std::uint32_t>(j));
+                }
+            }
+            std::sort(layerCandidates.begin(), layerCandidates.end());
+            if (layerCandidates.size() > m_EfConstruction) {
+                layerCandidates.resize(m_EfConstruction);
+            }
+
+            std::size_t degree{this->maximumDegree(layer)};
+            auto& links = m_Links[i][layer];
+            links = this->selectNeighbours(layerCandidates, m_MaximumDegree);
+
+            for (auto j : links) {
+                auto& neighbourLinks = m_Links[j][layer];
+                neighbourLinks.push_back(static_cast<std::uint32_t>(i));
+                if (neighbourLinks.size() > degree) {
+                    this->prune(j, layer, degree);
+                }
+            }
+        }
+
+        if (m_Links[i].size() > m_TopLayer + 1) {
+            m_TopLayer = m_Links[i].size() - 1;
+            m_EntryPoint = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    //! Reduce the links of the i'th point in \p layer to \p degree.
+    void prune(std::size_t i, std::size_t layer, std::size_t degree) {
+        auto& links = m_Links[i][layer];
+        TDistanceIndexPrVec candidates;
+        candidates.reserve(links.size());
+        for (auto j : links) {
+            candidates.emplace_back(this->distanceBetween(i, j), j);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        links = this->selectNeighbours(candidates, degree);
+    }
+
+    //! Select up to \p degree neighbours from \p candidates.
+    //!
+    //! This prefers candidates which are closer to the point than to any
+    //! neighbour already selected. This keeps links to distinct clusters
+    //! which is important for the graph to remain navigable. If there are
+    //! fewer than \p degree such candidates the remainder are filled with
+    //! the closest discarded candidates.
+    //!
+    //! \note \p candidates must be sorted by increasing distance.
+    TUInt32Vec selectNeighbours(const TDistanceIndexPrVec& candidates, std::size_t degree) const {
+        TUInt32Vec result;
+        TUInt32Vec discarded;
+        result.reserve(degree);
+        for (const auto& candidate : candidates) {
+            if (result.size() == degree) {
+                break;
+            }
+            bool diverse{std::all_of(result.begin(), result.end(), [&](std::uint32_t j) {
+                return this->distanceBetween(candidate.second, j) >= candidate.first;
+            })};
+            (diverse ? result : discarded).push_back(candidate.second);
+        }
+        for (std::size_t i = 0; result.size() < degree && i < discarded.size(); ++i) {
+            result.push_back(discarded[i]);
+        }
+        return result;
+    }
+
+    //! Move \p entry to the closest point to \p point in \p layer greedily.
+    void greedySearch(const TPoint& point,
+                      std::size_t layer,
+                      std::uint32_t& entry,
+                      TCoordinatePrecise& distanceToEntry) const {
+        for (bool improved = true; improved; /**/) {
+            improved = false;
+            for (auto j : m_Links[entry][layer]) {
+                TCoordinatePrecise distanceToNeighbour{this->distance(point, j)};
+                if (distanceToNeighbour < distanceToEntry) {
+                    entry = j;
+                    distanceToEntry = distanceToNeighbour;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    //! Beam search \p layer for the closest \p ef points to \p point.
+    //!
+    //! \return The points found sorted by increasing distance.
+    TDistanceIndexPrVec searchLayer(const TPoint& point,
+                                    std::size_t layer,
+                                    std::uint32_t entry,
+                                    TCoordinatePrecise distanceToEntry,
+                                    std::size_t ef) const {
+
+        std::greater<TDistanceIndexPr> closestFirst;
+        std::less<TDistanceIndexPr> furthestFirst;
+
+        TUInt32USet visited;
+        visited.insert(entry);
+
+        // A min-heap of points to expand and a max-heap of the closest points.
+        TDistanceIndexPrVec candidates{{distanceToEntry, entry}};
+        TDistanceIndexPrVec result{{distanceToEntry, entry}};
+        candidates.reserve(ef);
+        result.reserve(ef + 1);
+
+        while (candidates.size() > 0) {
+            std::pop_heap(candidates.begin(), candidates.end(), closestFirst);
+            TDistanceIndexPr closest{candidates.back()};
+            candidates.pop_back();
+            if (result.size() >= ef && closest.first > result.front().first) {
+                break;
+            }
+            for (auto j : m_Links[closest.second][layer]) {
+                if (visited.insert(j).second == false) {
+                    continue;
+                }
+                TDistanceIndexPr neighbour{this->distance(point, j), j};
+                if (result.size() < ef || neighbour < result.front()) {
+                    candidates.push_back(neighbour);
+                    std::push_heap(candidates.begin(), candidates.end(), closestFirst);
+                    result.push_back(neighbour);
+                    std::push_heap(result.begin(), result.end(), furthestFirst);
+                    if (result.size() > ef) {
+                        std::pop_heap(result.begin(), result.end(), furthestFirst);
+                        result.pop_back();
+                    }
+                }
+            }
+        }
+
+        std::sort_heap(result.begin(), result.end(), furthestFirst);
+        return result;
+    }
+
+    //! Copy the closest \p n of \p neighbours to \p result.
+    void copyPoints(const TDistanceIndexPrVec& neighbours, std::size_t n, TPointVec& result) const {
+        n = std::min(n, neighbours.size());
+        result.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            result.push_back(m_Points[neighbours[i].second]);
+        }
+    }
+
+private:
+    //! The maximum number of links per point in the upper layers.
+    std::size_t m_MaximumDegree;
+    //! The beam width used when building the graph.
+    std::size_t m_EfConstruction;
+    //! The beam width used for queries.
+    std::size_t m_EfSearch;
+    //! The point at which to start all searches.
+    std::uint32_t m_EntryPoint{0};
+    //! The top layer of the graph.
+    std::size_t m_TopLayer{0};
+    //! The points.
+    TPointVec m_Points;
+    //! The links of each point in each of its layers.
+    TUInt32VecVecVec m_Links;
+};
+}
+}
+}
+
+#endif // INCLUDED_ml_maths_common_CHnsw_h
@@ -33,6 +33,7 @@
 #include <functional>
 #include <limits>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ml {
@@ -56,6 +57,14 @@ struct SEmptyNodeData {};
 //! can be stored by value in pre-reserved vector, which is as efficient
 //! as possible for this use case.
 //!
+//! The nodes are stored in pre-order so every subtree occupies a contiguous
+//! range of them. Subtrees with at most BUCKET_SIZE points are treated as
+//! leaf buckets by the nearest neighbours search: rather than branch and
+//! bound over their nodes we compute the distance to all their points in
+//! one pass. Their coordinates are additionally stored in a contiguous
+//! dimension major buffer so this loop is over independent accumulators
+//! and vectorises.
+//!
 //! The POINT type must have value semantics, support coordinate access,
 //! via operator(), support subtraction, via operator-, and provide a
 //! Euclidean norm, i.e. \f$\sqrt{\sum_i x_i^2}\f$. This is handled by
@@ -73,8 +82,12 @@ public:
     using TPoint =
         typename std::remove_const<typename core::unwrap_reference<POINT>::type>::type;
     using TPointVec = std::vector<POINT>;
+    using TPointVecVec = std::vector<TPointVec>;
     using TCoordinate = typename SCoordinate<TPoint>::Type;
     using TCoordinatePrecise = typename SPromoted<TCoordinate>::Type;
+    using TBucketCoordinate =
+        typename std::decay<decltype(std::declval<const TPoint&>()(0))>::type;
+    using TBucketCoordinatePrecise = typename SPromoted<TBucketCoordinate>::Type;
     using TPointCRef = std::reference_wrapper<const POINT>;
     using TCoordinatePrecisePointCRefPr = std::pair<TCoordinatePrecise, TPointCRef>;
     using TCoordinatePrecisePointCRefPrVec = std::vector<TCoordinatePrecisePointCRefPr>;
@@ -210,9 +223,16 @@ public:
     using TPointItr = TPointIterator<POINT, TNodeVecItr>;
     using TPointCItr = TPointIterator<const POINT, TNodeVecCItr>;
 
+public:
+    //! The maximum number of points in a leaf bucket.
+    static constexpr std::size_t BUCKET_SIZE{32};
+
 public:
     //! Reserve space for \p n points.
-    void reserve(std::size_t n) { m_Nodes.reserve(n); }
+    void reserve(std::size_t n) {
+        m_Nodes.reserve(n);
+        m_SubtreeEnds.reserve(n);
+    }
 
     //! Build a k-d tree on the collection of points \p points.
     //!
@@ -242,9 +262,13 @@ public:
         m_Dimension = las::dimension(core::unwrap_ref(*begin));
         m_Nodes.clear();
         m_Nodes.reserve(std::distance(begin, end));
+        m_SubtreeEnds.clear();
+        m_SubtreeEnds.reserve(std::distance(begin, end));
         this->buildRecursively(nullptr, // Parent pointer
                                0,       // Split coordinate
                                begin, end, move);
+        m_Coordinates.resize(m_Nodes.size() * m_Dimension);
+        this->copyCoordinates(0);
     }
 
     //! Get the number of points in the tree.
@@ -288,36 +312,31 @@ public:
                            const TPoint& point,
                            TPoint& distancesToHyperplanes,
                            TPointVec& result) const {
+        TCoordinatePrecisePointCRefPrVec neighbours;
+        this->nearestNeighbours(n, point, distancesToHyperplanes, neighbours, result);
+    }
 
-        result.clear();
-
-        if (n > 0 && n < m_Nodes.size()) {
-            auto inf = std::numeric_limits<TCoordinatePrecise>::max();
-
-            // These neighbour points will be completely replaced by the call
-            // to nearestNeighbours, but we need the collection to be initialized
-            // with infinite distances so we get the correct value for the furthest
-            // nearest neighbour at the start of the branch and bound search.
-            COrderings::SLess less;
-            TCoordinatePrecisePointCRefPrVec neighbours(
-                n, {inf, std::cref(m_Nodes[0].s_Point)});
-            this->nearestNeighbours(point, less, m_Nodes[0], distancesToHyperplanes,
-                                    0 /*split coordinate*/, neighbours);
-
-            result.reserve(n);
-            std::sort_heap(neighbours.begin(), neighbours.end(), less);
-            for (const auto& neighbour : neighbours) {
-                result.push_back(neighbour.second);
-            }
-        } else if (n >= m_Nodes.size()) {
-            TDoubleVec distances;
-            distances.reserve(m_Nodes.size());
-            result.reserve(m_Nodes.size());
-            for (const auto& node : m_Nodes) {
-                distances.push_back(las::distance(point, node.s_Point));
-                result.push_back(node.s_Point);
-            }
-            COrderings::simultaneousSort(distances, result);
+    //! Branch and bound search for nearest \p n neighbours of each point
+    //! in the range [\p begin, \p end).
+    //!
+    //! This is more efficient than calling nearestNeighbours for each point
+    //! separately because the working space is shared by all the queries.
+    //!
+    //! \param[out] result Filled in with the neighbours of each point in
+    //! the range in the same order. Its storage is reused so it is best to
+    //! pass the same object when calling repeatedly.
+    template<typename ITR>
+    void nearestNeighbours(std::size_t n, ITR begin, ITR end, TPointVecVec& result) const {
+        result.resize(static_cast<std::size_t>(std::distance(begin, end)));
+        if (begin == end) {
+            return;
+        }
+        auto temp = las::zero(core::unwrap_ref(*begin));
+        TPoint distancesToHyperplanes{std::move(temp)};
+        TCoordinatePrecisePointCRefPrVec neighbours;
+        for (std::size_t i = 0; begin != end; ++begin, ++i) {
+            this->nearestNeighbours(n, core::unwrap_ref(*begin),
+                                    distancesToHyperplanes, neighbours, result[i]);
         }
     }
 
@@ -363,12 +382,32 @@ public:
                 return false;
             }
         }
+        if (m_SubtreeEnds.size() != m_Nodes.size()) {
+            LOG_ERROR(<< "# subtree ends = " << m_SubtreeEnds.size()
+                      << ", # nodes = " << m_Nodes.size());
+            return false;
+        }
+        for (std::size_t i = 0; i < m_Nodes.size(); ++i) {
+            const SNode& node{m_Nodes[i]};
+            std::size_t end{i + 1};
+            if (node.s_LeftChild != nullptr) {
+                end = m_SubtreeEnds[this->index(node.s_LeftChild)];
+            }
+            if (node.s_RightChild != nullptr) {
+                end = m_SubtreeEnds[this->index(node.s_RightChild)];
+            }
+            if (m_SubtreeEnds[i] != end) {
+                LOG_ERROR(<< "subtree end = " << m_SubtreeEnds[i] << ", expected " << end);
+                return false;
+            }
+        }
         return true;
     }
 
     //! Get the memory used by this object.
     std::size_t memoryUsage() const {
-        return core::memory::dynamicSize(m_Nodes);
+        return core::memory::dynamicSize(m_Nodes) + core::memory::dynamicSize(m_SubtreeEnds) +
+               core::memory::dynamicSize(m_Coordinates);
     }
 
     //! Estimate the amount of memory the k-d tree will use.
@@ -376,7 +415,8 @@ public:
     //! \param[in] numberPoints The number of points it will hold.
     //! \param[in] dimension The dimension of points it will hold.
     static std::size_t estimateMemoryUsage(std::size_t numberPoints, std::size_t dimension) {
-        return numberPoints * SNode::estimateMemoryUsage(dimension);
+        return numberPoints * (SNode::estimateMemoryUsage(dimension) + sizeof(std::size_t) +
+                               dimension * sizeof(TBucketCoordinate));
     }
 
 private:
@@ -397,6 +437,7 @@ private:
         ITR median{begin + n};
         std::nth_element(begin, median, end, CCoordinateLess(coordinate));
         this->append(move, parent, *median);
+        m_SubtreeEnds.push_back(m_Nodes.size() - 1 + static_cast<std::size_t>(end - begin));
         SNode* node{&m_Nodes.back()};
         if (median - begin > 0) {
             std::size_t next{this->nextCoordinate(coordinate)};
@@ -463,6 +504,112 @@ private:
         return nearest;
     }
 
+    //! Copy the coordinates of the points in the subtree rooted at \p node
+    //! into the contiguous buffer.
+    //!
+    //! Each leaf bucket is stored in dimension major order.
+    void copyCoordinates(std::size_t node) {
+        std::size_t end{m_SubtreeEnds[node]};
+        std::size_t size{end - node};
+        if (size > BUCKET_SIZE) {
+            size = 1;
+            const SNode& node_{m_Nodes[node]};
+            if (node_.s_LeftChild != nullptr) {
+                this->copyCoordinates(this->index(node_.s_LeftChild));
+            }
+            if (node_.s_RightChild != nullptr) {
+                this->copyCoordinates(this->index(node_.s_RightChild));
+            }
+        }
+        TBucketCoordinate* bucket{&m_Coordinates[node * m_Dimension]};
+        for (std::size_t i = 0; i < size; ++i) {
+            const TPoint& point{core::unwrap_ref(m_Nodes[node + i].s_Point)};
+            for (std::size_t j = 0; j < m_Dimension; ++j) {
+                bucket[j * size + i] = point(j);
+            }
+        }
+    }
+
+    //! Get the index of \p node.
+    std::size_t index(const SNode* node) const {
+        return static_cast<std::size_t>(node - m_Nodes.data());
+    }
+
+    //! Find the nearest \p n neighbours of \p point using \p neighbours
+    //! as working space.
+    void nearestNeighbours(std::size_t n,
+                           const TPoint& point,
+                           TPoint& distancesToHyperplanes,
+                           TCoordinatePrecisePointCRefPrVec& neighbours,
+                           TPointVec& result) const {
+
+        result.clear();
+
+        if (n > 0 && n < m_Nodes.size()) {
+            auto inf = std::numeric_limits<TCoordinatePrecise>::max();
+
+            // These neighbour points will be completely replaced by the call
+            // to nearestNeighbours, but we need the collection to be initialized
+            // with infinite distances so we get the correct value for the furthest
+            // nearest neighbour at the start of the branch and bound search.
+            COrderings::SLess less;
+            neighbours.assign(n, {inf, std::cref(m_Nodes[0].s_Point)});
+            this->nearestNeighbours(point, less, m_Nodes[0], distancesToHyperplanes,
+                                    0 /*split coordinate*/, neighbours);
+
+            result.reserve(n);
+            std::sort_heap(neighbours.begin(), neighbours.end(), less);
+            for (const auto& neighbour : neighbours) {
+                result.push_back(neighbour.second);
+            }
+        } else if (n >= m_Nodes.size()) {
+            TDoubleVec distances;
+            distances.reserve(m_Nodes.size());
+            result.reserve(m_Nodes.size());
+            for (const auto& node : m_Nodes) {
+                distances.push_back(las::distance(point, node.s_Point));
+                result.push_back(node.s_Point);
+            }
+            COrderings::simultaneousSort(distances, result);
+        }
+    }
+
+    //! Update \p nearest with the points in the leaf bucket rooted at \p node.
+    void nearestNeighboursInBucket(const TPoint& point,
+                                   const COrderings::SLess& less,
+                                   std::size_t node,
+                                   TCoordinatePrecisePointCRefPrVec& nearest) const {
+
+        std::size_t size{m_SubtreeEnds[node] - node};
+        const TBucketCoordinate* bucket{&m_Coordinates[node * m_Dimension]};
+
+        TBucketCoordinatePrecise distances[BUCKET_SIZE];
+        std::fill_n(distances, size, TBucketCoordinatePrecise{0});
+        for (std::size_t i = 0; i < m_Dimension; ++i, bucket += size) {
+            TBucketCoordinatePrecise x{point(i)};
+            for (std::size_t j = 0; j < size; ++j) {
+                TBucketCoordinatePrecise dx{x - static_cast<TBucketCoordinatePrecise>(bucket[j])};
+                distances[j] += dx * dx;
+            }
+        }
+
+        for (std::size_t j = 0; j < size; ++j) {
+            TCoordinatePrecise distance{nearest.front().first};
+            if (distances[j] > distance * distance) {
+                continue;
+            }
+            distance = static_cast<TCoordinatePrecise>(std::sqrt(distances[j]));
+            const POINT& candidate{m_Nodes[node + j].s_Point};
+            if (distance < nearest.front().first ||
+                (distance == nearest.front().first && core::unwrap_ref(candidate) < point)) {
+                std::pop_heap(nearest.begin(), nearest.end(), less);
+                nearest.back().first = distance;
+                nearest.back().second = std::cref(candidate);
+                std::push_heap(nearest.begin(), nearest.end(), less);
+            }
+        }
+    }
+
     //! Recursively find the nearest point to \p point.
     void nearestNeighbours(const TPoint& point,
                            const COrderings::SLess& less,
@@ -471,6 +618,12 @@ private:
                            std::size_t coordinate,
                            TCoordinatePrecisePointCRefPrVec& nearest) const {
 
+        std::size_t index{this->index(&node)};
+        if (m_SubtreeEnds[index] - index <= BUCKET_SIZE) {
+            this->nearestNeighboursInBucket(point, less, index, nearest);
+            return;
+        }
+
         TCoordinatePrecise distance{las::distance(point, core::unwrap_ref(node.s_Point))};
 
         if (distance < nearest.front().first ||
@@ -552,6 +705,12 @@ private:
 
     //! The representation of the points.
     TNodeVec m_Nodes;
+
+    //! The index of one past the last node in the subtree rooted at each node.
+    std::vector<std::size_t> m_SubtreeEnds;
+
+    //! The point coordinates with leaf buckets in dimension major order.
+    std::vector<TBucketCoordinate> m_Coordinates;
 };
 }
 }
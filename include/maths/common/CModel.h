@@ -313,6 +313,8 @@ public:
     using TSizeDoublePr1Vec = core::CSmallVector<TSizeDoublePr, 1>;
     using TTimeDouble2VecSizeTr = core::CTriple<core_t::TTime, TDouble2Vec, std::size_t>;
     using TTimeDouble2VecSizeTrVec = std::vector<TTimeDouble2VecSizeTr>;
+    using TTimeDouble2VecSizeTrVecVec = std::vector<TTimeDouble2VecSizeTrVec>;
+    using TModelAddSamplesParamsVec = std::vector<CModelAddSamplesParams>;
     using TDouble2VecWeightsAry = maths_t::TDouble2VecWeightsAry;
     using TDouble2VecWeightsAry1Vec = maths_t::TDouble2VecWeightsAry1Vec;
     using TTail2Vec = core::CSmallVector<maths_t::ETail, 2>;
@@ -370,6 +372,17 @@ public:
     virtual EUpdateResult addSamples(const CModelAddSamplesParams& params,
                                      TTimeDouble2VecSizeTrVec samples) = 0;
 
+    //! Update the model with the samples of a sequence of buckets.
+    //!
+    //! The result is the same as calling addSamples with \p params[i] and
+    //! \p samples[i] for each bucket in turn. Implementations can override
+    //! this to avoid repeating work which is common to all the buckets.
+    //!
+    //! \return E_Failure if any update failed, otherwise E_Reset if any
+    //! update reset the model, otherwise E_Success.
+    virtual EUpdateResult addSamplesForBuckets(const TModelAddSamplesParamsVec& params,
+                                               TTimeDouble2VecSizeTrVecVec samples);
+
     //! Advance time by \p gap.
     virtual void skipTime(core_t::TTime gap) = 0;
 
@@ -466,6 +479,9 @@ public:
     //! Get the memory used by this object.
     virtual std::size_t memoryUsage() const = 0;
 
+    //! Get the memory used by the copy of this created by cloneForForecast.
+    virtual std::size_t forecastMemoryUsage() const;
+
     //! Persist by passing information to \p inserter.
     virtual void acceptPersistInserter(core::CStatePersistInserter& inserter) const = 0;
 
@@ -484,9 +500,16 @@ public:
     //! Returns true
     virtual bool shouldPersist() const;
 
+    //! Check if this model has never been updated and so is equal to the
+    //! model from which it was cloned.
+    virtual bool isDormant() const;
+
 protected:
     CModel(const CModel&) = default;
 
+    //! Combine the results of updating the model with the samples of two buckets.
+    static EUpdateResult combine(EUpdateResult lhs, EUpdateResult rhs);
+
     //! Get the nearest mean of \p prior to \p detrended.
     template<typename VECTOR>
     static VECTOR marginalLikelihoodMean(const CPrior& prior);
@@ -0,0 +1,130 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#ifndef INCLUDED_ml_maths_common_CSparseRandomProjection_h
+#define INCLUDED_ml_maths_common_CSparseRandomProjection_h
+
+#include <maths/common/CPRNG.h>
+#include <maths/common/ImportExport.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ml {
+namespace maths {
+namespace common {
+
+//! \brief A sparse random projection for reducing the dimension of points
+//! whilst approximately preserving Euclidean distances.
+//!
+//! DESCRIPTION:\n
+//! This uses the construction from https://doi.org/10.1016/S0022-0000(03)00025-4:
+//! the projection matrix elements are \f$\sqrt{3 / m}\f$ times +1 with
+//! probability 1/6, 0 with probability 2/3 and -1 with probability 1/6,
+//! where \f$m\f$ is the output dimension. The Johnson-Lindenstrauss lemma
+//! holds for this projection, i.e. for n points distances are preserved
+//! to within a factor of \f$1 \pm \epsilon\f$ with high probability if
+//! \f$m \geq 4 \log(n) / (\epsilon^2 / 2 - \epsilon^3 / 3)\f$.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Since only one third of the elements are non-zero and they are all equal
+//! in magnitude we store just the indices of the positive and negative
+//! elements of each row. Projecting a point then needs only additions and
+//! one multiplication per output coordinate.
+class MATHS_COMMON_EXPORT CSparseRandomProjection {
+public:
+    using TUInt32Vec = std::vector<std::uint32_t>;
+    using TSizeVec = std::vector<std::size_t>;
+
+public:
+    //! Generate a random projection from \p inputDimension to \p outputDimension.
+    CSparseRandomProjection(CPRNG::CXorOShiro128Plus& rng,
+                            std::size_t inputDimension,
+                            std::size_t outputDimension);
+
+    //! Get the smallest dimension for which the distances between \p numberPoints
+    //! points are preserved to within a factor of 1 +/- \p distortion.
+    static std::size_t targetDimension(std::size_t numberPoints, double distortion);
+
+    //! Get the dimension of the points to project.
+    std::size_t inputDimension() const { return m_InputDimension; }
+
+    //! Get the dimension of the projected points.
+    std::size_t outputDimension() const { return m_RowBegins.size() - 1; }
+
+    //! Project \p x writing the result to \p result.
+    //!
+    //! \note \p result must have size outputDimension().
+    template<typename INPUT, typename OUTPUT>
+    void project(const INPUT& x, OUTPUT& result) const {
+        for (std::size_t i = 0; i + 1 < m_RowBegins.size(); ++i) {
+            double projection{0.0};
+            std::size_t j{m_RowBegins[i]};
+            for (/**/; j < m_NegativeBegins[i]; ++j) {
+                projection += x(m_Indices[j]);
+            }
+            for (/**/; j < m_RowBegins[i + 1]; ++j) {
+                projection -= x(m_Indices[j]);
+            }
+            result(i) = m_Scale * projection;
+        }
+    }
+
+    //! Compute the product of the matrix \p lhs and this projection.
+    //!
+    //! This is the projection of the input points equivalent to projecting
+    //! with this and then \p lhs.
+    //!
+    //! \note \p lhs must have outputDimension() columns.
+    template<typename MATRIX>
+    MATRIX compose(const MATRIX& lhs) const {
+        MATRIX result{MATRIX::Zero(lhs.rows(), m_InputDimension)};
+        for (std::size_t i = 0; i + 1 < m_RowBegins.size(); ++i) {
+            auto column = lhs.col(i);
+            std::size_t j{m_RowBegins[i]};
+            for (/**/; j < m_NegativeBegins[i]; ++j) {
+                result.col(m_Indices[j]) += column;
+            }
+            for (/**/; j < m_RowBegins[i + 1]; ++j) {
+                result.col(m_Indices[j]) -= column;
+            }
+        }
+        result *= m_Scale;
+        return result;
+    }
+
+    //! Get the memory used by this object.
+    std::size_t memoryUsage() const;
+
+    //! Estimate the memory a projection from \p inputDimension to \p outputDimension
+    //! will use.
+    static std::size_t estimateMemoryUsage(std::size_t inputDimension,
+                                           std::size_t outputDimension);
+
+private:
+    //! The dimension of the points to project.
+    std::size_t m_InputDimension;
+    //! The scale of the non-zero elements.
+    double m_Scale;
+    //! The start of the indices of the non-zero elements of each row.
+    TSizeVec m_RowBegins;
+    //! The start of the indices of the negative elements of each row.
+    TSizeVec m_NegativeBegins;
+    //! The column indices of the non-zero elements ordered by row and then
+    //! sign.
+    TUInt32Vec m_Indices;
+};
+}
+}
+}
+
+#endif // INCLUDED_ml_maths_common_CSparseRandomProjection_h
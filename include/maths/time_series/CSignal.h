@@ -217,12 +217,20 @@ public:
 
     //! Cooley-Tukey fast DFT transform implementation.
     //!
-    //! \note This is a simple implementation radix 2 DIT which uses the chirp-z
-    //! idea to handle the case that the length of \p fx is not a power of 2. As
-    //! such it is definitely not a highly optimized FFT implementation. It should
-    //! be sufficiently fast for our needs.
+    //! \note This is an iterative radix 2 DIT which uses the chirp-z idea to
+    //! handle the case that the length of \p f is not a power of 2. The twiddle
+    //! factors and the transformed chirp are cached per thread so repeated
+    //! transforms of the same length don't recompute them.
     static void fft(TComplexVec& f);
 
+    //! Compute the DFT of the real parts of \p f in-place.
+    //!
+    //! For even lengths this packs the even and odd terms into a complex series
+    //! of half the length and so does roughly half the work of fft.
+    //!
+    //! \note The imaginary parts of \p f are ignored.
+    static void realFft(TComplexVec& f);
+
     //! This uses conjugate of the conjugate of the series is the inverse DFT trick
     //! to compute this using fft.
     static void ifft(TComplexVec& f);
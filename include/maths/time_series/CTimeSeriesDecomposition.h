@@ -121,6 +121,28 @@ public:
                   double occupancy = 1.0,
                   core_t::TTime firstValueTime = MIN_TIME) override;
 
+    //! Adds the time series points \p values in the order they are supplied.
+    //!
+    //! This is equivalent to calling addPoint for each value in turn, but the
+    //! component change callbacks are attached and the closures which make the
+    //! predictors and tests for each point are created once for the batch.
+    //!
+    //! \param[in] values The times and values of the data points.
+    //! \param[in] weights The weights of \p values. This must be empty, in which
+    //! case unit weights are used, or the same size as \p values.
+    //! \param[in] componentChangeCallback Supplied with samples of the prediction
+    //! residuals if a new component is added as a result of adding a data point.
+    //! \param[in] modelAnnotationCallback Supplied with an annotation if a new
+    //! component is added as a result of adding a data point.
+    //! \param[in] occupancy The proportion of non-empty buckets.
+    //! \param[in] firstValueTime The time of the first value added to the decomposition.
+    void addPoints(const TTimeDoublePrVec& values,
+                   const TDoubleWeightsAryVec& weights = {},
+                   const TComponentChangeCallback& componentChangeCallback = noopComponentChange,
+                   const maths_t::TModelAnnotationCallback& modelAnnotationCallback = noopModelAnnotation,
+                   double occupancy = 1.0,
+                   core_t::TTime firstValueTime = MIN_TIME) override;
+
     //! Shift seasonality by \p shift at \p time.
     void shiftTime(core_t::TTime time, core_t::TTime shift) override;
 
@@ -235,7 +257,29 @@ public:
 private:
     using TMediatorPtr = std::unique_ptr<CMediator>;
 
+    //! \brief The functions which make the predictors and the test for
+    //! seasonality needed to add a value.
+    //!
+    //! These only capture the decomposition and are evaluated lazily so
+    //! they can be shared by all the values in a batch.
+    struct SAddValueFunctions {
+        TMakePredictor s_MakePredictor;
+        TMakeFilteredPredictor s_MakeSeasonalityTestPreconditioner;
+        TMakeTestForSeasonality s_MakeTestForSeasonality;
+    };
+
 private:
+    //! Make the functions needed to add a value.
+    SAddValueFunctions makeAddValueFunctions() const;
+
+    //! Add a valid value after the component change callbacks are attached.
+    void addValue(core_t::TTime time,
+                  double value,
+                  const maths_t::TDoubleWeightsAry& weights,
+                  double occupancy,
+                  core_t::TTime firstValueTime,
+                  const SAddValueFunctions& functions);
+
     //! Set up the communication mediator.
     void initializeMediator();
 
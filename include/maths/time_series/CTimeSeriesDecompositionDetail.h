@@ -114,12 +114,12 @@ public:
         //! The time series decomposition.
         CTimeSeriesDecomposition* s_Decomposition;
         //! Makes the predictor to use in the change detector test.
-        TMakePredictor s_MakePredictor;
+        const TMakePredictor& s_MakePredictor;
         //! Makes the preconditioner to use for seasonality testing. This removes
         //! components which won't be explicitly tested.
-        TMakeFilteredPredictor s_MakeSeasonalityTestPreconditioner;
+        const TMakeFilteredPredictor& s_MakeSeasonalityTestPreconditioner;
         //! A factory function to create the test for seasonal components.
-        TMakeTestForSeasonality s_MakeTestForSeasonality;
+        const TMakeTestForSeasonality& s_MakeTestForSeasonality;
     };
 
     //! \brief The message passed to indicate periodic components have been
@@ -60,6 +60,9 @@ public:
     using TDouble3VecVec = std::vector<TDouble3Vec>;
     using TWeights = maths_t::CUnitWeights;
     using TWriteForecastResult = std::function<void(core_t::TTime, const TDouble3Vec&)>;
+    using TTimeDoublePr = std::pair<core_t::TTime, double>;
+    using TTimeDoublePrVec = std::vector<TTimeDoublePr>;
+    using TDoubleWeightsAryVec = std::vector<maths_t::TDoubleWeightsAry>;
 
     //! The components of the decomposition.
     enum EComponents {
@@ -114,6 +117,29 @@ public:
              double occupancy = 1.0,
              core_t::TTime firstValueTime = MIN_TIME) = 0;
 
+    //! Adds the time series points \p values in the order they are supplied.
+    //!
+    //! This is equivalent to calling addPoint for each value in turn, but the
+    //! work which doesn't depend on the individual values is done once for the
+    //! batch. It is intended for replaying history, such as lookback.
+    //!
+    //! \param[in] values The times and values of the data points.
+    //! \param[in] weights The weights of \p values. This must be empty, in which
+    //! case unit weights are used, or the same size as \p values.
+    //! \param[in] componentChangeCallback Supplied with samples of the prediction
+    //! residuals if a new component is added as a result of adding a data point.
+    //! \param[in] modelAnnotationCallback Supplied with an annotation if a new
+    //! component is added as a result of adding a data point.
+    //! \param[in] occupancy The proportion of non-empty buckets.
+    //! \param[in] firstValueTime The time of the first value added to the decomposition.
+    virtual void
+    addPoints(const TTimeDoublePrVec& values,
+              const TDoubleWeightsAryVec& weights = {},
+              const TComponentChangeCallback& componentChangeCallback = noopComponentChange,
+              const maths_t::TModelAnnotationCallback& modelAnnotationCallback = noopModelAnnotation,
+              double occupancy = 1.0,
+              core_t::TTime firstValueTime = MIN_TIME) = 0;
+
     //! Shift seasonality by \p shift at \p time.
     virtual void shiftTime(core_t::TTime time, core_t::TTime shift) = 0;
 
@@ -54,6 +54,14 @@ public:
                   double occupancy = 1.0,
                   core_t::TTime firstValueTime = MIN_TIME) override;
 
+    //! No-op.
+    void addPoints(const TTimeDoublePrVec& values,
+                   const TDoubleWeightsAryVec& weights = {},
+                   const TComponentChangeCallback& componentChangeCallback = noopComponentChange,
+                   const maths_t::TModelAnnotationCallback& modelAnnotationCallback = noopModelAnnotation,
+                   double occupancy = 1.0,
+                   core_t::TTime firstValueTime = MIN_TIME) override;
+
     //! No-op.
     void shiftTime(core_t::TTime time, core_t::TTime shift) override;
 
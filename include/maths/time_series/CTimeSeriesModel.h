@@ -37,6 +37,19 @@ class CTimeSeriesDecompositionInterface;
 class CTimeSeriesAnomalyModel;
 
 //! \brief A CModel implementation for modeling a univariate time series.
+//!
+//! DESCRIPTION:\n
+//! In high cardinality jobs many models are created which receive little
+//! or no data. A model cloned from one which has never been updated is
+//! dormant: it shares the trend decomposition, residual model and the
+//! multi-bucket feature model of the model it was cloned from, and only
+//! gets its own copies when it is first updated. The shared components
+//! are counted by the model which owns them.
+//!
+//! Forecasting only reads the residual model, so the copy made for a
+//! forecast shares it and the model takes its own copy if it is updated
+//! while the forecast still holds it. This means requesting a forecast
+//! needn't double the memory used by the residual models.
 class MATHS_TIME_SERIES_EXPORT CUnivariateTimeSeriesModel : public common::CModel {
 public:
     using TFloatMeanAccumulator =
@@ -99,6 +112,17 @@ public:
     EUpdateResult addSamples(const common::CModelAddSamplesParams& params,
                              TTimeDouble2VecSizeTrVec samples) override;
 
+    //! Update the model with the samples of a sequence of buckets.
+    //!
+    //! This gives the same state as calling addSamples for each bucket in
+    //! turn. The per bucket updates of the priors and decay rate controllers
+    //! depend on the trend at the end of the previous bucket so they can't
+    //! be reordered, but the models are only activated once, the data type
+    //! is only propagated when it changes and the trend is updated with all
+    //! the values in each bucket at once.
+    EUpdateResult addSamplesForBuckets(const TModelAddSamplesParamsVec& params,
+                                       TTimeDouble2VecSizeTrVecVec samples) override;
+
     //! Advance time by \p gap.
     void skipTime(core_t::TTime gap) override;
 
@@ -179,6 +203,9 @@ public:
     //! Get the memory used by this object.
     std::size_t memoryUsage() const override;
 
+    //! Get the memory used by the copy of this created by cloneForForecast.
+    std::size_t forecastMemoryUsage() const override;
+
     //! Initialize reading state from \p traverser.
     bool acceptRestoreTraverser(const common::SModelRestoreParams& params,
                                 core::CStateRestoreTraverser& traverser);
@@ -192,6 +219,9 @@ public:
     //! Get the type of data being modeled.
     maths_t::EDataType dataType() const override;
 
+    //! Check if this shares its state with the model it was cloned from.
+    bool isDormant() const override;
+
     //! Unpack the weights in \p weights.
     static TDoubleWeightsAry unpack(const TDouble2VecWeightsAry& weights);
 
@@ -226,6 +256,16 @@ private:
                                std::size_t id,
                                bool isForForecast = false);
 
+    //! Get our own copies of any shared components before they're modified.
+    void activate();
+
+    //! Set the data type of the trend and residual models.
+    void dataType(maths_t::EDataType type);
+
+    //! Update all the models with the samples of a single bucket.
+    EUpdateResult updateModels(const common::CModelAddSamplesParams& params,
+                               TTimeDouble2VecSizeTrVec samples);
+
     //! Update the trend with \p samples.
     EUpdateResult updateTrend(const common::CModelAddSamplesParams& params,
                               const TTimeDouble2VecSizeTrVec& samples);
@@ -282,18 +322,27 @@ private:
     //! True if the model can be forecast.
     bool m_IsForecastable{true};
 
+    //! True if the model has been updated or restored.
+    bool m_IsUpdated{false};
+
+    //! True if the trend and residual models are shared with the model
+    //! this was cloned from.
+    bool m_IsDormant{false};
+
     //! These control the trend and residual model decay rates (see
     //! CDecayRateController for more details).
     TDecayRateController2AryPtr m_Controllers;
 
     //! The time series trend decomposition.
     //!
-    //! \note This can be temporarily be shared with the change detector.
+    //! \note This can be temporarily be shared with the change detector
+    //! and is shared with the model this was cloned from while dormant.
     TDecompositionPtr m_TrendModel;
 
     //! The time series' residual model.
     //!
-    //! \note This can be temporarily be shared with the change detector.
+    //! \note This can be temporarily be shared with the change detector
+    //! and is shared with the model this was cloned from while dormant.
     TPriorPtr m_ResidualModel;
 
     //! The multi-bucket feature to use.
@@ -183,6 +183,18 @@ public:
     //! Determine whether the detector should be persisted.
     bool shouldPersistDetector() const;
 
+    //! Only persist the models which changed since the previous copy for
+    //! persistence was made. This must only be called on a copy for
+    //! persistence.
+    void persistChangedModelsOnly();
+
+    //! Check if any models must be restored from an older snapshot.
+    bool hasMissingModels() const;
+
+    //! Take the models missing from this detector from \p other, which was
+    //! restored from an older snapshot.
+    void restoreMissingModels(CAnomalyDetector& other);
+
     //! Persist state for statics - this is only called from the
     //! simple count detector to ensure singleton behaviour
     void staticsAcceptPersistInserter(core::CStatePersistInserter& inserter) const;
@@ -224,6 +236,35 @@ public:
                              core_t::TTime bucketEndTime,
                              CHierarchicalResults& results);
 
+    //! Check if results can be built for this detector concurrently with
+    //! other detectors using the deferring refresh variants.
+    //!
+    //! This is the case if sampling the model won't read the resource
+    //! monitor, since this may depend on refreshes by other detectors.
+    bool canBuildResultsConcurrently() const;
+
+    //! As buildResults but record, rather than make, any updates to the
+    //! resource monitor. These are made by calling refreshResourceMonitor.
+    //!
+    //! \note If canBuildResultsConcurrently returns true this only modifies
+    //! state owned by this detector, so it can be called concurrently for
+    //! different detectors.
+    void buildResultsDeferringRefresh(core_t::TTime bucketStartTime,
+                                      core_t::TTime bucketEndTime,
+                                      CHierarchicalResults& results);
+
+    //! As buildInterimResults but record, rather than make, any updates to
+    //! the resource monitor.
+    //!
+    //! \see buildResultsDeferringRefresh for more details.
+    void buildInterimResultsDeferringRefresh(core_t::TTime bucketStartTime,
+                                             core_t::TTime bucketEndTime,
+                                             CHierarchicalResults& results);
+
+    //! Make the resource monitor updates recorded by the last call to one
+    //! of the deferring refresh variants of building results.
+    void refreshResourceMonitor();
+
     //! Generate the model plot data for the time series identified
     //! by \p terms.
     void generateModelPlot(core_t::TTime bucketStartTime,
@@ -323,6 +364,33 @@ protected:
     void initSimpleCounting();
 
 private:
+    //! Flags for the updates to the resource monitor which building results
+    //! makes.
+    enum EResourceMonitorUpdate {
+        E_NoUpdate = 0x0,
+        E_ClearExtraMemory = 0x1,
+        E_Refresh = 0x2,
+        E_ForceRefresh = 0x4
+    };
+
+private:
+    //! Update the results with this detector model's results optionally
+    //! deferring resource monitor updates.
+    void buildResults(core_t::TTime bucketStartTime,
+                      core_t::TTime bucketEndTime,
+                      bool deferRefresh,
+                      CHierarchicalResults& results);
+
+    //! Update the results with this detector model's interim results
+    //! optionally deferring resource monitor updates.
+    void buildInterimResults(core_t::TTime bucketStartTime,
+                             core_t::TTime bucketEndTime,
+                             bool deferRefresh,
+                             CHierarchicalResults& results);
+
+    //! Make or, if \p defer is true, record the resource monitor \p updates.
+    void updateResourceMonitor(int updates, bool defer);
+
     // Shared code for building results
     template<typename SAMPLE_FUNC, typename LAST_SAMPLED_BUCKET_UPDATE_FUNC>
     void buildResultsHelper(core_t::TTime bucketStartTime,
@@ -339,14 +407,18 @@ private:
     void noUpdateLastSampledBucket(core_t::TTime bucketEndTime) const;
 
     //! Sample the model in the interval [\p startTime, \p endTime].
-    void sample(core_t::TTime startTime, core_t::TTime endTime, CResourceMonitor& resourceMonitor);
+    //!
+    //! \return The resource monitor updates this requires.
+    int sample(core_t::TTime startTime, core_t::TTime endTime, CResourceMonitor& resourceMonitor);
 
     //! Sample bucket statistics and any other state needed to compute
     //! probabilities in the interval [\p startTime, \p endTime], but
     //! does not update the model.
-    void sampleBucketStatistics(core_t::TTime startTime,
-                                core_t::TTime endTime,
-                                CResourceMonitor& resourceMonitor);
+    //!
+    //! \return The resource monitor updates this requires.
+    int sampleBucketStatistics(core_t::TTime startTime,
+                               core_t::TTime endTime,
+                               CResourceMonitor& resourceMonitor);
 
     //! Restores the state that was formerly part of the model ensemble class.
     //! This includes the data gatherer and the model.
@@ -389,6 +461,9 @@ private:
     //! necessary to create a valid persisted state?
     bool m_IsForPersistence;
 
+    //! The resource monitor updates deferred when building results.
+    int m_DeferredResourceMonitorUpdates{E_NoUpdate};
+
     friend MODEL_EXPORT std::ostream& operator<<(std::ostream&, const CAnomalyDetector&);
 };
 
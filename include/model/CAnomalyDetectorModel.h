@@ -122,6 +122,7 @@ class MODEL_EXPORT CAnomalyDetectorModel {
     friend class CModelDetailsView;
 
 public:
+    using TBoolVec = std::vector<bool>;
     using TSizeVec = std::vector<std::size_t>;
     using TDoubleVec = std::vector<double>;
     using TDouble1Vec = core::CSmallVector<double, 1>;
@@ -150,6 +151,9 @@ public:
     using TFeatureInfluenceCalculatorCPtrPrVecVec =
         std::vector<TFeatureInfluenceCalculatorCPtrPrVec>;
     using TMathsModelSPtr = std::shared_ptr<maths::common::CModel>;
+    using TMathsModelSPtrVec = std::vector<TMathsModelSPtr>;
+    using TMathsModelWPtr = std::weak_ptr<maths::common::CModel>;
+    using TMathsModelWPtrVec = std::vector<TMathsModelWPtr>;
     using TFeatureMathsModelSPtrPr = std::pair<model_t::EFeature, TMathsModelSPtr>;
     using TFeatureMathsModelSPtrPrVec = std::vector<TFeatureMathsModelSPtrPr>;
     using TMathsModelUPtr = std::unique_ptr<maths::common::CModel>;
@@ -214,6 +218,19 @@ public:
     //! purpose.
     //! \warning The caller owns the object returned.
     virtual CAnomalyDetectorModel* cloneForPersistence() const = 0;
+
+    //! Only persist the person models which have changed since the copy
+    //! for persistence before this one was made, writing placeholders for
+    //! the others. This must only be called on a copy for persistence.
+    virtual void persistChangedModelsOnly();
+
+    //! Check if any person models are placeholders for models which are
+    //! restored from an older snapshot.
+    virtual bool hasMissingModels() const;
+
+    //! Take the models missing from this model from \p other, which must
+    //! be the same type of model restored from an older snapshot.
+    virtual void restoreMissingModels(CAnomalyDetectorModel& other);
     //@}
 
     //! Get the model category.
@@ -357,6 +374,15 @@ public:
                         core_t::TTime endTime,
                         CResourceMonitor& resourceMonitor) = 0;
 
+    //! Check if sampling the next bucket may read the state of the resource
+    //! monitor.
+    //!
+    //! This is the case if the model needs to create models for new people
+    //! or attributes or it maintains correlate models. Otherwise, sampling
+    //! doesn't depend on anything outside the model so different models can
+    //! be sampled concurrently.
+    virtual bool sampleDependsOnResourceMonitor() const;
+
     //! Rolls time to \p endTime while skipping sampling the models for
     //! buckets within the gap.
     //!
@@ -496,6 +522,28 @@ protected:
     using TFeatureSizeSize1VecUMapPrVec = std::vector<TFeatureSizeSize1VecUMapPr>;
 
     //! \brief The feature models.
+    //!
+    //! IMPLEMENTATION DECISIONS:\n
+    //! Copies made for background persistence can share the person models
+    //! with the original. In this case, the original copies a model before
+    //! modifying it, so the persisted state is frozen at the time of the
+    //! copy, but only models which are actually modified whilst persistence
+    //! is running are duplicated. Only the original can add owners to a
+    //! model, so if it is the only owner the model can't be shared.
+    //!
+    //! Correlation models hold references to the person models they
+    //! correlate so models with correlations are never shared.
+    //!
+    //! Since shared models are copied before they're modified, a model which
+    //! is the same object as it was when the previous copy was made hasn't
+    //! changed in the meantime. This lets copies for persistence write only
+    //! the models which have changed.
+    //!
+    //! The memory used by the person models is maintained incrementally.
+    //! Every change to a model goes through modelToModify, addModel or
+    //! replaceModel, which mark it to be measured again, so computing the
+    //! memory usage only visits the models which changed since it was last
+    //! computed. Debug builds periodically check this against a full walk.
     struct MODEL_EXPORT SFeatureModels {
         SFeatureModels(model_t::EFeature feature, TMathsModelSPtr newModel);
         SFeatureModels(const SFeatureModels&) = delete;
@@ -520,12 +568,71 @@ protected:
         //! Determine whether the model should be persisted or not.
         bool shouldPersist() const;
 
+        //! Copy these models for persistence.
+        //!
+        //! \param[in] share If true the person models are shared with the
+        //! copy and only duplicated when they are next modified.
+        SFeatureModels cloneForPersistence(bool share) const;
+
+        //! Get the model with identifier \p id for modification, copying it
+        //! first if it is shared with a copy being persisted.
+        maths::common::CModel* modelToModify(std::size_t id);
+
+        //! Append \p model, taking ownership of it.
+        maths::common::CModel* addModel(maths::common::CModel* model);
+
+        //! Replace the model with identifier \p id by \p model, taking
+        //! ownership of it.
+        maths::common::CModel* replaceModel(std::size_t id, maths::common::CModel* model);
+
+        //! Check if any models are placeholders for unchanged models.
+        bool hasMissingModels() const;
+
+        //! Move the models missing from this from \p other.
+        void restoreMissingModels(SFeatureModels& other);
+
+        //! Check if the models in \p features have any placeholders.
+        static bool hasMissingModels(const std::vector<SFeatureModels>& features);
+
+        //! Move the models missing from \p features from \p other.
+        static void restoreMissingModels(std::vector<SFeatureModels>& features,
+                                         std::vector<SFeatureModels>& other);
+
         //! The feature.
         model_t::EFeature s_Feature;
         //! A prototype model.
         TMathsModelSPtr s_NewModel;
         //! The person models.
-        TMathsModelUPtrVec s_Models;
+        TMathsModelSPtrVec s_Models;
+        //! The person models when the last copy for persistence was made.
+        //!
+        //! \note This is bookkeeping for copies for persistence so is updated
+        //! by cloneForPersistence.
+        mutable TMathsModelWPtrVec s_CopiedModels;
+        //! For a copy for persistence, true for each model which is unchanged
+        //! since the copy before it was made.
+        TBoolVec s_Unchanged;
+        //! If true placeholders are persisted for the unchanged models.
+        bool s_PersistChangedOnly{false};
+        //! The memory used by each model when it was last measured or
+        //! UNMEASURED if it has changed since.
+        //!
+        //! \note This and the following are bookkeeping for the memory
+        //! usage so are updated by memoryUsage.
+        mutable TSizeVec s_ModelMemoryUsages;
+        //! The models which have changed since they were last measured.
+        mutable TSizeVec s_ChangedModels;
+        //! The total memory used by the measured models.
+        mutable std::size_t s_ModelsMemoryUsage{0};
+        //! The number of times the memory usage has been computed.
+        mutable std::size_t s_MemoryUsageComputations{0};
+
+    private:
+        //! Mark the model with identifier \p id to be measured again.
+        void modelChanged(std::size_t id);
+
+        //! Get the memory used by the person models.
+        std::size_t modelsMemoryUsage() const;
     };
     using TFeatureModelsVec = std::vector<SFeatureModels>;
 
@@ -13,6 +13,7 @@
 #define INCLUDED_ml_model_CBucketGatherer_h
 
 #include <core/CCompressedDictionary.h>
+#include <core/CFlatHashMap.h>
 #include <core/CHashing.h>
 #include <core/CLogger.h>
 #include <core/CMemoryUsage.h>
@@ -79,7 +80,7 @@ public:
     using TWordSizeUMap = TDictionary::TWordTUMap<std::size_t>;
     using TWordSizeUMapItr = TWordSizeUMap::iterator;
     using TWordSizeUMapCItr = TWordSizeUMap::const_iterator;
-    using TSizeSizePrUInt64UMap = boost::unordered_map<TSizeSizePr, std::uint64_t>;
+    using TSizeSizePrUInt64UMap = core::CFlatHashMap<TSizeSizePr, std::uint64_t>;
     using TSizeSizePrUInt64UMapItr = TSizeSizePrUInt64UMap::iterator;
     using TSizeSizePrUInt64UMapCItr = TSizeSizePrUInt64UMap::const_iterator;
     using TSizeSizePrUInt64UMapQueue = CBucketQueue<TSizeSizePrUInt64UMap>;
@@ -115,7 +116,7 @@ public:
     };
 
     using TSizeSizePrStoredStringPtrPrUInt64UMap =
-        boost::unordered_map<TSizeSizePrStoredStringPtrPr, std::uint64_t, SSizeSizePrStoredStringPtrPrHash, SSizeSizePrStoredStringPtrPrEqual>;
+        core::CFlatHashMap<TSizeSizePrStoredStringPtrPr, std::uint64_t, SSizeSizePrStoredStringPtrPrHash, SSizeSizePrStoredStringPtrPrEqual>;
     using TSizeSizePrStoredStringPtrPrUInt64UMapCItr =
         TSizeSizePrStoredStringPtrPrUInt64UMap::const_iterator;
     using TSizeSizePrStoredStringPtrPrUInt64UMapItr =
@@ -20,6 +20,7 @@
 #include <boost/circular_buffer.hpp>
 
 #include <functional>
+#include <iterator>
 #include <string>
 
 namespace ml {
@@ -104,6 +105,30 @@ public:
         this->push(item);
     }
 
+    //! Moves the time forward by bucket length reusing the earliest
+    //! bucket's item for the new bucket. If the \p time is earlier than
+    //! the latest bucket end, this is ignored.
+    //!
+    //! This is equivalent to pushing an empty item, but \p reset can
+    //! keep the storage the item allocated for an earlier bucket, so
+    //! starting a new bucket needn't allocate.
+    //!
+    //! \param[in] time The time to which the new bucket corresponds.
+    //! \param[in] reset Called with the reused item to empty it.
+    template<typename F>
+    void recycle(core_t::TTime time, const F& reset) {
+        if (time <= m_LatestBucketEnd) {
+            LOG_ERROR(<< "Recycle was called with early time = " << time
+                      << ", latest bucket end time = " << m_LatestBucketEnd);
+            return;
+        }
+        m_LatestBucketEnd += m_BucketLength;
+        // The queue is always full so this is constant time.
+        m_Queue.rotate(std::prev(m_Queue.end()));
+        reset(m_Queue.front());
+        LOG_TRACE(<< "Queue after recycle -> " << *this);
+    }
+
     //! Pushes an item to the queue. This is only intended to be used
     //! internally and from clients that perform restoration of the queue.
     void push(const T& item) {
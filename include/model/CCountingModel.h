@@ -183,6 +183,9 @@ public:
     //! \param[in] resourceMonitor The resourceMonitor.
     void sample(core_t::TTime startTime, core_t::TTime endTime, CResourceMonitor& resourceMonitor) override;
 
+    //! Returns false: the counts are always allocated.
+    bool sampleDependsOnResourceMonitor() const override;
+
     //! No-op.
     void prune(std::size_t maximumAge) override;
     //@}
@@ -186,6 +186,16 @@ public:
     //! purpose.
     //! \warning The caller owns the object returned.
     CAnomalyDetectorModel* cloneForPersistence() const override;
+
+    //! Only persist the models which changed since the previous copy for
+    //! persistence was made.
+    void persistChangedModelsOnly() override;
+
+    //! Check if any models must be restored from an older snapshot.
+    bool hasMissingModels() const override;
+
+    //! Take the models missing from this model from \p other.
+    void restoreMissingModels(CAnomalyDetectorModel& other) override;
     //@}
 
     //! Get the model category.
@@ -27,6 +27,7 @@
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace ml {
 namespace core {
@@ -49,6 +50,7 @@ class MODEL_EXPORT CForecastDataSink final : private core::CNonCopyable {
 public:
     using TMathsModelPtr = std::shared_ptr<maths::common::CModel>;
     using TStrUMap = boost::unordered_set<std::string>;
+    using TErrorBarVec = std::vector<maths::common::SErrorBar>;
     struct SForecastResultSeries;
 
     //! \brief Wrapper which supports creating a forecast for a single
@@ -73,6 +75,21 @@ public:
                       CForecastDataSink& sink,
                       std::string& message) const;
 
+        //! Forecast into \p errorBars rather than writing to a sink.
+        //!
+        //! This is safe to call concurrently for different models. Use
+        //! write to output the forecast.
+        bool forecast(core_t::TTime startTime,
+                      core_t::TTime endTime,
+                      double boundsPercentile,
+                      TErrorBarVec& errorBars,
+                      std::string& message) const;
+
+        //! Write \p errorBars created by forecast to \p sink.
+        void write(const SForecastResultSeries& series,
+                   const TErrorBarVec& errorBars,
+                   CForecastDataSink& sink) const;
+
     private:
         model_t::EFeature m_Feature;
         std::string m_ByFieldValue;
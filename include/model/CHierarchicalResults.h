@@ -311,6 +311,16 @@ public:
     //! Add the influencer called \p name.
     void addInfluencer(const std::string& name);
 
+    //! Move the simple search results and influencers of \p other to the
+    //! end of these results.
+    //!
+    //! This is equivalent to having added the results of \p other directly
+    //! to this object, so results built separately for a number of detectors
+    //! and merged in a fixed order are independent of how they were built.
+    //!
+    //! \note This must be called before the hierarchy is built.
+    void merge(CHierarchicalResults&& other);
+
     //! Build a hierarchy from the current flat node list using the
     //! default aggregation rules.
     //!
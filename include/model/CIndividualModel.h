@@ -18,10 +18,12 @@
 
 #include <model/CAnomalyDetectorModel.h>
 #include <model/CMemoryUsageEstimator.h>
+#include <model/CModelSpillStore.h>
 #include <model/ImportExport.h>
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -86,6 +88,19 @@ public:
     CIndividualModel& operator=(const CIndividualModel&) = delete;
     //@}
 
+    //! \name Persistence
+    //@{
+    //! Only persist the models which changed since the previous copy for
+    //! persistence was made.
+    void persistChangedModelsOnly() override;
+
+    //! Check if any models must be restored from an older snapshot.
+    bool hasMissingModels() const override;
+
+    //! Take the models missing from this model from \p other.
+    void restoreMissingModels(CAnomalyDetectorModel& other) override;
+    //@}
+
     //! Returns false.
     bool isPopulation() const override;
 
@@ -124,6 +139,9 @@ public:
                 core_t::TTime endTime,
                 CResourceMonitor& resourceMonitor) override = 0;
 
+    //! Check if there are new people or correlate models to allocate.
+    bool sampleDependsOnResourceMonitor() const override;
+
     //! Prune any person models which haven't been updated for a
     //! specified period.
     void prune(std::size_t maximumAge) override;
@@ -284,6 +302,15 @@ private:
     //! Get the model memory usage estimator
     CMemoryUsageEstimator* memoryUsageEstimator() const override;
 
+    //! Write the models of \p people to the spill store, if one is
+    //! configured, before they are pruned.
+    void spillModels(const TSizeVec& people);
+
+    //! Restore the models of the person \p pid if they were spilled.
+    //!
+    //! \return True if the person's models were restored.
+    bool rehydrateModels(std::size_t pid);
+
 private:
     //! The time that each person was first seen.
     TTimeVec m_FirstBucketTimes;
@@ -303,6 +330,12 @@ private:
 
     //! The memory estimator.
     mutable CMemoryUsageEstimator m_MemoryEstimator;
+
+    //! The models of pruned people which may be restored if they reappear.
+    //!
+    //! \note This is created the first time people are pruned and isn't
+    //! copied into clones for persistence.
+    std::unique_ptr<CModelSpillStore> m_SpillStore;
 };
 }
 }
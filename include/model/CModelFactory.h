@@ -23,6 +23,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -146,7 +147,9 @@ public:
     //! CModelConfig this is ensured for you.
     CModelFactory(const SModelParams& params,
                   const TInterimBucketCorrectorWPtr& interimBucketCorrector);
+    CModelFactory(const CModelFactory& other);
     virtual ~CModelFactory() = default;
+    CModelFactory& operator=(const CModelFactory&) = delete;
 
     //! Create a copy of the factory owned by the calling code.
     virtual CModelFactory* clone() const = 0;
@@ -331,6 +334,9 @@ public:
     //! Set the prune window scale factor maximum
     void pruneWindowScaleMaximum(double factor);
 
+    //! Set the directory to which the models of pruned people are spilled.
+    void modelSpillDirectory(const std::string& directory);
+
     //! Set the window length to use for multibucket features.
     //!
     //! \note A length of zero disables modeling of multibucket features altogether.
@@ -447,6 +453,10 @@ private:
     //! memory usage in the objects this creates.
     TInterimBucketCorrectorWPtr m_InterimBucketCorrector;
 
+    //! Serialises access to the caches since models for different detectors
+    //! can be created concurrently, for example when restoring state.
+    mutable std::mutex m_CacheMutex;
+
     //! A cache of models for collections of features.
     mutable TFeatureVecMathsModelMap m_MathsModelCache;
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#ifndef INCLUDED_ml_model_CModelSpillStore_h
+#define INCLUDED_ml_model_CModelSpillStore_h
+
+#include <core/CMemoryUsage.h>
+#include <core/CNonCopyable.h>
+
+#include <model/ImportExport.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+
+namespace ml {
+namespace model {
+
+//! \brief A compressed file backed store for the state of cold models.
+//!
+//! DESCRIPTION:\n
+//! When memory is short we prune the models of people who haven't been
+//! seen recently. If a spill directory is configured their state is
+//! written here rather than discarded and is restored if they reappear.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! Each entry is deflated and appended to a single file and an index in
+//! memory maps its key to its position in the file. Only the index counts
+//! towards the memory used by the model which owns the store.
+//!
+//! Reading an entry removes it and the file is compacted when most of it
+//! is dead, so its size is bounded by a small multiple of the live state.
+//!
+//! The file is deleted when the store is destroyed. It is a cache of the
+//! state of pruned models and isn't part of the job's persisted state.
+class MODEL_EXPORT CModelSpillStore : private core::CNonCopyable {
+public:
+    //! \param[in] directory The directory in which to create the file.
+    explicit CModelSpillStore(const std::string& directory);
+    ~CModelSpillStore();
+
+    //! Write \p state for \p key, replacing any state already stored.
+    //!
+    //! \return False if the state couldn't be written.
+    bool spill(const std::string& key, const std::string& state);
+
+    //! Read and remove the state for \p key.
+    //!
+    //! \return False if there is no state for \p key or it can't be read.
+    bool rehydrate(const std::string& key, std::string& state);
+
+    //! Check if there is state for \p key.
+    bool contains(const std::string& key) const;
+
+    //! Get the number of entries.
+    std::size_t size() const;
+
+    //! Get the size of the spill file in bytes.
+    std::uint64_t fileSize() const;
+
+    //! Get the name of the spill file.
+    const std::string& fileName() const;
+
+    //! Debug the memory used by this object.
+    void debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const;
+
+    //! Get the memory used by this object.
+    std::size_t memoryUsage() const;
+
+private:
+    //! The offset and length of an entry in the file.
+    using TUInt64UInt64Pr = std::pair<std::uint64_t, std::uint64_t>;
+    using TStrUInt64UInt64PrUMap = boost::unordered_map<std::string, TUInt64UInt64Pr>;
+
+private:
+    //! Forget \p entry.
+    void erase(TStrUInt64UInt64PrUMap::iterator entry);
+
+    //! Rewrite the file with only the live entries if enough is dead.
+    bool compactIfRequired();
+
+private:
+    //! The name of the spill file.
+    std::string m_FileName;
+
+    //! The spill file.
+    std::fstream m_File;
+
+    //! The position of each live entry in the file.
+    TStrUInt64UInt64PrUMap m_Index;
+
+    //! The size of the file.
+    std::uint64_t m_FileSize = 0;
+
+    //! The total size of the live entries.
+    std::uint64_t m_LiveSize = 0;
+};
+}
+}
+
+#endif // INCLUDED_ml_model_CModelSpillStore_h
@@ -143,6 +143,10 @@ public:
     void sample(core_t::TTime startTime,
                 core_t::TTime endTime,
                 CResourceMonitor& resourceMonitor) override = 0;
+
+    //! Check if there are new people, attributes or correlate models to
+    //! allocate.
+    bool sampleDependsOnResourceMonitor() const override;
     //@}
 
     //! Get the checksum of this model.
@@ -21,8 +21,10 @@
 
 #include <boost/unordered_map.hpp>
 
+#include <atomic>
 #include <functional>
 #include <map>
+#include <mutex>
 
 namespace CResourceMonitorTest {
 class CTestFixture;
@@ -47,6 +49,12 @@ class CMonitoredResource;
 //!
 //! DESCRIPTION:\n
 //! Assess memory used by models and decide on further memory allocations.
+//!
+//! IMPLEMENTATION DECISIONS:\n
+//! The calls made whilst adding records to a data gatherer, i.e.
+//! areAllocationsAllowed, acceptAllocationFailureResult and addExtraMemory,
+//! are thread safe so records for different detectors can be added
+//! concurrently. All other functions must only be called from one thread.
 class MODEL_EXPORT CResourceMonitor {
 public:
     struct MODEL_EXPORT SModelSizeStats {
@@ -234,7 +242,10 @@ private:
     TMonitoredResourcePtrSizeUMap m_Resources;
 
     //! Is there enough free memory to allow creating new components
-    bool m_AllowAllocations{true};
+    std::atomic<bool> m_AllowAllocations{true};
+
+    //! Serialises the updates made whilst adding records.
+    std::mutex m_Mutex;
 
     //! The relative margin to apply to the byte limits.
     double m_ByteLimitMargin;
@@ -277,7 +277,9 @@ public:
     void startNewBucket(core_t::TTime time) {
         m_BucketStats.push(TMetricPartialStatistic(m_Dimension), time);
         for (auto& stats : m_InfluencerBucketStats) {
-            stats.push(TStoredStringPtrStatUMap(1), time);
+            stats.recycle(time, [](TStoredStringPtrStatUMap& bucketStats) {
+                bucketStats.clear();
+            });
         }
         m_Samples.clear();
     }
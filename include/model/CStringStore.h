@@ -20,9 +20,11 @@
 
 #include <boost/unordered_set.hpp>
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace CResourceMonitorTest {
 class CTestFixture;
@@ -54,7 +56,13 @@ namespace model {
 //! A singleton class: there should only be one collection strings for
 //! person names/attributes, and a separate collection for influencer
 //! strings.
-//! Write access is locked for the benefit of future threading.
+//!
+//! The strings are split between a fixed number of shards by their hash,
+//! which is computed once per lookup. Reads are lock free and writes lock
+//! only the shard they modify, so threads interning different strings
+//! rarely contend. Pruning uses the same protocol as inserting, i.e. it
+//! waits for the reads in progress on a shard to finish before it erases
+//! anything, so it is safe to prune while other threads call get.
 //!
 class MODEL_EXPORT CStringStore : private core::CNonCopyable {
 public:
@@ -71,9 +79,13 @@ public:
         }
     };
 
+public:
+    //! The number of shards into which each store is split.
+    static constexpr std::size_t NUMBER_SHARDS{16};
+
 public:
     //! Call this to tidy up any strings no longer needed.
-    static void tidyUpNotThreadSafe();
+    static void tidyUp();
 
     //! Singleton pattern for person/attribute names.
     static CStringStore& names();
@@ -91,10 +103,13 @@ public:
     void remove(const std::string& value);
 
     //! Prune strings which have been removed.
-    void pruneRemovedNotThreadSafe();
+    void pruneRemoved();
 
     //! Iterate over the string store and remove unused entries.
-    void pruneNotThreadSafe();
+    void prune();
+
+    //! Get the number of strings in the store.
+    std::size_t size() const;
 
     //! Get the memory used by this string store
     void debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const;
@@ -107,37 +122,66 @@ private:
         boost::unordered_set<core::CStoredStringPtr, SHashStoredStringPtr, SStoredStringPtrEqual>;
     using TStrVec = std::vector<std::string>;
 
+    //! \brief The strings whose hashes map to one shard.
+    //!
+    //! Each shard is aligned to a cache line so updating the counts of
+    //! readers of one shard doesn't slow down readers of the others.
+    struct alignas(64) SShard {
+        //! Get exclusive access to the shard for modification.
+        //!
+        //! \note This must be called with s_Mutex locked.
+        void startWriting();
+
+        //! Finish modifying the shard.
+        void stopWriting();
+
+        //! Free the storage of the set of strings if it is empty.
+        void releaseIfEmpty();
+
+        //! Get the memory used by the set of strings.
+        std::size_t stringsMemoryUsage() const;
+
+        //! The number of threads searching for a string. See get for details.
+        std::atomic_int s_Reading{0};
+
+        //! The number of threads modifying the strings. See get for details.
+        std::atomic_int s_Writing{0};
+
+        //! Set to keep the person/attribute string pointers
+        TStoredStringPtrUSet s_Strings;
+
+        //! A list of the strings to remove.
+        TStrVec s_Removed;
+
+        //! Running count of memory usage by stored strings.  Avoids the need to
+        //! recalculate repeatedly.
+        std::size_t s_StoredStringsMemUse{0};
+
+        //! Locking primitive
+        mutable core::CFastMutex s_Mutex;
+    };
+    using TShardArray = std::array<SShard, NUMBER_SHARDS>;
+
 private:
     //! Constructor of a Singleton is private.
     CStringStore();
 
+    //! Get the shard which holds strings whose hash is \p hash.
+    SShard& shard(std::size_t hash);
+    const SShard& shard(std::size_t hash) const;
+
+    //! Check if \p value is in the store.
+    bool containsTestOnly(const std::string& value) const;
+
     //! Bludgeoning device to delete all objects in store.
     void clearEverythingTestOnly();
 
 private:
-    //! Fence for reading operations (in which case we "leak" a string
-    //! if we try to write at the same time). See get for details.
-    std::atomic_int m_Reading;
-
-    //! Fence for writing operations (in which case we "leak" a string
-    //! if we try to read at the same time). See get for details.
-    std::atomic_int m_Writing;
-
     //! The empty string is often used so we store it outside the set.
     core::CStoredStringPtr m_EmptyString;
 
-    //! Set to keep the person/attribute string pointers
-    TStoredStringPtrUSet m_Strings;
-
-    //! A list of the strings to remove.
-    TStrVec m_Removed;
-
-    //! Running count of memory usage by stored strings.  Avoids the need to
-    //! recalculate repeatedly.
-    std::size_t m_StoredStringsMemUse;
-
-    //! Locking primitive
-    mutable core::CFastMutex m_Mutex;
+    //! The shards.
+    TShardArray m_Shards;
 
     friend class CResourceMonitorTest::CTestFixture;
     friend class CStringStoreTest::CTestFixture;
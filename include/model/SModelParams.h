@@ -158,6 +158,11 @@ struct MODEL_EXPORT SModelParams {
     //! The scale factor of the decayRate that determines the maximum size
     //! of the sliding prune window for purging older entries from the model
     double s_PruneWindowScaleMaximum;
+
+    //! The directory to which the models of pruned people are spilled so
+    //! they can be restored if those people reappear. If this is empty
+    //! pruned models are discarded.
+    std::string s_ModelSpillDirectory;
     //@}
 
     //! \name Rules
@@ -11,6 +11,8 @@
 #include <api/CAnomalyJob.h>
 
 #include <core/CDataAdder.h>
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CBinaryStateRestoreTraverser.h>
 #include <core/CDataSearcher.h>
 #include <core/CJsonStatePersistInserter.h>
 #include <core/CJsonStateRestoreTraverser.h>
@@ -24,6 +26,7 @@
 #include <core/CStopWatch.h>
 #include <core/CStringUtils.h>
 #include <core/CTimeUtils.h>
+#include <core/Concurrency.h>
 #include <core/UnwrapRef.h>
 
 #include <maths/common/CIntegerTools.h>
@@ -48,6 +51,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 namespace ml {
@@ -80,6 +84,7 @@ const std::string LATEST_RECORD_TIME_TAG("h");
 
 const std::string LAST_RESULTS_TIME_TAG("j");
 const std::string INTERIM_BUCKET_CORRECTOR_TAG("k");
+const std::string DELTA_TAG("l");
 
 //! The minimum version required to read the state corresponding to a model snapshot.
 //! This should be updated every time there is a breaking change to the model state.
@@ -93,6 +98,48 @@ const std::string INTERIM_BUCKET_CORRECTOR_TAG("k");
 //! compatibility code.)
 const std::string MODEL_SNAPSHOT_MIN_VERSION("8.3.0");
 
+//! The maximum number of records to buffer before adding them to the detectors
+//! when records are sharded by partition.
+const std::size_t MAX_BUFFERED_RECORDS{10000};
+
+//! The maximum total size of the copied detector state to hold before
+//! restoring the detectors when they are restored concurrently.
+const std::size_t MAX_PENDING_DETECTOR_RESTORE_BYTES{128 * 1024 * 1024};
+
+using TStatePersistInserterUPtr = std::unique_ptr<core::CStatePersistInserter>;
+
+//! Copy the remainder of the current level of \p traverser to \p inserter.
+bool copyState(core::CStateRestoreTraverser& traverser, core::CStatePersistInserter& inserter) {
+    do {
+        const std::string& name{traverser.name()};
+        if (traverser.hasSubLevel()) {
+            bool copied{true};
+            inserter.insertLevel(name, [&](core::CStatePersistInserter& subLevelInserter) {
+                copied = traverser.traverseSubLevel([&](core::CStateRestoreTraverser& subLevelTraverser) {
+                    return copyState(subLevelTraverser, subLevelInserter);
+                });
+            });
+            if (copied == false) {
+                return false;
+            }
+        } else if (name.empty() == false) {
+            // An empty name means we're at the end of an empty level. Numbers
+            // are copied directly because their string form may be inexact.
+            core::CStateRestoreTraverser::TNumericValue number{traverser.numericValue()};
+            if (const auto* value = std::get_if<double>(&number)) {
+                inserter.insertValue(name, *value);
+            } else if (const auto* value = std::get_if<std::int64_t>(&number)) {
+                inserter.insertValue(name, *value);
+            } else if (const auto* value = std::get_if<std::uint64_t>(&number)) {
+                inserter.insertValue(name, *value);
+            } else {
+                inserter.insertValue(name, traverser.value());
+            }
+        }
+    } while (traverser.next());
+    return traverser.haveBadState() == false;
+}
+
 //! Persist state as JSON with meaningful tag names.
 class CReadableJsonStatePersistInserter : public core::CJsonStatePersistInserter {
 public:
@@ -138,8 +185,9 @@ CAnomalyJob::CAnomalyJob(const std::string& jobId,
                          const std::string& timeFieldFormat,
                          size_t maxAnomalyRecords)
     : CDataProcessor{timeFieldName, timeFieldFormat}, m_JobId{jobId}, m_Limits{limits},
-      m_OutputStream{outputStream}, m_ForecastRunner{m_JobId, m_OutputStream,
-                                                     limits.resourceMonitor()},
+      m_OutputStream{outputStream},
+      m_ForecastRunner{m_JobId, m_OutputStream, limits.resourceMonitor(),
+                       core::defaultAsyncThreadPoolSize()},
       m_JsonOutputWriter{m_JobId, m_OutputStream}, m_JobConfig{jobConfig},
       m_ModelConfig{modelConfig}, m_NumRecordsHandled{0},
       m_LastFinalisedBucketEndTime{0}, m_PersistCompleteFunc{persistCompleteFunc},
@@ -192,6 +240,15 @@ bool CAnomalyJob::handleRecord(const TStrStrUMap& dataRowFields, TOptionalTime t
 
     if (m_DetectorKeys.empty()) {
         this->populateDetectorKeys(m_JobConfig, m_DetectorKeys);
+
+        // Records for different partitions can be added concurrently.
+        std::size_t numberShards{core::defaultAsyncThreadPoolSize()};
+        if (numberShards > 1 &&
+            std::any_of(m_DetectorKeys.begin(), m_DetectorKeys.end(), [](const auto& key) {
+                return key.partitionFieldName().empty() == false;
+            })) {
+            m_RecordShards.resize(numberShards);
+        }
     }
 
     for (std::size_t i = 0; i < m_DetectorKeys.size(); ++i) {
@@ -214,7 +271,15 @@ bool CAnomalyJob::handleRecord(const TStrStrUMap& dataRowFields, TOptionalTime t
             continue;
         }
 
-        this->addRecord(detector, *time, dataRowFields);
+        if (m_RecordShards.empty()) {
+            this->addRecord(detector, *time, dataRowFields);
+        } else {
+            this->bufferRecord(detector, partitionFieldValue, *time, dataRowFields);
+        }
+    }
+
+    if (m_NumberBufferedRecords >= MAX_BUFFERED_RECORDS) {
+        this->flushRecordShards();
     }
 
     ++core::CProgramCounters::counter(counter_t::E_TSADNumberApiRecordsHandled);
@@ -226,6 +291,8 @@ bool CAnomalyJob::handleRecord(const TStrStrUMap& dataRowFields, TOptionalTime t
 }
 
 void CAnomalyJob::finalise() {
+    this->flushRecordShards();
+
     // Persist final state of normalizer iff an input record has been handled or time has been advanced.
     if (this->isPersistenceNeeded("quantiles state and model size stats")) {
         m_JsonOutputWriter.persistNormalizer(m_Normalizer, m_LastNormalizerPersistTime);
@@ -320,6 +387,8 @@ bool CAnomalyJob::handleControlMessage(const std::string& controlMessage) {
         return false;
     }
 
+    this->flushRecordShards();
+
     switch (controlMessage[0]) {
     case ' ':
         // Spaces are just used to fill the buffers and force prior messages
@@ -514,6 +583,7 @@ void CAnomalyJob::outputBucketResultsUntil(core_t::TTime time) {
     for (core_t::TTime lastBucketEndTime = m_LastFinalisedBucketEndTime;
          lastBucketEndTime + bucketLength + latency <= time;
          lastBucketEndTime += bucketLength) {
+        this->flushRecordShards();
         this->outputResults(lastBucketEndTime);
         m_Limits.resourceMonitor().decreaseMargin(bucketLength);
         m_Limits.resourceMonitor().sendMemoryUsageReportIfSignificantlyChanged(
@@ -650,6 +720,8 @@ void CAnomalyJob::outputResults(core_t::TTime bucketStartTime) {
     TKeyCRefAnomalyDetectorPtrPrVec detectors;
     this->sortedDetectors(detectors);
 
+    bool builtResults{this->buildResultsConcurrently(false, bucketStartTime, detectors, results)};
+
     for (const auto& detector_ : detectors) {
         model::CAnomalyDetector* detector(detector_.second.get());
         if (detector == nullptr) {
@@ -657,7 +729,9 @@ void CAnomalyJob::outputResults(core_t::TTime bucketStartTime) {
                       << pairDebug(detector_.first) << '\'');
             continue;
         }
-        detector->buildResults(bucketStartTime, bucketStartTime + bucketLength, results);
+        if (builtResults == false) {
+            detector->buildResults(bucketStartTime, bucketStartTime + bucketLength, results);
+        }
         detector->releaseMemory(bucketStartTime - m_ModelConfig.samplingAgeCutoff());
 
         this->generateModelPlot(bucketStartTime, bucketStartTime + bucketLength,
@@ -703,7 +777,7 @@ void CAnomalyJob::outputResults(core_t::TTime bucketStartTime) {
 
     // Prune models based on memory resource limits
     m_Limits.resourceMonitor().pruneIfRequired(bucketStartTime);
-    model::CStringStore::tidyUpNotThreadSafe();
+    model::CStringStore::tidyUp();
 }
 
 void CAnomalyJob::outputInterimResults(core_t::TTime bucketStartTime) {
@@ -717,6 +791,8 @@ void CAnomalyJob::outputInterimResults(core_t::TTime bucketStartTime) {
     TKeyCRefAnomalyDetectorPtrPrVec detectors;
     this->sortedDetectors(detectors);
 
+    bool builtResults{this->buildResultsConcurrently(true, bucketStartTime, detectors, results)};
+
     for (const auto& detector_ : detectors) {
         model::CAnomalyDetector* detector(detector_.second.get());
         if (detector == nullptr) {
@@ -724,7 +800,10 @@ void CAnomalyJob::outputInterimResults(core_t::TTime bucketStartTime) {
                       << pairDebug(detector_.first) << '\'');
             continue;
         }
-        detector->buildInterimResults(bucketStartTime, bucketStartTime + bucketLength, results);
+        if (builtResults == false) {
+            detector->buildInterimResults(bucketStartTime,
+                                          bucketStartTime + bucketLength, results);
+        }
     }
 
     if (!results.empty()) {
@@ -747,6 +826,48 @@ void CAnomalyJob::outputInterimResults(core_t::TTime bucketStartTime) {
     this->writeOutResults(true, results, bucketStartTime, processingTime);
 }
 
+bool CAnomalyJob::buildResultsConcurrently(bool interim,
+                                           core_t::TTime bucketStartTime,
+                                           const TKeyCRefAnomalyDetectorPtrPrVec& detectors,
+                                           model::CHierarchicalResults& results) const {
+    if (core::defaultAsyncThreadPoolSize() < 2 || detectors.size() < 2 ||
+        std::any_of(detectors.begin(), detectors.end(), [](const auto& detector) {
+            return detector.second != nullptr &&
+                   detector.second->canBuildResultsConcurrently() == false;
+        })) {
+        return false;
+    }
+
+    core_t::TTime bucketEndTime{bucketStartTime + m_ModelConfig.bucketLength()};
+
+    // Refreshing the resource monitor isn't thread safe. The detectors only read it when
+    // sampling if they need to allocate, which excludes them from here, so we
+    // can replay the updates they would have made afterwards in order.
+    std::vector<model::CHierarchicalResults> detectorResults(detectors.size());
+    core::parallel_for_each(std::size_t{0}, detectors.size(), [&](std::size_t i) {
+        model::CAnomalyDetector* detector{detectors[i].second.get()};
+        if (detector == nullptr) {
+            return;
+        }
+        if (interim) {
+            detector->buildInterimResultsDeferringRefresh(bucketStartTime, bucketEndTime,
+                                                          detectorResults[i]);
+        } else {
+            detector->buildResultsDeferringRefresh(bucketStartTime, bucketEndTime,
+                                                   detectorResults[i]);
+        }
+    });
+
+    for (std::size_t i = 0; i < detectors.size(); ++i) {
+        if (detectors[i].second != nullptr) {
+            detectors[i].second->refreshResourceMonitor();
+            results.merge(std::move(detectorResults[i]));
+        }
+    }
+
+    return true;
+}
+
 void CAnomalyJob::writeOutResults(bool interim,
                                   model::CHierarchicalResults& results,
                                   core_t::TTime bucketTime,
@@ -813,34 +934,47 @@ bool CAnomalyJob::restoreState(core::CDataSearcher& restoreSearcher,
                                core_t::TTime& completeToTime) {
     size_t numDetectors(0);
     try {
-        // Restore from Elasticsearch compressed data.
-        // (To restore from uncompressed data for testing, comment the next line
-        // and substitute decompressor with restoreSearcher two lines below.)
-        core::CStateDecompressor decompressor(restoreSearcher);
-
-        core::CDataSearcher::TIStreamP strm(decompressor.search(1, 1));
-        if (strm == nullptr) {
-            LOG_ERROR(<< "Unable to connect to data store");
-            return false;
-        }
+        // A delta snapshot is followed by the older snapshots in its chain,
+        // newest first, each of which is a separate compressed document.
+        std::size_t olderSnapshots{0};
+        for (std::size_t i = 0; i == 0 || i <= olderSnapshots; ++i) {
+            // Restore from Elasticsearch compressed data.
+            // (To restore from uncompressed data for testing, comment the next line
+            // and substitute decompressor with restoreSearcher two lines below.)
+            core::CStateDecompressor decompressor(restoreSearcher);
+
+            core::CDataSearcher::TIStreamP strm(decompressor.search(1, 1));
+            if (strm == nullptr) {
+                LOG_ERROR(<< "Unable to connect to data store");
+                return false;
+            }
 
-        if (strm->bad()) {
-            LOG_ERROR(<< "State restoration search returned bad stream");
-            return false;
-        }
+            if (strm->bad()) {
+                LOG_ERROR(<< "State restoration search returned bad stream");
+                return false;
+            }
 
-        if (strm->fail()) {
-            // This is fatal. If the stream exists and has failed then state is missing
-            LOG_ERROR(<< "State restoration search returned failed stream");
-            return false;
-        }
+            if (strm->fail()) {
+                // This is fatal. If the stream exists and has failed then state is missing
+                LOG_ERROR(<< "State restoration search returned failed stream");
+                return false;
+            }
 
-        // We're dealing with streaming JSON state
-        core::CJsonStateRestoreTraverser traverser(*strm);
+            // We're dealing with streaming state which may be JSON or binary
+            auto traverser = core::CBinaryStateRestoreTraverser::makeTraverser(*strm);
 
-        if (this->restoreState(traverser, completeToTime, numDetectors) == false ||
-            traverser.haveBadState()) {
-            LOG_ERROR(<< "Failed to restore detectors");
+            if (this->restoreState(*traverser, completeToTime, numDetectors,
+                                   i == 0, olderSnapshots) == false ||
+                traverser->haveBadState()) {
+                LOG_ERROR(<< "Failed to restore detectors");
+                return false;
+            }
+        }
+        if (std::any_of(m_Detectors.begin(), m_Detectors.end(), [](const auto& detector) {
+                return detector.second->hasMissingModels();
+            })) {
+            LOG_ERROR(<< "Failed to restore detectors - models are missing from "
+                         "the chain of delta snapshots");
             return false;
         }
         LOG_DEBUG(<< "Finished restoration, with " << numDetectors << " detectors");
@@ -884,7 +1018,9 @@ bool CAnomalyJob::restoreState(core::CDataSearcher& restoreSearcher,
 
 bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
                                core_t::TTime& completeToTime,
-                               std::size_t& numDetectors) {
+                               std::size_t& numDetectors,
+                               bool isNewest,
+                               std::size_t& olderSnapshots) {
     m_RestoredStateDetail.s_RestoredStateStatus = E_Failure;
     m_RestoredStateDetail.s_Extra = std::nullopt;
 
@@ -904,11 +1040,13 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
                   << traverser.name() << '=' << traverser.value());
         return false;
     }
-    m_LastFinalisedBucketEndTime = lastBucketEndTime;
+    if (isNewest) {
+        m_LastFinalisedBucketEndTime = lastBucketEndTime;
 
-    if (lastBucketEndTime > completeToTime) {
-        LOG_INFO(<< "Processing is already complete to time " << lastBucketEndTime);
-        completeToTime = lastBucketEndTime;
+        if (lastBucketEndTime > completeToTime) {
+            LOG_INFO(<< "Processing is already complete to time " << lastBucketEndTime);
+            completeToTime = lastBucketEndTime;
+        }
     }
 
     if ((traverser.next() == false) || (traverser.name() != VERSION_TAG)) {
@@ -924,13 +1062,36 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
                   << stateVersion << " - ignoring it as current state version is "
                   << model::CAnomalyDetector::STATE_VERSION);
 
-        // This counts as successful restoration
-        return true;
+        // This counts as successful restoration unless we've already
+        // restored part of a chain of delta snapshots
+        return isNewest;
     }
 
     while (traverser.next()) {
         const std::string& name = traverser.name();
-        if (name == INTERIM_BUCKET_CORRECTOR_TAG) {
+        if (name == TOP_LEVEL_DETECTOR_TAG) {
+            if (traverser.traverseSubLevel(std::bind(&CAnomalyJob::restoreSingleDetector, this,
+                                                     isNewest == false,
+                                                     std::placeholders::_1)) == false) {
+                LOG_ERROR(<< "Cannot restore anomaly detector");
+                m_PendingDetectorRestores.clear();
+                m_PendingDetectorRestoreBytes = 0;
+                return false;
+            }
+            if (isNewest) {
+                ++numDetectors;
+            }
+        } else if (isNewest == false) {
+            // Everything else comes from the newest snapshot.
+            continue;
+        } else if (name == DELTA_TAG) {
+            if (traverser.valueAs(olderSnapshots) == false) {
+                LOG_ERROR(<< "Invalid delta snapshot count " << traverser.value());
+                return false;
+            }
+            LOG_DEBUG(<< "Restoring delta snapshot with " << olderSnapshots
+                      << " older snapshots");
+        } else if (name == INTERIM_BUCKET_CORRECTOR_TAG) {
             // Note that this has to be persisted and restored before any detectors.
             auto interimBucketCorrector = std::make_shared<model::CInterimBucketCorrector>(
                 m_ModelConfig.bucketLength());
@@ -941,13 +1102,6 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
                 return false;
             }
             m_ModelConfig.interimBucketCorrector(interimBucketCorrector);
-        } else if (name == TOP_LEVEL_DETECTOR_TAG) {
-            if (traverser.traverseSubLevel(std::bind(&CAnomalyJob::restoreSingleDetector,
-                                                     this, std::placeholders::_1)) == false) {
-                LOG_ERROR(<< "Cannot restore anomaly detector");
-                return false;
-            }
-            ++numDetectors;
         } else if (name == RESULTS_AGGREGATOR_TAG) {
             if (traverser.traverseSubLevel(std::bind(
                     &model::CHierarchicalResultsAggregator::acceptRestoreTraverser,
@@ -962,12 +1116,18 @@ bool CAnomalyJob::restoreState(core::CStateRestoreTraverser& traverser,
         }
     }
 
+    if (this->restorePendingDetectors() == false) {
+        LOG_ERROR(<< "Cannot restore anomaly detector");
+        return false;
+    }
+
     m_RestoredStateDetail.s_RestoredStateStatus = E_Success;
 
     return true;
 }
 
-bool CAnomalyJob::restoreSingleDetector(core::CStateRestoreTraverser& traverser) {
+bool CAnomalyJob::restoreSingleDetector(bool isOlder,
+                                        core::CStateRestoreTraverser& traverser) {
     if (traverser.name() != KEY_TAG) {
         LOG_ERROR(<< "Cannot restore anomaly detector - " << KEY_TAG << " element expected but found "
                   << traverser.name() << '=' << traverser.value());
@@ -1029,6 +1189,40 @@ bool CAnomalyJob::restoreSingleDetector(core::CStateRestoreTraverser& traverser)
         return false;
     }
 
+    if (isOlder) {
+        // We only need the models which were unchanged in the newer snapshots.
+        const std::string& partition{key.isSimpleCount() ? EMPTY_STRING : partitionFieldValue};
+        auto detector = m_Detectors.find(
+            model::CSearchKey::TStrCRefKeyCRefPr(std::cref(partition), std::cref(key)),
+            model::CStrKeyPrHash(), model::CStrKeyPrEqual());
+        if (detector == m_Detectors.end() || detector->second->hasMissingModels() == false) {
+            LOG_TRACE(<< "Skipping older state for " << key.toCue() << "/" << partitionFieldValue);
+            return true;
+        }
+
+        // Creating and destroying the temporary detector updates the memory
+        // usage counter, which should keep the value restored from the newest
+        // snapshot.
+        std::uint64_t memoryUsage{core::CProgramCounters::counter(counter_t::E_TSADMemoryUsage)};
+        {
+            TAnomalyDetectorPtr olderDetector{this->makeDetector(
+                m_ModelConfig, m_Limits, partition, 0, m_ModelConfig.factory(key))};
+            if (traverser.traverseSubLevel(std::bind(
+                    &model::CAnomalyDetector::acceptRestoreTraverser, olderDetector.get(),
+                    std::cref(partitionFieldValue), std::placeholders::_1)) == false) {
+                LOG_ERROR(<< "Error restoring older state of anomaly detector for key '"
+                          << key.debug() << '/' << partitionFieldValue << '\'');
+                m_RestoredStateDetail.s_RestoredStateStatus = E_Failure;
+                return false;
+            }
+            detector->second->restoreMissingModels(*olderDetector);
+        }
+        core::CProgramCounters::counter(counter_t::E_TSADMemoryUsage) = memoryUsage;
+
+        LOG_TRACE(<< "Restored older state for " << key.toCue() << "/" << partitionFieldValue);
+        return true;
+    }
+
     if (this->restoreDetectorState(key, partitionFieldValue, traverser) == false) {
         LOG_ERROR(<< "Delegated portion of anomaly detector restore failed");
         m_RestoredStateDetail.s_RestoredStateStatus = E_Failure;
@@ -1055,6 +1249,33 @@ bool CAnomalyJob::restoreDetectorState(const model::CSearchKey& key,
         return false;
     }
 
+    // The simple count detector also restores the static state so we always
+    // restore it here.
+    if (core::defaultAsyncThreadPoolSize() > 1 && key.isSimpleCount() == false) {
+        LOG_DEBUG(<< "Copying state for detector with key '" << key.debug()
+                  << '/' << partitionFieldValue << '\'');
+
+        std::ostringstream state;
+        bool copied{false};
+        {
+            core::CBinaryStatePersistInserter inserter{state};
+            copied = traverser.traverseSubLevel([&](core::CStateRestoreTraverser& traverser_) {
+                return copyState(traverser_, inserter);
+            });
+        }
+        if (copied == false) {
+            LOG_ERROR(<< "Error reading state of anomaly detector for key '"
+                      << key.debug() << '/' << partitionFieldValue << '\'');
+            return false;
+        }
+
+        m_PendingDetectorRestoreBytes += state.str().size();
+        m_PendingDetectorRestores.push_back(
+            {detector.get(), key.debug(), partitionFieldValue, state.str()});
+        return m_PendingDetectorRestoreBytes < MAX_PENDING_DETECTOR_RESTORE_BYTES ||
+               this->restorePendingDetectors();
+    }
+
     LOG_DEBUG(<< "Restoring state for detector with key '" << key.debug() << '/'
               << partitionFieldValue << '\'');
 
@@ -1069,9 +1290,50 @@ bool CAnomalyJob::restoreDetectorState(const model::CSearchKey& key,
     return true;
 }
 
+bool CAnomalyJob::restorePendingDetectors() {
+    if (m_PendingDetectorRestores.empty()) {
+        return true;
+    }
+
+    TPendingDetectorRestoreVec pending;
+    pending.swap(m_PendingDetectorRestores);
+    m_PendingDetectorRestoreBytes = 0;
+
+    LOG_DEBUG(<< "Restoring " << pending.size() << " detectors concurrently");
+
+    // The detectors have already been added to the detector map and the only
+    // state they share while restoring is the string store and the model
+    // factories' caches, which are both thread safe.
+    std::vector<std::uint8_t> restored(pending.size(), false);
+    core::parallel_for_each(std::size_t{0}, pending.size(), [&](std::size_t i) {
+        std::istringstream state{std::move(pending[i].s_State)};
+        core::CBinaryStateRestoreTraverser traverser{state};
+        try {
+            restored[i] = pending[i].s_Detector->acceptRestoreTraverser(
+                              pending[i].s_PartitionFieldValue, traverser) &&
+                          traverser.haveBadState() == false;
+        } catch (const std::exception& e) {
+            LOG_ERROR(<< "Restoration failed: " << e.what());
+        }
+    });
+
+    bool result{true};
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        if (restored[i] == false) {
+            LOG_ERROR(<< "Error restoring anomaly detector for key '"
+                      << pending[i].s_Description << '/'
+                      << pending[i].s_PartitionFieldValue << '\'');
+            result = false;
+        }
+    }
+    return result;
+}
+
 bool CAnomalyJob::persistModelsState(core::CDataAdder& persister,
                                      core_t::TTime timestamp,
                                      const std::string& outputFormat) {
+    this->flushRecordShards();
+
     TKeyCRefAnomalyDetectorPtrPrVec detectors;
     this->sortedDetectors(detectors);
 
@@ -1083,6 +1345,14 @@ bool CAnomalyJob::persistModelsState(core::CDataAdder& persister,
     return this->persistModelsState(detectors, persister, timestamp, outputFormat);
 }
 
+void CAnomalyJob::persistInBinaryFormat(bool binary) {
+    m_PersistInBinaryFormat = binary;
+}
+
+void CAnomalyJob::maxDeltaSnapshots(std::size_t maxDeltas) {
+    m_MaxDeltaSnapshots = maxDeltas;
+}
+
 bool CAnomalyJob::persistStateInForeground(core::CDataAdder& persister,
                                            const std::string& descriptionPrefix) {
     if (m_LastFinalisedBucketEndTime == 0) {
@@ -1101,6 +1371,8 @@ bool CAnomalyJob::doPersistStateInForeground(core::CDataAdder& persister,
                                              const std::string& description,
                                              const std::string& snapshotId,
                                              core_t::TTime snapshotTimestamp) {
+    this->flushRecordShards();
+
     if (m_PersistenceManager != nullptr) {
         // This will not happen if finalise() was called before persisting state
         if (m_PersistenceManager->isBusy()) {
@@ -1126,7 +1398,7 @@ bool CAnomalyJob::doPersistStateInForeground(core::CDataAdder& persister,
         m_Limits.resourceMonitor().createMemoryUsageReport(
             m_LastFinalisedBucketEndTime - m_ModelConfig.bucketLength()),
         m_ModelConfig.interimBucketCorrector(), m_Aggregator, normaliserState,
-        m_LatestRecordTime, m_LastResultsTime, persister);
+        m_LatestRecordTime, m_LastResultsTime, false, persister);
 }
 
 bool CAnomalyJob::backgroundPersistState() {
@@ -1151,6 +1423,8 @@ bool CAnomalyJob::backgroundPersistState() {
     // it should be relatively fast though
     m_Normalizer.toJson(m_LastResultsTime, "api", args->s_NormalizerState, true);
 
+    args->s_CopyNumber = ++m_NumberPersistCopies;
+
     TKeyCRefAnomalyDetectorPtrPrVec& copiedDetectors = args->s_Detectors;
     copiedDetectors.reserve(m_Detectors.size());
 
@@ -1206,11 +1480,30 @@ bool CAnomalyJob::runBackgroundPersist(TBackgroundPersistArgsPtr args,
     const std::string description{"Periodic background persist at " +
                                   core::CTimeUtils::toIso8601(snapshotTimestamp)};
 
-    return this->persistCopiedState(
+    // The models' record of what has changed is relative to the previous copy
+    // so a delta is only possible if that copy was successfully persisted.
+    bool delta{m_MaxDeltaSnapshots > 0 && m_LastSnapshotId.empty() == false &&
+               m_NumberDeltaSnapshots < m_MaxDeltaSnapshots &&
+               args->s_CopyNumber == m_LastPersistedCopyNumber + 1};
+    if (delta) {
+        for (const auto& detector : args->s_Detectors) {
+            detector.second->persistChangedModelsOnly();
+        }
+    }
+
+    bool persisted{this->persistCopiedState(
         description, snapshotId, snapshotTimestamp, args->s_Time,
         args->s_Detectors, args->s_ModelSizeStats, args->s_InterimBucketCorrector,
         args->s_Aggregator, args->s_NormalizerState, args->s_LatestRecordTime,
-        args->s_LastResultsTime, persister);
+        args->s_LastResultsTime, delta, persister)};
+
+    if (m_MaxDeltaSnapshots > 0) {
+        m_NumberDeltaSnapshots = delta ? m_NumberDeltaSnapshots + 1 : 0;
+        m_LastSnapshotId = persisted ? snapshotId : std::string{};
+        m_LastPersistedCopyNumber = args->s_CopyNumber;
+    }
+
+    return persisted;
 }
 
 bool CAnomalyJob::persistModelsState(const TKeyCRefAnomalyDetectorPtrPrVec& detectors,
@@ -1270,6 +1563,7 @@ bool CAnomalyJob::persistCopiedState(const std::string& description,
                                      const std::string& normalizerState,
                                      core_t::TTime latestRecordTime,
                                      core_t::TTime lastResultsTime,
+                                     bool delta,
                                      core::CDataAdder& persister) {
     // Ensure that the cache of program counters is cleared upon exiting the current scope.
     // As the cache is cleared when the simple count detector is persisted this may seem
@@ -1288,12 +1582,25 @@ bool CAnomalyJob::persistCopiedState(const std::string& description,
             // analytics carries on processing new buckets in the main thread.
             // Therefore, this method must NOT access any member variables whose
             // values can change.  There should be no use of m_ variables in the
-            // following code block.
+            // following code block, except for the delta snapshot state which
+            // only persistence uses.
             {
-                // The JSON inserter must be destructed before the stream is complete
-                core::CJsonStatePersistInserter inserter(*strm);
+                // The inserter must be destructed before the stream is complete.
+                // Note m_PersistInBinaryFormat is only set before processing starts.
+                TStatePersistInserterUPtr inserter_;
+                if (m_PersistInBinaryFormat) {
+                    inserter_ = std::make_unique<core::CBinaryStatePersistInserter>(*strm);
+                } else {
+                    inserter_ = std::make_unique<core::CJsonStatePersistInserter>(*strm);
+                }
+                core::CStatePersistInserter& inserter{*inserter_};
                 inserter.insertValue(TIME_TAG, time);
                 inserter.insertValue(VERSION_TAG, model::CAnomalyDetector::STATE_VERSION);
+                if (delta) {
+                    // The number of older snapshots to restore: the previous
+                    // deltas and the last full snapshot.
+                    inserter.insertValue(DELTA_TAG, m_NumberDeltaSnapshots + 1);
+                }
                 inserter.insertLevel(
                     INTERIM_BUCKET_CORRECTOR_TAG,
                     std::bind(&model::CInterimBucketCorrector::acceptPersistInserter,
@@ -1341,7 +1648,8 @@ bool CAnomalyJob::persistCopiedState(const std::string& description,
                     // This needs to be the last final result time as it serves
                     // as the time after which all results are deleted when a
                     // model snapshot is reverted
-                    time - m_ModelConfig.bucketLength()};
+                    time - m_ModelConfig.bucketLength(),
+                    delta ? m_LastSnapshotId : std::string{}};
 
                 m_PersistCompleteFunc(modelSnapshotReport);
             }
@@ -1594,6 +1902,8 @@ CAnomalyJob::detectorForKey(bool isRestoring,
 }
 
 void CAnomalyJob::pruneAllModels(std::size_t buckets) {
+    this->flushRecordShards();
+
     if (buckets == 0) {
         LOG_INFO(<< "Pruning obsolete models");
     } else {
@@ -1662,6 +1972,50 @@ void CAnomalyJob::addRecord(const TAnomalyDetectorPtr detector,
     detector->addRecord(time, fieldValues);
 }
 
+void CAnomalyJob::bufferRecord(const TAnomalyDetectorPtr& detector,
+                               const std::string& partitionFieldValue,
+                               core_t::TTime time,
+                               const TStrStrUMap& dataRowFields) {
+    std::size_t shard{std::hash<std::string>{}(partitionFieldValue) %
+                      m_RecordShards.size()};
+    const TStrVec& fieldNames = detector->fieldsOfInterest();
+    m_RecordShards[shard].push_back({detector.get(), time, TStrVec(fieldNames.size()),
+                                     std::vector<bool>(fieldNames.size(), false)});
+    auto& record = m_RecordShards[shard].back();
+    for (std::size_t i = 0; i < fieldNames.size(); ++i) {
+        const std::string* value{fieldValue(fieldNames[i], dataRowFields)};
+        if (value == nullptr) {
+            record.s_Missing[i] = true;
+        } else {
+            record.s_FieldValues[i] = *value;
+        }
+    }
+    ++m_NumberBufferedRecords;
+}
+
+void CAnomalyJob::flushRecordShards() {
+    if (m_NumberBufferedRecords == 0) {
+        return;
+    }
+
+    // Detectors only share the resource monitor and string store, both of
+    // which can be safely updated concurrently whilst adding records.
+    core::parallel_for_each(std::size_t{0}, m_RecordShards.size(), [this](std::size_t shard) {
+        model::CAnomalyDetector::TStrCPtrVec fieldValues;
+        for (const auto& record : m_RecordShards[shard]) {
+            fieldValues.clear();
+            for (std::size_t i = 0; i < record.s_FieldValues.size(); ++i) {
+                fieldValues.push_back(record.s_Missing[i] ? nullptr
+                                                          : &record.s_FieldValues[i]);
+            }
+            record.s_Detector->addRecord(record.s_Time, fieldValues);
+        }
+        m_RecordShards[shard].clear();
+    });
+
+    m_NumberBufferedRecords = 0;
+}
+
 CAnomalyJob::SBackgroundPersistArgs::SBackgroundPersistArgs(
     core_t::TTime time,
     const model::CResourceMonitor::SModelSizeStats& modelSizeStats,
@@ -159,7 +159,8 @@ void CDataFrameOutliersRunner::runImpl(core::CDataFrame& frame) {
         static_cast<maths::analytics::COutliers::EMethod>(m_Method),
         m_NumberNeighbours,
         m_ComputeFeatureInfluence,
-        m_OutlierFraction};
+        m_OutlierFraction,
+        true /*reduce dimension*/};
     maths::analytics::COutliers::compute(params, frame, m_Instrumentation);
 }
 
@@ -175,7 +176,8 @@ CDataFrameOutliersRunner::estimateBookkeepingMemoryUsage(std::size_t numberParti
         static_cast<maths::analytics::COutliers::EMethod>(m_Method),
         m_NumberNeighbours,
         m_ComputeFeatureInfluence,
-        m_OutlierFraction};
+        m_OutlierFraction,
+        true /*reduce dimension*/};
     return maths::analytics::COutliers::estimateMemoryUsedByCompute(
         params, totalNumberRows, partitionNumberRows, numberColumns);
 }
@@ -14,6 +14,9 @@
 #include <core/CLogger.h>
 #include <core/CStopWatch.h>
 #include <core/CTimeUtils.h>
+#include <core/Concurrency.h>
+
+#include <maths/common/CModel.h>
 
 #include <model/CForecastDataSink.h>
 #include <model/CForecastModelPersist.h>
@@ -23,6 +26,7 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/system/error_code.hpp>
 
+#include <algorithm>
 #include <sstream>
 
 namespace ml {
@@ -50,6 +54,19 @@ bool sufficientAvailableDiskSpaceForPath(std::size_t minForecastAvailableDiskSpa
 }
 
 const std::string EMPTY_STRING;
+
+//! \brief The result of forecasting a single model.
+struct SModelForecast {
+    void clear() {
+        s_ErrorBars.clear();
+        s_Message.clear();
+        s_Success = false;
+    }
+
+    model::CForecastDataSink::TErrorBarVec s_ErrorBars;
+    std::string s_Message;
+    bool s_Success = false;
+};
 }
 
 const std::size_t CForecastRunner::DEFAULT_MAX_FORECAST_MODEL_MEMORY{20971520}; // 20MB
@@ -78,21 +95,29 @@ const std::string CForecastRunner::INFO_NO_MODELS_CAN_CURRENTLY_BE_FORECAST("Ins
 
 CForecastRunner::CForecastRunner(const std::string& jobId,
                                  core::CJsonOutputStreamWrapper& strmOut,
-                                 model::CResourceMonitor& resourceMonitor)
+                                 model::CResourceMonitor& resourceMonitor,
+                                 std::size_t numberWorkers)
     : m_JobId{jobId}, m_ConcurrentOutputStream{strmOut},
       m_ResourceMonitor{resourceMonitor}, m_Shutdown{false} {
-    m_Worker = std::thread([this] { this->forecastWorker(); });
+    numberWorkers = std::max(
+        std::min(numberWorkers, std::size_t{MAX_FORECAST_JOBS_IN_QUEUE}), std::size_t{1});
+    m_Workers.reserve(numberWorkers);
+    for (std::size_t i = 0; i < numberWorkers; ++i) {
+        m_Workers.emplace_back([this] { this->forecastWorker(); });
+    }
 }
 
 CForecastRunner::~CForecastRunner() {
     // shutdown
     m_Shutdown.store(true);
-    // signal the worker
+    // signal the workers
     {
         std::unique_lock<std::mutex> lock(m_Mutex);
         m_WorkAvailableCondition.notify_all();
     }
-    m_Worker.join();
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
 }
 
 void CForecastRunner::finishForecasts() {
@@ -108,102 +133,12 @@ void CForecastRunner::forecastWorker() {
     SForecast forecastJob;
     while (m_Shutdown.load() == false) {
         if (this->tryGetJob(forecastJob)) {
-            LOG_INFO(<< "Start forecasting from "
-                     << core::CTimeUtils::toIso8601(forecastJob.s_StartTime) << " to "
-                     << core::CTimeUtils::toIso8601(forecastJob.forecastEnd()));
-
-            core::CStopWatch timer(true);
-            std::uint64_t lastStatsUpdate = 0;
-
-            LOG_TRACE(<< "about to create sink");
-            model::CForecastDataSink sink(
-                m_JobId, forecastJob.s_ForecastId, forecastJob.s_ForecastAlias,
-                forecastJob.s_CreateTime, forecastJob.s_StartTime,
-                forecastJob.forecastEnd(), forecastJob.s_ExpiryTime,
-                forecastJob.s_MemoryUsage, m_ConcurrentOutputStream);
-
-            std::string message;
-
-            // collecting the runtime messages first and sending it in 1 go
-            TStrUSet messages(forecastJob.s_Messages);
-            double processedModels = 0;
-            double totalNumberOfForecastableModels =
-                static_cast<double>(forecastJob.s_NumberOfForecastableModels);
-            std::size_t failedForecasts = 0;
-            sink.writeStats(0.0, 0, forecastJob.s_Messages);
-
-            // while loops allow us to free up memory for every model right after each forecast is done
-            while (!forecastJob.s_ForecastSeries.empty()) {
-                TForecastResultSeries& series = forecastJob.s_ForecastSeries.back();
-                std::unique_ptr<model::CForecastModelPersist::CRestore> modelRestore;
-
-                // initialize persistence restore exactly once
-                if (!series.s_ToForecastPersisted.empty()) {
-                    modelRestore = std::make_unique<model::CForecastModelPersist::CRestore>(
-                        series.s_ModelParams, series.s_MinimumSeasonalVarianceScale,
-                        series.s_ToForecastPersisted);
-                }
-
-                while (series.s_ToForecast.empty() == false || modelRestore != nullptr) {
-                    // check if we should backfill from persistence
-                    if (series.s_ToForecast.empty()) {
-                        TMathsModelPtr model;
-                        core_t::TTime firstDataTime;
-                        core_t::TTime lastDataTime;
-                        model_t::EFeature feature;
-                        std::string byFieldValue;
-
-                        if (modelRestore->nextModel(model, firstDataTime, lastDataTime,
-                                                    feature, byFieldValue)) {
-                            series.s_ToForecast.emplace_back(
-                                feature, byFieldValue, std::move(model),
-                                firstDataTime, lastDataTime);
-                        } else {
-                            // restorer exhausted, no need for further restoring
-                            modelRestore.reset();
-                            break;
-                        }
-                    }
-
-                    const TForecastModelWrapper& model{series.s_ToForecast.back()};
-                    bool success{model.forecast(
-                        series, forecastJob.s_StartTime, forecastJob.forecastEnd(),
-                        forecastJob.s_BoundsPercentile, sink, message)};
-                    series.s_ToForecast.pop_back();
-
-                    if (success == false) {
-                        LOG_DEBUG(<< "Detector " << series.s_DetectorIndex
-                                  << " failed to forecast");
-                        ++failedForecasts;
-                    }
-
-                    if (message.empty() == false) {
-                        messages.insert("Detector[" + std::to_string(series.s_DetectorIndex) +
-                                        "]: " + message);
-                        message.clear();
-                    }
+            this->runForecast(forecastJob);
 
-                    ++processedModels;
-
-                    if (processedModels != totalNumberOfForecastableModels) {
-                        std::uint64_t elapsedTime = timer.lap();
-                        if (elapsedTime - lastStatsUpdate > MINIMUM_TIME_ELAPSED_FOR_STATS_UPDATE) {
-                            sink.writeStats(processedModels / totalNumberOfForecastableModels,
-                                            elapsedTime, forecastJob.s_Messages);
-                            lastStatsUpdate = elapsedTime;
-                        }
-                    }
-                }
-                forecastJob.s_ForecastSeries.pop_back();
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_InMemoryModelUsage -= inMemoryModelUsage(forecastJob);
             }
-            // write final message
-            sink.writeStats(1.0, timer.stop(), messages,
-                            failedForecasts != forecastJob.s_NumberOfForecastableModels);
-
-            // important: reset the structure to decrease shared pointer reference counts
-            forecastJob.reset();
-            LOG_INFO(<< "Finished forecasting, wrote "
-                     << sink.numRecordsWritten() << " records");
 
             // signal that job is done
             m_WorkCompleteCondition.notify_all();
@@ -227,8 +162,132 @@ void CForecastRunner::forecastWorker() {
     this->deleteAllForecastJobs();
 }
 
+void CForecastRunner::runForecast(SForecast& forecastJob) {
+    LOG_INFO(<< "Start forecasting from "
+             << core::CTimeUtils::toIso8601(forecastJob.s_StartTime) << " to "
+             << core::CTimeUtils::toIso8601(forecastJob.forecastEnd()));
+
+    core::CStopWatch timer(true);
+    std::uint64_t lastStatsUpdate = 0;
+
+    LOG_TRACE(<< "about to create sink");
+    model::CForecastDataSink sink(
+        m_JobId, forecastJob.s_ForecastId, forecastJob.s_ForecastAlias,
+        forecastJob.s_CreateTime, forecastJob.s_StartTime, forecastJob.forecastEnd(),
+        forecastJob.s_ExpiryTime, forecastJob.s_MemoryUsage, m_ConcurrentOutputStream);
+
+    // collecting the runtime messages first and sending it in 1 go
+    TStrUSet messages(forecastJob.s_Messages);
+    double processedModels = 0;
+    double totalNumberOfForecastableModels =
+        static_cast<double>(forecastJob.s_NumberOfForecastableModels);
+    std::size_t failedForecasts = 0;
+    sink.writeStats(0.0, 0, forecastJob.s_Messages);
+
+    // We forecast one model per thread at a time. This bounds the number of
+    // models we restore from disk and the results we buffer.
+    std::size_t batchSize{std::max(core::defaultAsyncThreadPoolSize(), std::size_t{1})};
+    std::vector<TForecastModelWrapper> batch;
+    std::vector<SModelForecast> results(batchSize);
+    batch.reserve(batchSize);
+
+    // while loops allow us to free up memory for every model right after each forecast is done
+    while (!forecastJob.s_ForecastSeries.empty()) {
+        TForecastResultSeries& series = forecastJob.s_ForecastSeries.back();
+        std::unique_ptr<model::CForecastModelPersist::CRestore> modelRestore;
+
+        // initialize persistence restore exactly once
+        if (!series.s_ToForecastPersisted.empty()) {
+            modelRestore = std::make_unique<model::CForecastModelPersist::CRestore>(
+                series.s_ModelParams, series.s_MinimumSeasonalVarianceScale,
+                series.s_ToForecastPersisted);
+        }
+
+        for (;;) {
+            while (batch.size() < batchSize) {
+                if (series.s_ToForecast.empty() == false) {
+                    batch.push_back(std::move(series.s_ToForecast.back()));
+                    series.s_ToForecast.pop_back();
+                    continue;
+                }
+
+                // check if we should backfill from persistence
+                if (modelRestore == nullptr) {
+                    break;
+                }
+                TMathsModelPtr model;
+                core_t::TTime firstDataTime;
+                core_t::TTime lastDataTime;
+                model_t::EFeature feature;
+                std::string byFieldValue;
+                if (modelRestore->nextModel(model, firstDataTime, lastDataTime,
+                                            feature, byFieldValue)) {
+                    batch.emplace_back(feature, byFieldValue, std::move(model),
+                                       firstDataTime, lastDataTime);
+                } else {
+                    // restorer exhausted, no need for further restoring
+                    modelRestore.reset();
+                }
+            }
+            if (batch.empty()) {
+                break;
+            }
+
+            core::parallel_for_each(std::size_t{0}, batch.size(), [&](std::size_t i) {
+                results[i].s_Success = batch[i].forecast(
+                    forecastJob.s_StartTime, forecastJob.forecastEnd(),
+                    forecastJob.s_BoundsPercentile, results[i].s_ErrorBars,
+                    results[i].s_Message);
+            });
+
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                SModelForecast& result{results[i]};
+                batch[i].write(series, result.s_ErrorBars, sink);
+
+                if (result.s_Success == false) {
+                    LOG_DEBUG(<< "Detector " << series.s_DetectorIndex << " failed to forecast");
+                    ++failedForecasts;
+                }
+
+                if (result.s_Message.empty() == false) {
+                    messages.insert("Detector[" + std::to_string(series.s_DetectorIndex) +
+                                    "]: " + result.s_Message);
+                }
+                result.clear();
+
+                ++processedModels;
+
+                if (processedModels != totalNumberOfForecastableModels) {
+                    std::uint64_t elapsedTime = timer.lap();
+                    if (elapsedTime - lastStatsUpdate > MINIMUM_TIME_ELAPSED_FOR_STATS_UPDATE) {
+                        sink.writeStats(processedModels / totalNumberOfForecastableModels,
+                                        elapsedTime, forecastJob.s_Messages);
+                        lastStatsUpdate = elapsedTime;
+                    }
+                }
+            }
+            batch.clear();
+        }
+        forecastJob.s_ForecastSeries.pop_back();
+    }
+    // write final message
+    sink.writeStats(1.0, timer.stop(), messages,
+                    failedForecasts != forecastJob.s_NumberOfForecastableModels);
+
+    // important: reset the structure to decrease shared pointer reference counts
+    forecastJob.reset();
+    LOG_INFO(<< "Finished forecasting, wrote " << sink.numRecordsWritten() << " records");
+}
+
+std::size_t CForecastRunner::inMemoryModelUsage(const SForecast& forecastJob) {
+    return forecastJob.s_TemporaryFolder.empty() ? forecastJob.s_MemoryUsage : 0;
+}
+
 void CForecastRunner::deleteAllForecastJobs() {
     std::unique_lock<std::mutex> lock(m_Mutex);
+    for (const auto& forecastJob : m_ForecastJobs) {
+        m_InMemoryModelUsage -= inMemoryModelUsage(forecastJob);
+    }
     m_ForecastJobs.clear();
     m_WorkAvailableCondition.notify_all();
 }
@@ -274,6 +333,14 @@ bool CForecastRunner::pushForecastJob(const std::string& controlMessage,
     bool atLeastOneSupportedFunction = false;
     std::size_t totalMemoryUsage = 0;
 
+    // Models of forecasts which are queued or running are held in memory
+    // at the same time as the models of this forecast.
+    std::size_t otherForecastsMemoryUsage = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        otherForecastsMemoryUsage = m_InMemoryModelUsage;
+    }
+
     // 1st loop over the detectors to check prerequisites
     for (const auto& detector : detectors) {
         if (detector.get() == nullptr) {
@@ -292,7 +359,7 @@ bool CForecastRunner::pushForecastJob(const std::string& controlMessage,
                                       prerequisites.s_IsSupportedFunction;
         totalMemoryUsage += prerequisites.s_MemoryUsageForDetector;
 
-        if (totalMemoryUsage >= forecastJob.s_MaxForecastModelMemory &&
+        if (otherForecastsMemoryUsage + totalMemoryUsage >= forecastJob.s_MaxForecastModelMemory &&
             forecastJob.s_TemporaryFolder.empty()) {
             this->sendErrorMessage(
                 forecastJob, "Forecast cannot be executed as forecast memory usage is predicted to exceed " +
@@ -331,7 +398,7 @@ bool CForecastRunner::pushForecastJob(const std::string& controlMessage,
 
     // 2nd loop over the detectors to clone models for forecasting
     bool persistOnDisk = false;
-    if (totalMemoryUsage >= forecastJob.s_MaxForecastModelMemory) {
+    if (otherForecastsMemoryUsage + totalMemoryUsage >= forecastJob.s_MaxForecastModelMemory) {
         boost::filesystem::path temporaryFolder(forecastJob.s_TemporaryFolder);
 
         if (sufficientAvailableDiskSpaceForPath(forecastJob.s_MinForecastAvailableDiskSpace,
@@ -390,6 +457,7 @@ bool CForecastRunner::push(SForecast& forecastJob) {
         return false;
     }
 
+    m_InMemoryModelUsage += inMemoryModelUsage(forecastJob);
     m_ForecastJobs.push_back(std::move(forecastJob));
 
     lock.unlock();
@@ -62,5 +62,9 @@ const CInputParser::TStrVec& CInputParser::fieldNames() const {
 CInputParser::TStrVec& CInputParser::fieldNames() {
     return m_FieldNames;
 }
+
+const CInputParser::TStrVec& CInputParser::mutableFieldNames() const {
+    return m_MutableFieldNames;
+}
 }
 }
@@ -24,6 +24,7 @@ const std::string TIMESTAMP("timestamp");
 const std::string MODEL_SNAPSHOT("model_snapshot");
 const std::string SNAPSHOT_ID("snapshot_id");
 const std::string SNAPSHOT_DOC_COUNT("snapshot_doc_count");
+const std::string PREVIOUS_SNAPSHOT_ID("previous_snapshot_id");
 const std::string DESCRIPTION("description");
 const std::string LATEST_RECORD_TIME("latest_record_time_stamp");
 const std::string LATEST_RESULT_TIME("latest_result_time_stamp");
@@ -53,6 +54,11 @@ void CModelSnapshotJsonWriter::write(const SModelSnapshotReport& report) {
     m_Writer.String(SNAPSHOT_DOC_COUNT);
     m_Writer.Uint64(report.s_NumDocs);
 
+    if (report.s_PreviousSnapshotId.empty() == false) {
+        m_Writer.String(PREVIOUS_SNAPSHOT_ID);
+        m_Writer.String(report.s_PreviousSnapshotId);
+    }
+
     m_Writer.String(TIMESTAMP);
     m_Writer.Time(report.s_SnapshotTimestamp);
 
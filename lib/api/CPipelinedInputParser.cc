@@ -0,0 +1,125 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <api/CPipelinedInputParser.h>
+
+#include <thread>
+#include <utility>
+
+namespace ml {
+namespace api {
+namespace {
+using TStrStrUMap = CInputParser::TStrStrUMap;
+
+//! Copy \p from to \p to reusing the strings in \p to if the field names
+//! are unchanged, which is the usual case.
+void copyFields(const TStrStrUMap& from, TStrStrUMap& to) {
+    if (from.size() == to.size()) {
+        bool sameNames{true};
+        for (const auto& field : from) {
+            auto iter = to.find(field.first);
+            if (iter == to.end()) {
+                sameNames = false;
+                break;
+            }
+            iter->second.assign(field.second);
+        }
+        if (sameNames) {
+            return;
+        }
+    }
+    to = from;
+}
+}
+
+CPipelinedInputParser::CPipelinedInputParser(CInputParser& parser)
+    : CInputParser{parser.mutableFieldNames()}, m_Parser{parser} {
+    for (std::size_t i = 0; i < NUMBER_BUFFERS; ++i) {
+        m_FreeRecords.push(std::make_unique<SRecord>());
+    }
+}
+
+bool CPipelinedInputParser::readStreamIntoMaps(const TMapReaderFunc& readerFunc,
+                                               const TRegisterMutableFieldFunc& registerFunc) {
+    return this->pipeline(
+        [this](const TQueueRecordFunc& queue) {
+            return m_Parser.readStreamIntoMaps([&queue](const TStrStrUMap& fields) {
+                return queue([&fields](SRecord& record) {
+                    copyFields(fields, record.s_Fields);
+                });
+            });
+        },
+        [&](SRecord& record) {
+            this->registerMutableFields(registerFunc, record.s_Fields);
+            return readerFunc(record.s_Fields);
+        });
+}
+
+bool CPipelinedInputParser::readStreamIntoVecs(const TVecReaderFunc& readerFunc,
+                                               const TRegisterMutableFieldFunc& registerFunc) {
+    return this->pipeline(
+        [this](const TQueueRecordFunc& queue) {
+            return m_Parser.readStreamIntoVecs(
+                [&queue](const TStrVec& fieldNames, const TStrVec& fieldValues) {
+                    return queue([&](SRecord& record) {
+                        record.s_FieldNames = fieldNames;
+                        record.s_FieldValues = fieldValues;
+                    });
+                });
+        },
+        [&](SRecord& record) {
+            this->registerMutableFields(registerFunc, record.s_FieldNames,
+                                        record.s_FieldValues);
+            return readerFunc(record.s_FieldNames, record.s_FieldValues);
+        });
+}
+
+bool CPipelinedInputParser::pipeline(const TProducerFunc& producer,
+                                     const TConsumerFunc& consumer) {
+    m_Stop.store(false);
+
+    bool parsed{false};
+    std::thread parser{[&] {
+        parsed = producer([this](const TFillRecordFunc& fill) {
+            if (m_Stop.load()) {
+                return false;
+            }
+            // This blocks if all the buffers are waiting to be handled.
+            TRecordUPtr record{m_FreeRecords.pop()};
+            fill(*record);
+            m_ReadyRecords.push(std::move(record));
+            return true;
+        });
+        m_ReadyRecords.push(TRecordUPtr{});
+    }};
+
+    // If the consumer asks to stop we keep recycling the buffers so the
+    // producer can't block before it sees the request.
+    bool handled{true};
+    for (;;) {
+        TRecordUPtr record{m_ReadyRecords.pop()};
+        if (record == nullptr) {
+            break;
+        }
+        if (handled && consumer(*record) == false) {
+            handled = false;
+            m_Stop.store(true);
+        }
+        m_FreeRecords.push(std::move(record));
+    }
+
+    parser.join();
+
+    this->fieldNames() = std::as_const(m_Parser).fieldNames();
+
+    return parsed && handled;
+}
+}
+}
@@ -13,6 +13,8 @@
 #include <core/CJsonOutputStreamWrapper.h>
 #include <core/CLogger.h>
 #include <core/CRegex.h>
+#include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 
 #include <model/CAnomalyDetectorModelConfig.h>
 #include <model/CDataGatherer.h>
@@ -25,6 +27,8 @@
 #include <api/CSingleStreamSearcher.h>
 #include <api/CStateRestoreStreamFilter.h>
 
+#include <test/CRandomNumbers.h>
+
 #include "CTestAnomalyJob.h"
 
 #include <rapidjson/document.h>
@@ -35,6 +39,7 @@
 #include <cstdio>
 #include <fstream>
 #include <map>
+#include <regex>
 #include <sstream>
 
 BOOST_TEST_DONT_PRINT_LOG_VALUE(rapidjson::Value::ConstMemberIterator)
@@ -712,6 +717,76 @@ BOOST_AUTO_TEST_CASE(testInterimResultEdgeCases) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testConcurrentResults) {
+
+    // Check that adding records to different partitions and building the
+    // results for many detectors concurrently gives identical output to doing
+    // this sequentially.
+
+    using TDoubleVec = std::vector<double>;
+    using TStrVec = std::vector<std::string>;
+
+    core_t::TTime bucketSize{3600};
+    api::CAnomalyJobConfig jobConfig = CTestAnomalyJob::makeSimpleJobConfig(
+        "mean", "value", "animal", "", "region", {"animal"});
+
+    TStrVec regions{"r1", "r2", "r3", "r4", "r5", "r6", "r7", "r8"};
+    TStrVec animals{"a1", "a2", "a3", "a4", "a5"};
+
+    auto runJob = [&](std::size_t numberThreads) {
+        if (numberThreads > 1) {
+            core::startDefaultAsyncExecutor(numberThreads);
+        }
+
+        model::CLimits limits;
+        model::CAnomalyDetectorModelConfig modelConfig =
+            model::CAnomalyDetectorModelConfig::defaultConfig(bucketSize);
+        std::stringstream outputStrm;
+        {
+            core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
+            CTestAnomalyJob job("job", limits, jobConfig, modelConfig, wrappedOutputStream);
+
+            test::CRandomNumbers rng;
+            TDoubleVec values;
+            CTestAnomalyJob::TStrStrUMap dataRows;
+            CTestAnomalyJob::TStrStrUMap interim{{".", "i"}};
+            for (core_t::TTime time = 0; time < 150 * bucketSize; time += bucketSize / 4) {
+                rng.generateNormalSamples(10.0, 4.0, regions.size() * animals.size(), values);
+                for (std::size_t i = 0; i < regions.size(); ++i) {
+                    for (std::size_t j = 0; j < animals.size(); ++j) {
+                        double value{values[i * animals.size() + j]};
+                        if (time == 120 * bucketSize && i == 2 && j == 1) {
+                            value += 40.0;
+                        }
+                        dataRows["time"] = core::CStringUtils::typeToString(time);
+                        dataRows["region"] = regions[i];
+                        dataRows["animal"] = animals[j];
+                        dataRows["value"] = core::CStringUtils::typeToString(value);
+                        BOOST_TEST_REQUIRE(job.handleRecord(dataRows));
+                    }
+                }
+                if (time % (10 * bucketSize) == bucketSize / 2) {
+                    BOOST_TEST_REQUIRE(job.handleRecord(interim));
+                }
+            }
+            job.finalise();
+        }
+
+        core::stopDefaultAsyncExecutor();
+
+        // Remove the fields which depend on the wall clock and the peak memory
+        // usage, which depends on the order the workers account for memory.
+        std::regex timing{"\"(processing_time_ms|log_time|peak_model_bytes)\":[0-9]+"};
+        return std::regex_replace(outputStrm.str(), timing, "");
+    };
+
+    std::string sequential{runJob(1)};
+    std::string concurrent{runJob(4)};
+
+    BOOST_TEST_REQUIRE(sequential.find("record_score") != std::string::npos);
+    BOOST_REQUIRE_EQUAL(sequential, concurrent);
+}
+
 BOOST_AUTO_TEST_CASE(testRestoreFailsWithEmptyStream) {
     model::CLimits limits;
     api::CAnomalyJobConfig jobConfig =
@@ -11,6 +11,7 @@
 
 #include <core/CJsonOutputStreamWrapper.h>
 #include <core/CLogger.h>
+#include <core/Concurrency.h>
 #include <core/Constants.h>
 
 #include <model/CAnomalyDetectorModelConfig.h>
@@ -21,12 +22,16 @@
 #include "CTestAnomalyJob.h"
 
 #include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
 #include <boost/test/unit_test.hpp>
 
 #include <cmath>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(CForecastRunnerTest)
 
@@ -262,6 +267,90 @@ BOOST_AUTO_TEST_CASE(testInsufficientData) {
                         forecastStats["forecast_expiry_timestamp"].GetInt64());
 }
 
+BOOST_AUTO_TEST_CASE(testConcurrentForecasts) {
+
+    // Check that running several forecasts at once, each of which forecasts
+    // its models in parallel, gives identical results to running them one
+    // after another.
+
+    using TStrVec = std::vector<std::string>;
+    using TStrStrVecMap = std::map<std::string, TStrVec>;
+
+    std::size_t numberForecasts{ml::api::CForecastRunner::MAX_FORECAST_JOBS_IN_QUEUE};
+
+    auto runForecasts = [numberForecasts](std::size_t numberThreads) {
+        if (numberThreads > 1) {
+            ml::core::startDefaultAsyncExecutor(numberThreads);
+        }
+
+        std::stringstream outputStrm;
+        {
+            ml::core::CJsonOutputStreamWrapper streamWrapper(outputStrm);
+            ml::model::CLimits limits;
+            ml::api::CAnomalyJobConfig jobConfig =
+                CTestAnomalyJob::makeSimpleJobConfig("mean", "value", "animal", "", "");
+
+            ml::model::CAnomalyDetectorModelConfig modelConfig =
+                ml::model::CAnomalyDetectorModelConfig::defaultConfig(BUCKET_LENGTH);
+
+            CTestAnomalyJob job("job", limits, jobConfig, modelConfig, streamWrapper);
+
+            CTestAnomalyJob::TStrStrUMap dataRows;
+            for (std::size_t bucket = 0; bucket < 500; ++bucket) {
+                ml::core_t::TTime time{START_TIME + static_cast<ml::core_t::TTime>(bucket) *
+                                                        BUCKET_LENGTH};
+                for (std::size_t i = 0; i < 10; ++i) {
+                    double x{static_cast<double>(bucket + 3 * i)};
+                    dataRows["time"] = ml::core::CStringUtils::typeToString(time);
+                    dataRows["animal"] = "a" + std::to_string(i);
+                    dataRows["value"] = ml::core::CStringUtils::typeToString(
+                        10.0 * static_cast<double>(i + 1) + 5.0 * std::sin(x / 4.0));
+                    BOOST_TEST_REQUIRE(job.handleRecord(dataRows));
+                }
+            }
+
+            dataRows.clear();
+            for (std::size_t i = 0; i < numberForecasts; ++i) {
+                dataRows["."] = "p{\"duration\":" + std::to_string((10 + i) * BUCKET_LENGTH) +
+                                ",\"forecast_id\": \"" + std::to_string(i) + "\"" +
+                                ",\"create_time\": \"1511370819\" }";
+                BOOST_TEST_REQUIRE(job.handleRecord(dataRows));
+            }
+        }
+
+        ml::core::stopDefaultAsyncExecutor();
+
+        rapidjson::Document doc;
+        doc.Parse<rapidjson::kParseDefaultFlags>(outputStrm.str());
+        BOOST_TEST_REQUIRE(!doc.HasParseError());
+
+        TStrStrVecMap forecasts;
+        for (const auto& m : doc.GetArray()) {
+            if (m.HasMember("model_forecast")) {
+                const rapidjson::Value& forecast{m["model_forecast"]};
+                rapidjson::StringBuffer buffer;
+                rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+                forecast.Accept(writer);
+                forecasts[forecast["forecast_id"].GetString()].emplace_back(
+                    buffer.GetString());
+            }
+        }
+        return forecasts;
+    };
+
+    TStrStrVecMap sequential{runForecasts(1)};
+    TStrStrVecMap concurrent{runForecasts(4)};
+
+    BOOST_REQUIRE_EQUAL(numberForecasts, sequential.size());
+    for (const auto& forecast : sequential) {
+        LOG_DEBUG(<< "forecast " << forecast.first << " records = "
+                  << forecast.second.size());
+        BOOST_REQUIRE_EQUAL(10 * (10 + std::stoi(forecast.first)),
+                            forecast.second.size());
+    }
+    BOOST_TEST_REQUIRE(sequential == concurrent);
+}
+
 BOOST_AUTO_TEST_CASE(testValidateDefaultExpiry) {
     ml::api::CForecastRunner::SForecast forecastJob;
 
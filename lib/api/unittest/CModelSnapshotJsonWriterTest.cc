@@ -63,8 +63,8 @@ BOOST_AUTO_TEST_CASE(testWrite) {
             modelSizeStats,
             "some normalizer state",
             core_t::TTime(1521046409), // last record time
-            core_t::TTime(1521040000)  // last result time
-        };
+            core_t::TTime(1521040000), // last result time
+            "previous_snapshot_id"};
 
         core::CJsonOutputStreamWrapper wrappedOutStream(sstream);
         CModelSnapshotJsonWriter writer("job", wrappedOutStream);
@@ -90,6 +90,8 @@ BOOST_AUTO_TEST_CASE(testWrite) {
     BOOST_REQUIRE_EQUAL("test_snapshot_id", snapshot["snapshot_id"].GetString());
     BOOST_TEST_REQUIRE(snapshot.HasMember("snapshot_doc_count"));
     BOOST_REQUIRE_EQUAL(15, snapshot["snapshot_doc_count"].GetUint64());
+    BOOST_TEST_REQUIRE(snapshot.HasMember("previous_snapshot_id"));
+    BOOST_REQUIRE_EQUAL("previous_snapshot_id", snapshot["previous_snapshot_id"].GetString());
     BOOST_TEST_REQUIRE(snapshot.HasMember("timestamp"));
     BOOST_REQUIRE_EQUAL(1521046309000, snapshot["timestamp"].GetInt64());
     BOOST_TEST_REQUIRE(snapshot.HasMember("description"));
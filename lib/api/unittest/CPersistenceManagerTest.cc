@@ -24,14 +24,18 @@
 #include <api/CNdJsonInputParser.h>
 #include <api/CPersistenceManager.h>
 #include <api/CSingleStreamDataAdder.h>
+#include <api/CSingleStreamSearcher.h>
+#include <api/CStateRestoreStreamFilter.h>
 
 #include "CTestAnomalyJob.h"
 #include "CTestFieldDataCategorizer.h"
 
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -571,4 +575,145 @@ BOOST_FIXTURE_TEST_CASE(testCategorizationOnlyPersist, CTestFixture) {
     BOOST_REQUIRE_EQUAL(backgroundState, foregroundState);
 }
 
+BOOST_FIXTURE_TEST_CASE(testDeltaSnapshots, CTestFixture) {
+    // Check that a delta snapshot only contains the models which changed since
+    // the previous snapshot and that restoring it followed by the snapshot it
+    // is based on recovers the full state.
+
+    static const ml::core_t::TTime BUCKET_SIZE{3600};
+    static const std::string JOB_ID{"job"};
+
+    std::ofstream outputStrm{ml::core::COsFileFuncs::NULL_FILENAME};
+    BOOST_TEST_REQUIRE(outputStrm.is_open());
+
+    ml::model::CLimits limits;
+    ml::api::CAnomalyJobConfig jobConfig{
+        CTestAnomalyJob::makeSimpleJobConfig("mean", "value", "host", "", "")};
+    ml::model::CAnomalyDetectorModelConfig modelConfig{
+        ml::model::CAnomalyDetectorModelConfig::defaultConfig(BUCKET_SIZE)};
+
+    std::ostringstream* backgroundStream{nullptr};
+    ml::api::CSingleStreamDataAdder::TOStreamP backgroundStreamPtr{
+        backgroundStream = new std::ostringstream()};
+    ml::api::CSingleStreamDataAdder backgroundDataAdder{backgroundStreamPtr};
+
+    // The 30000 second persist interval is set large enough that the timer will
+    // not trigger during the test - we bypass the timer in this test and kick
+    // off the background persistence chain explicitly
+    ml::api::CPersistenceManager persistenceManager{30000, false, backgroundDataAdder};
+
+    std::string snapshotId;
+    std::string previousSnapshotId;
+    auto reportPersistComplete =
+        [&](const ml::api::CModelSnapshotJsonWriter::SModelSnapshotReport& report) {
+            snapshotId = report.s_SnapshotId;
+            previousSnapshotId = report.s_PreviousSnapshotId;
+        };
+
+    auto addRecords = [](CTestAnomalyJob& job, ml::core_t::TTime start,
+                         ml::core_t::TTime end, std::size_t numberHosts) {
+        CTestAnomalyJob::TStrStrUMap dataRows;
+        for (ml::core_t::TTime time = start; time < end; time += BUCKET_SIZE) {
+            for (std::size_t i = 0; i < numberHosts; ++i) {
+                dataRows["time"] = ml::core::CStringUtils::typeToString(time + 60 * i);
+                dataRows["value"] = ml::core::CStringUtils::typeToString(10 * (i + 1));
+                dataRows["host"] = "h" + ml::core::CStringUtils::typeToString(i);
+                BOOST_TEST_REQUIRE(job.handleRecord(dataRows));
+            }
+        }
+    };
+
+    ml::core_t::TTime startTime{1600000000};
+
+    std::string baseSnapshotId;
+    std::string baseState;
+    std::string deltaState;
+    std::string fullSnapshotId;
+    std::string fullState;
+    {
+        ml::core::CJsonOutputStreamWrapper wrappedOutputStream{outputStrm};
+
+        CTestAnomalyJob job{JOB_ID, limits, jobConfig, modelConfig, wrappedOutputStream,
+                            reportPersistComplete, &persistenceManager};
+        job.maxDeltaSnapshots(2);
+        ml::api::CDataProcessor& processor{job};
+
+        addRecords(job, startTime, startTime + 48 * BUCKET_SIZE, 20);
+
+        // Only a few hosts have data after the first snapshot. Note that the
+        // last bucket with data for every host is sampled once the next bucket
+        // starts, so this must happen before the first snapshot.
+        addRecords(job, startTime + 48 * BUCKET_SIZE, startTime + 49 * BUCKET_SIZE, 2);
+
+        BOOST_TEST_REQUIRE(processor.periodicPersistStateInBackground());
+        BOOST_TEST_REQUIRE(persistenceManager.startPersistInBackground());
+        BOOST_TEST_REQUIRE(persistenceManager.waitForIdle());
+        BOOST_TEST_REQUIRE(previousSnapshotId.empty());
+        baseSnapshotId = snapshotId;
+        baseState = backgroundStream->str();
+
+        addRecords(job, startTime + 49 * BUCKET_SIZE, startTime + 72 * BUCKET_SIZE, 2);
+
+        BOOST_TEST_REQUIRE(processor.periodicPersistStateInBackground());
+        BOOST_TEST_REQUIRE(persistenceManager.startPersistInBackground());
+        BOOST_TEST_REQUIRE(persistenceManager.waitForIdle());
+        BOOST_REQUIRE_EQUAL(baseSnapshotId, previousSnapshotId);
+        deltaState = backgroundStream->str().substr(baseState.length());
+
+        std::ostringstream* fullStream{nullptr};
+        ml::api::CSingleStreamDataAdder::TOStreamP fullStreamPtr{
+            fullStream = new std::ostringstream()};
+        ml::api::CSingleStreamDataAdder fullDataAdder{fullStreamPtr};
+        BOOST_TEST_REQUIRE(job.persistStateInForeground(fullDataAdder, "Foreground persist at "));
+        fullSnapshotId = snapshotId;
+        fullState = fullStream->str();
+    }
+
+    LOG_DEBUG(<< "base size = " << baseState.size() << ", delta size = "
+              << deltaState.size() << ", full size = " << fullState.size());
+    BOOST_TEST_REQUIRE(2 * deltaState.size() < fullState.size());
+
+    auto restore = [&](const std::string& state, std::string& persistedState) {
+        ml::core::CJsonOutputStreamWrapper wrappedOutputStream{outputStrm};
+
+        CTestAnomalyJob job{JOB_ID, limits, jobConfig, modelConfig,
+                            wrappedOutputStream, reportPersistComplete};
+
+        ml::core_t::TTime completeToTime{0};
+        auto strm = std::make_shared<boost::iostreams::filtering_istream>();
+        strm->push(ml::api::CStateRestoreStreamFilter());
+        std::istringstream inputStream{state};
+        strm->push(inputStream);
+        ml::api::CSingleStreamSearcher retriever{strm};
+        if (job.restoreState(retriever, completeToTime) == false) {
+            return false;
+        }
+        BOOST_TEST_REQUIRE(completeToTime > 0);
+
+        std::ostringstream* restoredStream{nullptr};
+        ml::api::CSingleStreamDataAdder::TOStreamP restoredStreamPtr{
+            restoredStream = new std::ostringstream()};
+        ml::api::CSingleStreamDataAdder restoredDataAdder{restoredStreamPtr};
+        BOOST_TEST_REQUIRE(job.persistStateInForeground(restoredDataAdder,
+                                                        "Foreground persist at "));
+        persistedState = restoredStream->str();
+        return true;
+    };
+
+    // The delta must be restored with the snapshot it's based on.
+    std::string restoredState;
+    BOOST_REQUIRE_EQUAL(false, restore(deltaState, restoredState));
+    BOOST_REQUIRE_EQUAL(true, restore(deltaState + baseState, restoredState));
+
+    BOOST_REQUIRE_EQUAL(1, ml::core::CStringUtils::replaceFirst(fullSnapshotId, "snap", fullState));
+    BOOST_REQUIRE_EQUAL(1, ml::core::CStringUtils::replaceFirst(snapshotId, "snap", restoredState));
+
+    // Replace the zero byte separators to avoid '\0's in the output if the test
+    // fails
+    std::replace(fullState.begin(), fullState.end(), '\0', ',');
+    std::replace(restoredState.begin(), restoredState.end(), '\0', ',');
+
+    BOOST_REQUIRE_EQUAL(fullState, restoredState);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,158 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CLogger.h>
+
+#include <api/CCsvInputParser.h>
+#include <api/CPipelinedInputParser.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CPipelinedInputParserTest)
+
+using namespace ml;
+
+namespace {
+using TStrVec = std::vector<std::string>;
+using TStrStrMap = std::map<std::string, std::string>;
+using TStrStrMapVec = std::vector<TStrStrMap>;
+
+std::string makeInput(std::size_t numberRecords) {
+    // Include control messages to check ordering is preserved.
+    std::ostringstream result;
+    result << "time,person,value,.\n";
+    for (std::size_t i = 0; i < numberRecords; ++i) {
+        if (i % 97 == 0) {
+            result << ",,,f" << i << '\n';
+        }
+        result << 1000 + i << ",p" << i % 13 << ',' << 0.5 * static_cast<double>(i) << ",\n";
+    }
+    return result.str();
+}
+
+TStrStrMapVec readMaps(api::CInputParser& parser) {
+    TStrStrMapVec result;
+    BOOST_TEST_REQUIRE(parser.readStreamIntoMaps([&](const api::CInputParser::TStrStrUMap& fields) {
+        result.emplace_back(fields.begin(), fields.end());
+        return true;
+    }));
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testReadStreamIntoMaps) {
+
+    // Check we get exactly the same records, in the same order, as reading
+    // directly. There are many more records than buffers so they must be
+    // recycled.
+
+    std::string input{makeInput(5000)};
+
+    std::istringstream directStrm{input};
+    api::CCsvInputParser directParser{directStrm};
+    TStrStrMapVec expected{readMaps(directParser)};
+
+    std::istringstream pipelinedStrm{input};
+    api::CCsvInputParser wrappedParser{pipelinedStrm};
+    api::CPipelinedInputParser pipelinedParser{wrappedParser};
+    TStrStrMapVec actual{readMaps(pipelinedParser)};
+
+    BOOST_REQUIRE_EQUAL(5000 + 52, expected.size());
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        BOOST_TEST_REQUIRE((expected[i] == actual[i]));
+    }
+    BOOST_REQUIRE_EQUAL(std::as_const(directParser).fieldNames().size(),
+                        std::as_const(pipelinedParser).fieldNames().size());
+}
+
+BOOST_AUTO_TEST_CASE(testReadStreamIntoVecs) {
+
+    std::string input{makeInput(2000)};
+
+    std::vector<std::pair<TStrVec, TStrVec>> expected;
+    std::istringstream directStrm{input};
+    api::CCsvInputParser directParser{directStrm};
+    BOOST_TEST_REQUIRE(directParser.readStreamIntoVecs(
+        [&](const TStrVec& fieldNames, const TStrVec& fieldValues) {
+            expected.emplace_back(fieldNames, fieldValues);
+            return true;
+        }));
+
+    std::vector<std::pair<TStrVec, TStrVec>> actual;
+    std::istringstream pipelinedStrm{input};
+    api::CCsvInputParser wrappedParser{pipelinedStrm};
+    api::CPipelinedInputParser pipelinedParser{wrappedParser};
+    BOOST_TEST_REQUIRE(pipelinedParser.readStreamIntoVecs(
+        [&](const TStrVec& fieldNames, const TStrVec& fieldValues) {
+            actual.emplace_back(fieldNames, fieldValues);
+            return true;
+        }));
+
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        BOOST_TEST_REQUIRE((expected[i] == actual[i]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testReaderStops) {
+
+    // Check that if the reader function stops reading part way through we
+    // don't handle any further records and don't deadlock.
+
+    std::string input{makeInput(5000)};
+
+    std::istringstream strm{input};
+    api::CCsvInputParser wrappedParser{strm};
+    api::CPipelinedInputParser parser{wrappedParser};
+
+    std::size_t count{0};
+    BOOST_REQUIRE_EQUAL(false, parser.readStreamIntoMaps([&](const api::CInputParser::TStrStrUMap&) {
+        return ++count < 100;
+    }));
+    BOOST_REQUIRE_EQUAL(100, count);
+}
+
+BOOST_AUTO_TEST_CASE(testMutableFields) {
+
+    // Check mutable fields are registered against the record being handled.
+
+    std::string input{makeInput(2000)};
+
+    std::istringstream strm{input};
+    api::CCsvInputParser wrappedParser{{"mlcategory"}, strm};
+    api::CPipelinedInputParser parser{wrappedParser};
+
+    std::string* category{nullptr};
+    std::size_t count{0};
+    BOOST_TEST_REQUIRE(parser.readStreamIntoMaps(
+        [&](const api::CInputParser::TStrStrUMap& fields) {
+            auto iter = fields.find("mlcategory");
+            BOOST_TEST_REQUIRE((iter != fields.end()));
+            BOOST_TEST_REQUIRE(&iter->second == category);
+            BOOST_TEST_REQUIRE(iter->second.empty());
+            *category = std::to_string(count++);
+            return true;
+        },
+        [&](const std::string& fieldName, std::string& fieldValue) {
+            BOOST_REQUIRE_EQUAL("mlcategory", fieldName);
+            category = &fieldValue;
+        }));
+    BOOST_REQUIRE_EQUAL(2000 + 21, count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
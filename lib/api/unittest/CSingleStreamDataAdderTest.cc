@@ -12,6 +12,7 @@
 #include <core/CJsonOutputStreamWrapper.h>
 #include <core/COsFileFuncs.h>
 #include <core/CStringUtils.h>
+#include <core/Concurrency.h>
 #include <core/CoreTypes.h>
 
 #include <maths/common/CModelWeight.h>
@@ -49,10 +50,11 @@ void reportPersistComplete(ml::api::CModelSnapshotJsonWriter::SModelSnapshotRepo
     numDocsOut = modelSnapshotReport.s_NumDocs;
 }
 
-void detectorPersistHelper(const std::string& configFileName,
+void detectorPersistHelper(bool persistInBinaryFormat,
+                           const std::string& configFileName,
                            const std::string& inputFilename,
                            int latencyBuckets,
-                           const std::string& timeFormat = std::string()) {
+                           const std::string& timeFormat) {
     // Start by creating a detector with non-trivial state
     static const ml::core_t::TTime BUCKET_SIZE(3600);
     static const std::string JOB_ID("job");
@@ -84,6 +86,7 @@ void detectorPersistHelper(const std::string& configFileName,
             std::bind(&reportPersistComplete, std::placeholders::_1,
                       std::ref(origSnapshotId), std::ref(numOrigDocs)),
             nullptr, -1, "time", timeFormat);
+        origJob.persistInBinaryFormat(persistInBinaryFormat);
 
         // The categorizer knows how to assign categories to records
         CTestFieldDataCategorizer categorizer(JOB_ID, jobConfig.analysisConfig(),
@@ -133,6 +136,7 @@ void detectorPersistHelper(const std::string& configFileName,
             JOB_ID, limits, jobConfig, modelConfig, wrappedOutputStream,
             std::bind(&reportPersistComplete, std::placeholders::_1,
                       std::ref(restoredSnapshotId), std::ref(numRestoredDocs)));
+        restoredJob.persistInBinaryFormat(persistInBinaryFormat);
 
         // The categorizer knows how to assign categories to records
         CTestFieldDataCategorizer restoredCategorizer(
@@ -190,6 +194,17 @@ void detectorPersistHelper(const std::string& configFileName,
 
     BOOST_REQUIRE_EQUAL(origPersistedState, newPersistedState);
 }
+
+void detectorPersistHelper(const std::string& configFileName,
+                           const std::string& inputFilename,
+                           int latencyBuckets,
+                           const std::string& timeFormat = std::string()) {
+    for (bool persistInBinaryFormat : {false, true}) {
+        LOG_DEBUG(<< "Persist in binary format " << persistInBinaryFormat);
+        detectorPersistHelper(persistInBinaryFormat, configFileName,
+                              inputFilename, latencyBuckets, timeFormat);
+    }
+}
 }
 
 BOOST_AUTO_TEST_CASE(testDetectorPersistBy) {
@@ -207,6 +222,14 @@ BOOST_AUTO_TEST_CASE(testDetectorPersistPartition) {
                           "testfiles/big_ascending.txt", 0, "%d/%b/%Y:%T %z");
 }
 
+BOOST_AUTO_TEST_CASE(testDetectorPersistPartitionConcurrently) {
+    // Check the state is unchanged if the detectors are restored concurrently.
+    ml::core::startDefaultAsyncExecutor(3);
+    detectorPersistHelper("testfiles/new_mlfields_partition.json",
+                          "testfiles/big_ascending.txt", 0, "%d/%b/%Y:%T %z");
+    ml::core::stopDefaultAsyncExecutor();
+}
+
 BOOST_AUTO_TEST_CASE(testDetectorPersistDc) {
     detectorPersistHelper("testfiles/new_persist_dc.json",
                           "testfiles/files_users_programs.csv", 5);
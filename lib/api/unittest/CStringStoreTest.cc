@@ -97,31 +97,16 @@ core_t::TTime playData(core_t::TTime start,
     return t;
 }
 
-//! Helper class to look up a string in core::CStoredStringPtr set
-struct SLookup {
-    std::size_t operator()(const std::string& key) const {
-        boost::hash<std::string> hasher;
-        return hasher(key);
-    }
-
-    bool operator()(const std::string& lhs, const core::CStoredStringPtr& rhs) const {
-        return lhs == *rhs;
-    }
-};
 } // namespace
 
 class CTestFixture {
 protected:
     bool nameExists(const std::string& string) {
-        model::CStringStore::TStoredStringPtrUSet names =
-            model::CStringStore::names().m_Strings;
-        return names.find(string, SLookup(), SLookup()) != names.end();
+        return model::CStringStore::names().containsTestOnly(string);
     }
 
     bool influencerExists(const std::string& string) {
-        model::CStringStore::TStoredStringPtrUSet names =
-            model::CStringStore::influencers().m_Strings;
-        return names.find(string, SLookup(), SLookup()) != names.end();
+        return model::CStringStore::influencers().containsTestOnly(string);
     }
 };
 
@@ -147,8 +132,8 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         LOG_TRACE(<< "Setting up job");
 
@@ -163,7 +148,7 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         BOOST_REQUIRE_EQUAL(0, countBuckets("records", outputStrm.str() + "]"));
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // "", "count", "max", "notes", "composer", "instrument", "Elgar", "Holst", "Delius", "flute", "tuba"
         BOOST_TEST_REQUIRE(this->nameExists("count"));
@@ -191,8 +176,8 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         std::ostringstream outputStrm;
         ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
@@ -204,7 +189,7 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         adder.clear();
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // "", "count", "notes", "composer", "instrument", "Elgar", "Holst", "Delius", "flute", "tuba"
         BOOST_TEST_REQUIRE(this->nameExists("count"));
@@ -230,8 +215,8 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         std::ostringstream outputStrm;
         ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
@@ -243,7 +228,7 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         adder.clear();
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // While the 3 composers from the second partition should have been culled in the prune,
         // their names still exist in the first partition, so will still be in the string store.
@@ -271,8 +256,8 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         std::ostringstream outputStrm;
         ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
@@ -284,7 +269,7 @@ BOOST_FIXTURE_TEST_CASE(testPersonStringPruning, CTestFixture) {
         adder.clear();
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // One composer should have been culled!
         BOOST_TEST_REQUIRE(this->nameExists("count"));
@@ -321,8 +306,8 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         LOG_TRACE(<< "Setting up job");
         std::ostringstream outputStrm;
@@ -335,10 +320,10 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         BOOST_REQUIRE_EQUAL(0, countBuckets("records", outputStrm.str() + "]"));
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // "", "count", "distinct_count", "notes", "composer", "instrument", "Elgar", "Holst", "Delius", "flute", "tuba"
-        LOG_DEBUG(<< model::CStringStore::names().m_Strings);
+        LOG_DEBUG(<< "names = " << model::CStringStore::names().size());
         BOOST_TEST_REQUIRE(this->nameExists("count"));
         BOOST_TEST_REQUIRE(this->nameExists("distinct_count"));
         BOOST_TEST_REQUIRE(this->nameExists("notes"));
@@ -362,8 +347,8 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         std::ostringstream outputStrm;
         ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
@@ -376,7 +361,7 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         adder.clear();
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // "", "count", "distinct_count", "notes", "composer", "instrument", "Elgar", "Holst", "Delius", "flute", "tuba"
         BOOST_TEST_REQUIRE(this->nameExists("count"));
@@ -401,8 +386,8 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         std::ostringstream outputStrm;
         ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
@@ -415,7 +400,7 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         adder.clear();
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // While the 3 composers from the second partition should have been culled in the prune,
         // their names still exist in the first partition, so will still be in the string store.
@@ -443,8 +428,8 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         std::ostringstream outputStrm;
         ml::core::CJsonOutputStreamWrapper wrappedOutputStream(outputStrm);
@@ -457,7 +442,7 @@ BOOST_FIXTURE_TEST_CASE(testAttributeStringPruning, CTestFixture) {
         adder.clear();
 
         // No influencers in this configuration
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
 
         // One composer should have been culled!
         BOOST_TEST_REQUIRE(this->nameExists("count"));
@@ -493,8 +478,8 @@ BOOST_FIXTURE_TEST_CASE(testInfluencerStringPruning, CTestFixture) {
         model::CStringStore::influencers().clearEverythingTestOnly();
         model::CStringStore::names().clearEverythingTestOnly();
 
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::influencers().size());
+        BOOST_REQUIRE_EQUAL(0, model::CStringStore::names().size());
 
         LOG_TRACE(<< "Setting up job");
         std::ostringstream outputStrm;
@@ -507,8 +492,8 @@ BOOST_FIXTURE_TEST_CASE(testInfluencerStringPruning, CTestFixture) {
         LOG_DEBUG(<< "Running 20 buckets");
         time = playData(time, BUCKET_SPAN, 20, 7, 5, 99, job);
 
-        LOG_TRACE(<< model::CStringStore::names().m_Strings);
-        LOG_TRACE(<< model::CStringStore::influencers().m_Strings);
+        LOG_TRACE(<< "names = " << model::CStringStore::names().size());
+        LOG_TRACE(<< "influencers = " << model::CStringStore::influencers().size());
 
         BOOST_TEST_REQUIRE(this->influencerExists("Delius"));
         BOOST_TEST_REQUIRE(this->influencerExists("Walton"));
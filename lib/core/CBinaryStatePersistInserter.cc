@@ -0,0 +1,124 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <core/CBinaryStatePersistInserter.h>
+
+#include <cstring>
+#include <ostream>
+
+namespace ml {
+namespace core {
+namespace {
+const std::size_t BUFFER_SIZE{1 << 16};
+}
+
+const std::string CBinaryStatePersistInserter::MARKER{"\xb1ml"};
+
+CBinaryStatePersistInserter::CBinaryStatePersistInserter(std::ostream& outputStream)
+    : m_OutputStream{outputStream} {
+    m_Buffer.reserve(BUFFER_SIZE + 256);
+    m_Buffer.append(MARKER);
+    m_Buffer.push_back(static_cast<char>(VERSION));
+}
+
+CBinaryStatePersistInserter::~CBinaryStatePersistInserter() {
+    m_Buffer.push_back(static_cast<char>(E_EndLevel));
+    this->flush();
+}
+
+void CBinaryStatePersistInserter::insertValue(const std::string& name,
+                                              const std::string& value) {
+    this->writeToken(E_String, name);
+    this->writeVarint(value.size());
+    m_Buffer.append(value);
+    this->writeIfFull();
+}
+
+void CBinaryStatePersistInserter::insertValue(const std::string& name,
+                                              double value,
+                                              CIEEE754::EPrecision precision) {
+    this->insertDouble(name, precision == CIEEE754::E_DoublePrecision
+                                 ? value
+                                 : CIEEE754::round(value, precision));
+}
+
+void CBinaryStatePersistInserter::flush() {
+    m_OutputStream.write(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+    m_OutputStream.flush();
+    m_Buffer.clear();
+}
+
+void CBinaryStatePersistInserter::newLevel(const std::string& name) {
+    this->writeToken(E_StartLevel, name);
+    this->writeIfFull();
+}
+
+void CBinaryStatePersistInserter::endLevel() {
+    m_Buffer.push_back(static_cast<char>(E_EndLevel));
+}
+
+void CBinaryStatePersistInserter::insertDouble(const std::string& name, double value) {
+    auto single = static_cast<float>(value);
+    if (static_cast<double>(single) == value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &single, sizeof(bits));
+        this->writeToken(E_Float, name);
+        this->writeLittleEndian(bits, sizeof(bits));
+    } else {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        this->writeToken(E_Double, name);
+        this->writeLittleEndian(bits, sizeof(bits));
+    }
+    this->writeIfFull();
+}
+
+void CBinaryStatePersistInserter::insertSigned(const std::string& name, std::int64_t value) {
+    // Zig-zag encode so small negative values are also short.
+    this->writeToken(E_Signed, name);
+    this->writeVarint((static_cast<std::uint64_t>(value) << 1) ^
+                      static_cast<std::uint64_t>(value >> 63));
+    this->writeIfFull();
+}
+
+void CBinaryStatePersistInserter::insertUnsigned(const std::string& name, std::uint64_t value) {
+    this->writeToken(E_Unsigned, name);
+    this->writeVarint(value);
+    this->writeIfFull();
+}
+
+void CBinaryStatePersistInserter::writeToken(EToken token, const std::string& name) {
+    m_Buffer.push_back(static_cast<char>(token));
+    this->writeVarint(name.size());
+    m_Buffer.append(name);
+}
+
+void CBinaryStatePersistInserter::writeVarint(std::uint64_t value) {
+    while (value >= 0x80) {
+        m_Buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    m_Buffer.push_back(static_cast<char>(value));
+}
+
+void CBinaryStatePersistInserter::writeLittleEndian(std::uint64_t bits, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i, bits >>= 8) {
+        m_Buffer.push_back(static_cast<char>(bits & 0xff));
+    }
+}
+
+void CBinaryStatePersistInserter::writeIfFull() {
+    if (m_Buffer.size() >= BUFFER_SIZE) {
+        m_OutputStream.write(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+        m_Buffer.clear();
+    }
+}
+}
+}
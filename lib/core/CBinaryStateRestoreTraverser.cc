@@ -0,0 +1,303 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+#include <core/CBinaryStateRestoreTraverser.h>
+
+#include <core/CJsonStateRestoreTraverser.h>
+#include <core/CLogger.h>
+#include <core/CStringUtils.h>
+
+#include <cstring>
+#include <istream>
+
+namespace ml {
+namespace core {
+namespace {
+const std::string EMPTY_STRING;
+const std::size_t BUFFER_SIZE{1 << 16};
+}
+
+CBinaryStateRestoreTraverser::CBinaryStateRestoreTraverser(std::istream& inputStream)
+    : m_InputStream{inputStream}, m_Buffer(BUFFER_SIZE) {
+}
+
+bool CBinaryStateRestoreTraverser::isBinaryFormat(std::istream& inputStream) {
+    return inputStream.peek() ==
+           std::istream::traits_type::to_int_type(CBinaryStatePersistInserter::MARKER[0]);
+}
+
+CBinaryStateRestoreTraverser::TStateRestoreTraverserUPtr
+CBinaryStateRestoreTraverser::makeTraverser(std::istream& inputStream) {
+    if (isBinaryFormat(inputStream)) {
+        return std::make_unique<CBinaryStateRestoreTraverser>(inputStream);
+    }
+    return std::make_unique<CJsonStateRestoreTraverser>(inputStream);
+}
+
+bool CBinaryStateRestoreTraverser::next() {
+    if (m_Started == false && this->start() == false) {
+        return false;
+    }
+    if (this->haveBadState() || m_Current.s_Type == CBinaryStatePersistInserter::E_EndLevel) {
+        return false;
+    }
+    if (m_Current.s_Type == CBinaryStatePersistInserter::E_StartLevel &&
+        this->skipLevel() == false) {
+        return false;
+    }
+    return this->readElement();
+}
+
+bool CBinaryStateRestoreTraverser::hasSubLevel() const {
+    if (m_Started == false && const_cast<CBinaryStateRestoreTraverser*>(this)->start() == false) {
+        return false;
+    }
+    return this->haveBadState() == false &&
+           m_Current.s_Type == CBinaryStatePersistInserter::E_StartLevel;
+}
+
+const std::string& CBinaryStateRestoreTraverser::name() const {
+    if (m_Started == false && const_cast<CBinaryStateRestoreTraverser*>(this)->start() == false) {
+        return EMPTY_STRING;
+    }
+    return this->haveBadState() ? EMPTY_STRING : m_Current.s_Name;
+}
+
+const std::string& CBinaryStateRestoreTraverser::value() const {
+    if (m_Started == false && const_cast<CBinaryStateRestoreTraverser*>(this)->start() == false) {
+        return EMPTY_STRING;
+    }
+    if (this->haveBadState()) {
+        return EMPTY_STRING;
+    }
+    if (m_Current.s_HaveValue == false) {
+        // Numbers are only converted to strings if they're asked for.
+        if (const auto* value = std::get_if<double>(&m_Current.s_Number)) {
+            m_Current.s_Value = CStringUtils::typeToStringPrecise(
+                *value, CIEEE754::E_DoublePrecision);
+        } else if (const auto* value = std::get_if<std::int64_t>(&m_Current.s_Number)) {
+            m_Current.s_Value = CStringUtils::typeToString(*value);
+        } else if (const auto* value = std::get_if<std::uint64_t>(&m_Current.s_Number)) {
+            m_Current.s_Value = CStringUtils::typeToString(*value);
+        }
+        m_Current.s_HaveValue = true;
+    }
+    return m_Current.s_Value;
+}
+
+bool CBinaryStateRestoreTraverser::isEof() const {
+    return m_Position == m_End &&
+           m_InputStream.peek() == std::istream::traits_type::eof();
+}
+
+bool CBinaryStateRestoreTraverser::descend() {
+    if (this->hasSubLevel() == false) {
+        return false;
+    }
+    m_Parents.push_back(std::move(m_Current.s_Name));
+    // If the sub-level is empty the current element is left as the end of
+    // the level so the sub-level traverser finds nothing and then ascends.
+    this->readElement();
+    return this->haveBadState() == false;
+}
+
+bool CBinaryStateRestoreTraverser::ascend() {
+    if (m_Parents.empty()) {
+        LOG_ERROR(<< "Inconsistency - trying to ascend above root");
+        return false;
+    }
+    while (this->next()) {
+    }
+    if (this->haveBadState()) {
+        return false;
+    }
+    // The parent's sub-level has been read so it is now a plain element.
+    m_Current.s_Type = CBinaryStatePersistInserter::E_String;
+    m_Current.s_Name = std::move(m_Parents.back());
+    m_Current.s_Value.clear();
+    m_Current.s_Number = TNumericValue{};
+    m_Current.s_HaveValue = true;
+    m_Parents.pop_back();
+    return true;
+}
+
+CBinaryStateRestoreTraverser::TNumericValue CBinaryStateRestoreTraverser::numericValue() const {
+    return m_Current.s_Number;
+}
+
+bool CBinaryStateRestoreTraverser::start() {
+    m_Started = true;
+    std::string marker;
+    std::uint8_t version;
+    if (this->readBytes(CBinaryStatePersistInserter::MARKER.size(), marker) == false ||
+        marker != CBinaryStatePersistInserter::MARKER || this->readByte(version) == false) {
+        return this->fail("missing marker");
+    }
+    if (version > CBinaryStatePersistInserter::VERSION) {
+        return this->fail("unsupported version " +
+                          CStringUtils::typeToString(static_cast<int>(version)));
+    }
+    this->readElement();
+    return this->haveBadState() == false;
+}
+
+bool CBinaryStateRestoreTraverser::readElement() {
+    std::uint8_t type;
+    if (this->readByte(type) == false) {
+        return this->fail("unexpected end of input");
+    }
+
+    m_Current.s_Type = static_cast<EToken>(type);
+    m_Current.s_Number = TNumericValue{};
+    m_Current.s_HaveValue = true;
+    m_Current.s_Value.clear();
+
+    if (m_Current.s_Type == CBinaryStatePersistInserter::E_EndLevel) {
+        m_Current.s_Name.clear();
+        return false;
+    }
+
+    std::uint64_t length;
+    if (this->readVarint(length) == false || this->readBytes(length, m_Current.s_Name) == false) {
+        return this->fail("bad tag");
+    }
+
+    std::uint64_t bits;
+    switch (m_Current.s_Type) {
+    case CBinaryStatePersistInserter::E_EndLevel:
+    case CBinaryStatePersistInserter::E_StartLevel:
+        break;
+    case CBinaryStatePersistInserter::E_String:
+        if (this->readVarint(length) == false ||
+            this->readBytes(length, m_Current.s_Value) == false) {
+            return this->fail("bad string value for " + m_Current.s_Name);
+        }
+        break;
+    case CBinaryStatePersistInserter::E_Double: {
+        if (this->readLittleEndian(8, bits) == false) {
+            return this->fail("bad double value for " + m_Current.s_Name);
+        }
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        m_Current.s_Number = value;
+        m_Current.s_HaveValue = false;
+        break;
+    }
+    case CBinaryStatePersistInserter::E_Float: {
+        if (this->readLittleEndian(4, bits) == false) {
+            return this->fail("bad float value for " + m_Current.s_Name);
+        }
+        auto bits32 = static_cast<std::uint32_t>(bits);
+        float value;
+        std::memcpy(&value, &bits32, sizeof(value));
+        m_Current.s_Number = static_cast<double>(value);
+        m_Current.s_HaveValue = false;
+        break;
+    }
+    case CBinaryStatePersistInserter::E_Signed:
+        if (this->readVarint(bits) == false) {
+            return this->fail("bad integer value for " + m_Current.s_Name);
+        }
+        m_Current.s_Number = static_cast<std::int64_t>(bits >> 1) ^
+                             -static_cast<std::int64_t>(bits & 1);
+        m_Current.s_HaveValue = false;
+        break;
+    case CBinaryStatePersistInserter::E_Unsigned:
+        if (this->readVarint(bits) == false) {
+            return this->fail("bad integer value for " + m_Current.s_Name);
+        }
+        m_Current.s_Number = bits;
+        m_Current.s_HaveValue = false;
+        break;
+    default:
+        return this->fail("unknown token " + CStringUtils::typeToString(static_cast<int>(type)));
+    }
+    return true;
+}
+
+bool CBinaryStateRestoreTraverser::skipLevel() {
+    std::size_t depth{1};
+    while (depth > 0) {
+        if (this->readElement()) {
+            if (m_Current.s_Type == CBinaryStatePersistInserter::E_StartLevel) {
+                ++depth;
+            }
+        } else if (this->haveBadState()) {
+            return false;
+        } else {
+            --depth;
+        }
+    }
+    return true;
+}
+
+bool CBinaryStateRestoreTraverser::readByte(std::uint8_t& byte) {
+    if (m_Position == m_End && this->fill() == false) {
+        return false;
+    }
+    byte = static_cast<std::uint8_t>(m_Buffer[m_Position++]);
+    return true;
+}
+
+bool CBinaryStateRestoreTraverser::readBytes(std::size_t n, std::string& result) {
+    result.clear();
+    while (n > 0) {
+        if (m_Position == m_End && this->fill() == false) {
+            return false;
+        }
+        std::size_t m{std::min(n, m_End - m_Position)};
+        result.append(&m_Buffer[m_Position], m);
+        m_Position += m;
+        n -= m;
+    }
+    return true;
+}
+
+bool CBinaryStateRestoreTraverser::readVarint(std::uint64_t& result) {
+    result = 0;
+    for (std::size_t shift = 0; shift < 64; shift += 7) {
+        std::uint8_t byte;
+        if (this->readByte(byte) == false) {
+            return false;
+        }
+        result |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CBinaryStateRestoreTraverser::readLittleEndian(std::size_t bytes, std::uint64_t& result) {
+    result = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        std::uint8_t byte;
+        if (this->readByte(byte) == false) {
+            return false;
+        }
+        result |= static_cast<std::uint64_t>(byte) << (8 * i);
+    }
+    return true;
+}
+
+bool CBinaryStateRestoreTraverser::fill() {
+    m_InputStream.read(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+    m_Position = 0;
+    m_End = static_cast<std::size_t>(m_InputStream.gcount());
+    return m_End > 0;
+}
+
+bool CBinaryStateRestoreTraverser::fail(const std::string& reason) {
+    LOG_ERROR(<< "Failed to read binary state: " << reason);
+    this->setBadState();
+    return false;
+}
+}
+}
@@ -22,6 +22,18 @@ void CStatePersistInserter::insertValue(const std::string& name,
     this->insertValue(name, CStringUtils::typeToStringPrecise(value, precision));
 }
 
+void CStatePersistInserter::insertDouble(const std::string& name, double value) {
+    this->insertValue(name, CStringUtils::typeToString(value));
+}
+
+void CStatePersistInserter::insertSigned(const std::string& name, std::int64_t value) {
+    this->insertValue(name, CStringUtils::typeToString(value));
+}
+
+void CStatePersistInserter::insertUnsigned(const std::string& name, std::uint64_t value) {
+    this->insertValue(name, CStringUtils::typeToString(value));
+}
+
 bool operator==(const std::string& lhs, const CPersistenceTag& rhs) {
     return lhs == rhs.m_ShortTag || lhs == rhs.m_LongTag;
 }
@@ -0,0 +1,151 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CIEEE754.h>
+#include <core/CJsonStatePersistInserter.h>
+#include <core/CLogger.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(CBinaryStatePersistInserterTest)
+
+using namespace ml;
+
+namespace {
+using TInserter = core::CBinaryStatePersistInserter;
+
+std::string header() {
+    return TInserter::MARKER + static_cast<char>(TInserter::VERSION);
+}
+
+std::string token(TInserter::EToken type, const std::string& name) {
+    return std::string(1, static_cast<char>(type)) +
+           static_cast<char>(name.size()) + name;
+}
+
+void insert2ndLevel(core::CStatePersistInserter& inserter) {
+    inserter.insertValue("level2A", 3.14, core::CIEEE754::E_SinglePrecision);
+    inserter.insertValue("level2B", 'z');
+}
+}
+
+BOOST_AUTO_TEST_CASE(testPersist) {
+
+    std::ostringstream strm;
+    {
+        TInserter inserter(strm);
+        inserter.insertValue("level1A", "a");
+        inserter.insertValue("level1B", 25);
+        inserter.insertLevel("level1C", &insert2ndLevel);
+    }
+
+    float level2A{static_cast<float>(
+        core::CIEEE754::round(3.14, core::CIEEE754::E_SinglePrecision))};
+    std::string level2ABytes(4, '\0');
+    std::uint32_t bits;
+    std::memcpy(&bits, &level2A, sizeof(bits));
+    for (std::size_t i = 0; i < 4; ++i, bits >>= 8) {
+        level2ABytes[i] = static_cast<char>(bits & 0xff);
+    }
+
+    std::string expected{header() + token(TInserter::E_String, "level1A") + '\x01' + 'a' +
+                         token(TInserter::E_Signed, "level1B") + '\x32' +
+                         token(TInserter::E_StartLevel, "level1C") +
+                         token(TInserter::E_Float, "level2A") + level2ABytes +
+                         token(TInserter::E_String, "level2B") + '\x01' + 'z' +
+                         static_cast<char>(TInserter::E_EndLevel) +
+                         static_cast<char>(TInserter::E_EndLevel)};
+
+    BOOST_REQUIRE_EQUAL(expected, strm.str());
+}
+
+BOOST_AUTO_TEST_CASE(testNumericEncoding) {
+
+    // Check the number of bytes used for different numeric values.
+
+    auto bytes = [](const auto& insert) {
+        std::ostringstream strm;
+        {
+            TInserter inserter(strm);
+            insert(inserter);
+        }
+        // Remove the header, token type, one character tag and root end.
+        return strm.str().size() - header().size() - 4;
+    };
+
+    BOOST_REQUIRE_EQUAL(1, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", std::size_t{127});
+                        }));
+    BOOST_REQUIRE_EQUAL(2, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", std::size_t{128});
+                        }));
+    BOOST_REQUIRE_EQUAL(10, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", ~std::uint64_t{0});
+                        }));
+    BOOST_REQUIRE_EQUAL(1, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", -64);
+                        }));
+    BOOST_REQUIRE_EQUAL(2, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", -65);
+                        }));
+    BOOST_REQUIRE_EQUAL(4, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", 0.5);
+                        }));
+    BOOST_REQUIRE_EQUAL(8, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", 0.1);
+                        }));
+    BOOST_REQUIRE_EQUAL(4, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", 0.1, core::CIEEE754::E_SinglePrecision);
+                        }));
+    BOOST_REQUIRE_EQUAL(8, bytes([](TInserter& inserter) {
+                            inserter.insertValue("a", 0.1, core::CIEEE754::E_DoublePrecision);
+                        }));
+}
+
+BOOST_AUTO_TEST_CASE(testSize) {
+
+    // Check the binary state is much smaller than JSON for numeric state.
+
+    auto insert = [](core::CStatePersistInserter& inserter) {
+        for (std::size_t i = 0; i < 1000; ++i) {
+            inserter.insertLevel("a", [i](core::CStatePersistInserter& inserter_) {
+                inserter_.insertValue("b", i);
+                inserter_.insertValue("c", 1.0 / static_cast<double>(i + 3),
+                                      core::CIEEE754::E_DoublePrecision);
+                inserter_.insertValue("d", 1.0 / static_cast<double>(i + 3),
+                                      core::CIEEE754::E_SinglePrecision);
+            });
+        }
+    };
+
+    std::ostringstream json;
+    {
+        core::CJsonStatePersistInserter inserter(json);
+        insert(inserter);
+    }
+    std::ostringstream binary;
+    {
+        TInserter inserter(binary);
+        insert(inserter);
+    }
+
+    LOG_DEBUG(<< "JSON size = " << json.str().size()
+              << ", binary size = " << binary.str().size());
+    BOOST_TEST_REQUIRE(2 * binary.str().size() < json.str().size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,299 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CBinaryStateRestoreTraverser.h>
+#include <core/CIEEE754.h>
+#include <core/CJsonStatePersistInserter.h>
+#include <core/CJsonStateRestoreTraverser.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(CBinaryStateRestoreTraverserTest)
+
+using namespace ml;
+
+namespace {
+
+void insert2ndLevel(core::CStatePersistInserter& inserter) {
+    inserter.insertValue("level2A", 3.14, core::CIEEE754::E_DoublePrecision);
+    inserter.insertValue("level2B", "z");
+}
+
+void insert1stLevel(core::CStatePersistInserter& inserter, bool empty2ndLevel, bool level1D) {
+    inserter.insertValue("level1A", "a");
+    inserter.insertValue("level1B", 25);
+    inserter.insertLevel("level1C", [&](core::CStatePersistInserter& inserter_) {
+        if (empty2ndLevel == false) {
+            insert2ndLevel(inserter_);
+        }
+    });
+    if (level1D) {
+        inserter.insertValue("level1D", "afterAscending");
+    }
+}
+
+std::string makeState(bool empty2ndLevel, bool level1D) {
+    std::ostringstream strm;
+    {
+        core::CBinaryStatePersistInserter inserter(strm);
+        inserter.insertLevel("_source", [&](core::CStatePersistInserter& inserter_) {
+            insert1stLevel(inserter_, empty2ndLevel, level1D);
+        });
+    }
+    return strm.str();
+}
+
+bool traverse2ndLevel(core::CStateRestoreTraverser& traverser) {
+    BOOST_REQUIRE_EQUAL(std::string("level2A"), traverser.name());
+    double level2A;
+    BOOST_TEST_REQUIRE(traverser.valueAs(level2A));
+    BOOST_REQUIRE_EQUAL(3.14, level2A);
+    BOOST_TEST_REQUIRE(!traverser.hasSubLevel());
+    BOOST_TEST_REQUIRE(traverser.next());
+    BOOST_REQUIRE_EQUAL(std::string("level2B"), traverser.name());
+    BOOST_REQUIRE_EQUAL(std::string("z"), traverser.value());
+    BOOST_TEST_REQUIRE(!traverser.hasSubLevel());
+    BOOST_TEST_REQUIRE(!traverser.next());
+
+    return true;
+}
+
+bool traverse2ndLevelEmpty(core::CStateRestoreTraverser& traverser) {
+    BOOST_TEST_REQUIRE(traverser.name().empty());
+    BOOST_TEST_REQUIRE(traverser.value().empty());
+    BOOST_TEST_REQUIRE(!traverser.hasSubLevel());
+    BOOST_TEST_REQUIRE(!traverser.next());
+
+    return true;
+}
+
+bool traverse1stLevel(core::CStateRestoreTraverser& traverser,
+                      bool empty2ndLevel,
+                      bool level1D,
+                      bool skip2ndLevel) {
+    BOOST_REQUIRE_EQUAL(std::string("level1A"), traverser.name());
+    BOOST_REQUIRE_EQUAL(std::string("a"), traverser.value());
+    BOOST_TEST_REQUIRE(!traverser.hasSubLevel());
+    BOOST_TEST_REQUIRE(traverser.next());
+    BOOST_REQUIRE_EQUAL(std::string("level1B"), traverser.name());
+    BOOST_REQUIRE_EQUAL(std::string("25"), traverser.value());
+    BOOST_TEST_REQUIRE(!traverser.hasSubLevel());
+    BOOST_TEST_REQUIRE(traverser.next());
+    BOOST_REQUIRE_EQUAL(std::string("level1C"), traverser.name());
+    BOOST_TEST_REQUIRE(traverser.hasSubLevel());
+    if (skip2ndLevel == false) {
+        BOOST_TEST_REQUIRE(traverser.traverseSubLevel(
+            empty2ndLevel ? &traverse2ndLevelEmpty : &traverse2ndLevel));
+    }
+    if (level1D) {
+        BOOST_TEST_REQUIRE(traverser.next());
+        BOOST_REQUIRE_EQUAL(std::string("level1D"), traverser.name());
+        BOOST_REQUIRE_EQUAL(std::string("afterAscending"), traverser.value());
+        BOOST_TEST_REQUIRE(!traverser.hasSubLevel());
+    }
+    BOOST_TEST_REQUIRE(!traverser.next());
+
+    return true;
+}
+
+void testRestore(bool empty2ndLevel, bool level1D, bool skip2ndLevel) {
+    std::istringstream strm(makeState(empty2ndLevel, level1D));
+
+    core::CBinaryStateRestoreTraverser traverser(strm);
+
+    BOOST_REQUIRE_EQUAL(std::string("_source"), traverser.name());
+    BOOST_TEST_REQUIRE(traverser.hasSubLevel());
+    BOOST_TEST_REQUIRE(traverser.traverseSubLevel([&](auto& traverser_) {
+        return traverse1stLevel(traverser_, empty2ndLevel, level1D, skip2ndLevel);
+    }));
+    BOOST_TEST_REQUIRE(!traverser.next());
+    BOOST_TEST_REQUIRE(traverser.isEof());
+    BOOST_TEST_REQUIRE(!traverser.haveBadState());
+}
+}
+
+BOOST_AUTO_TEST_CASE(testRestore1) {
+    testRestore(false, false, false);
+}
+
+BOOST_AUTO_TEST_CASE(testRestore2) {
+    // Check we can continue at the level above after ascending.
+    testRestore(false, true, false);
+}
+
+BOOST_AUTO_TEST_CASE(testRestore3) {
+    // Check an empty sub-level.
+    testRestore(true, true, false);
+}
+
+BOOST_AUTO_TEST_CASE(testRestore4) {
+    // Check we can skip the contents of a sub-level.
+    testRestore(false, false, true);
+    testRestore(false, true, true);
+}
+
+BOOST_AUTO_TEST_CASE(testNumericValues) {
+
+    // Check that numbers are restored exactly and can be read as strings
+    // or numbers of a different type.
+
+    std::ostringstream strm;
+    {
+        core::CBinaryStatePersistInserter inserter(strm);
+        inserter.insertValue("a", std::numeric_limits<std::uint64_t>::max());
+        inserter.insertValue("b", std::numeric_limits<std::int64_t>::min());
+        inserter.insertValue("c", -25);
+        inserter.insertValue("d", 1.0 / 3.0);
+        inserter.insertValue("e", 1.0 / 3.0, core::CIEEE754::E_SinglePrecision);
+        inserter.insertValue("f", std::numeric_limits<double>::infinity());
+        inserter.insertValue("g", "17");
+        inserter.insertValue("h", true);
+    }
+
+    std::istringstream istrm(strm.str());
+    core::CBinaryStateRestoreTraverser traverser(istrm);
+
+    BOOST_REQUIRE_EQUAL(std::string("a"), traverser.name());
+    std::uint64_t a;
+    BOOST_TEST_REQUIRE(traverser.valueAs(a));
+    BOOST_REQUIRE_EQUAL(std::numeric_limits<std::uint64_t>::max(), a);
+    std::int64_t tooSmall;
+    BOOST_TEST_REQUIRE(!traverser.valueAs(tooSmall));
+    BOOST_REQUIRE_EQUAL(std::string("18446744073709551615"), traverser.value());
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    std::int64_t b;
+    BOOST_TEST_REQUIRE(traverser.valueAs(b));
+    BOOST_REQUIRE_EQUAL(std::numeric_limits<std::int64_t>::min(), b);
+    int bInt;
+    BOOST_TEST_REQUIRE(!traverser.valueAs(bInt));
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    int c;
+    BOOST_TEST_REQUIRE(traverser.valueAs(c));
+    BOOST_REQUIRE_EQUAL(-25, c);
+    std::size_t cUnsigned;
+    BOOST_TEST_REQUIRE(!traverser.valueAs(cUnsigned));
+    double cDouble;
+    BOOST_TEST_REQUIRE(traverser.valueAs(cDouble));
+    BOOST_REQUIRE_EQUAL(-25.0, cDouble);
+    BOOST_REQUIRE_EQUAL(std::string("-25"), traverser.value());
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    double d;
+    BOOST_TEST_REQUIRE(traverser.valueAs(d));
+    BOOST_REQUIRE_EQUAL(1.0 / 3.0, d);
+    double dFromString;
+    BOOST_TEST_REQUIRE(core::CStringUtils::stringToType(traverser.value(), dFromString));
+    BOOST_REQUIRE_EQUAL(1.0 / 3.0, dFromString);
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    double e;
+    BOOST_TEST_REQUIRE(traverser.valueAs(e));
+    BOOST_REQUIRE_EQUAL(core::CIEEE754::round(1.0 / 3.0, core::CIEEE754::E_SinglePrecision), e);
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    double f;
+    BOOST_TEST_REQUIRE(traverser.valueAs(f));
+    BOOST_REQUIRE_EQUAL(std::numeric_limits<double>::infinity(), f);
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    int g;
+    BOOST_TEST_REQUIRE(traverser.valueAs(g));
+    BOOST_REQUIRE_EQUAL(17, g);
+
+    BOOST_TEST_REQUIRE(traverser.next());
+    bool h;
+    BOOST_TEST_REQUIRE(traverser.valueAs(h));
+    BOOST_REQUIRE_EQUAL(true, h);
+
+    BOOST_TEST_REQUIRE(!traverser.next());
+    BOOST_TEST_REQUIRE(!traverser.haveBadState());
+}
+
+BOOST_AUTO_TEST_CASE(testFormatDetection) {
+
+    // Check we create the right traverser for each format.
+
+    auto insert = [](core::CStatePersistInserter& inserter) {
+        inserter.insertValue("a", 1.5);
+        inserter.insertLevel("b", [](core::CStatePersistInserter& inserter_) {
+            inserter_.insertValue("c", "d");
+        });
+    };
+
+    std::ostringstream json;
+    {
+        core::CJsonStatePersistInserter inserter(json);
+        insert(inserter);
+    }
+    std::ostringstream binary;
+    {
+        core::CBinaryStatePersistInserter inserter(binary);
+        insert(inserter);
+    }
+
+    for (const auto& state : {json.str(), binary.str()}) {
+        std::istringstream strm(state);
+        BOOST_REQUIRE_EQUAL(state == binary.str(),
+                            core::CBinaryStateRestoreTraverser::isBinaryFormat(strm));
+        auto traverser = core::CBinaryStateRestoreTraverser::makeTraverser(strm);
+        BOOST_REQUIRE_EQUAL(state == binary.str(),
+                            dynamic_cast<core::CBinaryStateRestoreTraverser*>(
+                                traverser.get()) != nullptr);
+        BOOST_REQUIRE_EQUAL(std::string("a"), traverser->name());
+        double a;
+        BOOST_TEST_REQUIRE(traverser->valueAs(a));
+        BOOST_REQUIRE_EQUAL(1.5, a);
+        BOOST_TEST_REQUIRE(traverser->next());
+        BOOST_REQUIRE_EQUAL(std::string("b"), traverser->name());
+        BOOST_TEST_REQUIRE(traverser->traverseSubLevel([](auto& traverser_) {
+            return traverser_.name() == "c" && traverser_.value() == "d";
+        }));
+        BOOST_TEST_REQUIRE(!traverser->next());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBadState) {
+
+    // Check truncated and corrupt state is detected.
+
+    std::string state{makeState(false, true)};
+
+    for (std::size_t length : {std::size_t{2}, state.size() / 2, state.size() - 1}) {
+        std::istringstream strm(state.substr(0, length));
+        core::CBinaryStateRestoreTraverser traverser(strm);
+        traverser.traverseSubLevel([](auto& traverser_) {
+            while (traverser_.next()) {
+            }
+            return true;
+        });
+        while (traverser.next()) {
+        }
+        BOOST_TEST_REQUIRE(traverser.haveBadState());
+    }
+
+    std::string newerVersion{state};
+    newerVersion[core::CBinaryStatePersistInserter::MARKER.size()] =
+        static_cast<char>(core::CBinaryStatePersistInserter::VERSION + 1);
+    std::istringstream strm(newerVersion);
+    core::CBinaryStateRestoreTraverser traverser(strm);
+    BOOST_TEST_REQUIRE(traverser.name().empty());
+    BOOST_TEST_REQUIRE(traverser.haveBadState());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,297 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CFlatHashMap.h>
+#include <core/CLogger.h>
+#include <core/CMemoryDefStd.h>
+#include <core/CMemoryUsage.h>
+#include <core/CStopWatch.h>
+
+#include <test/CRandomNumbers.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CFlatHashMapTest)
+
+using namespace ml;
+
+namespace {
+using TSizeVec = std::vector<std::size_t>;
+using TSizeSizePr = std::pair<std::size_t, std::size_t>;
+using TSizeSizePrUInt64Map = std::map<TSizeSizePr, std::uint64_t>;
+using TSizeSizePrUInt64UMap = boost::unordered_map<TSizeSizePr, std::uint64_t>;
+using TSizeSizePrUInt64FlatUMap = core::CFlatHashMap<TSizeSizePr, std::uint64_t>;
+using TSizeStrFlatUMap = core::CFlatHashMap<std::size_t, std::string>;
+
+template<typename MAP>
+TSizeSizePrUInt64Map ordered(const MAP& map) {
+    return {map.begin(), map.end()};
+}
+}
+
+BOOST_AUTO_TEST_CASE(testInsertAndFind) {
+    // Test that inserts and lookups match boost::unordered_map.
+
+    test::CRandomNumbers rng;
+
+    TSizeSizePrUInt64UMap expected;
+    TSizeSizePrUInt64FlatUMap map;
+    BOOST_TEST_REQUIRE(map.empty());
+    BOOST_REQUIRE_EQUAL(0, map.capacity());
+    BOOST_TEST_REQUIRE((map.find({0, 0}) == map.end()));
+    BOOST_TEST_REQUIRE((map.begin() == map.end()));
+
+    TSizeVec people;
+    TSizeVec attributes;
+    for (std::size_t t = 0; t < 10; ++t) {
+        rng.generateUniformSamples(0, 100, 1000, people);
+        rng.generateUniformSamples(0, 20, 1000, attributes);
+        for (std::size_t i = 0; i < people.size(); ++i) {
+            TSizeSizePr key{people[i], attributes[i]};
+            if (i % 2 == 0) {
+                expected[key] += i;
+                map[key] += i;
+            } else {
+                bool inserted{expected.emplace(key, i).second};
+                BOOST_REQUIRE_EQUAL(inserted, map.emplace(key, i).second);
+            }
+        }
+        BOOST_REQUIRE_EQUAL(expected.size(), map.size());
+        BOOST_TEST_REQUIRE((ordered(expected) == ordered(map)));
+
+        for (std::size_t i = 0; i < 100; ++i) {
+            for (std::size_t j = 0; j < 25; ++j) {
+                auto expectedValue = expected.find({i, j});
+                auto value = map.find({i, j});
+                BOOST_REQUIRE_EQUAL(expectedValue == expected.end(), value == map.end());
+                BOOST_REQUIRE_EQUAL(expected.count({i, j}), map.count({i, j}));
+                if (value != map.end()) {
+                    BOOST_REQUIRE_EQUAL(expectedValue->second, value->second);
+                }
+            }
+        }
+    }
+
+    // The load factor should be bounded.
+    BOOST_TEST_REQUIRE(8 * map.size() <= 7 * map.capacity());
+    BOOST_TEST_REQUIRE(4 * map.size() >= map.capacity());
+}
+
+BOOST_AUTO_TEST_CASE(testErase) {
+    // Test erasing by key and erasing while iterating.
+
+    test::CRandomNumbers rng;
+
+    TSizeSizePrUInt64UMap expected;
+    TSizeSizePrUInt64FlatUMap map;
+
+    TSizeVec people;
+    TSizeVec attributes;
+    rng.generateUniformSamples(0, 200, 2000, people);
+    rng.generateUniformSamples(0, 10, 2000, attributes);
+    for (std::size_t i = 0; i < people.size(); ++i) {
+        expected[{people[i], attributes[i]}] += 1;
+        map[{people[i], attributes[i]}] += 1;
+    }
+
+    for (std::size_t i = 0; i < 200; i += 3) {
+        for (std::size_t j = 0; j < 10; ++j) {
+            BOOST_REQUIRE_EQUAL(expected.erase({i, j}), map.erase({i, j}));
+        }
+    }
+    BOOST_REQUIRE_EQUAL(expected.size(), map.size());
+    BOOST_TEST_REQUIRE((ordered(expected) == ordered(map)));
+
+    // Remove people in the same way as the bucket gatherers, checking we
+    // visit each element exactly once.
+    std::size_t visited{0};
+    std::size_t size{map.size()};
+    for (auto i = map.begin(); i != map.end(); /**/) {
+        ++visited;
+        if (i->first.first % 2 == 0) {
+            i = map.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    for (auto i = expected.begin(); i != expected.end(); /**/) {
+        i = i->first.first % 2 == 0 ? expected.erase(i) : ++i;
+    }
+    BOOST_REQUIRE_EQUAL(size, visited);
+    BOOST_REQUIRE_EQUAL(expected.size(), map.size());
+    BOOST_TEST_REQUIRE((ordered(expected) == ordered(map)));
+
+    // Check that repeatedly inserting and erasing doesn't grow the table.
+    std::size_t capacity{map.capacity()};
+    for (std::size_t i = 0; i < 10000; ++i) {
+        map[{1000 + i, 0}] = i;
+        map.erase({1000 + i, 0});
+    }
+    BOOST_REQUIRE_EQUAL(capacity, map.capacity());
+    BOOST_TEST_REQUIRE((ordered(expected) == ordered(map)));
+
+    map.clear();
+    BOOST_TEST_REQUIRE(map.empty());
+    BOOST_TEST_REQUIRE((map.begin() == map.end()));
+    BOOST_REQUIRE_EQUAL(capacity, map.capacity());
+}
+
+BOOST_AUTO_TEST_CASE(testRecycle) {
+    TSizeSizePrUInt64FlatUMap map;
+    for (std::size_t i = 0; i < 100; ++i) {
+        map[{i, i}] = i;
+    }
+
+    // Refilling with a similar number of elements should reuse the table.
+    std::size_t capacity{map.capacity()};
+    map.recycle();
+    BOOST_TEST_REQUIRE(map.empty());
+    BOOST_TEST_REQUIRE((map.begin() == map.end()));
+    BOOST_REQUIRE_EQUAL(capacity, map.capacity());
+    for (std::size_t i = 0; i < 80; ++i) {
+        map[{i, 2 * i}] += 1;
+    }
+    BOOST_REQUIRE_EQUAL(80, map.size());
+    BOOST_REQUIRE_EQUAL(capacity, map.capacity());
+    BOOST_REQUIRE_EQUAL(0, map.count({1, 1}));
+    BOOST_REQUIRE_EQUAL(1, (map[{1, 2}]));
+
+    // A table much larger than needed should be released.
+    map.recycle();
+    for (std::size_t i = 0; i < 10; ++i) {
+        map[{i, i}] = i;
+    }
+    map.recycle();
+    BOOST_REQUIRE_EQUAL(0, map.capacity());
+    BOOST_REQUIRE_EQUAL(0, core::memory::dynamicSize(map));
+
+    // Check clear leaves no stale values for non-trivial types.
+    TSizeStrFlatUMap strings;
+    strings[1] = "foo";
+    strings.clear();
+    BOOST_REQUIRE_EQUAL("", strings[1]);
+}
+
+BOOST_AUTO_TEST_CASE(testCopyAndEquality) {
+    TSizeStrFlatUMap map;
+    for (std::size_t i = 0; i < 100; ++i) {
+        map[i] = std::to_string(i);
+    }
+
+    TSizeStrFlatUMap copy{map};
+    BOOST_TEST_REQUIRE((copy == map));
+    copy[5] = "foo";
+    BOOST_TEST_REQUIRE((copy != map));
+    BOOST_REQUIRE_EQUAL("5", map[5]);
+
+    // Equality shouldn't depend on the insertion order.
+    TSizeStrFlatUMap reversed;
+    for (std::size_t i = 100; i > 0; --i) {
+        reversed[i - 1] = std::to_string(i - 1);
+    }
+    BOOST_TEST_REQUIRE((reversed == map));
+
+    TSizeStrFlatUMap empty;
+    empty.swap(copy);
+    BOOST_TEST_REQUIRE(copy.empty());
+    BOOST_REQUIRE_EQUAL(100, empty.size());
+    BOOST_REQUIRE_EQUAL("foo", empty[5]);
+}
+
+BOOST_AUTO_TEST_CASE(testMemoryUsage) {
+    TSizeSizePrUInt64FlatUMap counts;
+    BOOST_REQUIRE_EQUAL(0, core::memory::dynamicSize(counts));
+    for (std::size_t i = 0; i < 100; ++i) {
+        counts[{i, i}] = i;
+    }
+    BOOST_REQUIRE_EQUAL(counts.capacity() * counts.slotSize(),
+                        core::memory::dynamicSize(counts));
+
+    // Check we account for the values' memory.
+    TSizeStrFlatUMap strings;
+    std::size_t stringsMemory{0};
+    for (std::size_t i = 0; i < 10; ++i) {
+        std::string value(100 + i, 'x');
+        stringsMemory += core::memory::dynamicSize(value);
+        strings[i] = std::move(value);
+    }
+    BOOST_REQUIRE_EQUAL(strings.capacity() * strings.slotSize() + stringsMemory,
+                        core::memory::dynamicSize(strings));
+
+    // Assigning a smaller map reuses the table's storage which should
+    // still be accounted for.
+    std::size_t countsMemory{core::memory::dynamicSize(counts)};
+    TSizeSizePrUInt64FlatUMap small;
+    small[{0, 0}] = 1;
+    counts = small;
+    BOOST_REQUIRE_EQUAL(countsMemory, core::memory::dynamicSize(counts));
+
+    core::CMemoryUsage memoryUsage;
+    memoryUsage.setName("root", 0);
+    core::memory_debug::dynamicSize("strings", strings, memoryUsage.addChild());
+    BOOST_REQUIRE_EQUAL(core::memory::dynamicSize(strings), memoryUsage.usage());
+}
+
+BOOST_AUTO_TEST_CASE(testThroughput) {
+    // Compare with boost::unordered_map for the per bucket counts workload
+    // in the bucket gatherers: each record increments the count for its
+    // (person, attribute) pair and the counts are cleared for each bucket.
+
+    const std::size_t numberBuckets{200};
+    const std::size_t recordsPerBucket{20000};
+
+    test::CRandomNumbers rng;
+    TSizeVec people;
+    TSizeVec attributes;
+    rng.generateUniformSamples(0, 5000, recordsPerBucket, people);
+    rng.generateUniformSamples(0, 5, recordsPerBucket, attributes);
+
+    auto run = [&](auto map, const std::string& name) {
+        std::uint64_t total{0};
+        std::size_t memory{0};
+        std::size_t entries{0};
+        core::CStopWatch watch{true};
+        for (std::size_t bucket = 0; bucket < numberBuckets; ++bucket) {
+            // Use a new map per bucket as CBucketQueue does.
+            decltype(map) counts;
+            for (std::size_t i = 0; i < recordsPerBucket; ++i) {
+                counts[{people[i], attributes[i]}] += 1;
+            }
+            for (const auto& count : counts) {
+                total += count.second;
+            }
+            memory += core::memory::dynamicSize(counts);
+            entries += counts.size();
+        }
+        std::uint64_t elapsed{std::max(watch.stop(), std::uint64_t{1})};
+        LOG_DEBUG(<< name << ": records/s = "
+                  << 1000 * numberBuckets * recordsPerBucket / elapsed
+                  << ", bytes/entry = "
+                  << static_cast<double>(memory) / static_cast<double>(entries));
+        BOOST_REQUIRE_EQUAL(numberBuckets * recordsPerBucket, total);
+        return static_cast<double>(memory) / static_cast<double>(entries);
+    };
+
+    double unorderedMapBytesPerEntry{run(TSizeSizePrUInt64UMap{}, "boost::unordered_map")};
+    double flatMapBytesPerEntry{run(TSizeSizePrUInt64FlatUMap{}, "CFlatHashMap")};
+
+    BOOST_TEST_REQUIRE(flatMapBytesPerEntry < unorderedMapBytesPerEntry);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,8 @@
  * limitation.
  */
 
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CBinaryStateRestoreTraverser.h>
 #include <core/CContainerPrinter.h>
 #include <core/CJsonStatePersistInserter.h>
 #include <core/CJsonStateRestoreTraverser.h>
@@ -158,12 +160,12 @@ bool equal(const T& lhs, const T& rhs) {
            std::equal(lhs.begin(), lhs.end(), rhs.begin(), SEqual());
 }
 
-template<typename T>
-void testPersistRestore(const T& collection, const T& initial = T()) {
+template<typename INSERTER, typename TRAVERSER, typename T>
+void testPersistRestore(const T& collection, const T& initial) {
     const std::string tag("baseTag");
     std::stringstream origSs;
     {
-        core::CJsonStatePersistInserter inserter(origSs);
+        INSERTER inserter(origSs);
         core::CPersistUtils::persist(tag, collection, inserter);
     }
     LOG_TRACE(<< "String data is: " << origSs.str());
@@ -171,13 +173,13 @@ void testPersistRestore(const T& collection, const T& initial = T()) {
     T restored = initial;
     std::stringstream restoredSs;
     {
-        core::CJsonStateRestoreTraverser traverser(origSs);
+        TRAVERSER traverser(origSs);
         BOOST_TEST_REQUIRE(core::CPersistUtils::restore(tag, restored, traverser));
     }
     LOG_TRACE(<< " - doing persist again " << typeid(T).name());
     {
         const T& restoredRef = restored;
-        core::CJsonStatePersistInserter inserter(restoredSs);
+        INSERTER inserter(restoredSs);
         core::CPersistUtils::persist(tag, restoredRef, inserter);
     }
     LOG_TRACE(<< "String data is: " << restoredSs.str());
@@ -185,6 +187,14 @@ void testPersistRestore(const T& collection, const T& initial = T()) {
     BOOST_REQUIRE_EQUAL(origSs.str(), restoredSs.str());
     BOOST_TEST_REQUIRE(compare(collection, restored));
 }
+
+template<typename T>
+void testPersistRestore(const T& collection, const T& initial = T()) {
+    testPersistRestore<core::CJsonStatePersistInserter, core::CJsonStateRestoreTraverser>(
+        collection, initial);
+    testPersistRestore<core::CBinaryStatePersistInserter, core::CBinaryStateRestoreTraverser>(
+        collection, initial);
+}
 }
 
 BOOST_AUTO_TEST_CASE(testPersistContainers) {
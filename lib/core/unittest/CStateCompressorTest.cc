@@ -9,6 +9,8 @@
  * limitation.
  */
 
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CBinaryStateRestoreTraverser.h>
 #include <core/CJsonStatePersistInserter.h>
 #include <core/CJsonStateRestoreTraverser.h>
 #include <core/CLogger.h>
@@ -20,6 +22,7 @@
 #include <boost/random/uniform_int.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <functional>
 #include <iostream>
 
 BOOST_AUTO_TEST_SUITE(CStateCompressorTest)
@@ -229,6 +232,67 @@ BOOST_AUTO_TEST_CASE(testStreaming) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBinaryFormat) {
+    // Check that state in the binary format is restored the same as JSON
+    // after compression and the format is detected from the decompressed
+    // stream.
+
+    auto readAll = [](CStateRestoreTraverser& traverser) {
+        std::ostringstream result;
+        std::function<bool(CStateRestoreTraverser&)> read;
+        read = [&](CStateRestoreTraverser& traverser_) {
+            do {
+                // All the numeric values are persisted with single precision.
+                double number;
+                result << traverser_.name() << '='
+                       << (CStringUtils::stringToTypeSilent(traverser_.value(), number)
+                               ? CStringUtils::typeToStringPrecise(number, CIEEE754::E_SinglePrecision)
+                               : traverser_.value())
+                       << ';';
+                if (traverser_.hasSubLevel()) {
+                    result << '{';
+                    traverser_.traverseSubLevel(read);
+                    result << '}';
+                }
+            } while (traverser_.next());
+            return true;
+        };
+        read(traverser);
+        return result.str();
+    };
+
+    std::string expected;
+    for (bool binary : {false, true}) {
+        CMockDataAdder mockKvAdder(3000);
+        {
+            ml::core::CStateCompressor compressor(mockKvAdder);
+            TOStreamP strm = compressor.addStreamed("");
+            if (binary) {
+                CBinaryStatePersistInserter inserter(*strm);
+                insert1stLevel(inserter, 100);
+            } else {
+                CJsonStatePersistInserter inserter(*strm);
+                insert1stLevel(inserter, 100);
+            }
+            compressor.streamComplete(strm, true);
+        }
+
+        CMockDataSearcher mockKvSearcher(mockKvAdder);
+        ml::core::CStateDecompressor decompressor(mockKvSearcher);
+        TIStreamP istrm = decompressor.search(1, 1);
+
+        BOOST_REQUIRE_EQUAL(binary, CBinaryStateRestoreTraverser::isBinaryFormat(*istrm));
+        auto traverser = CBinaryStateRestoreTraverser::makeTraverser(*istrm);
+        std::string actual{readAll(*traverser)};
+        BOOST_TEST_REQUIRE(traverser->haveBadState() == false);
+        if (binary) {
+            BOOST_REQUIRE_EQUAL(expected, actual);
+        } else {
+            expected = actual;
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testChunking) {
     // Put arbitrary string data into the stream, and stress different sizes
     // check CMockDataAdder with max doc sizes from 500 to 500000
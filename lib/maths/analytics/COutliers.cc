@@ -16,6 +16,7 @@
 #include <core/CMemoryDef.h>
 #include <core/CProgramCounters.h>
 #include <core/CStopWatch.h>
+#include <core/Concurrency.h>
 
 #include <maths/analytics/CDataFrameAnalysisInstrumentationInterface.h>
 #include <maths/analytics/CDataFrameUtils.h>
@@ -24,6 +25,7 @@
 #include <maths/common/CBasicStatisticsPersist.h>
 #include <maths/common/CIntegration.h>
 #include <maths/common/CLinearAlgebraEigen.h>
+#include <maths/common/CSparseRandomProjection.h>
 #include <maths/common/CSpline.h>
 #include <maths/common/CTools.h>
 
@@ -73,6 +75,12 @@ std::int64_t signedMemoryUsage(const T& obj) {
 //!
 //! The models can be built from a data stream by repeatedly calling addPoint.
 //! The evaluation of the outlier score for a point is delagated.
+//!
+//! For high dimensional data the points can optionally first be reduced using
+//! a sparse random projection whose dimension is chosen so that the distances
+//! between the points are approximately preserved. The models' projections are
+//! then generated in the reduced space and every point only needs to be reduced
+//! once, rather than once per model, in the original space.
 template<typename POINT>
 class CEnsemble {
 private:
@@ -85,8 +93,9 @@ public:
     using TSizeSizePrVec = std::vector<TSizeSizePr>;
     using TMeanVarAccumulator = common::CBasicStatistics::SSampleMeanVar<double>::TAccumulator;
     using TMeanVarAccumulator2Vec = core::CSmallVector<TMeanVarAccumulator, 2>;
-    using TPoint =
-        common::CAnnotatedVector<decltype(common::SConstant<POINT>::get(0, 0)), std::size_t>;
+    using TVector = decltype(common::SConstant<POINT>::get(0, 0));
+    using TVectorVec = std::vector<TVector>;
+    using TPoint = common::CAnnotatedVector<TVector, std::size_t>;
     using TPointVec = std::vector<TPoint>;
     using TPointVecVec = std::vector<TPointVec>;
     using TKdTree = common::CKdTree<TPoint>;
@@ -96,7 +105,9 @@ public:
     using TMethodUPtrVec = std::vector<TMethodUPtr>;
     using TMethodFactory = std::function<TMethodUPtr(std::size_t, const TKdTree&)>;
     using TMethodFactoryVec = std::vector<TMethodFactory>;
-    using TMethodSize = std::function<std::size_t(std::size_t, std::size_t, std::size_t)>;
+    using TMethodSize =
+        std::function<std::size_t(std::size_t, std::size_t, std::size_t, std::size_t)>;
+    using TSparseRandomProjectionUPtr = std::unique_ptr<common::CSparseRandomProjection>;
 
     //! \brief Builds (online) one model of the points for the ensemble.
     class CModelBuilder {
@@ -107,7 +118,8 @@ public:
         CModelBuilder(common::CPRNG::CXorOShiro128Plus& rng,
                       TSizeSizePrVec&& methodsAndNumberNeighbours,
                       std::size_t sampleSize,
-                      TMatrix&& projection);
+                      TMatrix&& projection,
+                      TMatrix&& featureProjection);
 
         //! Maybe sample the point.
         void addPoint(const TRowRef& point) { m_Sampler.sample(point); }
@@ -121,11 +133,16 @@ public:
     private:
         TSampler makeSampler(common::CPRNG::CXorOShiro128Plus& rng, std::size_t sampleSize);
 
+        const TMatrix& featureProjection() const {
+            return m_FeatureProjection.size() > 0 ? m_FeatureProjection : m_Projection;
+        }
+
     private:
         TSizeSizePrVec m_MethodsAndNumberNeighbours;
         std::size_t m_SampleSize;
         TSampler m_Sampler;
         TMatrix m_Projection;
+        TMatrix m_FeatureProjection;
         TPointVec m_SampledProjectedPoints;
     };
     using TModelBuilderVec = std::vector<CModelBuilder>;
@@ -173,25 +190,40 @@ public:
 public:
     static const double SAMPLE_SIZE_SCALE;
     static const double NEIGHBOURHOOD_FRACTION;
+    static const double REDUCTION_DISTORTION;
 
 public:
     CEnsemble(const TMethodFactoryVec& methodFactories,
+              TSparseRandomProjectionUPtr reduction,
               TModelBuilderVec builders,
               TMemoryUsageCallback recordMemoryUsage,
               TStepCallback recordStep);
-    ~CEnsemble() { m_RecordMemoryUsage(-signedMemoryUsage(m_Models)); }
+    ~CEnsemble() {
+        m_RecordMemoryUsage(-signedMemoryUsage(m_Reduction) - signedMemoryUsage(m_Models));
+    }
 
     CEnsemble(const CEnsemble&) = delete;
     CEnsemble& operator=(const CEnsemble&) = delete;
     CEnsemble(CEnsemble&&) noexcept = default;
     CEnsemble& operator=(CEnsemble&&) noexcept = default;
 
+    //! Make the projection used to reduce the dimension of the points if this
+    //! is enabled and it would reduce their dimension.
+    static TSparseRandomProjectionUPtr makeReduction(bool reduceDimension,
+                                                     std::size_t numberPoints,
+                                                     std::size_t dimension,
+                                                     common::CPRNG::CXorOShiro128Plus& rng);
+
     //! Make the builders for the ensemble models.
+    //!
+    //! \param[in] reduction The projection used to reduce the dimension of
+    //! the points or null if they are not reduced.
     static TModelBuilderVec
     makeBuilders(const TSizeVecVec& methods,
                  std::size_t numberPoints,
                  std::size_t dimension,
                  std::size_t numberNeighbours,
+                 const common::CSparseRandomProjection* reduction = nullptr,
                  common::CPRNG::CXorOShiro128Plus rng = common::CPRNG::CXorOShiro128Plus{});
 
     //! Compute the outlier scores for \p points.
@@ -201,6 +233,7 @@ public:
     static std::size_t estimateMemoryUsage(TMethodSize methodSize,
                                            std::size_t numberMethodsPerModel,
                                            bool computeFeatureInfluence,
+                                           bool reduceDimension,
                                            std::size_t totalNumberPoints,
                                            std::size_t partitionNumberPoints,
                                            std::size_t dimension);
@@ -217,19 +250,24 @@ private:
         CModel(const TMethodFactoryVec& methodFactories,
                TSizeSizePrVec methodsAndNumberNeighbours,
                TPointVec samples,
-               TMatrix projection);
+               TMatrix projection,
+               TMatrix featureProjection);
 
         std::size_t numberPoints() const { return m_Lookup->size(); }
 
         void proportionOfRuntimePerMethod(double proportion);
 
-        void addOutlierScores(const std::vector<POINT>& points,
+        //! \note \p points are either the original or the reduced points
+        //! depending on whether the ensemble reduces dimension.
+        template<typename VECTOR>
+        void addOutlierScores(const std::vector<VECTOR>& points,
                               TScorerVec& scores,
                               const TMemoryUsageCallback& recordMemoryUsage) const;
 
         std::size_t memoryUsage() const {
             return core::memory::dynamicSize(m_Lookup) +
                    core::memory::dynamicSize(m_Projection) +
+                   core::memory::dynamicSize(m_FeatureProjection) +
                    core::memory::dynamicSize(m_Method) +
                    core::memory::dynamicSize(m_LogScoreMoments);
         }
@@ -238,13 +276,24 @@ private:
                                                std::size_t sampleSize,
                                                std::size_t numberNeighbours,
                                                std::size_t projectionDimension,
+                                               std::size_t reducedDimension,
                                                std::size_t dimension);
 
         std::string print() const;
 
+    private:
+        //! Get the projection of the original feature space onto the space
+        //! in which we search for neighbours.
+        const TMatrix& featureProjection() const {
+            return m_FeatureProjection.size() > 0 ? m_FeatureProjection : m_Projection;
+        }
+
     private:
         TKdTreeUPtr m_Lookup;
         TMatrix m_Projection;
+        //! The composition of m_Projection and the dimension reduction if
+        //! the points are reduced, otherwise empty.
+        TMatrix m_FeatureProjection;
         TMethodUPtr m_Method;
         TMeanVarAccumulator2Vec m_LogScoreMoments;
     };
@@ -299,12 +348,30 @@ private:
         return static_cast<std::size_t>(std::min(std::max(target, 2.0), 10.0) + 0.5);
     }
 
+    static std::size_t computeReducedDimension(bool reduceDimension,
+                                               std::size_t numberPoints,
+                                               std::size_t dimension) {
+        // We choose the smallest dimension for which the Johnson-Lindenstrauss
+        // lemma says distances are approximately preserved. The ensemble models
+        // search for neighbours in random subspaces of at most 10 dimensions so
+        // we can tolerate a fairly large distortion.
+        if (reduceDimension) {
+            std::size_t reducedDimension{common::CSparseRandomProjection::targetDimension(
+                numberPoints, REDUCTION_DISTORTION)};
+            if (reducedDimension < dimension) {
+                return reducedDimension;
+            }
+        }
+        return dimension;
+    }
+
     static TMatrixVec createProjections(common::CPRNG::CXorOShiro128Plus& rng,
                                         std::size_t numberProjections,
                                         std::size_t projectionDimension,
                                         std::size_t dimension);
 
 private:
+    TSparseRandomProjectionUPtr m_Reduction;
     TModelVec m_Models;
     TMemoryUsageCallback m_RecordMemoryUsage;
     TStepCallback m_RecordStep;
@@ -314,13 +381,17 @@ template<typename POINT>
 const double CEnsemble<POINT>::SAMPLE_SIZE_SCALE{5.0};
 template<typename POINT>
 const double CEnsemble<POINT>::NEIGHBOURHOOD_FRACTION{0.01};
+template<typename POINT>
+const double CEnsemble<POINT>::REDUCTION_DISTORTION{0.5};
 
 template<typename POINT>
 CEnsemble<POINT>::CEnsemble(const TMethodFactoryVec& methodFactories,
+                            TSparseRandomProjectionUPtr reduction,
                             TModelBuilderVec builders,
                             TMemoryUsageCallback recordMemoryUsage,
                             TStepCallback recordStep)
-    : m_RecordMemoryUsage{std::move(recordMemoryUsage)}, m_RecordStep{std::move(recordStep)} {
+    : m_Reduction{std::move(reduction)}, m_RecordMemoryUsage{std::move(recordMemoryUsage)},
+      m_RecordStep{std::move(recordStep)} {
 
     m_Models.reserve(builders.size());
     for (auto& builder : builders) {
@@ -331,7 +402,22 @@ CEnsemble<POINT>::CEnsemble(const TMethodFactoryVec& methodFactories,
         model.proportionOfRuntimePerMethod(1.0 / static_cast<double>(m_Models.size()));
     }
 
-    m_RecordMemoryUsage(core::memory::dynamicSize(m_Models));
+    m_RecordMemoryUsage(core::memory::dynamicSize(m_Reduction) +
+                        core::memory::dynamicSize(m_Models));
+}
+
+template<typename POINT>
+typename CEnsemble<POINT>::TSparseRandomProjectionUPtr
+CEnsemble<POINT>::makeReduction(bool reduceDimension,
+                                std::size_t numberPoints,
+                                std::size_t dimension,
+                                common::CPRNG::CXorOShiro128Plus& rng) {
+    std::size_t reducedDimension{computeReducedDimension(reduceDimension, numberPoints, dimension)};
+    if (reducedDimension == dimension) {
+        return nullptr;
+    }
+    LOG_TRACE(<< "Reducing dimension from " << dimension << " to " << reducedDimension);
+    return std::make_unique<common::CSparseRandomProjection>(rng, dimension, reducedDimension);
 }
 
 template<typename POINT>
@@ -340,6 +426,7 @@ CEnsemble<POINT>::makeBuilders(const TSizeVecVec& methods,
                                std::size_t numberPoints,
                                std::size_t dimension,
                                std::size_t numberNeighbours,
+                               const common::CSparseRandomProjection* reduction,
                                common::CPRNG::CXorOShiro128Plus rng) {
     // Compute some constants of the ensemble:
     //   - The number of ensemble models, which is proportional n^(1/2),
@@ -349,6 +436,10 @@ CEnsemble<POINT>::makeBuilders(const TSizeVecVec& methods,
     //     model sample size and
     //   - The dimension of the projected points, which is proportional to log(n)
     //     (to ensure there is sufficient data) and d^(1/2)
+    //
+    // If the points are reduced the models' projections are of the reduced
+    // points.
+    dimension = reduction != nullptr ? reduction->outputDimension() : dimension;
     std::size_t ensembleSize{computeEnsembleSize(methods.size(), numberPoints, dimension)};
     std::size_t sampleSize{computeSampleSize(numberPoints)};
     std::size_t numberModels{(ensembleSize + methods.size() - 1) / methods.size()};
@@ -376,8 +467,12 @@ CEnsemble<POINT>::makeBuilders(const TSizeVecVec& methods,
                                                  maxNumberNeighbours + 1));
         }
 
-        result.emplace_back(rng, std::move(methodsAndNumberNeighbours),
-                            sampleSize, std::move(projections[i]));
+        TMatrix featureProjection{reduction != nullptr
+                                      ? reduction->compose(projections[i])
+                                      : TMatrix{}};
+
+        result.emplace_back(rng, std::move(methodsAndNumberNeighbours), sampleSize,
+                            std::move(projections[i]), std::move(featureProjection));
 
         rng.jump();
     }
@@ -397,9 +492,27 @@ CEnsemble<POINT>::computeOutlierScores(const std::vector<POINT>& points) const {
     TScorerVec scores(points.size());
     m_RecordMemoryUsage(core::memory::dynamicSize(scores));
 
+    if (m_Reduction == nullptr) {
+        for (const auto& model : m_Models) {
+            model.addOutlierScores(points, scores, m_RecordMemoryUsage);
+        }
+        return scores;
+    }
+
+    // Reduce the points once for all models.
+    TVectorVec reducedPoints(points.size(),
+                             common::SConstant<TVector>::get(m_Reduction->outputDimension(), 0));
+    core::parallel_for_each(0, points.size(), [&](std::size_t i) {
+        m_Reduction->project(points[i], reducedPoints[i]);
+    });
+    std::int64_t reducedPointsMemory{signedMemoryUsage(reducedPoints)};
+    m_RecordMemoryUsage(reducedPointsMemory);
+
     for (const auto& model : m_Models) {
-        model.addOutlierScores(points, scores, m_RecordMemoryUsage);
+        model.addOutlierScores(reducedPoints, scores, m_RecordMemoryUsage);
     }
+
+    m_RecordMemoryUsage(-reducedPointsMemory);
     return scores;
 }
 
@@ -407,29 +520,40 @@ template<typename POINT>
 std::size_t CEnsemble<POINT>::estimateMemoryUsage(TMethodSize methodSize,
                                                   std::size_t numberMethodsPerModel,
                                                   bool computeFeatureInfluence,
+                                                  bool reduceDimension,
                                                   std::size_t totalNumberPoints,
                                                   std::size_t partitionNumberPoints,
                                                   std::size_t dimension) {
+    std::size_t reducedDimension{
+        computeReducedDimension(reduceDimension, totalNumberPoints, dimension)};
     std::size_t ensembleSize{computeEnsembleSize(numberMethodsPerModel,
-                                                 totalNumberPoints, dimension)};
+                                                 totalNumberPoints, reducedDimension)};
     std::size_t sampleSize{computeSampleSize(totalNumberPoints)};
     std::size_t numberModels{(ensembleSize + numberMethodsPerModel - 1) / numberMethodsPerModel};
     std::size_t maxNumberNeighbours{computeNumberNeighbours(sampleSize)};
-    std::size_t projectionDimension{computeProjectionDimension(sampleSize, dimension)};
+    std::size_t projectionDimension{computeProjectionDimension(sampleSize, reducedDimension)};
 
     std::size_t pointsMemory{
         partitionNumberPoints *
         (sizeof(TPoint) + common::las::estimateMemoryUsage<TPoint>(dimension))};
+    if (reducedDimension < dimension) {
+        pointsMemory += common::CSparseRandomProjection::estimateMemoryUsage(
+                            dimension, reducedDimension) +
+                        partitionNumberPoints *
+                            (sizeof(TVector) +
+                             common::las::estimateMemoryUsage<TVector>(reducedDimension));
+    }
     std::size_t scorersMemory{
         partitionNumberPoints *
         CScorer::estimateMemoryUsage(computeFeatureInfluence ? dimension : 0)};
-    std::size_t modelMemory{CModel::estimateMemoryUsage(
-        methodSize, sampleSize, maxNumberNeighbours, projectionDimension, dimension)};
+    std::size_t modelMemory{CModel::estimateMemoryUsage(methodSize, sampleSize, maxNumberNeighbours,
+                                                        projectionDimension,
+                                                        reducedDimension, dimension)};
     // The scores for a single method plus bookkeeping overhead for a single partition.
     std::size_t partitionScoringMemory{
         numberMethodsPerModel * partitionNumberPoints *
             (sizeof(TDouble1Vec) + (computeFeatureInfluence ? dimension * sizeof(double) : 0)) +
-        methodSize(maxNumberNeighbours, partitionNumberPoints, dimension)};
+        methodSize(maxNumberNeighbours, 0, partitionNumberPoints, dimension)};
 
     return pointsMemory + scorersMemory + numberModels * modelMemory + partitionScoringMemory;
 }
@@ -515,10 +639,12 @@ template<typename POINT>
 CEnsemble<POINT>::CModelBuilder::CModelBuilder(common::CPRNG::CXorOShiro128Plus& rng,
                                                TSizeSizePrVec&& methodsAndNumberNeighbours,
                                                std::size_t sampleSize,
-                                               TMatrix&& projection)
+                                               TMatrix&& projection,
+                                               TMatrix&& featureProjection)
     : m_MethodsAndNumberNeighbours{std::forward<TSizeSizePrVec>(methodsAndNumberNeighbours)},
       m_SampleSize{sampleSize}, m_Sampler{makeSampler(rng, sampleSize)},
-      m_Projection{std::forward<TMatrix>(projection)} {
+      m_Projection{std::forward<TMatrix>(projection)},
+      m_FeatureProjection{std::forward<TMatrix>(featureProjection)} {
 
     m_SampledProjectedPoints.reserve(m_Sampler.targetSampleSize());
 }
@@ -541,7 +667,8 @@ CEnsemble<POINT>::CModelBuilder::make(const TMethodFactoryVec& methodFactories)
     }
 
     return {methodFactories, std::move(m_MethodsAndNumberNeighbours),
-            std::move(m_SampledProjectedPoints), std::move(m_Projection)};
+            std::move(m_SampledProjectedPoints), std::move(m_Projection),
+            std::move(m_FeatureProjection)};
 }
 
 template<typename POINT>
@@ -551,9 +678,9 @@ CEnsemble<POINT>::CModelBuilder::makeSampler(common::CPRNG::CXorOShiro128Plus& r
     auto onSample = [this](std::size_t index, const TRowRef& row) {
         if (index >= m_SampledProjectedPoints.size()) {
             m_SampledProjectedPoints.emplace_back(
-                m_Projection * CDataFrameUtils::rowTo<POINT>(row));
+                this->featureProjection() * CDataFrameUtils::rowTo<POINT>(row));
         } else {
-            m_SampledProjectedPoints[index] = m_Projection *
+            m_SampledProjectedPoints[index] = this->featureProjection() *
                                               CDataFrameUtils::rowTo<POINT>(row);
         }
     };
@@ -700,8 +827,10 @@ template<typename POINT>
 CEnsemble<POINT>::CModel::CModel(const TMethodFactoryVec& methodFactories,
                                  TSizeSizePrVec methodsAndNumberNeighbours,
                                  TPointVec sample,
-                                 TMatrix projection)
-    : m_Lookup{std::make_unique<TKdTree>()}, m_Projection{std::move(projection)} {
+                                 TMatrix projection,
+                                 TMatrix featureProjection)
+    : m_Lookup{std::make_unique<TKdTree>()}, m_Projection{std::move(projection)},
+      m_FeatureProjection{std::move(featureProjection)} {
 
     m_Lookup->reserve(sample.size());
     m_Lookup->build(sample);
@@ -724,7 +853,8 @@ CEnsemble<POINT>::CModel::CModel(const TMethodFactoryVec& methodFactories,
 
     for (auto& method : methods) {
         method->progressRecorder().swap(noop);
-        TDouble1VecVec2Vec scores(method->run(sample, m_Projection, 0.0, sample.size()));
+        TDouble1VecVec2Vec scores(
+            method->run(sample, this->featureProjection(), 0.0, sample.size()));
         method->progressRecorder().swap(noop);
 
         m_LogScoreMoments.emplace_back();
@@ -745,7 +875,8 @@ void CEnsemble<POINT>::CModel::proportionOfRuntimePerMethod(double proportion) {
 }
 
 template<typename POINT>
-void CEnsemble<POINT>::CModel::addOutlierScores(const std::vector<POINT>& points,
+template<typename VECTOR>
+void CEnsemble<POINT>::CModel::addOutlierScores(const std::vector<VECTOR>& points,
                                                 TScorerVec& scores,
                                                 const TMemoryUsageCallback& recordMemoryUsage) const {
     // This index is used for addressing an array in the cache of nearest neighbour
@@ -768,10 +899,12 @@ void CEnsemble<POINT>::CModel::addOutlierScores(const std::vector<POINT>& points
     std::int64_t methodMemoryBeforeRun{signedMemoryUsage(m_Method)};
 
     // Run the method.
-    TDouble1VecVec2Vec methodScores(m_Method->run(points_, m_Projection, eps, index));
+    TDouble1VecVec2Vec methodScores(
+        m_Method->run(points_, this->featureProjection(), eps, index));
 
     std::int64_t methodMemoryAfterRun{signedMemoryUsage(m_Method)};
-    recordMemoryUsage(methodMemoryAfterRun - methodMemoryBeforeRun);
+    std::int64_t methodScoresMemory{signedMemoryUsage(methodScores)};
+    recordMemoryUsage(methodMemoryAfterRun - methodMemoryBeforeRun + methodScoresMemory);
 
     // Recover temporary memory.
     m_Method->recoverMemory();
@@ -789,7 +922,8 @@ void CEnsemble<POINT>::CModel::addOutlierScores(const std::vector<POINT>& points
         scores[i].add(m_LogScoreMoments, pointScores);
     }
 
-    recordMemoryUsage(signedMemoryUsage(scores) - scoresMemoryBeforeAdd - pointsMemory);
+    recordMemoryUsage(signedMemoryUsage(scores) - scoresMemoryBeforeAdd -
+                      pointsMemory - methodScoresMemory);
 }
 
 template<typename POINT>
@@ -797,18 +931,20 @@ std::size_t CEnsemble<POINT>::CModel::estimateMemoryUsage(TMethodSize methodSize
                                                           std::size_t sampleSize,
                                                           std::size_t numberNeighbours,
                                                           std::size_t projectionDimension,
+                                                          std::size_t reducedDimension,
                                                           std::size_t dimension) {
     std::size_t lookupMemory{TKdTree::estimateMemoryUsage(sampleSize, projectionDimension)};
-    std::size_t projectionMemory{projectionDimension * dimension *
-                                 sizeof(typename common::SCoordinate<TPoint>::Type)};
+    std::size_t projectionMemory{
+        projectionDimension * (reducedDimension + (reducedDimension < dimension ? dimension : 0)) *
+        sizeof(typename common::SCoordinate<TPoint>::Type)};
     return sizeof(CModel) + lookupMemory + projectionMemory +
-           methodSize(numberNeighbours, sampleSize, dimension);
+           methodSize(numberNeighbours, sampleSize, 0, dimension);
 }
 
 template<typename POINT>
 std::string CEnsemble<POINT>::CModel::print() const {
-    return "projection = " + std::to_string(m_Projection.rows()) + " x " +
-           std::to_string(m_Projection.cols()) + " method = " + m_Method->print() +
+    return "projection = " + std::to_string(this->featureProjection().rows()) + " x " +
+           std::to_string(this->featureProjection().cols()) + " method = " + m_Method->print() +
            " score moments = " + core::CContainerPrinter::print(m_LogScoreMoments);
 }
 
@@ -863,8 +999,12 @@ CEnsemble<POINT> buildEnsemble(const COutliers::SComputeParameters& params,
         methods.push_back(TSizeVec{static_cast<std::size_t>(params.s_Method)});
     }
 
+    common::CPRNG::CXorOShiro128Plus rng;
+    auto reduction = CEnsemble<POINT>::makeReduction(
+        params.s_ReduceDimension, frame.numberRows(), frame.numberColumns(), rng);
     auto builders = CEnsemble<POINT>::makeBuilders(
-        methods, frame.numberRows(), frame.numberColumns(), params.s_NumberNeighbours);
+        methods, frame.numberRows(), frame.numberColumns(),
+        params.s_NumberNeighbours, reduction.get(), rng);
 
     frame.readRows(1, [&builders](const TRowItr& beginRows, const TRowItr& endRows) {
         for (auto row = beginRows; row != endRows; ++row) {
@@ -876,7 +1016,8 @@ CEnsemble<POINT> buildEnsemble(const COutliers::SComputeParameters& params,
 
     return CEnsemble<POINT>{
         methodFactories<POINT>(params.s_ComputeFeatureInfluence, std::move(recordProgress)),
-        std::move(builders), std::move(recordMemoryUsage), std::move(recordStep)};
+        std::move(reduction), std::move(builders), std::move(recordMemoryUsage),
+        std::move(recordStep)};
 }
 
 bool computeOutliersNoPartitions(const COutliers::SComputeParameters& params,
@@ -1100,26 +1241,30 @@ std::size_t COutliers::estimateMemoryUsedByCompute(const SComputeParameters& par
                                                    std::size_t dimension) {
     using TLof = CLof<TAnnotatedPoint<POINT>, common::CKdTree<TAnnotatedPoint<POINT>>>;
 
-    auto methodSize = [=](std::size_t k, std::size_t numberPoints, std::size_t dimension) {
+    auto methodSize = [=](std::size_t k, std::size_t numberLookupPoints,
+                          std::size_t numberQueryPoints, std::size_t dimension) {
 
         k = params.s_NumberNeighbours > 0 ? params.s_NumberNeighbours : k;
 
+        // The points which aren't in the lookup are streamed.
+        std::size_t lofSize{
+            TLof::estimateOwnMemoryOverhead(params.s_ComputeFeatureInfluence, k,
+                                            numberLookupPoints, dimension) +
+            TLof::estimateOwnMemoryOverheadForQueries(numberQueryPoints)};
+
         if (params.s_Method == E_Ensemble) {
             // On average half of models use CLof.
-            return TLof::estimateOwnMemoryOverhead(params.s_ComputeFeatureInfluence,
-                                                   k, numberPoints, dimension) /
-                   2;
+            return lofSize / 2;
         }
         if (params.s_Method == E_Lof) {
-            return TLof::estimateOwnMemoryOverhead(params.s_ComputeFeatureInfluence,
-                                                   k, numberPoints, dimension);
+            return lofSize;
         }
         return std::size_t{0};
     };
     return CEnsemble<POINT>::estimateMemoryUsage(
         methodSize, params.s_Method == E_Ensemble ? 2 : 1 /*number methods*/,
-        params.s_ComputeFeatureInfluence, totalNumberPoints,
-        partitionNumberPoints, dimension);
+        params.s_ComputeFeatureInfluence, params.s_ReduceDimension,
+        totalNumberPoints, partitionNumberPoints, dimension);
 }
 
 void COutliers::noopRecordProgress(double) {
@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <numeric>
 #include <optional>
 
@@ -175,7 +176,8 @@ void outlierErrorStatisticsForEnsemble(std::size_t numberThreads,
             maths::analytics::COutliers::E_Ensemble,
             0,     // Compute number neighbours
             false, // Compute feature influences
-            0.05}; // Outlier fraction
+            0.05,  // Outlier fraction
+            true}; // Reduce dimension
         maths::analytics::COutliers::compute(params, *frame, instrumentation);
 
         frame->readRows(1, [&scores](const core::CDataFrame::TRowItr& beginRows,
@@ -279,6 +281,82 @@ BOOST_AUTO_TEST_CASE(testLof) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testLofStreaming) {
+
+    // Test the scores of points which aren't in the lookup, which are streamed,
+    // match the definition of local outlier factor.
+
+    using TAnnotatedPoint = maths::common::CAnnotatedVector<TPoint, std::size_t>;
+    using TAnnotatedPointVec = std::vector<TAnnotatedPoint>;
+    using TKdTree = maths::common::CKdTree<TAnnotatedPoint>;
+    using TLof = maths::analytics::outliers_detail::CLof<TAnnotatedPoint, TKdTree>;
+    using TMatrix = maths::common::CDenseMatrix<double>;
+
+    test::CRandomNumbers rng;
+    std::size_t numberInliers{200};
+    std::size_t numberOutliers{20};
+    std::size_t numberQueries{40};
+    TPointVec points;
+    gaussianWithUniformNoise(rng, numberInliers, numberOutliers, points);
+
+    TPointVec sample(points.begin(), points.end() - numberQueries);
+    TPointVec queries(points.end() - numberQueries, points.end());
+
+    TAnnotatedPointVec annotatedSample;
+    TAnnotatedPointVec annotatedQueries;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        (i < sample.size() ? annotatedSample : annotatedQueries).emplace_back(points[i], i);
+    }
+
+    for (std::size_t k : {5, 10}) {
+
+        TKdTree lookup;
+        lookup.build(annotatedSample);
+        TLof lof{false, k, [](double) {}, std::move(lookup)};
+        TMatrix projection{TMatrix::Identity(6, 6)};
+        lof.run(annotatedSample, projection, 0.0, sample.size());
+        std::size_t memoryBeforeQueries{lof.memoryUsage()};
+        auto scores = lof.run(annotatedQueries, projection, 0.0, points.size());
+
+        // The additional memory is independent of k.
+        BOOST_TEST_REQUIRE(lof.memoryUsage() - memoryBeforeQueries <=
+                           TLof::estimateOwnMemoryOverheadForQueries(numberQueries));
+
+        // The neighbours are copies so we look them up in the sample to be
+        // able to exclude them from their own neighbours.
+        auto inSample = [&](const TPoint& point) -> const TPoint& {
+            return *std::find(sample.begin(), sample.end(), point);
+        };
+        auto kdistance = [&](const TPoint& point) {
+            TPointVec neighbours;
+            nearestNeightbours(k, sample, point, neighbours);
+            return maths::common::las::distance(point, neighbours.back());
+        };
+        auto lrd = [&](const TPoint& point) {
+            TPointVec neighbours;
+            nearestNeightbours(k, sample, point, neighbours);
+            TMeanAccumulator reachability;
+            for (const auto& neighbour : neighbours) {
+                reachability.add(std::max(kdistance(inSample(neighbour)),
+                                          maths::common::las::distance(point, neighbour)));
+            }
+            return 1.0 / maths::common::CBasicStatistics::mean(reachability);
+        };
+
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            TPointVec neighbours;
+            nearestNeightbours(k, sample, queries[i], neighbours);
+            TMeanAccumulator neighbourhoodLrd;
+            for (const auto& neighbour : neighbours) {
+                neighbourhoodLrd.add(lrd(inSample(neighbour)));
+            }
+            double expected{maths::common::CBasicStatistics::mean(neighbourhoodLrd) /
+                            lrd(queries[i])};
+            BOOST_REQUIRE_CLOSE(expected, scores[0][sample.size() + i][0], 1e-8);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testDlof) {
 
     // Test against definition without projecting.
@@ -391,6 +469,57 @@ BOOST_AUTO_TEST_CASE(testTotalDistancekNN) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testHighDimensionalDistancekNN) {
+
+    // Test approximate nearest neighbour search for high dimensional points
+    // against the exact definition.
+
+    std::size_t dimension{40};
+    BOOST_TEST_REQUIRE(maths::analytics::COutliers::useApproximateNearestNeighbours(dimension));
+
+    test::CRandomNumbers rng;
+    std::size_t numberInliers{1000};
+    std::size_t numberOutliers{50};
+
+    TDoubleVec inliers;
+    rng.generateNormalSamples(0.0, 1.0, numberInliers * dimension, inliers);
+    TDoubleVec outliers;
+    rng.generateUniformSamples(-6.0, 6.0, numberOutliers * dimension, outliers);
+
+    TPointVec points(numberInliers + numberOutliers, TPoint(dimension));
+    for (std::size_t i = 0; i < inliers.size(); ++i) {
+        points[i / dimension](i % dimension) = inliers[i];
+    }
+    for (std::size_t i = 0; i < outliers.size(); ++i) {
+        points[numberInliers + i / dimension](i % dimension) = outliers[i];
+    }
+
+    TDoubleVec scores;
+    std::size_t k{10};
+    maths::analytics::COutliers::distancekNN(k, points, scores);
+
+    TMaxAccumulator outlierScores(numberOutliers);
+    std::size_t exact{0};
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        TPointVec neighbours;
+        nearestNeightbours(k, points, points[i], neighbours);
+        double distance{maths::common::las::distance(points[i], neighbours.back())};
+        // Missing neighbours can only increase the k-distance.
+        BOOST_TEST_REQUIRE(scores[i] >= distance - 1e-5);
+        exact += std::fabs(scores[i] - distance) < 1e-5 ? 1 : 0;
+        outlierScores.add({scores[i], i});
+    }
+
+    double recall{static_cast<double>(exact) / static_cast<double>(points.size())};
+    LOG_DEBUG(<< "recall = " << recall);
+    BOOST_TEST_REQUIRE(recall > 0.95);
+
+    // The outliers should have the highest scores.
+    for (const auto& score : outlierScores) {
+        BOOST_TEST_REQUIRE(score.second >= numberInliers);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testEnsemble) {
 
     // Check error stats for scores, 0.1, 0.5 and 0.9. We should see precision increase
@@ -536,7 +665,8 @@ BOOST_AUTO_TEST_CASE(testFeatureInfluences) {
                     maths::analytics::COutliers::E_Ensemble,
                     0,     // Compute number neighbours
                     true,  // Compute feature influences
-                    0.05}; // Outlier fraction
+                    0.05,  // Outlier fraction
+                    true}; // Reduce dimension
                 maths::analytics::COutliers::compute(params, *frame, instrumentation);
 
                 bool passed{true};
@@ -592,6 +722,75 @@ BOOST_AUTO_TEST_CASE(testFeatureInfluences) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testDimensionReduction) {
+
+    // Test that we find the outliers in high dimensional data and compute
+    // valid feature influences when we reduce the dimension of the points.
+
+    std::size_t dimension{500};
+    std::size_t numberInliers{1000};
+    std::size_t numberOutliers{20};
+
+    test::CRandomNumbers rng;
+
+    TDoubleVec inliers;
+    rng.generateNormalSamples(0.0, 1.0, numberInliers * dimension, inliers);
+    TDoubleVec outliers;
+    rng.generateUniformSamples(-4.0, 4.0, numberOutliers * dimension, outliers);
+
+    TPointVec points(numberInliers + numberOutliers, TPoint(dimension));
+    for (std::size_t i = 0; i < inliers.size(); ++i) {
+        points[i / dimension](i % dimension) = inliers[i];
+    }
+    for (std::size_t i = 0; i < outliers.size(); ++i) {
+        points[numberInliers + i / dimension](i % dimension) = outliers[i];
+    }
+
+    CTestInstrumentation instrumentation;
+
+    for (std::size_t numberPartitions : {1, 2}) {
+        for (bool reduceDimension : {false, true}) {
+            LOG_DEBUG(<< "# partitions = " << numberPartitions
+                      << ", reduce dimension = " << reduceDimension);
+
+            auto frame = test::CDataFrameTestUtils::toMainMemoryDataFrame(points);
+
+            maths::analytics::COutliers::SComputeParameters params{
+                1, // Number threads
+                numberPartitions,
+                true, // Standardize columns
+                maths::analytics::COutliers::E_Ensemble,
+                0,    // Compute number neighbours
+                true, // Compute feature influences
+                0.05, // Outlier fraction
+                reduceDimension};
+            maths::analytics::COutliers::compute(params, *frame, instrumentation);
+
+            TMaxAccumulator outlierScores(numberOutliers);
+            bool passed{true};
+            frame->readRows(1, [&](const core::CDataFrame::TRowItr& beginRows,
+                                   const core::CDataFrame::TRowItr& endRows) {
+                for (auto row = beginRows; row != endRows; ++row) {
+                    outlierScores.add({(*row)[dimension], row->index()});
+                    double sumInfluences{0.0};
+                    for (std::size_t i = 0; i < dimension; ++i) {
+                        sumInfluences += (*row)[dimension + 1 + i];
+                    }
+                    passed &= std::fabs(sumInfluences - 1.0) < 1e-5;
+                }
+            });
+            BOOST_TEST_REQUIRE(passed);
+
+            std::size_t correct{0};
+            for (const auto& score : outlierScores) {
+                correct += score.second >= numberInliers ? 1 : 0;
+            }
+            LOG_DEBUG(<< "# correct = " << correct);
+            BOOST_TEST_REQUIRE(correct >= numberOutliers - 1);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testEstimateMemoryUsedByCompute) {
 
     // Test that the memory estimated for compute is close to what it uses.
@@ -635,7 +834,8 @@ BOOST_AUTO_TEST_CASE(testEstimateMemoryUsedByCompute) {
             methods[i],
             numberNeighbours[i],
             computeFeatureInfluences[i],
-            0.05}; // Outlier fraction
+            0.05,  // Outlier fraction
+            true}; // Reduce dimension
 
         std::int64_t estimatedMemoryUsage(
             core::CDataFrame::estimateMemoryUsage(i == 0, 40500, 6, core::CAlignment::E_Aligned16) +
@@ -721,7 +921,8 @@ BOOST_AUTO_TEST_CASE(testProgressMonitoring) {
                 maths::analytics::COutliers::E_Ensemble,
                 0,     // Compute number neighbours
                 false, // Compute feature influences
-                0.05}; // Outlier fraction
+                0.05,  // Outlier fraction
+                true}; // Reduce dimension
             maths::analytics::COutliers::compute(params, *frame, instrumentation);
             finished.store(true);
         }};
@@ -780,7 +981,8 @@ BOOST_AUTO_TEST_CASE(testMostlyDuplicate) {
             maths::analytics::COutliers::E_Ensemble,
             0,     // Compute number neighbours
             false, // Compute feature influences
-            0.05}; // Outlier fraction
+            0.05,  // Outlier fraction
+            true}; // Reduce dimension
         maths::analytics::COutliers::compute(params, *frame, instrumentation);
 
         TDoubleVec outlierScores(outliers.size());
@@ -838,7 +1040,8 @@ BOOST_AUTO_TEST_CASE(testFewPoints) {
             maths::analytics::COutliers::E_Ensemble,
             0,     // Compute number neighbours
             true,  // Compute feature influences
-            0.05}; // Outlier fraction
+            0.05,  // Outlier fraction
+            true}; // Reduce dimension
         maths::analytics::COutliers::compute(params, *frame, instrumentation);
 
         bool passed{true};
@@ -285,6 +285,19 @@ double CModel::emptyBucketWeight(double occupancy) {
     return common::CTools::truncate(2.0 * occupancy, 1e-6, 1.0);
 }
 
+CModel::EUpdateResult CModel::addSamplesForBuckets(const TModelAddSamplesParamsVec& params,
+                                                  TTimeDouble2VecSizeTrVecVec samples) {
+    if (params.size() != samples.size()) {
+        LOG_ERROR(<< "Size mismatch: " << params.size() << " != " << samples.size());
+        return E_Failure;
+    }
+    EUpdateResult result{E_Success};
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        result = combine(result, this->addSamples(params[i], std::move(samples[i])));
+    }
+    return result;
+}
+
 const CModelParams& CModel::params() const {
     return m_Params;
 }
@@ -297,6 +310,21 @@ bool CModel::shouldPersist() const {
     return true;
 }
 
+bool CModel::isDormant() const {
+    return false;
+}
+
+std::size_t CModel::forecastMemoryUsage() const {
+    return this->memoryUsage();
+}
+
+CModel::EUpdateResult CModel::combine(EUpdateResult lhs, EUpdateResult rhs) {
+    if (lhs == E_Failure || rhs == E_Failure) {
+        return E_Failure;
+    }
+    return lhs == E_Reset || rhs == E_Reset ? E_Reset : E_Success;
+}
+
 //////// CModelStub ////////
 
 CModelStub::CModelStub() : CModel(stubParameters()) {
@@ -0,0 +1,80 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <maths/common/CSparseRandomProjection.h>
+
+#include <core/CMemoryDef.h>
+
+#include <maths/common/CSampling.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ml {
+namespace maths {
+namespace common {
+
+CSparseRandomProjection::CSparseRandomProjection(CPRNG::CXorOShiro128Plus& rng,
+                                                 std::size_t inputDimension,
+                                                 std::size_t outputDimension)
+    : m_InputDimension{inputDimension},
+      m_Scale{std::sqrt(3.0 / static_cast<double>(std::max(outputDimension, std::size_t{1})))} {
+
+    m_RowBegins.reserve(outputDimension + 1);
+    m_NegativeBegins.reserve(outputDimension);
+    m_Indices.reserve(inputDimension * outputDimension / 3);
+
+    // Each element is +1 with probability 1/6, -1 with probability 1/6 and
+    // 0 otherwise.
+
+    std::vector<std::size_t> signs;
+    TUInt32Vec negative;
+    m_RowBegins.push_back(0);
+    for (std::size_t i = 0; i < outputDimension; ++i) {
+        CSampling::uniformSample(rng, std::size_t{0}, std::size_t{6}, inputDimension, signs);
+        negative.clear();
+        for (std::size_t j = 0; j < inputDimension; ++j) {
+            if (signs[j] == 0) {
+                m_Indices.push_back(static_cast<std::uint32_t>(j));
+            } else if (signs[j] == 1) {
+                negative.push_back(static_cast<std::uint32_t>(j));
+            }
+        }
+        m_NegativeBegins.push_back(m_Indices.size());
+        m_Indices.insert(m_Indices.end(), negative.begin(), negative.end());
+        m_RowBegins.push_back(m_Indices.size());
+    }
+    m_Indices.shrink_to_fit();
+}
+
+std::size_t CSparseRandomProjection::targetDimension(std::size_t numberPoints, double distortion) {
+    double n{static_cast<double>(std::max(numberPoints, std::size_t{2}))};
+    double eps2{distortion * distortion};
+    return static_cast<std::size_t>(
+        std::ceil(4.0 * std::log(n) / (eps2 / 2.0 - eps2 * distortion / 3.0)));
+}
+
+std::size_t CSparseRandomProjection::memoryUsage() const {
+    std::size_t mem{core::memory::dynamicSize(m_RowBegins)};
+    mem += core::memory::dynamicSize(m_NegativeBegins);
+    mem += core::memory::dynamicSize(m_Indices);
+    return mem;
+}
+
+std::size_t CSparseRandomProjection::estimateMemoryUsage(std::size_t inputDimension,
+                                                         std::size_t outputDimension) {
+    // On average one third of the elements are non-zero.
+    return (2 * outputDimension + 1) * sizeof(std::size_t) +
+           (inputDimension * outputDimension / 3) * sizeof(std::uint32_t);
+}
+}
+}
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CLogger.h>
+#include <core/CMemoryDefStd.h>
+#include <core/Concurrency.h>
+
+#include <maths/common/CBasicStatistics.h>
+#include <maths/common/CHnsw.h>
+#include <maths/common/CLinearAlgebra.h>
+#include <maths/common/CLinearAlgebraEigen.h>
+#include <maths/common/CLinearAlgebraTools.h>
+
+#include <test/CRandomNumbers.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CHnswTest)
+
+using namespace ml;
+
+namespace {
+using TDoubleVec = std::vector<double>;
+using TVector = maths::common::CDenseVector<double>;
+using TVectorVec = std::vector<TVector>;
+using TVectorVecVec = std::vector<TVectorVec>;
+using TMeanAccumulator = maths::common::CBasicStatistics::SSampleMean<double>::TAccumulator;
+
+TVectorVec clusteredPoints(test::CRandomNumbers& rng,
+                           std::size_t numberClusters,
+                           std::size_t numberPoints,
+                           std::size_t dimension) {
+    TDoubleVec centres;
+    rng.generateUniformSamples(-10.0, 10.0, numberClusters * dimension, centres);
+
+    TVectorVec result;
+    result.reserve(numberPoints);
+    TDoubleVec noise;
+    for (std::size_t i = 0; i < numberPoints; ++i) {
+        rng.generateNormalSamples(0.0, 4.0, dimension, noise);
+        std::size_t cluster{i % numberClusters};
+        TVector point(dimension);
+        for (std::size_t j = 0; j < dimension; ++j) {
+            point(j) = centres[cluster * dimension + j] + noise[j];
+        }
+        result.push_back(std::move(point));
+    }
+    return result;
+}
+
+TVectorVec nearestNeighbours(std::size_t k, const TVectorVec& points, const TVector& point) {
+    using TDoubleSizePr = std::pair<double, std::size_t>;
+    using TMinDoubleSizePrAccumulator =
+        maths::common::CBasicStatistics::COrderStatisticsHeap<TDoubleSizePr>;
+
+    TMinDoubleSizePrAccumulator nearest(k);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        nearest.add({maths::common::las::distance(point, points[i]), i});
+    }
+    nearest.sort();
+
+    TVectorVec result;
+    for (const auto& neighbour : nearest) {
+        result.push_back(points[neighbour.second]);
+    }
+    return result;
+}
+
+double recall(const TVectorVec& expected, const TVectorVec& actual) {
+    std::size_t matched{0};
+    for (const auto& point : actual) {
+        matched += std::count(expected.begin(), expected.end(), point) > 0 ? 1 : 0;
+    }
+    return static_cast<double>(matched) / static_cast<double>(expected.size());
+}
+}
+
+BOOST_AUTO_TEST_CASE(testBuild) {
+
+    // Check the graph invariants hold for a range of sizes.
+
+    test::CRandomNumbers rng;
+
+    for (std::size_t n : {1, 2, 5, 40, 300, 1000}) {
+        TVectorVec points(clusteredPoints(rng, 5, n, 10));
+
+        maths::common::CHnsw<TVector> hnsw;
+        hnsw.build(points);
+        BOOST_REQUIRE_EQUAL(n, hnsw.size());
+        BOOST_TEST_REQUIRE(hnsw.checkInvariants());
+
+        // The order of the points is preserved.
+        BOOST_TEST_REQUIRE(std::equal(points.begin(), points.end(), hnsw.begin()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testNearestNeighbours) {
+
+    // Test the recall compared to an exact search in high dimensions.
+
+    test::CRandomNumbers rng;
+
+    std::size_t k{10};
+
+    for (std::size_t dimension : {20, 50}) {
+        TVectorVec points(clusteredPoints(rng, 10, 2100, dimension));
+        TVectorVec queries(points.begin() + 2000, points.end());
+        points.resize(2000);
+
+        maths::common::CHnsw<TVector> hnsw;
+        hnsw.build(points);
+        BOOST_TEST_REQUIRE(hnsw.checkInvariants());
+
+        TMeanAccumulator meanRecall;
+        TVectorVec neighbours;
+        for (const auto& query : queries) {
+            hnsw.nearestNeighbours(k, query, neighbours);
+            BOOST_REQUIRE_EQUAL(k, neighbours.size());
+            for (std::size_t i = 1; i < neighbours.size(); ++i) {
+                BOOST_TEST_REQUIRE(maths::common::las::distance(query, neighbours[i - 1]) <=
+                                   maths::common::las::distance(query, neighbours[i]));
+            }
+            meanRecall.add(recall(nearestNeighbours(k, points, query), neighbours));
+        }
+
+        LOG_DEBUG(<< "dimension = " << dimension << " mean recall = "
+                  << maths::common::CBasicStatistics::mean(meanRecall));
+        BOOST_TEST_REQUIRE(maths::common::CBasicStatistics::mean(meanRecall) > 0.95);
+    }
+
+    // Requesting at least as many neighbours as there are points is exact.
+
+    TVectorVec points(clusteredPoints(rng, 2, 20, 30));
+    maths::common::CHnsw<TVector> hnsw;
+    hnsw.build(points);
+    TVectorVec neighbours;
+    hnsw.nearestNeighbours(25, points[0], neighbours);
+    BOOST_REQUIRE_EQUAL(points.size(), neighbours.size());
+    BOOST_TEST_REQUIRE(recall(nearestNeighbours(20, points, points[0]), neighbours) == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(testParallel) {
+
+    // Test that the graph built and the batched queries are independent of
+    // the number of threads.
+
+    test::CRandomNumbers rng;
+
+    std::size_t k{5};
+    TVectorVec points(clusteredPoints(rng, 8, 1700, 32));
+    TVectorVec queries(points.begin() + 1500, points.end());
+    points.resize(1500);
+
+    maths::common::CHnsw<TVector> serial;
+    serial.build(points);
+    TVectorVecVec expected(queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        serial.nearestNeighbours(k, queries[i], expected[i]);
+    }
+
+    core::startDefaultAsyncExecutor(4);
+
+    maths::common::CHnsw<TVector> parallel;
+    parallel.build(points);
+    BOOST_TEST_REQUIRE(parallel.checkInvariants());
+    TVectorVecVec actual;
+    parallel.nearestNeighbours(k, queries, actual);
+
+    core::stopDefaultAsyncExecutor();
+
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        BOOST_TEST_REQUIRE(expected[i] == actual[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMemoryUsage) {
+
+    // Test the estimated memory usage is close to the actual memory usage.
+
+    test::CRandomNumbers rng;
+
+    for (std::size_t dimension : {10, 40}) {
+        TVectorVec points(clusteredPoints(rng, 5, 1000, dimension));
+
+        maths::common::CHnsw<TVector> hnsw;
+        hnsw.build(points);
+
+        std::size_t estimated{
+            maths::common::CHnsw<TVector>::estimateMemoryUsage(1000, dimension)};
+        std::size_t actual{hnsw.memoryUsage()};
+        LOG_DEBUG(<< "estimated = " << estimated << ", actual = " << actual);
+        BOOST_TEST_REQUIRE(estimated > actual / 2);
+        BOOST_TEST_REQUIRE(estimated < 2 * actual);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -37,6 +37,7 @@ using TDoubleVector5Pr = std::pair<double, TVector5>;
 using TDoubleVector5PrVec = std::vector<TDoubleVector5Pr>;
 using TVector5Vec = std::vector<TVector5>;
 using TVector = maths::common::CVector<double>;
+using TVectorVec = std::vector<TVector>;
 
 class CVectorCountMoves : public TVector {
 public:
@@ -252,6 +253,57 @@ BOOST_AUTO_TEST_CASE(testNearestNeighbours) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testBatchedNearestNeighbours) {
+
+    // Test batched queries match brute force for a range of tree sizes either
+    // side of the leaf bucket size.
+
+    test::CRandomNumbers rng;
+
+    for (std::size_t n : {5, 20, 32, 33, 64, 100, 1000}) {
+        TDoubleVec samples;
+        rng.generateUniformSamples(-100.0, 100.0, 10 * n, samples);
+
+        TVectorVec points;
+        for (std::size_t j = 0; j < samples.size(); j += 10) {
+            points.emplace_back(&samples[j], &samples[j + 10]);
+        }
+
+        maths::common::CKdTree<TVector> kdTree;
+        kdTree.build(points);
+        BOOST_TEST_REQUIRE(kdTree.checkInvariants());
+
+        rng.generateUniformSamples(-100.0, 100.0, 10 * 20, samples);
+
+        TVectorVec tests;
+        for (std::size_t j = 0; j < samples.size(); j += 10) {
+            tests.emplace_back(&samples[j], &samples[j + 10]);
+        }
+
+        for (std::size_t k : {1, 5, 40}) {
+            std::vector<TVectorVec> neighbours;
+            kdTree.nearestNeighbours(k, tests.begin(), tests.end(), neighbours);
+            BOOST_REQUIRE_EQUAL(tests.size(), neighbours.size());
+
+            for (std::size_t j = 0; j < tests.size(); ++j) {
+                std::vector<std::pair<double, TVector>> expectedNeighbours;
+                nearestNeightbours(k, points, tests[j], expectedNeighbours);
+
+                BOOST_REQUIRE_EQUAL(expectedNeighbours.size(), neighbours[j].size());
+                for (std::size_t l = 0; l < expectedNeighbours.size(); ++l) {
+                    BOOST_REQUIRE_EQUAL(print(expectedNeighbours[l].second),
+                                        print(neighbours[j][l]));
+                }
+
+                TVectorVec neighbours_;
+                kdTree.nearestNeighbours(k, tests[j], neighbours_);
+                BOOST_REQUIRE_EQUAL(core::CContainerPrinter::print(neighbours_),
+                                    core::CContainerPrinter::print(neighbours[j]));
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testRequestingEveryPoint) {
 
     test::CRandomNumbers rng;
@@ -0,0 +1,191 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CLogger.h>
+#include <core/CMemoryDefStd.h>
+
+#include <maths/common/CBasicStatistics.h>
+#include <maths/common/CLinearAlgebraEigen.h>
+#include <maths/common/CPRNG.h>
+#include <maths/common/CSparseRandomProjection.h>
+
+#include <test/CRandomNumbers.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CSparseRandomProjectionTest)
+
+using namespace ml;
+
+namespace {
+using TDoubleVec = std::vector<double>;
+using TVector = maths::common::CDenseVector<double>;
+using TVectorVec = std::vector<TVector>;
+using TMatrix = maths::common::CDenseMatrix<double>;
+using TMeanAccumulator = maths::common::CBasicStatistics::SSampleMean<double>::TAccumulator;
+
+TMatrix dense(const maths::common::CSparseRandomProjection& projection) {
+    TMatrix result(projection.outputDimension(), projection.inputDimension());
+    TVector e{TVector::Zero(projection.inputDimension())};
+    TVector column(projection.outputDimension());
+    for (std::size_t i = 0; i < projection.inputDimension(); ++i) {
+        e(i) = 1.0;
+        projection.project(e, column);
+        result.col(i) = column;
+        e(i) = 0.0;
+    }
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testTargetDimension) {
+
+    // Check the dimension matches the Johnson-Lindenstrauss bound and
+    // behaves as expected as a function of the number of points and the
+    // distortion.
+
+    BOOST_REQUIRE_EQUAL(
+        static_cast<std::size_t>(std::ceil(4.0 * std::log(1000.0) / (0.125 - 0.125 / 3.0))),
+        maths::common::CSparseRandomProjection::targetDimension(1000, 0.5));
+
+    std::size_t last{0};
+    for (std::size_t n : {10, 100, 1000, 10000, 100000}) {
+        std::size_t dimension{maths::common::CSparseRandomProjection::targetDimension(n, 0.5)};
+        BOOST_TEST_REQUIRE(dimension > last);
+        last = dimension;
+    }
+    BOOST_TEST_REQUIRE(maths::common::CSparseRandomProjection::targetDimension(1000, 0.2) >
+                       maths::common::CSparseRandomProjection::targetDimension(1000, 0.5));
+}
+
+BOOST_AUTO_TEST_CASE(testSparsity) {
+
+    // Check that the elements are +/- sqrt(3 / m) with probability 1/6 and
+    // zero otherwise.
+
+    maths::common::CPRNG::CXorOShiro128Plus rng;
+
+    std::size_t m{50};
+    maths::common::CSparseRandomProjection projection{rng, 600, m};
+    BOOST_REQUIRE_EQUAL(600, projection.inputDimension());
+    BOOST_REQUIRE_EQUAL(m, projection.outputDimension());
+
+    TMatrix matrix{dense(projection)};
+
+    double scale{std::sqrt(3.0 / static_cast<double>(m))};
+    TMeanAccumulator positive;
+    TMeanAccumulator negative;
+    for (std::ptrdiff_t i = 0; i < matrix.rows(); ++i) {
+        for (std::ptrdiff_t j = 0; j < matrix.cols(); ++j) {
+            double x{matrix(i, j)};
+            BOOST_TEST_REQUIRE((x == 0.0 || std::fabs(std::fabs(x) - scale) < 1e-12));
+            positive.add(x > 0.0 ? 1.0 : 0.0);
+            negative.add(x < 0.0 ? 1.0 : 0.0);
+        }
+    }
+    LOG_DEBUG(<< "P(+) = " << maths::common::CBasicStatistics::mean(positive)
+              << ", P(-) = " << maths::common::CBasicStatistics::mean(negative));
+    BOOST_REQUIRE_CLOSE_FRACTION(1.0 / 6.0, maths::common::CBasicStatistics::mean(positive), 0.05);
+    BOOST_REQUIRE_CLOSE_FRACTION(1.0 / 6.0, maths::common::CBasicStatistics::mean(negative), 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(testDistancePreservation) {
+
+    // Check that the pairwise distances are preserved to within the target
+    // distortion.
+
+    test::CRandomNumbers rng;
+    maths::common::CPRNG::CXorOShiro128Plus prng;
+
+    std::size_t n{200};
+    std::size_t d{2000};
+    double distortion{0.5};
+    std::size_t m{maths::common::CSparseRandomProjection::targetDimension(n, distortion)};
+    LOG_DEBUG(<< "target dimension = " << m);
+
+    TVectorVec points;
+    TDoubleVec coordinates;
+    for (std::size_t i = 0; i < n; ++i) {
+        rng.generateNormalSamples(0.0, 1.0, d, coordinates);
+        TVector point(d);
+        for (std::size_t j = 0; j < d; ++j) {
+            point(j) = coordinates[j];
+        }
+        points.push_back(std::move(point));
+    }
+
+    maths::common::CSparseRandomProjection projection{prng, d, m};
+    TVectorVec projected(n, TVector(m));
+    for (std::size_t i = 0; i < n; ++i) {
+        projection.project(points[i], projected[i]);
+    }
+
+    TMeanAccumulator meanRatio;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+            double ratio{(projected[i] - projected[j]).squaredNorm() /
+                         (points[i] - points[j]).squaredNorm()};
+            BOOST_TEST_REQUIRE(ratio > 1.0 - distortion);
+            BOOST_TEST_REQUIRE(ratio < 1.0 + distortion);
+            meanRatio.add(ratio);
+        }
+    }
+    LOG_DEBUG(<< "mean ratio = " << maths::common::CBasicStatistics::mean(meanRatio));
+    BOOST_REQUIRE_CLOSE_FRACTION(1.0, maths::common::CBasicStatistics::mean(meanRatio), 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(testCompose) {
+
+    // Check composing with a dense matrix matches the dense product.
+
+    test::CRandomNumbers rng;
+    maths::common::CPRNG::CXorOShiro128Plus prng;
+
+    maths::common::CSparseRandomProjection projection{prng, 100, 20};
+
+    TDoubleVec elements;
+    rng.generateNormalSamples(0.0, 1.0, 5 * 20, elements);
+    TMatrix lhs(5, 20);
+    for (std::size_t i = 0; i < 5; ++i) {
+        for (std::size_t j = 0; j < 20; ++j) {
+            lhs(i, j) = elements[20 * i + j];
+        }
+    }
+
+    TMatrix expected{lhs * dense(projection)};
+    TMatrix actual{projection.compose(lhs)};
+
+    BOOST_REQUIRE_EQUAL(expected.rows(), actual.rows());
+    BOOST_REQUIRE_EQUAL(expected.cols(), actual.cols());
+    BOOST_TEST_REQUIRE((expected - actual).norm() < 1e-10 * expected.norm());
+}
+
+BOOST_AUTO_TEST_CASE(testMemoryUsage) {
+
+    // Test the estimated memory usage is close to the actual memory usage.
+
+    maths::common::CPRNG::CXorOShiro128Plus rng;
+
+    for (std::size_t d : {100, 1000}) {
+        maths::common::CSparseRandomProjection projection{rng, d, 60};
+        std::size_t estimated{
+            maths::common::CSparseRandomProjection::estimateMemoryUsage(d, 60)};
+        std::size_t actual{projection.memoryUsage()};
+        LOG_DEBUG(<< "estimated = " << estimated << ", actual = " << actual);
+        BOOST_TEST_REQUIRE(estimated > (9 * actual) / 10);
+        BOOST_TEST_REQUIRE(estimated < (11 * actual) / 10);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
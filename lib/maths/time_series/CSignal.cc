@@ -52,37 +52,116 @@ void scale(double scale, TComplexVec& f) {
     }
 }
 
+//! Check if \p n is a power of 2.
+bool isPow2(std::size_t n) {
+    return (n & (n - 1)) == 0;
+}
+
+//! Get the twiddle factors \f$e^{-2\pi i k / m}\f$ for \f$k < m/2\f$ where m is
+//! the largest power of 2 at least \p n for which they've been computed.
+//!
+//! \note The factors for any smaller power of 2 are a strided subset of these.
+//! Each thread has its own copy so it is safe to call this concurrently.
+const TComplexVec& twiddles(std::size_t n) {
+    thread_local TComplexVec result;
+    if (2 * result.size() < n) {
+        result.resize(n / 2);
+        for (std::size_t k = 0; k < result.size(); ++k) {
+            double t{-boost::math::double_constants::two_pi *
+                     static_cast<double>(k) / static_cast<double>(n)};
+            result[k] = TComplex{std::cos(t), std::sin(t)};
+        }
+    }
+    return result;
+}
+
+//! \brief The state for Bluestein's algorithm which only depends on the length.
+struct SBluestein {
+    std::size_t s_Length = 0;
+    //! The chirp \f$e^{\pi i k^2 / n}\f$.
+    TComplexVec s_Chirp;
+    //! The DFT of the chirp padded to a power of 2.
+    TComplexVec s_ChirpDft;
+};
+
 //! Compute the radix 2 FFT of \p f in-place.
 void radix2fft(TComplexVec& f) {
+    std::size_t n{f.size()};
+    if (n < 2) {
+        return;
+    }
+
     // Perform the appropriate permutation of f(x) by swapping each i in [0, N]
     // with its bit reversal.
 
-    std::uint64_t bits = common::CIntegerTools::nextPow2(f.size()) - 1;
-    for (std::uint64_t i = 0; i < f.size(); ++i) {
+    std::uint64_t bits = common::CIntegerTools::nextPow2(n) - 1;
+    for (std::uint64_t i = 0; i < n; ++i) {
         std::uint64_t j{common::CIntegerTools::reverseBits(i) >> (64 - bits)};
         if (j > i) {
-            LOG_TRACE(<< j << " -> " << i);
             std::swap(f[i], f[j]);
         }
     }
 
-    // Apply the twiddle factors.
+    // The first pass doesn't need any twiddle factors.
 
-    for (std::size_t stride = 1; stride < f.size(); stride <<= 1) {
-        for (std::size_t k = 0; k < stride; ++k) {
-            double t{boost::math::double_constants::pi *
-                     static_cast<double>(k) / static_cast<double>(stride)};
-            TComplex w(std::cos(t), std::sin(t));
-            for (std::size_t start = k; start + stride < f.size(); start += 2 * stride) {
-                TComplex fs{f[start]};
-                TComplex tw{w * f[start + stride]};
-                f[start] = fs + tw;
-                f[start + stride] = fs - tw;
+    for (std::size_t start = 0; start < n; start += 2) {
+        TComplex fs{f[start]};
+        f[start] = fs + f[start + 1];
+        f[start + 1] = fs - f[start + 1];
+    }
+
+    // Apply the twiddle factors. We iterate over blocks in the outer loop so
+    // the inner loop reads f contiguously.
+
+    const TComplexVec& w{twiddles(n)};
+    std::size_t m{2 * w.size()};
+    for (std::size_t stride = 2; stride < n; stride <<= 1) {
+        std::size_t step{m / (2 * stride)};
+        for (std::size_t start = 0; start < n; start += 2 * stride) {
+            TComplex* lower{&f[start]};
+            TComplex* upper{&f[start + stride]};
+            for (std::size_t k = 0; k < stride; ++k) {
+                TComplex fs{lower[k]};
+                TComplex tw{w[k * step] * upper[k]};
+                lower[k] = fs + tw;
+                upper[k] = fs - tw;
             }
         }
     }
+}
 
-    std::reverse(f.begin() + 1, f.end());
+//! Compute the inverse radix 2 FFT of \p f in-place.
+void radix2ifft(TComplexVec& f) {
+    CSignal::conj(f);
+    radix2fft(f);
+    CSignal::conj(f);
+    scale(1.0 / static_cast<double>(f.size()), f);
+}
+
+//! Get the state for Bluestein's algorithm for length \p n.
+//!
+//! \note Each thread caches the state for the last length it used, since we
+//! typically compute many transforms of the same length.
+const SBluestein& bluestein(std::size_t n) {
+    thread_local SBluestein result;
+    if (result.s_Length != n) {
+        std::size_t m{std::size_t{1} << common::CIntegerTools::nextPow2(2 * n - 1)};
+        result.s_Length = n;
+        result.s_Chirp.resize(n);
+        result.s_ChirpDft.assign(m, TComplex{0.0, 0.0});
+        for (std::size_t i = 0; i < n; ++i) {
+            // Reduce k^2 modulo 2n to avoid losing precision for large k.
+            double t{boost::math::double_constants::pi *
+                     static_cast<double>((i * i) % (2 * n)) / static_cast<double>(n)};
+            result.s_Chirp[i] = TComplex{std::cos(t), std::sin(t)};
+            result.s_ChirpDft[i] = result.s_Chirp[i];
+            if (i > 0) {
+                result.s_ChirpDft[m - i] = result.s_Chirp[i];
+            }
+        }
+        radix2fft(result.s_ChirpDft);
+    }
+    return result;
 }
 }
 
@@ -100,10 +179,8 @@ void CSignal::hadamard(const TComplexVec& fx, TComplexVec& fy) {
 
 void CSignal::fft(TComplexVec& f) {
     std::size_t n{f.size()};
-    std::size_t p{common::CIntegerTools::nextPow2(n)};
-    std::size_t m{std::size_t{1} << p};
 
-    if ((m >> 1) == n) {
+    if (isPow2(n)) {
         radix2fft(f);
     } else {
         // We use Bluestein's trick to reformulate as a convolution which can be
@@ -111,33 +188,20 @@ void CSignal::fft(TComplexVec& f) {
 
         LOG_TRACE(<< "Using Bluestein's trick");
 
-        m = 2 * n - 1;
-        p = common::CIntegerTools::nextPow2(m);
-        m = std::size_t{1} << p;
-
-        TComplexVec chirp;
-        chirp.reserve(n);
-        TComplexVec a(m, TComplex{0.0, 0.0});
-        TComplexVec b(m, TComplex{0.0, 0.0});
-
-        chirp.emplace_back(1.0, 0.0);
-        a[0] = f[0] * chirp[0];
-        b[0] = chirp[0];
-        for (std::size_t i = 1; i < n; ++i) {
-            double t = boost::math::double_constants::pi *
-                       static_cast<double>(i * i) / static_cast<double>(n);
-            chirp.emplace_back(std::cos(t), std::sin(t));
+        const SBluestein& state{bluestein(n)};
+        const TComplexVec& chirp{state.s_Chirp};
+
+        TComplexVec a(state.s_ChirpDft.size(), TComplex{0.0, 0.0});
+        for (std::size_t i = 0; i < n; ++i) {
             a[i] = f[i] * std::conj(chirp[i]);
-            b[i] = b[m - i] = chirp[i];
         }
 
-        fft(a);
-        fft(b);
-        hadamard(a, b);
-        ifft(b);
+        radix2fft(a);
+        hadamard(state.s_ChirpDft, a);
+        radix2ifft(a);
 
         for (std::size_t i = 0; i < n; ++i) {
-            f[i] = std::conj(chirp[i]) * b[i];
+            f[i] = std::conj(chirp[i]) * a[i];
         }
     }
 }
@@ -149,6 +213,53 @@ void CSignal::ifft(TComplexVec& f) {
     scale(1.0 / static_cast<double>(f.size()), f);
 }
 
+void CSignal::realFft(TComplexVec& f) {
+    std::size_t n{f.size()};
+
+    if (n % 2 == 1) {
+        for (auto& fi : f) {
+            fi = TComplex{fi.real(), 0.0};
+        }
+        fft(f);
+        return;
+    }
+
+    // We pack the even and odd terms into the real and imaginary parts of
+    // a sequence of half the length, transform it and then separate the
+    // transforms of the even and odd terms using the symmetry of the DFT
+    // of a real sequence.
+
+    std::size_t h{n / 2};
+    TComplexVec z(h);
+    for (std::size_t i = 0; i < h; ++i) {
+        z[i] = TComplex{f[2 * i].real(), f[2 * i + 1].real()};
+    }
+    fft(z);
+
+    const TComplexVec* w{isPow2(n) ? &twiddles(n) : nullptr};
+    std::size_t step{w != nullptr ? 2 * w->size() / n : 0};
+    for (std::size_t k = 0; k <= h; ++k) {
+        TComplex zk{z[k % h]};
+        TComplex zc{std::conj(z[(h - k) % h])};
+        TComplex even{0.5 * (zk + zc)};
+        TComplex odd{TComplex{0.0, -0.5} * (zk - zc)};
+        TComplex wk;
+        if (k == h) {
+            wk = TComplex{-1.0, 0.0};
+        } else if (w != nullptr) {
+            wk = (*w)[k * step];
+        } else {
+            double t{-boost::math::double_constants::two_pi *
+                     static_cast<double>(k) / static_cast<double>(n)};
+            wk = TComplex{std::cos(t), std::sin(t)};
+        }
+        f[k] = even + wk * odd;
+        if (k > 0 && k < h) {
+            f[n - k] = std::conj(f[k]);
+        }
+    }
+}
+
 double CSignal::cyclicAutocorrelation(const SSeasonalComponentSummary& period,
                                       const TFloatMeanAccumulatorVec& values,
                                       const TMomentTransformFunc& tranform,
@@ -242,15 +353,18 @@ void CSignal::autocorrelations(const TFloatMeanAccumulatorVec& values,
         f[i] = TComplex{common::CBasicStatistics::mean(values[i]) - mean, 0.0};
     }
 
-    fft(f);
-    TComplexVec fConj(f);
-    conj(fConj);
-    hadamard(fConj, f);
-    ifft(f);
+    // The power spectrum is real and even so its inverse transform is equal
+    // to its transform divided by n.
+    realFft(f);
+    for (auto& fi : f) {
+        fi = TComplex{std::norm(fi), 0.0};
+    }
+    realFft(f);
 
     result.reserve(n);
+    double normalizer{variance * static_cast<double>(n) * static_cast<double>(n)};
     for (std::size_t i = 1; i < n; ++i) {
-        result.push_back(f[i].real() / variance / static_cast<double>(n));
+        result.push_back(f[i].real() / normalizer);
     }
 }
 
@@ -300,6 +414,11 @@ CSignal::seasonalDecomposition(const TFloatMeanAccumulatorVec& values,
         }
     }
 
+    std::size_t paddedLength{std::size_t{1}
+                             << common::CIntegerTools::nextPow2(n + 3 * pad - 1)};
+    double paddingScale{static_cast<double>(paddedLength) /
+                        static_cast<double>(n + 3 * pad)};
+
     TDoubleVec correlations;
     TComplexVec placeholder;
     TFloatMeanAccumulatorVec valuesToTest{values.begin(), values.begin() + n};
@@ -332,11 +451,16 @@ CSignal::seasonalDecomposition(const TFloatMeanAccumulatorVec& values,
         }
 
         // Compute the serial autocorrelations padding to the maximum offset to
-        // avoid windowing effects.
-        valuesToTest.resize(n + 3 * pad);
+        // avoid windowing effects. We pad further to a power of 2, which is much
+        // cheaper to transform, and rescale to undo the normalization by the
+        // extra zeros. The offsets we use are unaffected by the extra padding.
+        valuesToTest.resize(paddedLength);
         autocorrelations(valuesToTest, placeholder, correlations);
         valuesToTest.resize(n);
         correlations.resize(std::max(3 * pad, periods.back()));
+        for (auto& correlation : correlations) {
+            correlation *= paddingScale;
+        }
 
         // In order to handle with smooth varying functions whose autocorrelation
         // is high for small offsets we perform an average the serial correlations
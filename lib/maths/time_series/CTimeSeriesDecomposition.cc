@@ -217,50 +217,37 @@ void CTimeSeriesDecomposition::addPoint(core_t::TTime time,
     CComponents::CScopeAttachComponentChangeCallback attach{
         m_Components, componentChangeCallback, modelAnnotationCallback};
 
-    time += m_TimeShift;
+    this->addValue(time, value, weights, occupancy, firstValueTime,
+                   this->makeAddValueFunctions());
+}
 
-    core_t::TTime lastTime{std::max(m_LastValueTime, m_LastPropagationTime)};
+void CTimeSeriesDecomposition::addPoints(const TTimeDoublePrVec& values,
+                                         const TDoubleWeightsAryVec& weights,
+                                         const TComponentChangeCallback& componentChangeCallback,
+                                         const maths_t::TModelAnnotationCallback& modelAnnotationCallback,
+                                         double occupancy,
+                                         core_t::TTime firstValueTime) {
 
-    m_LastValueTime = std::max(m_LastValueTime, time);
-    this->propagateForwardsTo(time);
+    if (weights.empty() == false && weights.size() != values.size()) {
+        LOG_ERROR(<< "Weights mismatch: " << weights.size() << " != " << values.size());
+        return;
+    }
 
-    auto testForSeasonality = m_Components.makeTestForSeasonality([this] {
-        auto predictor_ = this->predictor(E_Seasonal);
-        return [ predictor = std::move(predictor_),
-                 this ](core_t::TTime time_, const TBoolVec& removedSeasonalMask) {
-            return predictor(time_, removedSeasonalMask) +
-                   this->smooth(
-                       [&](core_t::TTime shiftedTime) {
-                           return predictor(shiftedTime - m_TimeShift, removedSeasonalMask);
-                       },
-                       time_ + m_TimeShift, E_Seasonal);
-        };
-    });
+    // Make sure that we always attach this as the first thing we do.
+    CComponents::CScopeAttachComponentChangeCallback attach{
+        m_Components, componentChangeCallback, modelAnnotationCallback};
 
-    SAddValue message{time,
-                      lastTime,
-                      m_TimeShift,
-                      value,
-                      weights,
-                      occupancy,
-                      firstValueTime,
-                      this->value(time, 0.0, E_TrendForced, true).mean(),
-                      this->value(time, 0.0, E_Seasonal, true).mean(),
-                      this->value(time, 0.0, E_Calendar, true).mean(),
-                      *this,
-                      [this] {
-                          auto predictor_ = this->predictor(E_All | E_TrendForced);
-                          return [predictor = std::move(predictor_)](core_t::TTime time_) {
-                              return predictor(time_, {});
-                          };
-                      },
-                      [this] { return this->predictor(E_Seasonal | E_Calendar); },
-                      testForSeasonality};
+    SAddValueFunctions functions{this->makeAddValueFunctions()};
 
-    m_ChangePointTest.handle(message);
-    m_Components.handle(message);
-    m_SeasonalityTest.handle(message);
-    m_CalendarCyclicTest.handle(message);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const auto & [ time, value ] = values[i];
+        if (common::CMathsFuncs::isFinite(value) == false) {
+            LOG_ERROR(<< "Discarding invalid value.");
+            continue;
+        }
+        this->addValue(time, value, weights.empty() ? TWeights::UNIT : weights[i],
+                       occupancy, firstValueTime, functions);
+    }
 }
 
 void CTimeSeriesDecomposition::shiftTime(core_t::TTime time, core_t::TTime shift) {
@@ -607,6 +594,65 @@ core_t::TTime CTimeSeriesDecomposition::lastValueTime() const {
     return m_LastValueTime;
 }
 
+CTimeSeriesDecomposition::SAddValueFunctions
+CTimeSeriesDecomposition::makeAddValueFunctions() const {
+    return {[this] {
+                auto predictor_ = this->predictor(E_All | E_TrendForced);
+                return [predictor = std::move(predictor_)](core_t::TTime time) {
+                    return predictor(time, {});
+                };
+            },
+            [this] { return this->predictor(E_Seasonal | E_Calendar); },
+            m_Components.makeTestForSeasonality([this] {
+                auto predictor_ = this->predictor(E_Seasonal);
+                return [ predictor = std::move(predictor_),
+                         this ](core_t::TTime time, const TBoolVec& removedSeasonalMask) {
+                    return predictor(time, removedSeasonalMask) +
+                           this->smooth(
+                               [&](core_t::TTime shiftedTime) {
+                                   return predictor(shiftedTime - m_TimeShift,
+                                                    removedSeasonalMask);
+                               },
+                               time + m_TimeShift, E_Seasonal);
+                };
+            })};
+}
+
+void CTimeSeriesDecomposition::addValue(core_t::TTime time,
+                                        double value,
+                                        const maths_t::TDoubleWeightsAry& weights,
+                                        double occupancy,
+                                        core_t::TTime firstValueTime,
+                                        const SAddValueFunctions& functions) {
+
+    time += m_TimeShift;
+
+    core_t::TTime lastTime{std::max(m_LastValueTime, m_LastPropagationTime)};
+
+    m_LastValueTime = std::max(m_LastValueTime, time);
+    this->propagateForwardsTo(time);
+
+    SAddValue message{time,
+                      lastTime,
+                      m_TimeShift,
+                      value,
+                      weights,
+                      occupancy,
+                      firstValueTime,
+                      this->value(time, 0.0, E_TrendForced, true).mean(),
+                      this->value(time, 0.0, E_Seasonal, true).mean(),
+                      this->value(time, 0.0, E_Calendar, true).mean(),
+                      *this,
+                      functions.s_MakePredictor,
+                      functions.s_MakeSeasonalityTestPreconditioner,
+                      functions.s_MakeTestForSeasonality};
+
+    m_ChangePointTest.handle(message);
+    m_Components.handle(message);
+    m_SeasonalityTest.handle(message);
+    m_CalendarCyclicTest.handle(message);
+}
+
 void CTimeSeriesDecomposition::initializeMediator() {
     m_Mediator = std::make_unique<CMediator>();
     m_Mediator->registerHandler(m_ChangePointTest);
@@ -1681,7 +1681,7 @@ void CTimeSeriesDecompositionDetail::CComponents::acceptPersistInserter(
     inserter.insertLevel(COMPONENTS_MACHINE_6_3_TAG, [this](auto& inserter_) {
         m_Machine.acceptPersistInserter(inserter_);
     });
-    inserter.insertValue(DECAY_RATE_6_3_TAG, m_DecayRate, core::CIEEE754::E_SinglePrecision);
+    inserter.insertValue(DECAY_RATE_6_3_TAG, m_DecayRate, core::CIEEE754::E_DoublePrecision);
     inserter.insertLevel(GAIN_CONTROLLER_6_3_TAG, [this](auto& inserter_) {
         m_GainController.acceptPersistInserter(inserter_);
     });
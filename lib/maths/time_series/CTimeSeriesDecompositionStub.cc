@@ -48,6 +48,14 @@ void CTimeSeriesDecompositionStub::addPoint(core_t::TTime /*time*/,
                                             core_t::TTime /*firstValueTime*/) {
 }
 
+void CTimeSeriesDecompositionStub::addPoints(const TTimeDoublePrVec& /*values*/,
+                                             const TDoubleWeightsAryVec& /*weights*/,
+                                             const TComponentChangeCallback& /*componentChangeCallback*/,
+                                             const maths_t::TModelAnnotationCallback& /*modelAnnotationCallback*/,
+                                             double /*occupancy*/,
+                                             core_t::TTime /*firstValueTime*/) {
+}
+
 void CTimeSeriesDecompositionStub::shiftTime(core_t::TTime /*time*/, core_t::TTime /*shift*/) {
 }
 
@@ -40,6 +40,7 @@
 #include <cstddef>
 #include <limits>
 #include <numeric>
+#include <optional>
 #include <tuple>
 
 namespace ml {
@@ -63,6 +64,8 @@ using TTail10Vec = core::CSmallVector<maths_t::ETail, 10>;
 using TMeanAccumulator = common::CBasicStatistics::SSampleMean<double>::TAccumulator;
 using TUnivariatePriorPtr = std::shared_ptr<common::CPrior>;
 using TMultivariatePriorCPtrSizePr1Vec = CTimeSeriesCorrelations::TMultivariatePriorCPtrSizePr1Vec;
+using TTimeDoublePrVec = CTimeSeriesDecompositionInterface::TTimeDoublePrVec;
+using TDoubleWeightsAryVec = CTimeSeriesDecompositionInterface::TDoubleWeightsAryVec;
 
 //! The decay rate controllers we maintain.
 enum EDecayRateController {
@@ -76,6 +79,28 @@ const double MINIMUM_CORRELATE_PRIOR_SAMPLE_COUNT{24.0};
 const TSize10Vec NOTHING_TO_MARGINALIZE;
 const TSizeDoublePr10Vec NOTHING_TO_CONDITION;
 
+//! Get the memory used by \p component counting it in full even if it is
+//! shared with dormant models.
+template<typename T>
+std::size_t ownedMemoryUsage(const std::shared_ptr<T>& component) {
+    return component == nullptr ? 0
+                                : sizeof(long) + core::memory::staticSize(*component) +
+                                      core::memory::dynamicSize(*component);
+}
+
+//! Debug the memory used by \p component counting it in full even if it
+//! is shared with dormant models.
+template<typename T>
+void ownedMemoryUsage(const char* name,
+                      const std::shared_ptr<T>& component,
+                      const core::CMemoryUsage::TMemoryUsagePtr& mem) {
+    if (component != nullptr) {
+        mem->addItem(std::string{name} + "_shared_ptr",
+                     sizeof(long) + core::memory::staticSize(*component));
+        core::memory_debug::dynamicSize(name, *component, mem);
+    }
+}
+
 //! Expand \p calculation for computing multibucket anomalies.
 TCalculation2Vec expand(maths_t::EProbabilityCalculation calculation) {
     switch (calculation) {
@@ -675,6 +700,11 @@ CUnivariateTimeSeriesModel::TSize2Vec1Vec CUnivariateTimeSeriesModel::correlates
 }
 
 void CUnivariateTimeSeriesModel::addBucketValue(const TTimeDouble2VecSizeTrVec& values) {
+    if (values.empty()) {
+        return;
+    }
+
+    this->activate();
     for (const auto& value : values) {
         m_ResidualModel->adjustOffset(
             {m_TrendModel->detrend(value.first, value.second[0], 0.0, m_IsNonNegative)},
@@ -689,36 +719,42 @@ CUnivariateTimeSeriesModel::addSamples(const common::CModelAddSamplesParams& par
         return E_Success;
     }
 
-    // Update the data characteristics.
-    m_IsNonNegative = params.isNonNegative();
-    maths_t::EDataType type{params.type()};
-    m_ResidualModel->dataType(type);
-    if (m_MultibucketFeatureModel != nullptr) {
-        m_MultibucketFeatureModel->dataType(type);
-    }
-    m_TrendModel->dataType(type);
-
-    EUpdateResult result{this->updateTrend(params, samples)};
+    this->activate();
+    this->dataType(params.type());
 
-    auto[residuals, decayRateMultiplier] =
-        this->updateResidualModels(params, std::move(samples));
+    return this->updateModels(params, std::move(samples));
+}
 
-    // Age the anomaly model. Note that update requires the probability
-    // to be calculated. This is expensive to compute and so unlike our
-    // other model components is done in that function.
-    if (m_AnomalyModel != nullptr) {
-        m_AnomalyModel->propagateForwardsByTime(params.propagationInterval());
+CUnivariateTimeSeriesModel::EUpdateResult
+CUnivariateTimeSeriesModel::addSamplesForBuckets(const TModelAddSamplesParamsVec& params,
+                                                 TTimeDouble2VecSizeTrVecVec samples) {
+    if (params.size() != samples.size()) {
+        LOG_ERROR(<< "Size mismatch: " << params.size() << " != " << samples.size());
+        return E_Failure;
     }
 
-    // Add the samples to the correlation models if there are any.
-    if (m_Correlations != nullptr) {
-        m_Correlations->addSamples(m_Id, params, residuals, decayRateMultiplier);
+    EUpdateResult result{E_Success};
+    std::optional<maths_t::EDataType> type;
+
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].empty()) {
+            continue;
+        }
+        if (type == std::nullopt) {
+            this->activate();
+        }
+        if (type != params[i].type()) {
+            type = params[i].type();
+            this->dataType(*type);
+        }
+        result = combine(result, this->updateModels(params[i], std::move(samples[i])));
     }
 
     return result;
 }
 
 void CUnivariateTimeSeriesModel::skipTime(core_t::TTime gap) {
+    this->activate();
     m_TrendModel->skipTime(gap);
 }
 
@@ -1236,25 +1272,36 @@ std::uint64_t CUnivariateTimeSeriesModel::checksum(std::uint64_t seed) const {
 void CUnivariateTimeSeriesModel::debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const {
     mem->setName("CUnivariateTimeSeriesModel");
     core::memory_debug::dynamicSize("m_Controllers", m_Controllers, mem);
-    core::memory_debug::dynamicSize("m_TrendModel", m_TrendModel, mem);
-    core::memory_debug::dynamicSize("m_ResidualModel", m_ResidualModel, mem);
+    if (m_IsDormant == false) {
+        ownedMemoryUsage("m_TrendModel", m_TrendModel, mem);
+        ownedMemoryUsage("m_ResidualModel", m_ResidualModel, mem);
+        ownedMemoryUsage("m_MultibucketFeatureModel", m_MultibucketFeatureModel, mem);
+    }
     core::memory_debug::dynamicSize("m_MultibucketFeature", m_MultibucketFeature, mem);
-    core::memory_debug::dynamicSize("m_MultibucketFeatureModel",
-                                    m_MultibucketFeatureModel, mem);
     core::memory_debug::dynamicSize("m_AnomalyModel", m_AnomalyModel, mem);
 }
 
 std::size_t CUnivariateTimeSeriesModel::memoryUsage() const {
-    return core::memory::dynamicSize(m_Controllers) +
-           core::memory::dynamicSize(m_TrendModel) +
-           core::memory::dynamicSize(m_ResidualModel) +
-           core::memory::dynamicSize(m_MultibucketFeature) +
-           core::memory::dynamicSize(m_MultibucketFeatureModel) +
-           core::memory::dynamicSize(m_AnomalyModel);
+    std::size_t mem{core::memory::dynamicSize(m_Controllers) +
+                    core::memory::dynamicSize(m_MultibucketFeature) +
+                    core::memory::dynamicSize(m_AnomalyModel)};
+    if (m_IsDormant == false) {
+        mem += ownedMemoryUsage(m_TrendModel) + ownedMemoryUsage(m_ResidualModel) +
+               ownedMemoryUsage(m_MultibucketFeatureModel);
+    }
+    return mem;
+}
+
+std::size_t CUnivariateTimeSeriesModel::forecastMemoryUsage() const {
+    // The copy shares the residual model and the trend is counted in full
+    // although the copy doesn't include the state of its tests.
+    return sizeof(*this) + ownedMemoryUsage(m_TrendModel);
 }
 
 bool CUnivariateTimeSeriesModel::acceptRestoreTraverser(const common::SModelRestoreParams& params,
                                                         core::CStateRestoreTraverser& traverser) {
+    m_IsUpdated = true;
+    m_IsDormant = false;
     bool stateMissingControllerChecks{false};
     if (traverser.name() == VERSION_6_3_TAG || traverser.name() == VERSION_7_11_TAG) {
         stateMissingControllerChecks = (traverser.name() == VERSION_6_3_TAG);
@@ -1379,6 +1426,10 @@ maths_t::EDataType CUnivariateTimeSeriesModel::dataType() const {
     return m_ResidualModel->dataType();
 }
 
+bool CUnivariateTimeSeriesModel::isDormant() const {
+    return m_IsDormant;
+}
+
 CUnivariateTimeSeriesModel::TDoubleWeightsAry
 CUnivariateTimeSeriesModel::unpack(const TDouble2VecWeightsAry& weights) {
     TDoubleWeightsAry result{maths_t::CUnitWeights::UNIT};
@@ -1406,22 +1457,83 @@ CUnivariateTimeSeriesModel::CUnivariateTimeSeriesModel(const CUnivariateTimeSeri
                                                        bool isForForecast)
     : common::CModel(other.params()), m_Id(id),
       m_IsNonNegative(other.m_IsNonNegative), m_IsForecastable(other.m_IsForecastable),
-      m_TrendModel(other.m_TrendModel->clone()),
-      m_ResidualModel(other.m_ResidualModel->clone()),
+      m_IsUpdated(other.m_IsUpdated), m_IsDormant(!isForForecast && !other.m_IsUpdated),
       m_MultibucketFeature(!isForForecast && other.m_MultibucketFeature
                                ? other.m_MultibucketFeature->clone()
                                : nullptr),
-      m_MultibucketFeatureModel(!isForForecast && other.m_MultibucketFeatureModel != nullptr
-                                    ? other.m_MultibucketFeatureModel->clone()
-                                    : nullptr),
       m_AnomalyModel(!isForForecast && other.m_AnomalyModel != nullptr
                          ? std::make_unique<CTimeSeriesAnomalyModel>(*other.m_AnomalyModel)
                          : nullptr) {
+    if (m_IsDormant) {
+        m_TrendModel = other.m_TrendModel;
+        m_ResidualModel = other.m_ResidualModel;
+        m_MultibucketFeatureModel = other.m_MultibucketFeatureModel;
+    } else if (isForForecast) {
+        m_TrendModel.reset(other.m_TrendModel->clone(true));
+        m_ResidualModel = other.m_ResidualModel;
+    } else {
+        m_TrendModel.reset(other.m_TrendModel->clone());
+        m_ResidualModel.reset(other.m_ResidualModel->clone());
+        if (other.m_MultibucketFeatureModel != nullptr) {
+            m_MultibucketFeatureModel.reset(other.m_MultibucketFeatureModel->clone());
+        }
+    }
     if (!isForForecast && other.m_Controllers != nullptr) {
         m_Controllers = std::make_unique<TDecayRateController2Ary>(*other.m_Controllers);
     }
 }
 
+void CUnivariateTimeSeriesModel::activate() {
+    if (m_IsDormant) {
+        m_TrendModel.reset(m_TrendModel->clone());
+        m_ResidualModel.reset(m_ResidualModel->clone());
+        if (m_MultibucketFeatureModel != nullptr) {
+            m_MultibucketFeatureModel.reset(m_MultibucketFeatureModel->clone());
+        }
+        m_IsDormant = false;
+    } else if (m_ResidualModel.use_count() > 1) {
+        // A forecast is still using the residual model. Note that only this
+        // thread creates references so the count can't increase under us.
+        m_ResidualModel.reset(m_ResidualModel->clone());
+    }
+    m_IsUpdated = true;
+}
+
+void CUnivariateTimeSeriesModel::dataType(maths_t::EDataType type) {
+    m_ResidualModel->dataType(type);
+    if (m_MultibucketFeatureModel != nullptr) {
+        m_MultibucketFeatureModel->dataType(type);
+    }
+    m_TrendModel->dataType(type);
+}
+
+CUnivariateTimeSeriesModel::EUpdateResult
+CUnivariateTimeSeriesModel::updateModels(const common::CModelAddSamplesParams& params,
+                                         TTimeDouble2VecSizeTrVec samples) {
+
+    // Update the data characteristics.
+    m_IsNonNegative = params.isNonNegative();
+
+    EUpdateResult result{this->updateTrend(params, samples)};
+
+    auto[residuals, decayRateMultiplier] =
+        this->updateResidualModels(params, std::move(samples));
+
+    // Age the anomaly model. Note that update requires the probability
+    // to be calculated. This is expensive to compute and so unlike our
+    // other model components is done in that function.
+    if (m_AnomalyModel != nullptr) {
+        m_AnomalyModel->propagateForwardsByTime(params.propagationInterval());
+    }
+
+    // Add the samples to the correlation models if there are any.
+    if (m_Correlations != nullptr) {
+        m_Correlations->addSamples(m_Id, params, residuals, decayRateMultiplier);
+    }
+
+    return result;
+}
+
 CUnivariateTimeSeriesModel::EUpdateResult
 CUnivariateTimeSeriesModel::updateTrend(const common::CModelAddSamplesParams& params,
                                         const TTimeDouble2VecSizeTrVec& samples) {
@@ -1456,17 +1568,18 @@ CUnivariateTimeSeriesModel::updateTrend(const common::CModelAddSamplesParams& pa
         result = E_Reset;
     };
     const auto& weights = params.trendWeights();
-    const auto& modelAnnotationCallback = params.annotationCallback();
-    double occupancy{params.bucketOccupancy()};
-    core_t::TTime firstValueTime{params.firstValueTime()};
 
+    TTimeDoublePrVec values;
+    TDoubleWeightsAryVec valueWeights;
+    values.reserve(timeorder.size());
+    valueWeights.reserve(timeorder.size());
     for (auto i : timeorder) {
-        core_t::TTime time{samples[i].first};
-        double value{samples[i].second[0]};
-        TDoubleWeightsAry weight{unpack(weights[i])};
-        m_TrendModel->addPoint(time, value, weight, componentChangeCallback,
-                               modelAnnotationCallback, occupancy, firstValueTime);
+        values.emplace_back(samples[i].first, samples[i].second[0]);
+        valueWeights.push_back(unpack(weights[i]));
     }
+    m_TrendModel->addPoints(values, valueWeights, componentChangeCallback,
+                            params.annotationCallback(),
+                            params.bucketOccupancy(), params.firstValueTime());
 
     if (result == E_Reset) {
         this->reinitializeStateGivenNewComponent(params, std::move(window));
@@ -2839,21 +2952,22 @@ CMultivariateTimeSeriesModel::updateTrend(const common::CModelAddSamplesParams&
         result = E_Reset;
     };
     const auto& weights = params.trendWeights();
-    const auto& modelAnnotationCallback = params.annotationCallback();
-    double occupancy{params.bucketOccupancy()};
-    core_t::TTime firstValueTime{params.firstValueTime()};
 
-    maths_t::TDoubleWeightsAry weight;
-    for (auto i : timeorder) {
-        core_t::TTime time{samples[i].first};
-        TDouble10Vec value(samples[i].second);
-        for (std::size_t d = 0; d < dimension; ++d) {
+    // The trend models are independent so we can add all the values for
+    // each one in turn.
+    TTimeDoublePrVec values(timeorder.size());
+    TDoubleWeightsAryVec valueWeights(timeorder.size());
+    for (std::size_t d = 0; d < dimension; ++d) {
+        for (std::size_t i = 0; i < timeorder.size(); ++i) {
+            const auto& sample = samples[timeorder[i]];
+            values[i] = {sample.first, sample.second[d]};
             for (std::size_t j = 0; j < maths_t::NUMBER_WEIGHT_STYLES; ++j) {
-                weight[j] = weights[i][j][d];
+                valueWeights[i][j] = weights[timeorder[i]][j][d];
             }
-            m_TrendModel[d]->addPoint(time, value[d], weight, componentChangeCallback,
-                                      modelAnnotationCallback, occupancy, firstValueTime);
         }
+        m_TrendModel[d]->addPoints(values, valueWeights, componentChangeCallback,
+                                   params.annotationCallback(),
+                                   params.bucketOccupancy(), params.firstValueTime());
     }
 
     if (result == E_Reset) {
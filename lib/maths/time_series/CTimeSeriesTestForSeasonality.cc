@@ -459,6 +459,17 @@ CSeasonalDecomposition CTimeSeriesTestForSeasonality::decompose() const {
         m_Values, m_SignificantPValue, m_OutlierFraction, m_MaximumNumberSegments)};
     LOG_TRACE(<< "trend segments = " << trendSegments);
 
+    // Every piecewise linear trend hypothesis starts from the values minus the
+    // trend fitted to the raw values so we compute this at most once.
+    TFloatMeanAccumulatorVec valuesMinusPiecewiseLinearTrend;
+    auto removePiecewiseLinearTrend = [&](TFloatMeanAccumulatorVec& values) {
+        if (valuesMinusPiecewiseLinearTrend.empty()) {
+            valuesMinusPiecewiseLinearTrend = TSegmentation::removePiecewiseLinear(
+                m_Values, trendSegments, m_OutlierFraction);
+        }
+        values = valuesMinusPiecewiseLinearTrend;
+    };
+
     TRemoveTrend removeTrendModels[]{
         [this](const TSeasonalComponentVec& /*periods*/,
                TFloatMeanAccumulatorVec& values, TSizeVec& modelTrendSegments) {
@@ -544,9 +555,7 @@ CSeasonalDecomposition CTimeSeriesTestForSeasonality::decompose() const {
                 return result;
             };
 
-            values = m_Values;
-            values = TSegmentation::removePiecewiseLinear(
-                std::move(values), modelTrendSegments, m_OutlierFraction);
+            removePiecewiseLinearTrend(values);
 
             if (periods.empty() == false) {
                 CSignal::fitSeasonalComponents(periods, values, m_Components);
@@ -564,11 +573,41 @@ CSeasonalDecomposition CTimeSeriesTestForSeasonality::decompose() const {
         TModelVec decompositions;
         decompositions.reserve(8 * std::size(removeTrendModels));
 
+        // Different hypotheses often remove the trend for the same periods. For
+        // example, the modelled and diurnal hypotheses both do so for the daily
+        // component if it's already modelled and every hypothesis removes the
+        // trend alone. This only depends on the periods so we reuse the values.
+        struct STrendRemoved {
+            TSeasonalComponentVec s_Periods;
+            bool s_Removed;
+            TFloatMeanAccumulatorVec s_Values;
+            TSizeVec s_ModelTrendSegments;
+        };
+        std::vector<STrendRemoved> trendsRemoved;
+
         for (const auto& removeTrend : removeTrendModels) {
-            this->addNotSeasonal(removeTrend, decompositions);
-            this->addModelled(removeTrend, decompositions);
-            this->addDiurnal(removeTrend, decompositions);
-            this->addHighestAutocorrelation(removeTrend, decompositions);
+            trendsRemoved.clear();
+            TRemoveTrend removeTrendOrReuse{
+                [&](const TSeasonalComponentVec& periods,
+                    TFloatMeanAccumulatorVec& values, TSizeVec& modelTrendSegments) {
+                    auto trendRemoved = std::find_if(
+                        trendsRemoved.begin(), trendsRemoved.end(),
+                        [&](const auto& trendRemoved_) {
+                            return trendRemoved_.s_Periods == periods;
+                        });
+                    if (trendRemoved == trendsRemoved.end()) {
+                        bool removed{removeTrend(periods, values, modelTrendSegments)};
+                        trendsRemoved.push_back({periods, removed, values, modelTrendSegments});
+                        return removed;
+                    }
+                    values = trendRemoved->s_Values;
+                    modelTrendSegments = trendRemoved->s_ModelTrendSegments;
+                    return trendRemoved->s_Removed;
+                }};
+            this->addNotSeasonal(removeTrendOrReuse, decompositions);
+            this->addModelled(removeTrendOrReuse, decompositions);
+            this->addDiurnal(removeTrendOrReuse, decompositions);
+            this->addHighestAutocorrelation(removeTrendOrReuse, decompositions);
         }
 
         return this->select(decompositions);
@@ -11,6 +11,7 @@
 
 #include <boost/test/unit_test_suite.hpp>
 #include <core/CLogger.h>
+#include <core/CStopWatch.h>
 #include <core/CoreTypes.h>
 
 #include <maths/common/CBasicStatistics.h>
@@ -68,6 +69,75 @@ void bruteForceDft(maths::time_series::CSignal::TComplexVec& f, double sign) {
     f.swap(result);
 }
 
+//! The FFT we used to use, which computes the twiddle factors and the chirp
+//! on each call. This is used as a baseline for testFFTPerformance.
+void referenceFft(maths::time_series::CSignal::TComplexVec& f) {
+    using TComplex = maths::time_series::CSignal::TComplex;
+    using TComplexVec = maths::time_series::CSignal::TComplexVec;
+
+    auto radix2fft = [](TComplexVec& g) {
+        std::uint64_t bits = maths::common::CIntegerTools::nextPow2(g.size()) - 1;
+        for (std::uint64_t i = 0; i < g.size(); ++i) {
+            std::uint64_t j{maths::common::CIntegerTools::reverseBits(i) >> (64 - bits)};
+            if (j > i) {
+                std::swap(g[i], g[j]);
+            }
+        }
+        for (std::size_t stride = 1; stride < g.size(); stride <<= 1) {
+            for (std::size_t k = 0; k < stride; ++k) {
+                double t{boost::math::double_constants::pi *
+                         static_cast<double>(k) / static_cast<double>(stride)};
+                TComplex w(std::cos(t), std::sin(t));
+                for (std::size_t start = k; start + stride < g.size(); start += 2 * stride) {
+                    TComplex fs{g[start]};
+                    TComplex tw{w * g[start + stride]};
+                    g[start] = fs + tw;
+                    g[start + stride] = fs - tw;
+                }
+            }
+        }
+        std::reverse(g.begin() + 1, g.end());
+    };
+    auto radix2ifft = [&](TComplexVec& g) {
+        maths::time_series::CSignal::conj(g);
+        radix2fft(g);
+        maths::time_series::CSignal::conj(g);
+        for (auto& gi : g) {
+            gi /= static_cast<double>(g.size());
+        }
+    };
+
+    std::size_t n{f.size()};
+    std::size_t m{std::size_t{1} << maths::common::CIntegerTools::nextPow2(n)};
+    if ((m >> 1) == n) {
+        radix2fft(f);
+        return;
+    }
+
+    m = std::size_t{1} << maths::common::CIntegerTools::nextPow2(2 * n - 1);
+    TComplexVec chirp;
+    chirp.reserve(n);
+    TComplexVec a(m, TComplex{0.0, 0.0});
+    TComplexVec b(m, TComplex{0.0, 0.0});
+    chirp.emplace_back(1.0, 0.0);
+    a[0] = f[0] * chirp[0];
+    b[0] = chirp[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        double t = boost::math::double_constants::pi *
+                   static_cast<double>(i * i) / static_cast<double>(n);
+        chirp.emplace_back(std::cos(t), std::sin(t));
+        a[i] = f[i] * std::conj(chirp[i]);
+        b[i] = b[m - i] = chirp[i];
+    }
+    radix2fft(a);
+    radix2fft(b);
+    maths::time_series::CSignal::hadamard(a, b);
+    radix2ifft(b);
+    for (std::size_t i = 0; i < n; ++i) {
+        f[i] = std::conj(chirp[i]) * b[i];
+    }
+}
+
 maths::time_series::CSignal::TSeasonalComponentVec seasonalComponentSummary(TSizeVec periods) {
     maths::time_series::CSignal::TSeasonalComponentVec result;
     result.reserve(periods.size());
@@ -354,6 +424,97 @@ BOOST_AUTO_TEST_CASE(testFFTIFFTIdempotency) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testRealFFT) {
+    // Test on randomized real input versus the complex transform.
+
+    test::CRandomNumbers rng;
+
+    TSizeVec lengths;
+    rng.generateUniformSamples(1, 200, 200, lengths);
+    lengths.insert(lengths.end(), {2, 4, 64, 1024});
+
+    TDoubleVec values;
+    for (auto length : lengths) {
+        rng.generateUniformSamples(-100000.0, 100000.0, length, values);
+
+        maths::time_series::CSignal::TComplexVec expected;
+        maths::time_series::CSignal::TComplexVec actual;
+        for (auto value : values) {
+            expected.emplace_back(value, 0.0);
+            // The imaginary parts should be ignored.
+            actual.emplace_back(value, 1.0);
+        }
+
+        maths::time_series::CSignal::fft(expected);
+        maths::time_series::CSignal::realFft(actual);
+
+        double error{0.0};
+        double norm{0.0};
+        for (std::size_t k = 0; k < actual.size(); ++k) {
+            error += std::abs(actual[k] - expected[k]);
+            norm += std::abs(expected[k]);
+        }
+
+        if (error >= 1e-12 * norm) {
+            LOG_DEBUG(<< "length = " << length << ", error  = " << error);
+        }
+        BOOST_TEST_REQUIRE(error < 1e-12 * norm);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testFFTPerformance) {
+    // Microbenchmark the FFT versus the implementation which computes the
+    // twiddle factors and chirp for each transform. We only check accuracy
+    // since timings are too noisy on CI to assert on.
+
+    test::CRandomNumbers rng;
+
+    std::size_t repeats{100};
+
+    for (std::size_t length : {1024, 4096, 336, 1008, 2016, 4032}) {
+        TDoubleVec values;
+        rng.generateUniformSamples(-100.0, 100.0, 2 * length, values);
+        maths::time_series::CSignal::TComplexVec f;
+        for (std::size_t i = 0; i < length; ++i) {
+            f.emplace_back(values[2 * i], values[2 * i + 1]);
+        }
+
+        maths::time_series::CSignal::TComplexVec expected;
+        maths::time_series::CSignal::TComplexVec actual;
+
+        core::CStopWatch watch{true};
+        for (std::size_t i = 0; i < repeats; ++i) {
+            expected = f;
+            referenceFft(expected);
+        }
+        std::uint64_t referenceTime{watch.lap()};
+        for (std::size_t i = 0; i < repeats; ++i) {
+            actual = f;
+            maths::time_series::CSignal::fft(actual);
+        }
+        std::uint64_t fftTime{watch.lap() - referenceTime};
+        for (std::size_t i = 0; i < repeats; ++i) {
+            actual = f;
+            maths::time_series::CSignal::realFft(actual);
+        }
+        std::uint64_t realFftTime{watch.stop() - referenceTime - fftTime};
+
+        LOG_DEBUG(<< "length = " << length << ", reference = " << referenceTime
+                  << "ms, fft = " << fftTime << "ms, real fft = " << realFftTime << "ms");
+
+        actual = f;
+        maths::time_series::CSignal::fft(actual);
+        double error{0.0};
+        double norm{0.0};
+        for (std::size_t k = 0; k < actual.size(); ++k) {
+            error += std::abs(actual[k] - expected[k]);
+            norm += std::abs(expected[k]);
+        }
+        LOG_DEBUG(<< "relative error = " << error / norm);
+        BOOST_TEST_REQUIRE(error < 1e-12 * norm);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testCyclicAutocorrelations) {
     // Test the cyclic autocorrelation matches the autocorrelation calculated with FFT.
 
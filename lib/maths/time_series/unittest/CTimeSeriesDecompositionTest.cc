@@ -37,6 +37,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fstream>
+#include <limits>
 #include <utility>
 #include <vector>
 
@@ -2367,6 +2368,74 @@ BOOST_FIXTURE_TEST_CASE(testSwap, CTestFixture) {
     BOOST_REQUIRE_EQUAL(checksum2, decomposition1.checksum());
 }
 
+BOOST_FIXTURE_TEST_CASE(testAddPoints, CTestFixture) {
+
+    // Test that adding points in batches gives the same state and reports
+    // the same component changes as adding them one at a time.
+
+    const double decayRate = 0.01;
+    const core_t::TTime bucketLength = HALF_HOUR;
+
+    test::CRandomNumbers rng;
+
+    TTimeDoublePrVec values;
+    TDoubleVec noise;
+    for (core_t::TTime time = 0; time <= 8 * WEEK; time += HALF_HOUR) {
+        double daily = 15.0 + 10.0 * std::sin(boost::math::double_constants::two_pi *
+                                              static_cast<double>(time) /
+                                              static_cast<double>(DAY));
+        double shift = time > 5 * WEEK ? 20.0 : 0.0;
+        rng.generateNormalSamples(0.0, 4.0, 1, noise);
+        values.emplace_back(time, daily + shift + noise[0]);
+    }
+    values[100].second = std::numeric_limits<double>::quiet_NaN();
+
+    TDoubleVec counts;
+    rng.generateUniformSamples(0.5, 1.5, values.size(), counts);
+    maths::time_series::CTimeSeriesDecomposition::TDoubleWeightsAryVec weights;
+    for (auto count : counts) {
+        weights.push_back(maths_t::countWeight(count));
+    }
+
+    maths::time_series::CTimeSeriesDecomposition sequential(decayRate, bucketLength);
+    maths::time_series::CTimeSeriesDecomposition batched(decayRate, bucketLength);
+
+    std::size_t sequentialChanges{0};
+    std::size_t batchedChanges{0};
+    auto sequentialCallback = [&](TFloatMeanAccumulatorVec) { ++sequentialChanges; };
+    auto batchedCallback = [&](TFloatMeanAccumulatorVec) { ++batchedChanges; };
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        sequential.addPoint(values[i].first, values[i].second, weights[i],
+                            sequentialCallback);
+    }
+
+    TDoubleVec batchSizes;
+    for (std::size_t i = 0; i < values.size(); /**/) {
+        rng.generateUniformSamples(1.0, 100.0, 1, batchSizes);
+        std::size_t end{std::min(i + static_cast<std::size_t>(batchSizes[0]),
+                                 values.size())};
+        batched.addPoints({values.begin() + i, values.begin() + end},
+                          {weights.begin() + i, weights.begin() + end}, batchedCallback);
+        i = end;
+    }
+
+    LOG_DEBUG(<< "component changes = " << sequentialChanges);
+    LOG_DEBUG(<< "seasonal components = " << sequential.seasonalComponents().size());
+    BOOST_TEST_REQUIRE(sequential.seasonalComponents().size() > 0);
+    BOOST_REQUIRE_EQUAL(sequentialChanges, batchedChanges);
+    BOOST_REQUIRE_EQUAL(sequential.checksum(), batched.checksum());
+
+    // Empty weights mean unit weights.
+    maths::time_series::CTimeSeriesDecomposition unitSequential(decayRate, bucketLength);
+    maths::time_series::CTimeSeriesDecomposition unitBatched(decayRate, bucketLength);
+    for (const auto & [ time, value ] : values) {
+        unitSequential.addPoint(time, value);
+    }
+    unitBatched.addPoints(values);
+    BOOST_REQUIRE_EQUAL(unitSequential.checksum(), unitBatched.checksum());
+}
+
 BOOST_FIXTURE_TEST_CASE(testPersist, CTestFixture) {
 
     // Check that serialization is idempotent.
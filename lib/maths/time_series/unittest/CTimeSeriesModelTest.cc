@@ -30,6 +30,7 @@
 #include <maths/time_series/CTimeSeriesDecomposition.h>
 #include <maths/time_series/CTimeSeriesDecompositionStub.h>
 #include <maths/time_series/CTimeSeriesModel.h>
+#include <maths/time_series/CTimeSeriesMultibucketFeatures.h>
 #include <maths/time_series/CTimeSeriesSegmentation.h>
 
 #include <test/BoostTestCloseAbsolute.h>
@@ -38,6 +39,7 @@
 
 #include "TestUtils.h"
 
+#include <boost/math/constants/constants.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include <cmath>
@@ -424,6 +426,144 @@ BOOST_AUTO_TEST_CASE(testClone) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testDormantModels) {
+    // Test that models cloned from a model which hasn't been updated share
+    // its state until they're updated and that they are then the same as a
+    // full copy.
+
+    using TUnivariateModelPtr = std::unique_ptr<maths::time_series::CUnivariateTimeSeriesModel>;
+
+    core_t::TTime bucketLength{600};
+
+    test::CRandomNumbers rng;
+
+    maths::time_series::CTimeSeriesDecomposition trend{DECAY_RATE, bucketLength};
+    auto controllers = decayRateControllers(1);
+    maths::time_series::CTimeSeriesMultibucketScalarMean multibucketFeature{5};
+    maths::time_series::CUnivariateTimeSeriesModel prototype{
+        modelParams(bucketLength), 0,           trend, univariateMultimodal(),
+        &controllers,              &multibucketFeature};
+    BOOST_TEST_REQUIRE(prototype.isDormant() == false);
+
+    std::uint64_t prototypeChecksum{prototype.checksum()};
+    std::size_t prototypeMemoryUsage{prototype.memoryUsage()};
+
+    TUnivariateModelPtr dormant{prototype.clone(1)};
+    BOOST_TEST_REQUIRE(dormant->isDormant());
+    BOOST_REQUIRE_EQUAL(prototypeChecksum, dormant->checksum());
+    TUnivariateModelPtr copy{dormant->cloneForPersistence()};
+    BOOST_TEST_REQUIRE(copy->isDormant());
+
+    // The shared state is counted by the prototype.
+    LOG_DEBUG(<< "prototype memory = " << prototypeMemoryUsage
+              << ", dormant memory = " << dormant->memoryUsage());
+    BOOST_REQUIRE_EQUAL(prototypeMemoryUsage, prototype.memoryUsage());
+    BOOST_TEST_REQUIRE(3 * dormant->memoryUsage() < prototypeMemoryUsage);
+
+    maths::time_series::CUnivariateTimeSeriesModel full{
+        modelParams(bucketLength), 1,           trend, univariateMultimodal(),
+        &controllers,              &multibucketFeature};
+
+    TDoubleVec samples;
+    rng.generateNormalSamples(10.0, 4.0, 200, samples);
+    TDouble2VecWeightsAryVec weights{maths_t::CUnitWeights::unit<TDouble2Vec>(1)};
+    core_t::TTime time{0};
+    for (auto sample : samples) {
+        dormant->addSamples(addSampleParams(weights),
+                            {core::make_triple(time, TDouble2Vec{sample}, TAG)});
+        full.addSamples(addSampleParams(weights),
+                        {core::make_triple(time, TDouble2Vec{sample}, TAG)});
+        BOOST_TEST_REQUIRE(dormant->isDormant() == false);
+        time += bucketLength;
+    }
+
+    // Updates shouldn't affect the models the state was shared with.
+    BOOST_REQUIRE_EQUAL(full.checksum(), dormant->checksum());
+    BOOST_REQUIRE_EQUAL(full.memoryUsage(), dormant->memoryUsage());
+    BOOST_REQUIRE_EQUAL(prototypeChecksum, prototype.checksum());
+    BOOST_REQUIRE_EQUAL(prototypeChecksum, copy->checksum());
+    BOOST_TEST_REQUIRE(copy->isDormant());
+
+    // Clones of updated models aren't dormant.
+    TUnivariateModelPtr clone{dormant->clone(2)};
+    BOOST_TEST_REQUIRE(clone->isDormant() == false);
+}
+
+BOOST_AUTO_TEST_CASE(testForecastSnapshots) {
+    // Test that the copy made for forecasting shares the residual model
+    // until the model is updated, that updates don't affect it and that
+    // it gives the same forecast as a full copy.
+
+    using TUnivariateModelPtr = std::unique_ptr<maths::time_series::CUnivariateTimeSeriesModel>;
+    using TErrorBarVec = std::vector<maths::common::SErrorBar>;
+
+    core_t::TTime bucketLength{1800};
+
+    test::CRandomNumbers rng;
+
+    maths::time_series::CTimeSeriesDecomposition trend{DECAY_RATE, bucketLength};
+    auto controllers = decayRateControllers(1);
+    maths::time_series::CUnivariateTimeSeriesModel model{
+        modelParams(bucketLength), 0, trend, univariateNormal(), &controllers};
+
+    TDouble2VecWeightsAryVec weights{maths_t::CUnitWeights::unit<TDouble2Vec>(1)};
+    core_t::TTime time{0};
+    auto updateModel = [&](std::size_t n) {
+        TDoubleVec noise;
+        rng.generateNormalSamples(0.0, 1.0, n, noise);
+        for (auto sample : noise) {
+            sample += 10.0 + 5.0 * std::sin(boost::math::double_constants::two_pi *
+                                            static_cast<double>(time) /
+                                            static_cast<double>(core::constants::DAY));
+            model.addSamples(addSampleParams(weights),
+                             {core::make_triple(time, TDouble2Vec{sample}, TAG)});
+            time += bucketLength;
+        }
+    };
+    auto forecast = [](maths::common::CModel& model_, core_t::TTime start) {
+        TErrorBarVec result;
+        std::string message;
+        model_.forecast(0, start, start, start + 2 * core::constants::DAY, 90.0,
+                        {-1000.0}, {1000.0},
+                        [&result](const maths::common::SErrorBar& errorBar) {
+                            result.push_back(errorBar);
+                        },
+                        message);
+        return result;
+    };
+
+    updateModel(1000);
+    BOOST_TEST_REQUIRE(model.isForecastPossible());
+
+    core_t::TTime snapshotTime{time};
+    std::uint64_t residualChecksum{model.residualModel().checksum()};
+    TUnivariateModelPtr copy{model.clone(1)};
+    TUnivariateModelPtr snapshot{model.cloneForForecast()};
+
+    // The residual model is shared.
+    BOOST_TEST_REQUIRE(&model.residualModel() == &snapshot->residualModel());
+    LOG_DEBUG(<< "memory = " << model.memoryUsage()
+              << ", forecast memory = " << model.forecastMemoryUsage());
+    BOOST_TEST_REQUIRE(model.forecastMemoryUsage() < model.memoryUsage());
+
+    // Updating the model gets its own copy and leaves the snapshot unchanged.
+    updateModel(100);
+    BOOST_TEST_REQUIRE(&model.residualModel() != &snapshot->residualModel());
+    BOOST_REQUIRE_EQUAL(residualChecksum, snapshot->residualModel().checksum());
+    BOOST_TEST_REQUIRE(residualChecksum != model.residualModel().checksum());
+
+    TErrorBarVec expected{forecast(*copy, snapshotTime)};
+    TErrorBarVec actual{forecast(*snapshot, snapshotTime)};
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    BOOST_TEST_REQUIRE(expected.size() > 0);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(expected[i].s_Time, actual[i].s_Time);
+        BOOST_REQUIRE_EQUAL(expected[i].s_LowerBound, actual[i].s_LowerBound);
+        BOOST_REQUIRE_EQUAL(expected[i].s_Predicted, actual[i].s_Predicted);
+        BOOST_REQUIRE_EQUAL(expected[i].s_UpperBound, actual[i].s_UpperBound);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testMode) {
     // Test that we get the modes we expect based versus updating the trend(s)
     // and prior directly.
@@ -1008,6 +1148,101 @@ BOOST_AUTO_TEST_CASE(testWithDecayRateControlInAddSamples) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testAddSamplesForBuckets) {
+
+    // Test that adding the samples of many buckets at once gives the same
+    // state as adding them one bucket at a time.
+
+    using TTimeDouble2VecSizeTrVecVec = maths::common::CModel::TTimeDouble2VecSizeTrVecVec;
+    using TModelAddSamplesParamsVec = maths::common::CModel::TModelAddSamplesParamsVec;
+    using TDouble2VecWeightsAryVecVec = std::vector<TDouble2VecWeightsAryVec>;
+
+    test::CRandomNumbers rng;
+    core_t::TTime bucketLength{1800};
+
+    for (std::size_t dimension : {1, 3}) {
+        LOG_DEBUG(<< "dimension = " << dimension);
+
+        auto params = modelParams(bucketLength);
+        auto controllers = decayRateControllers(dimension);
+        maths::time_series::CTimeSeriesDecomposition trend{DECAY_RATE, bucketLength};
+        std::unique_ptr<maths::common::CModel> sequential;
+        if (dimension == 1) {
+            sequential = std::make_unique<maths::time_series::CUnivariateTimeSeriesModel>(
+                params, 1, trend, univariateNormal(), &controllers);
+        } else {
+            sequential = std::make_unique<maths::time_series::CMultivariateTimeSeriesModel>(
+                params, trend, multivariateNormal(), &controllers);
+        }
+        std::unique_ptr<maths::common::CModel> batched{sequential->clone(1)};
+
+        // Generate buckets with a varying number of samples with daily
+        // seasonality and a step change.
+        TTimeDouble2VecSizeTrVecVec samples;
+        TDouble2VecWeightsAryVecVec weights;
+        TDoubleVec counts;
+        TDoubleVec noise;
+        for (core_t::TTime time = 0; time < 60 * core::constants::DAY; time += bucketLength) {
+            rng.generateUniformSamples(0.0, 3.0, 1, counts);
+            samples.emplace_back();
+            weights.emplace_back();
+            for (std::size_t i = 0; i < static_cast<std::size_t>(counts[0]); ++i) {
+                rng.generateNormalSamples(0.0, 4.0, dimension, noise);
+                TDouble2Vec sample(dimension);
+                for (std::size_t d = 0; d < dimension; ++d) {
+                    sample[d] = 20.0 + (time > 40 * core::constants::DAY ? 10.0 : 0.0) +
+                                4.0 * std::sin(boost::math::double_constants::two_pi *
+                                               static_cast<double>(time) / 86400.0) +
+                                noise[d];
+                }
+                samples.back().push_back(core::make_triple(
+                    time + static_cast<core_t::TTime>(i), sample, TAG));
+                weights.back().push_back(maths_t::CUnitWeights::unit<TDouble2Vec>(dimension));
+            }
+        }
+        TModelAddSamplesParamsVec addSamplesParams;
+        for (const auto& weight : weights) {
+            addSamplesParams.push_back(addSampleParams(weight));
+        }
+
+        maths::common::CModel::EUpdateResult sequentialResult{maths::common::CModel::E_Success};
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            if (sequential->addSamples(addSamplesParams[i], samples[i]) ==
+                maths::common::CModel::E_Reset) {
+                sequentialResult = maths::common::CModel::E_Reset;
+            }
+        }
+
+        maths::common::CModel::EUpdateResult batchedResult{maths::common::CModel::E_Success};
+        TDoubleVec batchSizes;
+        for (std::size_t i = 0; i < samples.size(); /**/) {
+            rng.generateUniformSamples(1.0, 200.0, 1, batchSizes);
+            std::size_t end{std::min(i + static_cast<std::size_t>(batchSizes[0]),
+                                     samples.size())};
+            if (batched->addSamplesForBuckets(
+                    {addSamplesParams.begin() + i, addSamplesParams.begin() + end},
+                    {samples.begin() + i, samples.begin() + end}) ==
+                maths::common::CModel::E_Reset) {
+                batchedResult = maths::common::CModel::E_Reset;
+            }
+            i = end;
+        }
+
+        BOOST_REQUIRE_EQUAL(sequentialResult, batchedResult);
+        BOOST_REQUIRE_EQUAL(sequential->checksum(), batched->checksum());
+    }
+
+    // Mismatched sizes should fail.
+    {
+        maths::time_series::CUnivariateTimeSeriesModel model{
+            modelParams(bucketLength), 1,
+            maths::time_series::CTimeSeriesDecomposition{DECAY_RATE, bucketLength},
+            univariateNormal()};
+        BOOST_REQUIRE_EQUAL(maths::common::CModel::E_Failure,
+                            model.addSamplesForBuckets({}, {TTimeDouble2VecSizeTrVec{}}));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testPredict) {
     // Test prediction with a trend and with multimodal data.
 
@@ -316,6 +316,18 @@ bool CAnomalyDetector::shouldPersistDetector() const {
     return true;
 }
 
+void CAnomalyDetector::persistChangedModelsOnly() {
+    m_Model->persistChangedModelsOnly();
+}
+
+bool CAnomalyDetector::hasMissingModels() const {
+    return m_Model->hasMissingModels();
+}
+
+void CAnomalyDetector::restoreMissingModels(CAnomalyDetector& other) {
+    m_Model->restoreMissingModels(*other.m_Model);
+}
+
 void CAnomalyDetector::acceptPersistInserter(core::CStatePersistInserter& inserter) const {
     // Persist static members only once within the simple count detector
     // and do this first so that other model components can use
@@ -378,6 +390,36 @@ CAnomalyDetector::preprocessFieldValues(const TStrCPtrVec& fieldValues) {
 void CAnomalyDetector::buildResults(core_t::TTime bucketStartTime,
                                     core_t::TTime bucketEndTime,
                                     CHierarchicalResults& results) {
+    this->buildResults(bucketStartTime, bucketEndTime, false, results);
+}
+
+bool CAnomalyDetector::canBuildResultsConcurrently() const {
+    return m_Limits.resourceMonitor().haveNoLimit() ||
+           m_Model->sampleDependsOnResourceMonitor() == false;
+}
+
+void CAnomalyDetector::buildResultsDeferringRefresh(core_t::TTime bucketStartTime,
+                                                    core_t::TTime bucketEndTime,
+                                                    CHierarchicalResults& results) {
+    this->buildResults(bucketStartTime, bucketEndTime, true, results);
+}
+
+void CAnomalyDetector::buildInterimResultsDeferringRefresh(core_t::TTime bucketStartTime,
+                                                           core_t::TTime bucketEndTime,
+                                                           CHierarchicalResults& results) {
+    this->buildInterimResults(bucketStartTime, bucketEndTime, true, results);
+}
+
+void CAnomalyDetector::refreshResourceMonitor() {
+    int updates{m_DeferredResourceMonitorUpdates};
+    m_DeferredResourceMonitorUpdates = E_NoUpdate;
+    this->updateResourceMonitor(updates, false);
+}
+
+void CAnomalyDetector::buildResults(core_t::TTime bucketStartTime,
+                                    core_t::TTime bucketEndTime,
+                                    bool deferRefresh,
+                                    CHierarchicalResults& results) {
     core_t::TTime bucketLength = m_ModelConfig.bucketLength();
     bucketStartTime = maths::common::CIntegerTools::floor(bucketStartTime, bucketLength);
     bucketEndTime = maths::common::CIntegerTools::floor(bucketEndTime, bucketLength);
@@ -385,22 +427,40 @@ void CAnomalyDetector::buildResults(core_t::TTime bucketStartTime,
         return;
     }
 
-    m_Limits.resourceMonitor().clearExtraMemory();
+    this->updateResourceMonitor(E_ClearExtraMemory, deferRefresh);
 
     this->buildResultsHelper(
         bucketStartTime, bucketEndTime,
-        std::bind(&CAnomalyDetector::sample, this, std::placeholders::_1,
-                  std::placeholders::_2, std::ref(m_Limits.resourceMonitor())),
+        [this, deferRefresh](core_t::TTime startTime, core_t::TTime endTime) {
+            this->updateResourceMonitor(
+                this->sample(startTime, endTime, m_Limits.resourceMonitor()), deferRefresh);
+        },
         std::bind(&CAnomalyDetector::updateLastSampledBucket, this, std::placeholders::_1),
         results);
 }
 
-void CAnomalyDetector::sample(core_t::TTime startTime,
-                              core_t::TTime endTime,
-                              CResourceMonitor& resourceMonitor) {
+void CAnomalyDetector::updateResourceMonitor(int updates, bool defer) {
+    if (defer) {
+        m_DeferredResourceMonitorUpdates |= updates;
+        return;
+    }
+    CResourceMonitor& resourceMonitor{m_Limits.resourceMonitor()};
+    if ((updates & E_ClearExtraMemory) != 0) {
+        resourceMonitor.clearExtraMemory();
+    }
+    if ((updates & E_ForceRefresh) != 0) {
+        resourceMonitor.forceRefresh(*this);
+    } else if ((updates & E_Refresh) != 0) {
+        resourceMonitor.refresh(*this);
+    }
+}
+
+int CAnomalyDetector::sample(core_t::TTime startTime,
+                             core_t::TTime endTime,
+                             CResourceMonitor& resourceMonitor) {
     if (endTime <= startTime) {
         // Nothing to sample.
-        return;
+        return E_NoUpdate;
     }
 
     core_t::TTime bucketLength = m_ModelConfig.bucketLength();
@@ -409,30 +469,26 @@ void CAnomalyDetector::sample(core_t::TTime startTime,
         m_Model->sample(time, time + bucketLength, resourceMonitor);
     }
 
-    if ((endTime / bucketLength) % 10 == 0) {
-        // Even if memory limiting is disabled, force a refresh every 10 buckets
-        // so the user has some idea what's going on with memory.  (Note: the
-        // 10 bucket interval is inexact as sampling may not take place for
-        // every bucket.  However, it's probably good enough.)
-        resourceMonitor.forceRefresh(*this);
-    } else {
-        resourceMonitor.refresh(*this);
-    }
+    // Even if memory limiting is disabled, force a refresh every 10 buckets
+    // so the user has some idea what's going on with memory.  (Note: the
+    // 10 bucket interval is inexact as sampling may not take place for
+    // every bucket.  However, it's probably good enough.)
+    return (endTime / bucketLength) % 10 == 0 ? E_ForceRefresh : E_Refresh;
 }
 
-void CAnomalyDetector::sampleBucketStatistics(core_t::TTime startTime,
-                                              core_t::TTime endTime,
-                                              CResourceMonitor& resourceMonitor) {
+int CAnomalyDetector::sampleBucketStatistics(core_t::TTime startTime,
+                                             core_t::TTime endTime,
+                                             CResourceMonitor& resourceMonitor) {
     if (endTime <= startTime) {
         // Nothing to sample.
-        return;
+        return E_NoUpdate;
     }
 
     core_t::TTime bucketLength = m_ModelConfig.bucketLength();
     for (core_t::TTime time = startTime; time < endTime; time += bucketLength) {
         m_Model->sampleBucketStatistics(time, time + bucketLength, resourceMonitor);
     }
-    resourceMonitor.refresh(*this);
+    return E_Refresh;
 }
 
 void CAnomalyDetector::generateModelPlot(core_t::TTime bucketStartTime,
@@ -507,10 +563,12 @@ CAnomalyDetector::getForecastPrerequisites() const {
                 // The model might not exist, e.g. for categorical features.
                 if (model != nullptr) {
                     ++prerequisites.s_NumberOfModels;
+                    // Only the models we can forecast are copied.
                     if (model->isForecastPossible()) {
                         ++prerequisites.s_NumberOfForecastableModels;
+                        prerequisites.s_MemoryUsageForDetector +=
+                            model->forecastMemoryUsage();
                     }
-                    prerequisites.s_MemoryUsageForDetector += model->memoryUsage();
                 }
             }
         }
@@ -589,10 +647,20 @@ CAnomalyDetector::getForecastModels(bool persistOnDisk,
 void CAnomalyDetector::buildInterimResults(core_t::TTime bucketStartTime,
                                            core_t::TTime bucketEndTime,
                                            CHierarchicalResults& results) {
+    this->buildInterimResults(bucketStartTime, bucketEndTime, false, results);
+}
+
+void CAnomalyDetector::buildInterimResults(core_t::TTime bucketStartTime,
+                                           core_t::TTime bucketEndTime,
+                                           bool deferRefresh,
+                                           CHierarchicalResults& results) {
     this->buildResultsHelper(
         bucketStartTime, bucketEndTime,
-        std::bind(&CAnomalyDetector::sampleBucketStatistics, this, std::placeholders::_1,
-                  std::placeholders::_2, std::ref(m_Limits.resourceMonitor())),
+        [this, deferRefresh](core_t::TTime startTime, core_t::TTime endTime) {
+            this->updateResourceMonitor(
+                this->sampleBucketStatistics(startTime, endTime, m_Limits.resourceMonitor()),
+                deferRefresh);
+        },
         std::bind(&CAnomalyDetector::noUpdateLastSampledBucket, this, std::placeholders::_1),
         results);
 }
@@ -37,13 +37,31 @@
 #include <boost/unordered_set.hpp>
 
 #include <algorithm>
+#include <limits>
 
 namespace ml {
 namespace model {
 namespace {
 const std::string MODEL_TAG{"a"};
+const std::string UNCHANGED_MODEL_TAG{"b"};
+const std::string DORMANT_MODEL_TAG{"c"};
 const std::string EMPTY;
 
+//! Marks a model whose memory usage needs to be measured.
+const std::size_t UNMEASURED{std::numeric_limits<std::size_t>::max()};
+//! The number of incremental memory usage computations between checks
+//! against a full computation in debug builds.
+const std::size_t MEMORY_USAGE_CHECK_INTERVAL{50};
+
+//! Get the memory used by \p model.
+std::size_t modelMemoryUsage(const CAnomalyDetectorModel::TMathsModelSPtr& model) {
+    // The person models may be temporarily shared with a copy being persisted,
+    // but any of them may need to be duplicated so we count their full size.
+    return model == nullptr ? 0
+                            : sizeof(long) + core::memory::staticSize(*model) +
+                                  core::memory::dynamicSize(*model);
+}
+
 const model_t::CResultType SKIP_SAMPLING_RESULT_TYPE;
 const double SKIP_SAMPLING_WEIGHT{0.005};
 
@@ -112,6 +130,16 @@ CAnomalyDetectorModel::CAnomalyDetectorModel(bool isForPersistence,
     }
 }
 
+void CAnomalyDetectorModel::persistChangedModelsOnly() {
+}
+
+bool CAnomalyDetectorModel::hasMissingModels() const {
+    return false;
+}
+
+void CAnomalyDetectorModel::restoreMissingModels(CAnomalyDetectorModel& /*other*/) {
+}
+
 std::string CAnomalyDetectorModel::description() const {
     return m_DataGatherer->description();
 }
@@ -208,6 +236,10 @@ void CAnomalyDetectorModel::sample(core_t::TTime startTime,
     }
 }
 
+bool CAnomalyDetectorModel::sampleDependsOnResourceMonitor() const {
+    return true;
+}
+
 void CAnomalyDetectorModel::skipSampling(core_t::TTime endTime) {
     CDataGatherer& gatherer{this->dataGatherer()};
     core_t::TTime startTime{gatherer.earliestBucketStartTime()};
@@ -513,6 +545,11 @@ bool CAnomalyDetectorModel::SFeatureModels::acceptRestoreTraverser(const SModelP
                 return false;
             }
             s_Models.push_back(std::move(model));
+        } else if (traverser.name() == UNCHANGED_MODEL_TAG) {
+            // This is restored from an older snapshot.
+            s_Models.emplace_back();
+        } else if (traverser.name() == DORMANT_MODEL_TAG) {
+            s_Models.emplace_back(s_NewModel->clone(s_Models.size()));
         }
     } while (traverser.next());
     return true;
@@ -525,7 +562,20 @@ void CAnomalyDetectorModel::SFeatureModels::persistModelsState(core::CStatePersi
 }
 
 void CAnomalyDetectorModel::SFeatureModels::acceptPersistInserter(core::CStatePersistInserter& inserter) const {
-    for (const auto& model : s_Models) {
+    for (std::size_t id = 0; id < s_Models.size(); ++id) {
+        const auto& model = s_Models[id];
+        // If every model was a stub when the last copy was made the detector
+        // wasn't persisted, so unchanged stubs are always persisted.
+        if (s_PersistChangedOnly && id < s_Unchanged.size() && s_Unchanged[id] &&
+            model->shouldPersist()) {
+            inserter.insertValue(UNCHANGED_MODEL_TAG, EMPTY);
+            continue;
+        }
+        // Dormant models are equal to the new model so we needn't store them.
+        if (model->isDormant()) {
+            inserter.insertValue(DORMANT_MODEL_TAG, EMPTY);
+            continue;
+        }
         inserter.insertLevel(
             MODEL_TAG, std::bind<void>(maths::time_series::CModelStateSerialiser(),
                                        std::cref(*model), std::placeholders::_1));
@@ -537,10 +587,18 @@ void CAnomalyDetectorModel::SFeatureModels::debugMemoryUsage(
     mem->setName("SFeatureModels");
     core::memory_debug::dynamicSize("s_NewModel", s_NewModel, mem);
     core::memory_debug::dynamicSize("s_Models", s_Models, mem);
+    core::memory_debug::dynamicSize("s_ModelMemoryUsages", s_ModelMemoryUsages, mem);
+    core::memory_debug::dynamicSize("s_ChangedModels", s_ChangedModels, mem);
 }
 
 std::size_t CAnomalyDetectorModel::SFeatureModels::memoryUsage() const {
-    return core::memory::dynamicSize(s_NewModel) + core::memory::dynamicSize(s_Models);
+    std::size_t mem{this->modelsMemoryUsage()};
+    mem += core::memory::dynamicSize(s_NewModel);
+    mem += sizeof(TMathsModelSPtr) * s_Models.capacity();
+    mem += sizeof(TMathsModelWPtr) * s_CopiedModels.capacity();
+    mem += core::memory::dynamicSize(s_ModelMemoryUsages);
+    mem += core::memory::dynamicSize(s_ChangedModels);
+    return mem;
 }
 
 bool CAnomalyDetectorModel::SFeatureModels::shouldPersist() const {
@@ -548,6 +606,134 @@ bool CAnomalyDetectorModel::SFeatureModels::shouldPersist() const {
                        [](const auto& model) { return model->shouldPersist(); });
 }
 
+CAnomalyDetectorModel::SFeatureModels
+CAnomalyDetectorModel::SFeatureModels::cloneForPersistence(bool share) const {
+    SFeatureModels result{s_Feature, s_NewModel};
+    if (share) {
+        result.s_Models = s_Models;
+        // Models which were replaced have different owners and models which
+        // were modified in place were expired by modelToModify.
+        result.s_Unchanged.resize(s_Models.size(), false);
+        for (std::size_t id = 0; id < std::min(s_Models.size(), s_CopiedModels.size()); ++id) {
+            const TMathsModelWPtr& copied{s_CopiedModels[id]};
+            result.s_Unchanged[id] = copied.owner_before(s_Models[id]) == false &&
+                                     s_Models[id].owner_before(copied) == false;
+        }
+        s_CopiedModels.assign(s_Models.begin(), s_Models.end());
+    } else {
+        s_CopiedModels.clear();
+        result.s_Models.reserve(s_Models.size());
+        for (const auto& model : s_Models) {
+            result.s_Models.emplace_back(model->cloneForPersistence());
+        }
+    }
+    return result;
+}
+
+maths::common::CModel* CAnomalyDetectorModel::SFeatureModels::modelToModify(std::size_t id) {
+    TMathsModelSPtr& model{s_Models[id]};
+    if (model.use_count() > 1) {
+        model.reset(model->cloneForPersistence());
+    }
+    if (id < s_CopiedModels.size()) {
+        s_CopiedModels[id].reset();
+    }
+    this->modelChanged(id);
+    return model.get();
+}
+
+maths::common::CModel*
+CAnomalyDetectorModel::SFeatureModels::addModel(maths::common::CModel* model) {
+    s_Models.emplace_back(model);
+    return model;
+}
+
+maths::common::CModel*
+CAnomalyDetectorModel::SFeatureModels::replaceModel(std::size_t id,
+                                                    maths::common::CModel* model) {
+    s_Models[id].reset(model);
+    this->modelChanged(id);
+    return model;
+}
+
+bool CAnomalyDetectorModel::SFeatureModels::hasMissingModels() const {
+    return std::any_of(s_Models.begin(), s_Models.end(),
+                       [](const auto& model) { return model == nullptr; });
+}
+
+void CAnomalyDetectorModel::SFeatureModels::restoreMissingModels(SFeatureModels& other) {
+    for (std::size_t id = 0; id < std::min(s_Models.size(), other.s_Models.size()); ++id) {
+        if (s_Models[id] == nullptr) {
+            s_Models[id] = std::move(other.s_Models[id]);
+            this->modelChanged(id);
+        }
+    }
+}
+
+bool CAnomalyDetectorModel::SFeatureModels::hasMissingModels(const TFeatureModelsVec& features) {
+    return std::any_of(features.begin(), features.end(), [](const auto& feature) {
+        return feature.hasMissingModels();
+    });
+}
+
+void CAnomalyDetectorModel::SFeatureModels::restoreMissingModels(TFeatureModelsVec& features,
+                                                                 TFeatureModelsVec& other) {
+    for (auto& feature : features) {
+        auto i = std::find_if(other.begin(), other.end(), [&](const auto& otherFeature) {
+            return otherFeature.s_Feature == feature.s_Feature;
+        });
+        if (i != other.end()) {
+            feature.restoreMissingModels(*i);
+        }
+    }
+}
+
+void CAnomalyDetectorModel::SFeatureModels::modelChanged(std::size_t id) {
+    // Models which have never been measured are picked up by size.
+    if (id < s_ModelMemoryUsages.size() && s_ModelMemoryUsages[id] != UNMEASURED) {
+        s_ModelsMemoryUsage -= s_ModelMemoryUsages[id];
+        s_ModelMemoryUsages[id] = UNMEASURED;
+        s_ChangedModels.push_back(id);
+    }
+}
+
+std::size_t CAnomalyDetectorModel::SFeatureModels::modelsMemoryUsage() const {
+    if (s_ModelMemoryUsages.size() > s_Models.size()) {
+        s_ModelMemoryUsages.clear();
+        s_ChangedModels.clear();
+        s_ModelsMemoryUsage = 0;
+    }
+    for (auto id : s_ChangedModels) {
+        if (id < s_ModelMemoryUsages.size() && s_ModelMemoryUsages[id] == UNMEASURED) {
+            s_ModelMemoryUsages[id] = modelMemoryUsage(s_Models[id]);
+            s_ModelsMemoryUsage += s_ModelMemoryUsages[id];
+        }
+    }
+    s_ChangedModels.clear();
+    for (std::size_t id = s_ModelMemoryUsages.size(); id < s_Models.size(); ++id) {
+        s_ModelMemoryUsages.push_back(modelMemoryUsage(s_Models[id]));
+        s_ModelsMemoryUsage += s_ModelMemoryUsages.back();
+    }
+
+#ifndef NDEBUG
+    if (++s_MemoryUsageComputations % MEMORY_USAGE_CHECK_INTERVAL == 0) {
+        std::size_t expected{0};
+        for (const auto& model : s_Models) {
+            expected += modelMemoryUsage(model);
+        }
+        if (expected != s_ModelsMemoryUsage) {
+            LOG_ERROR(<< "Inconsistent model memory usage: expected " << expected
+                      << ", got " << s_ModelsMemoryUsage);
+            s_ModelMemoryUsages.clear();
+            s_ModelsMemoryUsage = 0;
+            return this->modelsMemoryUsage();
+        }
+    }
+#endif
+
+    return s_ModelsMemoryUsage;
+}
+
 CAnomalyDetectorModel::SFeatureCorrelateModels::SFeatureCorrelateModels(
     model_t::EFeature feature,
     const TMultivariatePriorSPtr& modelPrior,
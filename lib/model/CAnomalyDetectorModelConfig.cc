@@ -747,6 +747,7 @@ const std::string COMPONENT_SIZE_PROPERTY("componentsize");
 const std::string SAMPLE_COUNT_FACTOR_PROPERTY("samplecountfactor");
 const std::string PRUNE_WINDOW_SCALE_MINIMUM("prunewindowscaleminimum");
 const std::string PRUNE_WINDOW_SCALE_MAXIMUM("prunewindowscalemaximum");
+const std::string MODEL_SPILL_DIRECTORY("modelspilldirectory");
 const std::string AGGREGATION_STYLE_PARAMS("aggregationstyleparams");
 const std::string MAXIMUM_ANOMALOUS_PROBABILITY_PROPERTY("maximumanomalousprobability");
 const std::string NOISE_PERCENTILE_PROPERTY("noisepercentile");
@@ -883,6 +884,10 @@ bool CAnomalyDetectorModelConfig::processStanza(const boost::property_tree::ptre
             for (auto& factory : m_Factories) {
                 factory.second->pruneWindowScaleMaximum(factor);
             }
+        } else if (propName == MODEL_SPILL_DIRECTORY) {
+            for (auto& factory : m_Factories) {
+                factory.second->modelSpillDirectory(propValue);
+            }
         } else if (propName == AGGREGATION_STYLE_PARAMS) {
             core::CStringUtils::trimWhitespace(propValue);
             propValue = core::CStringUtils::normaliseWhitespace(propValue);
@@ -211,7 +211,7 @@ CBucketGatherer::CBucketGatherer(CDataGatherer& dataGatherer,
       m_PersonAttributeCounts(dataGatherer.params().s_LatencyBuckets,
                               dataGatherer.params().s_BucketLength,
                               startTime,
-                              TSizeSizePrUInt64UMap(1)),
+                              TSizeSizePrUInt64UMap{}),
       m_PersonAttributeExplicitNulls(dataGatherer.params().s_LatencyBuckets,
                                      dataGatherer.params().s_BucketLength,
                                      startTime,
@@ -297,11 +297,7 @@ bool CBucketGatherer::addEventData(CEventData& data) {
                 const auto& inf = CStringStore::influencers().get(*influence);
                 canonicalInfluences[i] = inf;
                 if (count > 0) {
-                    influencerCounts[i]
-                        .emplace(boost::unordered::piecewise_construct,
-                                 boost::make_tuple(pidCid, inf),
-                                 boost::make_tuple(std::uint64_t(0)))
-                        .first->second += count;
+                    influencerCounts[i][{pidCid, inf}] += count;
                 }
             }
         }
@@ -329,10 +325,18 @@ void CBucketGatherer::hiddenTimeNow(core_t::TTime time, bool skipUpdates) {
         // after startNewBucket has been called.
         std::ptrdiff_t numberInfluences{this->endInfluencers() - this->beginInfluencers()};
         this->startNewBucket(newBucketStart, skipUpdates);
-        m_PersonAttributeCounts.push(TSizeSizePrUInt64UMap(1), newBucketStart);
-        m_PersonAttributeExplicitNulls.push(TSizeSizePrUSet(1), newBucketStart);
-        m_InfluencerCounts.push(TSizeSizePrStoredStringPtrPrUInt64UMapVec(numberInfluences),
-                                newBucketStart);
+        // Reuse the storage of the bucket which drops out of the latency
+        // window to avoid allocating the bucket's maps for every bucket.
+        m_PersonAttributeCounts.recycle(
+            newBucketStart, [](TSizeSizePrUInt64UMap& counts) { counts.recycle(); });
+        m_PersonAttributeExplicitNulls.recycle(
+            newBucketStart, [](TSizeSizePrUSet& nulls) { nulls.clear(); });
+        m_InfluencerCounts.recycle(newBucketStart, [numberInfluences](auto& counts) {
+            counts.resize(numberInfluences);
+            for (auto& influencerCounts : counts) {
+                influencerCounts.recycle();
+            }
+        });
         m_BucketStart = newBucketStart;
     }
 }
@@ -565,7 +569,7 @@ std::size_t CBucketGatherer::memoryUsage() const {
 }
 
 void CBucketGatherer::clear() {
-    m_PersonAttributeCounts.clear(TSizeSizePrUInt64UMap(1));
+    m_PersonAttributeCounts.clear(TSizeSizePrUInt64UMap{});
     m_PersonAttributeExplicitNulls.clear(TSizeSizePrUSet(1));
     m_InfluencerCounts.clear(TSizeSizePrStoredStringPtrPrUInt64UMapVec(
         this->endInfluencers() - this->beginInfluencers()));
@@ -618,10 +622,10 @@ bool CBucketGatherer::baseAcceptRestoreTraverser(core::CStateRestoreTraverser& t
             BUCKET_COUNT_TAG,
             m_PersonAttributeCounts = TSizeSizePrUInt64UMapQueue(
                 m_DataGatherer.params().s_LatencyBuckets, this->bucketLength(),
-                m_BucketStart, TSizeSizePrUInt64UMap(1)),
+                m_BucketStart, TSizeSizePrUInt64UMap{}),
             traverser.traverseSubLevel(std::bind<bool>(
                 TSizeSizePrUInt64UMapQueue::CSerializer<detail::SBucketCountsPersister>(
-                    TSizeSizePrUInt64UMap(1)),
+                    TSizeSizePrUInt64UMap{}),
                 std::ref(m_PersonAttributeCounts), std::placeholders::_1)),
             /**/)
         RESTORE_SETUP_TEARDOWN(
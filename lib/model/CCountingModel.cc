@@ -286,6 +286,10 @@ void CCountingModel::doSkipSampling(core_t::TTime /*startTime*/, core_t::TTime /
 void CCountingModel::prune(std::size_t /*maximumAge*/) {
 }
 
+bool CCountingModel::sampleDependsOnResourceMonitor() const {
+    return false;
+}
+
 bool CCountingModel::computeProbability(std::size_t pid,
                                         core_t::TTime startTime,
                                         core_t::TTime endTime,
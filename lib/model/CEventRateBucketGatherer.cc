@@ -11,6 +11,7 @@
 
 #include <model/CEventRateBucketGatherer.h>
 
+#include <core/CFlatHashMap.h>
 #include <core/CFunctional.h>
 #include <core/CMemoryDefStd.h>
 #include <core/CProgramCounters.h>
@@ -55,11 +56,11 @@ using TSizeUSet = boost::unordered_set<std::size_t>;
 using TSizeUSetCItr = TSizeUSet::const_iterator;
 using TSizeUSetVec = std::vector<TSizeUSet>;
 using TMeanAccumulator = maths::common::CBasicStatistics::SSampleMean<double>::TAccumulator;
-using TSizeSizePrMeanAccumulatorUMap = boost::unordered_map<TSizeSizePr, TMeanAccumulator>;
+using TSizeSizePrMeanAccumulatorUMap = core::CFlatHashMap<TSizeSizePr, TMeanAccumulator>;
 using TSizeSizePrUInt64Map = std::map<TSizeSizePr, std::uint64_t>;
 using TSizeSizePrMeanAccumulatorUMapQueue = CBucketQueue<TSizeSizePrMeanAccumulatorUMap>;
 using TCategoryAnyMap = CEventRateBucketGatherer::TCategoryAnyMap;
-using TSizeSizePrStrDataUMap = boost::unordered_map<TSizeSizePr, CUniqueStringFeatureData>;
+using TSizeSizePrStrDataUMap = core::CFlatHashMap<TSizeSizePr, CUniqueStringFeatureData>;
 using TSizeSizePrStrDataUMapQueue = CBucketQueue<TSizeSizePrStrDataUMap>;
 using TStoredStringPtrVec = CBucketGatherer::TStoredStringPtrVec;
 
@@ -272,11 +273,11 @@ bool restoreFeatureData(core::CStateRestoreTraverser& traverser,
             &featureData
                  .emplace(model_t::E_UniqueValues,
                           TSizeSizePrStrDataUMapQueue(latencyBuckets, bucketLength, currentBucketStartTime,
-                                                      TSizeSizePrStrDataUMap(1)))
+                                                      TSizeSizePrStrDataUMap{}))
                  .first->second)};
         if (traverser.traverseSubLevel(std::bind<bool>(
                 TSizeSizePrStrDataUMapQueue::CSerializer<SStrDataBucketSerializer>(
-                    TSizeSizePrStrDataUMap(1)),
+                    TSizeSizePrStrDataUMap{}),
                 std::ref(*data), std::placeholders::_1)) == false) {
             LOG_ERROR(<< "Invalid unique value mapping in " << traverser.value());
             return false;
@@ -501,7 +502,7 @@ struct SChecksum {
         }
     }
     template<typename DATA>
-    void checksum(const boost::unordered_map<TSizeSizePr, DATA>& bucket,
+    void checksum(const core::CFlatHashMap<TSizeSizePr, DATA>& bucket,
                   const CDataGatherer& gatherer,
                   TStrUInt64Map& hashes) const {
         using TSizeUInt64VecUMap = boost::unordered_map<std::size_t, TUInt64Vec>;
@@ -572,7 +573,7 @@ struct SAddValue {
             LOG_ERROR(<< "No queue item for time " << time << ", end of latest bucket "
                       << personAttributeUniqueCounts.latestBucketEnd() << ", bucket length "
                       << personAttributeUniqueCounts.bucketLength());
-            personAttributeUniqueCounts.push(TSizeSizePrStrDataUMap(1), time);
+            personAttributeUniqueCounts.push(TSizeSizePrStrDataUMap{}, time);
         }
         TSizeSizePrStrDataUMap& counts = personAttributeUniqueCounts.get(time);
         counts[{pid, cid}].insert(*uniqueString, influences);
@@ -589,7 +590,7 @@ struct SAddValue {
             LOG_ERROR(<< "No queue item for time " << time << ", end of latest bucket "
                       << arrivalTimes.latestBucketEnd() << ", bucket length "
                       << arrivalTimes.bucketLength());
-            arrivalTimes.push(TSizeSizePrMeanAccumulatorUMap(1), time);
+            arrivalTimes.push(TSizeSizePrMeanAccumulatorUMap{}, time);
         }
         TSizeSizePrMeanAccumulatorUMap& times = arrivalTimes.get(time);
         for (std::size_t i = 0; i < count; i++) {
@@ -604,7 +605,8 @@ struct SNewBucket {
     void operator()(TSizeSizePrStrDataUMapQueue& personAttributeUniqueCounts,
                     core_t::TTime time) const {
         if (time > personAttributeUniqueCounts.latestBucketEnd()) {
-            personAttributeUniqueCounts.push(TSizeSizePrStrDataUMap(1), time);
+            personAttributeUniqueCounts.recycle(
+                time, [](TSizeSizePrStrDataUMap& counts) { counts.recycle(); });
         } else {
             personAttributeUniqueCounts.get(time).clear();
         }
@@ -612,7 +614,8 @@ struct SNewBucket {
     void operator()(TSizeSizePrMeanAccumulatorUMapQueue& arrivalTimes,
                     core_t::TTime time) const {
         if (time > arrivalTimes.latestBucketEnd()) {
-            arrivalTimes.push(TSizeSizePrMeanAccumulatorUMap(1), time);
+            arrivalTimes.recycle(
+                time, [](TSizeSizePrMeanAccumulatorUMap& times) { times.recycle(); });
         } else {
             arrivalTimes.get(time).clear();
         }
@@ -1569,7 +1572,7 @@ void CEventRateBucketGatherer::initializeFeatureData() {
         case model_t::E_IndividualLowInfoContentByBucketAndPerson:
             m_FeatureData[model_t::E_UniqueValues] = TSizeSizePrStrDataUMapQueue(
                 m_DataGatherer.params().s_LatencyBuckets, this->bucketLength(),
-                this->currentBucketStartTime(), TSizeSizePrStrDataUMap(1));
+                this->currentBucketStartTime(), TSizeSizePrStrDataUMap{});
             break;
 
         case model_t::E_PopulationAttributeTotalCountByPerson:
@@ -1590,7 +1593,7 @@ void CEventRateBucketGatherer::initializeFeatureData() {
         case model_t::E_PopulationHighInfoContentByBucketPersonAndAttribute:
             m_FeatureData[model_t::E_UniqueValues] = TSizeSizePrStrDataUMapQueue(
                 m_DataGatherer.params().s_LatencyBuckets, this->bucketLength(),
-                this->currentBucketStartTime(), TSizeSizePrStrDataUMap(1));
+                this->currentBucketStartTime(), TSizeSizePrStrDataUMap{});
             break;
         case model_t::E_PopulationTimeOfDayByBucketPersonAndAttribute:
         case model_t::E_PopulationTimeOfWeekByBucketPersonAndAttribute:
@@ -157,13 +157,12 @@ CEventRatePopulationModel::CEventRatePopulationModel(bool isForPersistence,
         LOG_ABORT(<< "This constructor only creates clones for persistence");
     }
 
-    m_FeatureModels.reserve(m_FeatureModels.size());
+    // The models are only copied when they're next modified unless they are
+    // referenced by correlation models.
+    m_FeatureModels.reserve(other.m_FeatureModels.size());
     for (const auto& feature : other.m_FeatureModels) {
-        m_FeatureModels.emplace_back(feature.s_Feature, feature.s_NewModel);
-        m_FeatureModels.back().s_Models.reserve(feature.s_Models.size());
-        for (const auto& model : feature.s_Models) {
-            m_FeatureModels.back().s_Models.emplace_back(model->cloneForPersistence());
-        }
+        m_FeatureModels.push_back(
+            feature.cloneForPersistence(other.m_FeatureCorrelatesModels.empty()));
     }
 
     m_FeatureCorrelatesModels.reserve(other.m_FeatureCorrelatesModels.size());
@@ -252,6 +251,25 @@ CAnomalyDetectorModel* CEventRatePopulationModel::cloneForPersistence() const {
     return new CEventRatePopulationModel(true, *this);
 }
 
+void CEventRatePopulationModel::persistChangedModelsOnly() {
+    for (auto& feature : m_FeatureModels) {
+        feature.s_PersistChangedOnly = true;
+    }
+}
+
+bool CEventRatePopulationModel::hasMissingModels() const {
+    return SFeatureModels::hasMissingModels(m_FeatureModels);
+}
+
+void CEventRatePopulationModel::restoreMissingModels(CAnomalyDetectorModel& other) {
+    auto* other_ = dynamic_cast<CEventRatePopulationModel*>(&other);
+    if (other_ == nullptr) {
+        LOG_ERROR(<< "Can't restore models from a different type of model");
+        return;
+    }
+    SFeatureModels::restoreMissingModels(m_FeatureModels, other_->m_FeatureModels);
+}
+
 model_t::EModelType CEventRatePopulationModel::category() const {
     return model_t::E_EventRateOnline;
 }
@@ -962,7 +980,7 @@ void CEventRatePopulationModel::createNewModels(std::size_t n, std::size_t m) {
             std::size_t newM = feature.s_Models.size() + m;
             core::CAllocationStrategy::reserve(feature.s_Models, newM);
             for (std::size_t cid = feature.s_Models.size(); cid < newM; ++cid) {
-                feature.s_Models.emplace_back(feature.s_NewModel->clone(cid));
+                feature.addModel(feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -979,7 +997,7 @@ void CEventRatePopulationModel::updateRecycledModels() {
     for (auto cid : gatherer.recycledAttributeIds()) {
         for (auto& feature : m_FeatureModels) {
             if (cid < feature.s_Models.size()) {
-                feature.s_Models[cid].reset(feature.s_NewModel->clone(cid));
+                feature.replaceModel(cid, feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -1012,7 +1030,7 @@ void CEventRatePopulationModel::clearPrunedResources(const TSizeVec& /*people*/,
     for (auto cid : attributes) {
         for (auto& feature : m_FeatureModels) {
             if (cid < feature.s_Models.size()) {
-                feature.s_Models[cid].reset(this->tinyModel());
+                feature.replaceModel(cid, this->tinyModel());
             }
         }
     }
@@ -1025,8 +1043,8 @@ const CInterimBucketCorrector& CEventRatePopulationModel::interimValueCorrector(
 void CEventRatePopulationModel::doSkipSampling(core_t::TTime startTime, core_t::TTime endTime) {
     core_t::TTime gap = endTime - startTime;
     for (auto& feature : m_FeatureModels) {
-        for (auto& model : feature.s_Models) {
-            model->skipTime(gap);
+        for (std::size_t id = 0; id < feature.s_Models.size(); ++id) {
+            feature.modelToModify(id)->skipTime(gap);
         }
     }
     this->CPopulationModel::doSkipSampling(startTime, endTime);
@@ -1034,7 +1052,13 @@ void CEventRatePopulationModel::doSkipSampling(core_t::TTime startTime, core_t::
 
 const maths::common::CModel*
 CEventRatePopulationModel::model(model_t::EFeature feature, std::size_t cid) const {
-    return const_cast<CEventRatePopulationModel*>(this)->model(feature, cid);
+    auto i = std::find_if(m_FeatureModels.begin(), m_FeatureModels.end(),
+                          [feature](const SFeatureModels& model) {
+                              return model.s_Feature == feature;
+                          });
+    return i != m_FeatureModels.end() && cid < i->s_Models.size()
+               ? i->s_Models[cid].get()
+               : nullptr;
 }
 
 maths::common::CModel* CEventRatePopulationModel::model(model_t::EFeature feature,
@@ -1044,7 +1068,7 @@ maths::common::CModel* CEventRatePopulationModel::model(model_t::EFeature featur
                               return model.s_Feature == feature;
                           });
     return i != m_FeatureModels.end() && cid < i->s_Models.size()
-               ? i->s_Models[cid].get()
+               ? i->modelToModify(cid)
                : nullptr;
 }
 
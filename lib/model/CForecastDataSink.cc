@@ -95,6 +95,35 @@ bool CForecastDataSink::CForecastModelWrapper::forecast(const SForecastResultSer
         message);
 }
 
+bool CForecastDataSink::CForecastModelWrapper::forecast(core_t::TTime startTime,
+                                                        core_t::TTime endTime,
+                                                        double boundsPercentile,
+                                                        TErrorBarVec& errorBars,
+                                                        std::string& message) const {
+    core_t::TTime bucketLength{m_ForecastModel->params().bucketLength()};
+    startTime = model_t::sampleTime(m_Feature, startTime, bucketLength);
+    endTime = model_t::sampleTime(m_Feature, endTime, bucketLength);
+    model_t::TDouble1VecDouble1VecPr support{model_t::support(m_Feature)};
+    return m_ForecastModel->forecast(
+        m_FirstDataTime, m_LastDataTime, startTime, endTime, boundsPercentile,
+        support.first, support.second,
+        [&errorBars](maths::common::SErrorBar errorBar) {
+            errorBars.push_back(errorBar);
+        },
+        message);
+}
+
+void CForecastDataSink::CForecastModelWrapper::write(const SForecastResultSeries& series,
+                                                     const TErrorBarVec& errorBars,
+                                                     CForecastDataSink& sink) const {
+    std::string feature{model_t::print(m_Feature)};
+    for (const auto& errorBar : errorBars) {
+        sink.push(errorBar, feature, series.s_PartitionFieldName,
+                  series.s_PartitionFieldValue, series.s_ByFieldName,
+                  m_ByFieldValue, series.s_DetectorIndex);
+    }
+}
+
 CForecastDataSink::SForecastResultSeries::SForecastResultSeries(const SModelParams& modelParams)
     : s_ModelParams(modelParams), s_DetectorIndex(), s_ToForecastPersisted(),
       s_ByFieldName(), s_MinimumSeasonalVarianceScale(0.0) {
@@ -225,9 +225,10 @@ void CGathererTools::CSumGatherer::startNewBucket(core_t::TTime time) {
     if (!sum.empty()) {
         m_Classifier.add(model_t::E_IndividualSumByBucketAndPerson, sum[0].value(), 1);
     }
-    m_BucketSums.push(TSampleVec(), time);
+    m_BucketSums.recycle(time, [](TSampleVec& sums) { sums.clear(); });
     for (std::size_t i = 0; i < m_InfluencerBucketSums.size(); ++i) {
-        m_InfluencerBucketSums[i].push(TStoredStringPtrDoubleUMap(1), time);
+        m_InfluencerBucketSums[i].recycle(
+            time, [](TStoredStringPtrDoubleUMap& sums) { sums.clear(); });
     }
 }
 
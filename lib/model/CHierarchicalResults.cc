@@ -24,6 +24,7 @@
 #include <model/CStringStore.h>
 
 #include <algorithm>
+#include <iterator>
 
 namespace ml {
 namespace model {
@@ -369,6 +370,16 @@ void CHierarchicalResults::addInfluencer(const std::string& name) {
     this->newPivotRoot(CStringStore::influencers().get(name));
 }
 
+void CHierarchicalResults::merge(CHierarchicalResults&& other) {
+    std::move(other.m_Nodes.begin(), other.m_Nodes.end(), std::back_inserter(m_Nodes));
+    // Pivot roots are keyed by the influencer name and only hold the name.
+    for (auto& root : other.m_PivotRootNodes) {
+        m_PivotRootNodes.insert(std::move(root));
+    }
+    other.m_Nodes.clear();
+    other.m_PivotRootNodes.clear();
+}
+
 void CHierarchicalResults::buildHierarchy() {
     using TNodePtrVec = std::vector<SNode*>;
 
@@ -12,6 +12,8 @@
 #include <model/CIndividualModel.h>
 
 #include <core/CAllocationStrategy.h>
+#include <core/CBinaryStatePersistInserter.h>
+#include <core/CBinaryStateRestoreTraverser.h>
 #include <core/CLogger.h>
 #include <core/CMemoryDef.h>
 #include <core/CProgramCounters.h>
@@ -21,6 +23,9 @@
 #include <maths/common/CChecksum.h>
 #include <maths/common/CMultivariatePrior.h>
 #include <maths/common/COrderings.h>
+#include <maths/common/CRestoreParams.h>
+
+#include <maths/time_series/CModelStateSerialiser.h>
 
 #include <model/CAnnotatedProbability.h>
 #include <model/CDataGatherer.h>
@@ -29,6 +34,7 @@
 
 #include <algorithm>
 #include <map>
+#include <sstream>
 
 namespace ml {
 namespace model {
@@ -67,6 +73,7 @@ const std::string FEATURE_CORRELATE_MODELS_TAG("f");
 //const std::string INTERIM_BUCKET_CORRECTOR_TAG("h");
 const std::string MEMORY_ESTIMATOR_TAG("i");
 const std::string UPGRADING_PRE_7_5_STATE("j");
+const std::string SPILLED_MODELS_TAG("k");
 }
 
 CIndividualModel::CIndividualModel(const SModelParams& params,
@@ -109,13 +116,12 @@ CIndividualModel::CIndividualModel(bool isForPersistence, const CIndividualModel
         LOG_ABORT(<< "This constructor only creates clones for persistence");
     }
 
-    m_FeatureModels.reserve(m_FeatureModels.size());
+    // The models are only copied when they're next modified unless they are
+    // referenced by correlation models.
+    m_FeatureModels.reserve(other.m_FeatureModels.size());
     for (const auto& feature : other.m_FeatureModels) {
-        m_FeatureModels.emplace_back(feature.s_Feature, feature.s_NewModel);
-        m_FeatureModels.back().s_Models.reserve(feature.s_Models.size());
-        for (const auto& model : feature.s_Models) {
-            m_FeatureModels.back().s_Models.emplace_back(model->cloneForPersistence());
-        }
+        m_FeatureModels.push_back(
+            feature.cloneForPersistence(other.m_FeatureCorrelatesModels.empty()));
     }
 
     m_FeatureCorrelatesModels.reserve(other.m_FeatureCorrelatesModels.size());
@@ -194,6 +200,11 @@ void CIndividualModel::sample(core_t::TTime startTime,
     }
 }
 
+bool CIndividualModel::sampleDependsOnResourceMonitor() const {
+    return this->params().s_MultivariateByFields ||
+           this->dataGatherer().numberPeople() > m_FirstBucketTimes.size();
+}
+
 void CIndividualModel::prune(std::size_t maximumAge) {
     core_t::TTime time = this->currentBucketStartTime();
 
@@ -225,7 +236,9 @@ void CIndividualModel::prune(std::size_t maximumAge) {
     LOG_DEBUG(<< "Removing people {" << this->printPeople(peopleToRemove, 20) << '}');
 
     // We clear large state objects from removed people's model
-    // and reinitialize it when they are recycled.
+    // and reinitialize it when they are recycled, or restore it
+    // if it was spilled.
+    this->spillModels(peopleToRemove);
     this->clearPrunedResources(peopleToRemove, TSizeVec());
 }
 
@@ -289,6 +302,7 @@ void CIndividualModel::debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePt
     core::memory_debug::dynamicSize("m_FeatureCorrelatesModels",
                                     m_FeatureCorrelatesModels, mem);
     core::memory_debug::dynamicSize("m_MemoryEstimator", m_MemoryEstimator, mem);
+    core::memory_debug::dynamicSize("m_SpillStore", m_SpillStore, mem);
 }
 
 std::size_t CIndividualModel::memoryUsage() const {
@@ -306,6 +320,7 @@ std::size_t CIndividualModel::computeMemoryUsage() const {
     mem += core::memory::dynamicSize(m_FeatureModels);
     mem += core::memory::dynamicSize(m_FeatureCorrelatesModels);
     mem += core::memory::dynamicSize(m_MemoryEstimator);
+    mem += core::memory::dynamicSize(m_SpillStore);
     return mem;
 }
 
@@ -331,6 +346,25 @@ void CIndividualModel::doPersistModelsState(core::CStatePersistInserter& inserte
     }
 }
 
+void CIndividualModel::persistChangedModelsOnly() {
+    for (auto& feature : m_FeatureModels) {
+        feature.s_PersistChangedOnly = true;
+    }
+}
+
+bool CIndividualModel::hasMissingModels() const {
+    return SFeatureModels::hasMissingModels(m_FeatureModels);
+}
+
+void CIndividualModel::restoreMissingModels(CAnomalyDetectorModel& other) {
+    auto* other_ = dynamic_cast<CIndividualModel*>(&other);
+    if (other_ == nullptr) {
+        LOG_ERROR(<< "Can't restore models from a different type of model");
+        return;
+    }
+    SFeatureModels::restoreMissingModels(m_FeatureModels, other_->m_FeatureModels);
+}
+
 bool CIndividualModel::shouldPersist() const {
     return std::any_of(m_FeatureModels.begin(), m_FeatureModels.end(),
                        [](const auto& model) { return model.shouldPersist(); });
@@ -477,8 +511,9 @@ void CIndividualModel::createUpdateNewModels(core_t::TTime time,
 }
 
 void CIndividualModel::createNewModels(std::size_t n, std::size_t m) {
+    std::size_t numberExistingPeople = m_FirstBucketTimes.size();
     if (n > 0) {
-        std::size_t newN = m_FirstBucketTimes.size() + n;
+        std::size_t newN = numberExistingPeople + n;
         core::CAllocationStrategy::resize(m_FirstBucketTimes, newN,
                                           CAnomalyDetectorModel::TIME_UNSET);
         core::CAllocationStrategy::resize(m_LastBucketTimes, newN,
@@ -486,7 +521,7 @@ void CIndividualModel::createNewModels(std::size_t n, std::size_t m) {
         for (auto& feature : m_FeatureModels) {
             core::CAllocationStrategy::reserve(feature.s_Models, newN);
             for (std::size_t pid = feature.s_Models.size(); pid < newN; ++pid) {
-                feature.s_Models.emplace_back(feature.s_NewModel->clone(pid));
+                feature.addModel(feature.s_NewModel->clone(pid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -496,15 +531,19 @@ void CIndividualModel::createNewModels(std::size_t n, std::size_t m) {
         }
     }
     this->CAnomalyDetectorModel::createNewModels(n, m);
+    for (std::size_t pid = numberExistingPeople; pid < m_FirstBucketTimes.size(); ++pid) {
+        this->rehydrateModels(pid);
+    }
 }
 
 void CIndividualModel::updateRecycledModels() {
-    for (auto pid : this->dataGatherer().recycledPersonIds()) {
+    const TSizeVec& recycledPeople = this->dataGatherer().recycledPersonIds();
+    for (auto pid : recycledPeople) {
         if (pid < m_FirstBucketTimes.size()) {
             m_FirstBucketTimes[pid] = CAnomalyDetectorModel::TIME_UNSET;
             m_LastBucketTimes[pid] = CAnomalyDetectorModel::TIME_UNSET;
             for (auto& feature : m_FeatureModels) {
-                feature.s_Models[pid].reset(feature.s_NewModel->clone(pid));
+                feature.replaceModel(pid, feature.s_NewModel->clone(pid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -513,7 +552,18 @@ void CIndividualModel::updateRecycledModels() {
             }
         }
     }
+    // This resets the state for the recycled people held by the base
+    // class and clears them so we need to rehydrate a copy.
+    TSizeVec peopleToRehydrate;
+    if (m_SpillStore != nullptr) {
+        peopleToRehydrate = recycledPeople;
+    }
     this->CAnomalyDetectorModel::updateRecycledModels();
+    for (auto pid : peopleToRehydrate) {
+        if (pid < m_FirstBucketTimes.size()) {
+            this->rehydrateModels(pid);
+        }
+    }
 }
 
 void CIndividualModel::refreshCorrelationModels(std::size_t resourceLimit,
@@ -537,7 +587,7 @@ void CIndividualModel::clearPrunedResources(const TSizeVec& people,
     for (auto pid : people) {
         for (auto& feature : m_FeatureModels) {
             if (pid < feature.s_Models.size()) {
-                feature.s_Models[pid].reset(this->tinyModel());
+                feature.replaceModel(pid, this->tinyModel());
             }
         }
     }
@@ -558,7 +608,13 @@ double CIndividualModel::emptyBucketWeight(model_t::EFeature feature,
 
 const maths::common::CModel* CIndividualModel::model(model_t::EFeature feature,
                                                      std::size_t pid) const {
-    return const_cast<CIndividualModel*>(this)->model(feature, pid);
+    auto i = std::find_if(m_FeatureModels.begin(), m_FeatureModels.end(),
+                          [feature](const SFeatureModels& model) {
+                              return model.s_Feature == feature;
+                          });
+    return i != m_FeatureModels.end() && pid < i->s_Models.size()
+               ? i->s_Models[pid].get()
+               : nullptr;
 }
 
 maths::common::CModel* CIndividualModel::model(model_t::EFeature feature, std::size_t pid) {
@@ -567,7 +623,7 @@ maths::common::CModel* CIndividualModel::model(model_t::EFeature feature, std::s
                               return model.s_Feature == feature;
                           });
     return i != m_FeatureModels.end() && pid < i->s_Models.size()
-               ? i->s_Models[pid].get()
+               ? i->modelToModify(pid)
                : nullptr;
 }
 
@@ -636,10 +692,116 @@ void CIndividualModel::doSkipSampling(core_t::TTime startTime, core_t::TTime end
     }
 
     for (auto& feature : m_FeatureModels) {
-        for (auto& model : feature.s_Models) {
-            model->skipTime(gap);
+        for (std::size_t id = 0; id < feature.s_Models.size(); ++id) {
+            feature.modelToModify(id)->skipTime(gap);
         }
     }
 }
+
+void CIndividualModel::spillModels(const TSizeVec& people) {
+    const std::string& directory{this->params().s_ModelSpillDirectory};
+    if (directory.empty()) {
+        return;
+    }
+    if (m_SpillStore == nullptr) {
+        m_SpillStore = std::make_unique<CModelSpillStore>(directory);
+    }
+
+    const CDataGatherer& gatherer{this->dataGatherer()};
+    for (auto pid : people) {
+        if (std::any_of(m_FeatureModels.begin(), m_FeatureModels.end(),
+                        [pid](const SFeatureModels& feature) {
+                            return pid >= feature.s_Models.size() ||
+                                   feature.s_Models[pid] == nullptr;
+                        })) {
+            continue;
+        }
+        std::ostringstream state;
+        {
+            core::CBinaryStatePersistInserter inserter{state};
+            inserter.insertLevel(SPILLED_MODELS_TAG, [&](core::CStatePersistInserter& inserter_) {
+                inserter_.insertValue(PERSON_BUCKET_COUNT_TAG,
+                                      this->personBucketCounts()[pid],
+                                      core::CIEEE754::E_DoublePrecision);
+                inserter_.insertValue(FIRST_BUCKET_TIME_TAG, m_FirstBucketTimes[pid]);
+                for (const auto& feature : m_FeatureModels) {
+                    inserter_.insertLevel(
+                        FEATURE_MODELS_TAG,
+                        std::bind<void>(maths::time_series::CModelStateSerialiser(),
+                                        std::cref(*feature.s_Models[pid]),
+                                        std::placeholders::_1));
+                }
+            });
+        }
+        if (m_SpillStore->spill(gatherer.personName(pid), state.str()) == false) {
+            LOG_WARN(<< "Failed to spill models for " << gatherer.personName(pid));
+        }
+    }
+}
+
+bool CIndividualModel::rehydrateModels(std::size_t pid) {
+    if (m_SpillStore == nullptr) {
+        return false;
+    }
+
+    const CDataGatherer& gatherer{this->dataGatherer()};
+    std::string state;
+    if (m_SpillStore->rehydrate(gatherer.personName(pid), state) == false) {
+        return false;
+    }
+
+    double personBucketCount{0.0};
+    core_t::TTime firstBucketTime{CAnomalyDetectorModel::TIME_UNSET};
+    TMathsModelUPtrVec models;
+    models.reserve(m_FeatureModels.size());
+
+    std::istringstream strm{state};
+    core::CBinaryStateRestoreTraverser spilled{strm};
+    if (spilled.traverseSubLevel([&](core::CStateRestoreTraverser& traverser) {
+            do {
+                const std::string& name{traverser.name()};
+                RESTORE_BUILT_IN(PERSON_BUCKET_COUNT_TAG, personBucketCount)
+                RESTORE_BUILT_IN(FIRST_BUCKET_TIME_TAG, firstBucketTime)
+                if (name == FEATURE_MODELS_TAG) {
+                    if (models.size() == m_FeatureModels.size()) {
+                        return false;
+                    }
+                    const auto& newModel = m_FeatureModels[models.size()].s_NewModel;
+                    maths_t::EDataType dataType{newModel->dataType()};
+                    maths::common::SModelRestoreParams params{
+                        newModel->params(),
+                        this->params().decompositionRestoreParams(dataType),
+                        this->params().distributionRestoreParams(dataType)};
+                    TMathsModelUPtr model;
+                    if (traverser.traverseSubLevel(std::bind<bool>(
+                            maths::time_series::CModelStateSerialiser(), std::cref(params),
+                            std::ref(model), std::placeholders::_1)) == false) {
+                        return false;
+                    }
+                    models.push_back(std::move(model));
+                }
+            } while (traverser.next());
+            return true;
+        }) == false ||
+        models.size() != m_FeatureModels.size()) {
+        LOG_ERROR(<< "Failed to restore spilled models for " << gatherer.personName(pid));
+        return false;
+    }
+
+    this->personBucketCounts()[pid] = personBucketCount;
+    m_FirstBucketTimes[pid] = firstBucketTime;
+    for (std::size_t i = 0; i < m_FeatureModels.size(); ++i) {
+        auto& feature = m_FeatureModels[i];
+        feature.replaceModel(pid, models[i]->clone(pid));
+        for (const auto& correlates : m_FeatureCorrelatesModels) {
+            if (feature.s_Feature == correlates.s_Feature) {
+                feature.s_Models[pid]->modelCorrelations(*correlates.s_Models);
+            }
+        }
+    }
+    LOG_TRACE(<< "Restored spilled models for " << gatherer.personName(pid));
+
+    return true;
+}
 }
 }
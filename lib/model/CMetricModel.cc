@@ -230,12 +230,6 @@ void CMetricModel::sample(core_t::TTime startTime,
                 std::size_t pid = data_.first;
                 const CGathererTools::TSampleVec& samples = data_.second.s_Samples;
 
-                maths::common::CModel* model = this->model(feature, pid);
-                if (model == nullptr) {
-                    LOG_ERROR(<< "Missing model for " << this->personName(pid));
-                    continue;
-                }
-
                 // initialCountWeight returns a weight value as double:
                 // 0.0 if checkScheduledEvents is true
                 // 1.0 if both checkScheduledEvents and checkRules are false
@@ -251,6 +245,19 @@ void CMetricModel::sample(core_t::TTime startTime,
                 core_t::TTime sampleTime = model_t::sampleTime(feature, time, bucketLength);
                 double initialCountWeight{this->initialCountWeight(
                     feature, pid, model_t::INDIVIDUAL_ANALYSIS_ATTRIBUTE_ID, sampleTime)};
+                if (initialCountWeight != 0.0 && samples.empty() &&
+                    (model_t::isSampled(feature) == false ||
+                     data_.second.s_BucketValue == std::nullopt)) {
+                    // There's nothing to update so don't get the model for
+                    // modification, which copies it if it is being persisted.
+                    continue;
+                }
+
+                maths::common::CModel* model = this->model(feature, pid);
+                if (model == nullptr) {
+                    LOG_ERROR(<< "Missing model for " << this->personName(pid));
+                    continue;
+                }
                 if (initialCountWeight == 0.0) {
                     model->skipTime(time - lastBucketTimesMap[pid]);
                     continue;
@@ -149,13 +149,12 @@ CMetricPopulationModel::CMetricPopulationModel(bool isForPersistence,
         LOG_ABORT(<< "This constructor only creates clones for persistence");
     }
 
-    m_FeatureModels.reserve(m_FeatureModels.size());
+    // The models are only copied when they're next modified unless they are
+    // referenced by correlation models.
+    m_FeatureModels.reserve(other.m_FeatureModels.size());
     for (const auto& feature : other.m_FeatureModels) {
-        m_FeatureModels.emplace_back(feature.s_Feature, feature.s_NewModel);
-        m_FeatureModels.back().s_Models.reserve(feature.s_Models.size());
-        for (const auto& model : feature.s_Models) {
-            m_FeatureModels.back().s_Models.emplace_back(model->cloneForPersistence());
-        }
+        m_FeatureModels.push_back(
+            feature.cloneForPersistence(other.m_FeatureCorrelatesModels.empty()));
     }
 
     m_FeatureCorrelatesModels.reserve(other.m_FeatureCorrelatesModels.size());
@@ -227,6 +226,25 @@ CAnomalyDetectorModel* CMetricPopulationModel::cloneForPersistence() const {
     return new CMetricPopulationModel(true, *this);
 }
 
+void CMetricPopulationModel::persistChangedModelsOnly() {
+    for (auto& feature : m_FeatureModels) {
+        feature.s_PersistChangedOnly = true;
+    }
+}
+
+bool CMetricPopulationModel::hasMissingModels() const {
+    return SFeatureModels::hasMissingModels(m_FeatureModels);
+}
+
+void CMetricPopulationModel::restoreMissingModels(CAnomalyDetectorModel& other) {
+    auto* other_ = dynamic_cast<CMetricPopulationModel*>(&other);
+    if (other_ == nullptr) {
+        LOG_ERROR(<< "Can't restore models from a different type of model");
+        return;
+    }
+    SFeatureModels::restoreMissingModels(m_FeatureModels, other_->m_FeatureModels);
+}
+
 model_t::EModelType CMetricPopulationModel::category() const {
     return model_t::E_MetricOnline;
 }
@@ -854,7 +872,7 @@ void CMetricPopulationModel::createNewModels(std::size_t n, std::size_t m) {
             std::size_t newM = feature.s_Models.size() + m;
             core::CAllocationStrategy::reserve(feature.s_Models, newM);
             for (std::size_t cid = feature.s_Models.size(); cid < newM; ++cid) {
-                feature.s_Models.emplace_back(feature.s_NewModel->clone(cid));
+                feature.addModel(feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -871,7 +889,7 @@ void CMetricPopulationModel::updateRecycledModels() {
     for (auto cid : gatherer.recycledAttributeIds()) {
         for (auto& feature : m_FeatureModels) {
             if (cid < feature.s_Models.size()) {
-                feature.s_Models[cid].reset(feature.s_NewModel->clone(cid));
+                feature.replaceModel(cid, feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -905,7 +923,7 @@ void CMetricPopulationModel::clearPrunedResources(const TSizeVec& /*people*/,
     for (auto cid : gatherer.recycledAttributeIds()) {
         for (auto& feature : m_FeatureModels) {
             if (cid < feature.s_Models.size()) {
-                feature.s_Models[cid].reset(feature.s_NewModel->clone(cid));
+                feature.replaceModel(cid, feature.s_NewModel->clone(cid));
                 for (const auto& correlates : m_FeatureCorrelatesModels) {
                     if (feature.s_Feature == correlates.s_Feature) {
                         feature.s_Models.back()->modelCorrelations(*correlates.s_Models);
@@ -923,8 +941,8 @@ const CInterimBucketCorrector& CMetricPopulationModel::interimValueCorrector() c
 void CMetricPopulationModel::doSkipSampling(core_t::TTime startTime, core_t::TTime endTime) {
     core_t::TTime gap = endTime - startTime;
     for (auto& feature : m_FeatureModels) {
-        for (auto& model : feature.s_Models) {
-            model->skipTime(gap);
+        for (std::size_t id = 0; id < feature.s_Models.size(); ++id) {
+            feature.modelToModify(id)->skipTime(gap);
         }
     }
     this->CPopulationModel::doSkipSampling(startTime, endTime);
@@ -932,7 +950,13 @@ void CMetricPopulationModel::doSkipSampling(core_t::TTime startTime, core_t::TTi
 
 const maths::common::CModel*
 CMetricPopulationModel::model(model_t::EFeature feature, std::size_t cid) const {
-    return const_cast<CMetricPopulationModel*>(this)->model(feature, cid);
+    auto i = std::find_if(m_FeatureModels.begin(), m_FeatureModels.end(),
+                          [feature](const SFeatureModels& model) {
+                              return model.s_Feature == feature;
+                          });
+    return i != m_FeatureModels.end() && cid < i->s_Models.size()
+               ? i->s_Models[cid].get()
+               : nullptr;
 }
 
 maths::common::CModel* CMetricPopulationModel::model(model_t::EFeature feature,
@@ -942,7 +966,7 @@ maths::common::CModel* CMetricPopulationModel::model(model_t::EFeature feature,
                               return model.s_Feature == feature;
                           });
     return i != m_FeatureModels.end() && cid < i->s_Models.size()
-               ? i->s_Models[cid].get()
+               ? i->modelToModify(cid)
                : nullptr;
 }
 
@@ -44,11 +44,21 @@ CModelFactory::CModelFactory(const SModelParams& params,
     : m_ModelParams(params), m_InterimBucketCorrector(interimBucketCorrector) {
 }
 
+CModelFactory::CModelFactory(const CModelFactory& other)
+    : m_ModelParams(other.m_ModelParams),
+      m_InterimBucketCorrector(other.m_InterimBucketCorrector) {
+    std::lock_guard<std::mutex> lock{other.m_CacheMutex};
+    m_MathsModelCache = other.m_MathsModelCache;
+    m_CorrelatePriorCache = other.m_CorrelatePriorCache;
+    m_InfluenceCalculatorCache = other.m_InfluenceCalculatorCache;
+}
+
 const CModelFactory::TFeatureMathsModelPtrPrVec&
 CModelFactory::defaultFeatureModels(const TFeatureVec& features,
                                     core_t::TTime bucketLength,
                                     double minimumSeasonalVarianceScale,
                                     bool modelAnomalies) const {
+    std::lock_guard<std::mutex> lock{m_CacheMutex};
     auto result = m_MathsModelCache.emplace(features, TFeatureMathsModelPtrPrVec());
     if (result.second) {
         result.first->second.reserve(features.size());
@@ -118,6 +128,7 @@ CModelFactory::defaultFeatureModel(model_t::EFeature feature,
 
 const CModelFactory::TFeatureMultivariatePriorSPtrPrVec&
 CModelFactory::defaultCorrelatePriors(const TFeatureVec& features) const {
+    std::lock_guard<std::mutex> lock{m_CacheMutex};
     auto result = m_CorrelatePriorCache.emplace(features, TFeatureMultivariatePriorSPtrPrVec{});
     if (result.second) {
         result.first->second.reserve(features.size());
@@ -180,6 +191,7 @@ CModelFactory::defaultDecomposition(model_t::EFeature feature, core_t::TTime buc
 const CModelFactory::TFeatureInfluenceCalculatorCPtrPrVec&
 CModelFactory::defaultInfluenceCalculators(const std::string& influencerName,
                                            const TFeatureVec& features) const {
+    std::lock_guard<std::mutex> lock{m_CacheMutex};
     auto& result = m_InfluenceCalculatorCache[{influencerName, features}];
 
     if (result.empty()) {
@@ -251,6 +263,10 @@ void CModelFactory::pruneWindowScaleMaximum(double factor) {
     m_ModelParams.s_PruneWindowScaleMaximum = factor;
 }
 
+void CModelFactory::modelSpillDirectory(const std::string& directory) {
+    m_ModelParams.s_ModelSpillDirectory = directory;
+}
+
 void CModelFactory::multibucketFeaturesWindowLength(std::size_t length) {
     m_ModelParams.s_MultibucketFeaturesWindowLength = length;
 }
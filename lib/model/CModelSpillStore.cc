@@ -0,0 +1,209 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <model/CModelSpillStore.h>
+
+#include <core/CLogger.h>
+#include <core/CMemoryDef.h>
+#include <core/CProcess.h>
+#include <core/CompressUtils.h>
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+namespace ml {
+namespace model {
+namespace {
+using TByteVec = core::CCompressUtil::TByteVec;
+
+//! Don't compact files smaller than this.
+const std::uint64_t MINIMUM_SIZE_TO_COMPACT{1024 * 1024};
+
+//! Used to give each store in the process its own file.
+std::atomic<std::uint64_t> fileCounter{0};
+
+const std::ios::openmode MODE{std::ios::in | std::ios::out | std::ios::binary};
+
+bool read(std::fstream& file, std::uint64_t offset, std::uint64_t length, TByteVec& bytes) {
+    bytes.resize(static_cast<std::size_t>(length));
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(length));
+    return file.good();
+}
+
+bool write(std::fstream& file, std::uint64_t offset, const TByteVec& bytes) {
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+}
+
+CModelSpillStore::CModelSpillStore(const std::string& directory)
+    : m_FileName{directory + "/ml_model_spill_" +
+                 std::to_string(core::CProcess::instance().id()) + "_" +
+                 std::to_string(fileCounter.fetch_add(1)) + ".bin"},
+      m_File{m_FileName, MODE | std::ios::trunc} {
+    if (m_File.is_open() == false) {
+        LOG_ERROR(<< "Failed to create model spill file '" << m_FileName << "'");
+    }
+}
+
+CModelSpillStore::~CModelSpillStore() {
+    m_File.close();
+    std::remove(m_FileName.c_str());
+}
+
+bool CModelSpillStore::spill(const std::string& key, const std::string& state) {
+    if (m_File.is_open() == false) {
+        return false;
+    }
+
+    auto entry = m_Index.find(key);
+    if (entry != m_Index.end()) {
+        this->erase(entry);
+    }
+
+    core::CDeflator deflator{false};
+    TByteVec bytes;
+    if (deflator.addString(state) == false || deflator.finishAndTakeData(bytes) == false) {
+        LOG_ERROR(<< "Failed to compress state for '" << key << "'");
+        return false;
+    }
+    if (write(m_File, m_FileSize, bytes) == false) {
+        LOG_ERROR(<< "Failed to write state for '" << key << "' to '" << m_FileName << "'");
+        m_File.clear();
+        return false;
+    }
+
+    m_Index.emplace(key, TUInt64UInt64Pr{m_FileSize, bytes.size()});
+    m_FileSize += bytes.size();
+    m_LiveSize += bytes.size();
+    return this->compactIfRequired();
+}
+
+bool CModelSpillStore::rehydrate(const std::string& key, std::string& state) {
+    auto entry = m_Index.find(key);
+    if (entry == m_Index.end()) {
+        return false;
+    }
+
+    TByteVec bytes;
+    bool read_{read(m_File, entry->second.first, entry->second.second, bytes)};
+    m_File.clear();
+    this->erase(entry);
+    if (read_ == false) {
+        LOG_ERROR(<< "Failed to read state for '" << key << "' from '" << m_FileName << "'");
+        return false;
+    }
+
+    core::CInflator inflator{false};
+    TByteVec inflated;
+    if (inflator.addVector(bytes) == false || inflator.finishAndTakeData(inflated) == false) {
+        LOG_ERROR(<< "Failed to decompress state for '" << key << "'");
+        return false;
+    }
+    state.assign(inflated.begin(), inflated.end());
+
+    this->compactIfRequired();
+    return true;
+}
+
+bool CModelSpillStore::contains(const std::string& key) const {
+    return m_Index.find(key) != m_Index.end();
+}
+
+std::size_t CModelSpillStore::size() const {
+    return m_Index.size();
+}
+
+std::uint64_t CModelSpillStore::fileSize() const {
+    return m_FileSize;
+}
+
+const std::string& CModelSpillStore::fileName() const {
+    return m_FileName;
+}
+
+void CModelSpillStore::debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const {
+    mem->setName("CModelSpillStore");
+    core::memory_debug::dynamicSize("m_FileName", m_FileName, mem);
+    core::memory_debug::dynamicSize("m_Index", m_Index, mem);
+}
+
+std::size_t CModelSpillStore::memoryUsage() const {
+    return core::memory::dynamicSize(m_FileName) + core::memory::dynamicSize(m_Index);
+}
+
+void CModelSpillStore::erase(TStrUInt64UInt64PrUMap::iterator entry) {
+    m_LiveSize -= entry->second.second;
+    m_Index.erase(entry);
+    if (m_Index.empty()) {
+        // Everything is dead so we can simply write from the start.
+        m_FileSize = 0;
+    }
+}
+
+bool CModelSpillStore::compactIfRequired() {
+    if (m_FileSize < MINIMUM_SIZE_TO_COMPACT || m_FileSize < 2 * m_LiveSize) {
+        return true;
+    }
+
+    LOG_TRACE(<< "Compacting '" << m_FileName << "' size = " << m_FileSize
+              << ", live = " << m_LiveSize);
+
+    // We lose the spilled state if compaction fails, which is equivalent
+    // to the models having been pruned without a spill store.
+    auto fail = [this](const std::string& error) {
+        LOG_ERROR(<< error);
+        m_Index.clear();
+        m_FileSize = 0;
+        m_LiveSize = 0;
+        m_File.clear();
+        return false;
+    };
+
+    std::string compactedFileName{m_FileName + ".compacting"};
+    std::fstream compacted{compactedFileName, MODE | std::ios::trunc};
+    if (compacted.is_open() == false) {
+        return fail("Failed to create '" + compactedFileName + "'");
+    }
+
+    std::uint64_t offset{0};
+    TByteVec bytes;
+    for (auto& entry : m_Index) {
+        if (read(m_File, entry.second.first, entry.second.second, bytes) == false ||
+            write(compacted, offset, bytes) == false) {
+            compacted.close();
+            std::remove(compactedFileName.c_str());
+            return fail("Failed to compact '" + m_FileName + "'");
+        }
+        entry.second.first = offset;
+        offset += entry.second.second;
+    }
+
+    m_File.close();
+    compacted.close();
+    std::remove(m_FileName.c_str());
+    if (std::rename(compactedFileName.c_str(), m_FileName.c_str()) != 0) {
+        m_File.open(m_FileName, MODE | std::ios::trunc);
+        return fail("Failed to replace '" + m_FileName + "'");
+    }
+    m_File.open(m_FileName, MODE);
+    if (m_File.is_open() == false) {
+        return fail("Failed to reopen '" + m_FileName + "'");
+    }
+    m_FileSize = offset;
+    return true;
+}
+}
+}
@@ -187,6 +187,13 @@ void CPopulationModel::sample(core_t::TTime startTime,
     }
 }
 
+bool CPopulationModel::sampleDependsOnResourceMonitor() const {
+    const CDataGatherer& gatherer = this->dataGatherer();
+    return this->params().s_MultivariateByFields ||
+           gatherer.numberPeople() > m_PersonLastBucketTimes.size() ||
+           gatherer.numberAttributes() > m_AttributeLastBucketTimes.size();
+}
+
 std::uint64_t CPopulationModel::checksum(bool includeCurrentBucketStats) const {
     std::uint64_t seed = this->CAnomalyDetectorModel::checksum(includeCurrentBucketStats);
 
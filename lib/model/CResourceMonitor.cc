@@ -427,6 +427,7 @@ std::size_t CResourceMonitor::persistenceMemoryIncreaseFactor() const {
 }
 
 void CResourceMonitor::acceptAllocationFailureResult(core_t::TTime time) {
+    std::lock_guard<std::mutex> lock{m_Mutex};
     m_MemoryStatus = model_t::E_MemoryStatusHardLimit;
     ++m_AllocationFailures[time];
 }
@@ -452,6 +453,7 @@ bool CResourceMonitor::haveNoLimit() const {
 }
 
 void CResourceMonitor::addExtraMemory(std::size_t mem) {
+    std::lock_guard<std::mutex> lock{m_Mutex};
     m_ExtraMemory += mem;
     this->updateAllowAllocations();
 }
@@ -15,6 +15,9 @@
 #include <core/CMemoryDef.h>
 #include <core/CScopedFastLock.h>
 
+#include <cstdint>
+#include <thread>
+
 namespace ml {
 namespace model {
 
@@ -28,6 +31,12 @@ struct SStrHash {
     }
 } STR_HASH;
 
+//! \brief Returns a hash which has already been computed.
+struct SPrecomputedHash {
+    std::size_t operator()(const std::string& /*key*/) const { return s_Hash; }
+    std::size_t s_Hash;
+};
+
 //! \brief Helper class to compare a std::string and a CStoredStringPtr.
 struct SStrStoredStringPtrEqual {
     bool operator()(const std::string& lhs, const core::CStoredStringPtr& rhs) const {
@@ -43,9 +52,9 @@ const CStringStore& DO_NOT_USE_THIS_VARIABLE = CStringStore::names();
 const CStringStore& DO_NOT_USE_THIS_VARIABLE_EITHER = CStringStore::influencers();
 }
 
-void CStringStore::tidyUpNotThreadSafe() {
-    names().pruneRemovedNotThreadSafe();
-    influencers().pruneNotThreadSafe();
+void CStringStore::tidyUp() {
+    names().pruneRemoved();
+    influencers().prune();
 }
 
 CStringStore& CStringStore::names() {
@@ -65,134 +74,204 @@ const core::CStoredStringPtr& CStringStore::getEmpty() const {
 core::CStoredStringPtr CStringStore::get(const std::string& value) {
     // This section is expected to be performed frequently.
     //
-    // We ensure either:
-    //   1) Some threads may perform an insert and no thread will perform
-    //      a find until no threads can still perform an insert.
-    //   2) Some threads may perform a find and no thread will perform
-    //      an insert until no thread can still perform a find.
+    // For each shard we ensure either:
+    //   1) Some threads may modify the shard and no thread will perform
+    //      a find until no threads can still modify it.
+    //   2) Some threads may perform a find and no thread will modify the
+    //      shard until no thread can still perform a find.
+    //
+    // Finds don't take the lock. A thread which wants to insert takes the
+    // shard's lock, announces itself in s_Writing and then waits for any
+    // finds in progress to complete. A find which sees a writer falls back
+    // to the locked path. This uses sequentially consistent operations on
+    // s_Reading and s_Writing, so a reader and a writer can't both miss one
+    // another.
     //
-    // We "leak" strings if there is contention between reading and writing,
-    // which is expected to be rare because inserts are expected to be rare.
+    // Every string is stored exactly once however we are called concurrently.
+    // This matters because the store contributes to the memory usage we
+    // report and that must not depend on how threads happened to interleave.
 
     if (value.empty()) {
         return m_EmptyString;
     }
 
-    core::CStoredStringPtr result;
-
-    m_Reading.fetch_add(1, std::memory_order_release);
-    if (m_Writing.load(std::memory_order_consume) == 0) {
-        auto i = m_Strings.find(value, STR_HASH, STR_EQUAL);
-        if (i != m_Strings.end()) {
-            result = *i;
-            m_Reading.fetch_sub(1, std::memory_order_release);
-        } else {
-            m_Writing.fetch_add(1, std::memory_order_acq_rel);
-            // NB: fetch_sub() returns the OLD value, and we know we added 1 in
-            // this thread, hence the test for 1 rather than 0
-            if (m_Reading.fetch_sub(1, std::memory_order_release) == 1) {
-                // This section is expected to occur infrequently so inserts
-                // are synchronized with a mutex.
-                core::CScopedFastLock lock(m_Mutex);
-                auto ret = m_Strings.insert(core::CStoredStringPtr::makeStoredString(value));
-                result = *ret.first;
-                if (ret.second) {
-                    m_StoredStringsMemUse += result.actualMemoryUsage();
-                }
-                m_Writing.fetch_sub(1, std::memory_order_release);
-            } else {
-                m_Writing.fetch_sub(1, std::memory_order_release);
-                // This is leaked in the sense that it will never be shared and
-                // won't count towards our reported memory usage.  But it is not
-                // leaked in the traditional sense of the word, as its memory
-                // will be freed when the single user is finished with it.
-                result = core::CStoredStringPtr::makeStoredString(value);
-            }
+    SPrecomputedHash hash{STR_HASH(value)};
+    SShard& shard{this->shard(hash.s_Hash)};
+
+    shard.s_Reading.fetch_add(1);
+    if (shard.s_Writing.load() == 0) {
+        auto i = shard.s_Strings.find(value, hash, STR_EQUAL);
+        if (i != shard.s_Strings.end()) {
+            core::CStoredStringPtr result{*i};
+            shard.s_Reading.fetch_sub(1, std::memory_order_release);
+            return result;
         }
-    } else {
-        m_Reading.fetch_sub(1, std::memory_order_release);
-        // This is leaked in the sense that it will never be shared and won't
-        // count towards our reported memory usage.  But it is not leaked
-        // in the traditional sense of the word, as its memory will be freed
-        // when the single user is finished with it.
-        result = core::CStoredStringPtr::makeStoredString(value);
     }
+    shard.s_Reading.fetch_sub(1, std::memory_order_release);
+
+    // This section is expected to occur infrequently so inserts are
+    // synchronized with a mutex.
+    core::CScopedFastLock lock(shard.s_Mutex);
+    shard.startWriting();
+    auto i = shard.s_Strings.find(value, hash, STR_EQUAL);
+    if (i == shard.s_Strings.end()) {
+        i = shard.s_Strings.insert(core::CStoredStringPtr::makeStoredString(value)).first;
+        shard.s_StoredStringsMemUse += i->actualMemoryUsage();
+    }
+    core::CStoredStringPtr result{*i};
+    shard.stopWriting();
 
     return result;
 }
 
 void CStringStore::remove(const std::string& value) {
-    core::CScopedFastLock lock(m_Mutex);
-    m_Removed.push_back(value);
+    SShard& shard{this->shard(STR_HASH(value))};
+    core::CScopedFastLock lock(shard.s_Mutex);
+    shard.s_Removed.push_back(value);
 }
 
-void CStringStore::pruneRemovedNotThreadSafe() {
-    core::CScopedFastLock lock(m_Mutex);
-    for (const auto& removed : m_Removed) {
-        auto i = m_Strings.find(removed, STR_HASH, STR_EQUAL);
-        if (i != m_Strings.end() && i->isUnique()) {
-            m_StoredStringsMemUse -= i->actualMemoryUsage();
-            m_Strings.erase(i);
+void CStringStore::pruneRemoved() {
+    for (auto& shard : m_Shards) {
+        core::CScopedFastLock lock(shard.s_Mutex);
+        if (shard.s_Removed.empty()) {
+            continue;
+        }
+        shard.startWriting();
+        for (const auto& removed : shard.s_Removed) {
+            auto i = shard.s_Strings.find(removed, STR_HASH, STR_EQUAL);
+            // No other thread can copy the pointer while we're writing so
+            // if it's unique it can't become shared before it is erased.
+            if (i != shard.s_Strings.end() && i->isUnique()) {
+                shard.s_StoredStringsMemUse -= i->actualMemoryUsage();
+                shard.s_Strings.erase(i);
+            }
         }
+        shard.releaseIfEmpty();
+        shard.stopWriting();
+        shard.s_Removed.clear();
     }
-    m_Removed.clear();
 }
 
-void CStringStore::pruneNotThreadSafe() {
-    core::CScopedFastLock lock(m_Mutex);
-    for (auto i = m_Strings.begin(); i != m_Strings.end(); /**/) {
-        if (i->isUnique()) {
-            m_StoredStringsMemUse -= i->actualMemoryUsage();
-            i = m_Strings.erase(i);
-        } else {
-            ++i;
+void CStringStore::prune() {
+    for (auto& shard : m_Shards) {
+        core::CScopedFastLock lock(shard.s_Mutex);
+        shard.startWriting();
+        for (auto i = shard.s_Strings.begin(); i != shard.s_Strings.end(); /**/) {
+            if (i->isUnique()) {
+                shard.s_StoredStringsMemUse -= i->actualMemoryUsage();
+                i = shard.s_Strings.erase(i);
+            } else {
+                ++i;
+            }
         }
+        shard.releaseIfEmpty();
+        shard.stopWriting();
     }
 }
 
+std::size_t CStringStore::size() const {
+    std::size_t result{0};
+    for (const auto& shard : m_Shards) {
+        core::CScopedFastLock lock(shard.s_Mutex);
+        result += shard.s_Strings.size();
+    }
+    return result;
+}
+
 void CStringStore::debugMemoryUsage(const core::CMemoryUsage::TMemoryUsagePtr& mem) const {
     mem->setName(this == &CStringStore::names()
                      ? "names StringStore"
                      : (this == &CStringStore::influencers() ? "influencers StringStore"
                                                              : "unknown StringStore"));
     mem->addItem("empty string ptr", m_EmptyString.actualMemoryUsage());
-    core::CScopedFastLock lock(m_Mutex);
-    core::memory_debug::dynamicSize("stored strings", m_Strings, mem);
-    core::memory_debug::dynamicSize("removed strings", m_Removed, mem);
-    mem->addItem("stored string ptr memory", m_StoredStringsMemUse);
+    std::size_t stringsMemUse{0};
+    std::size_t removedMemUse{0};
+    std::size_t storedStringsMemUse{0};
+    for (const auto& shard : m_Shards) {
+        core::CScopedFastLock lock(shard.s_Mutex);
+        stringsMemUse += shard.stringsMemoryUsage();
+        removedMemUse += core::memory::dynamicSize(shard.s_Removed);
+        storedStringsMemUse += shard.s_StoredStringsMemUse;
+    }
+    mem->addItem("stored strings", stringsMemUse);
+    mem->addItem("removed strings", removedMemUse);
+    mem->addItem("stored string ptr memory", storedStringsMemUse);
 }
 
 std::size_t CStringStore::memoryUsage() const {
     std::size_t mem = m_EmptyString.actualMemoryUsage();
-    core::CScopedFastLock lock(m_Mutex);
-    // The assumption here is that the existence of
-    // core::CStoredStringPtr::dynamicSizeAlwaysZero() combined with dead code
-    // elimination will make calculating the size of m_Strings boil down to a
-    // couple of simple multiplications and additions
-    mem += core::memory::dynamicSize(m_Strings);
-    // This one could be more expensive, but the assumption is that there won't
-    // be many memory usage calculations while m_Removed is populated
-    mem += core::memory::dynamicSize(m_Removed);
-    // This adds back the size that was excluded from
-    // core::memory::dynamicSize(m_Strings)
-    mem += m_StoredStringsMemUse;
+    for (const auto& shard : m_Shards) {
+        core::CScopedFastLock lock(shard.s_Mutex);
+        // The assumption here is that the existence of
+        // core::CStoredStringPtr::dynamicSizeAlwaysZero() combined with dead
+        // code elimination will make calculating the size of s_Strings boil
+        // down to a couple of simple multiplications and additions
+        mem += shard.stringsMemoryUsage();
+        // This one could be more expensive, but the assumption is that there
+        // won't be many memory usage calculations while s_Removed is populated
+        mem += core::memory::dynamicSize(shard.s_Removed);
+        // This adds back the size that was excluded from
+        // core::memory::dynamicSize(s_Strings)
+        mem += shard.s_StoredStringsMemUse;
+    }
     return mem;
 }
 
 CStringStore::CStringStore()
-    : m_Reading(0), m_Writing(0),
-      m_EmptyString(core::CStoredStringPtr::makeStoredString(std::string())),
-      m_StoredStringsMemUse(0) {
+    : m_EmptyString(core::CStoredStringPtr::makeStoredString(std::string())) {
+}
+
+CStringStore::SShard& CStringStore::shard(std::size_t hash) {
+    return const_cast<SShard&>(static_cast<const CStringStore*>(this)->shard(hash));
+}
+
+const CStringStore::SShard& CStringStore::shard(std::size_t hash) const {
+    // The sets use the low bits of the hash so we choose the shard using
+    // the high bits of a multiplicative hash.
+    std::uint64_t mixed{static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15};
+    return m_Shards[static_cast<std::size_t>(mixed >> 32) % NUMBER_SHARDS];
+}
+
+bool CStringStore::containsTestOnly(const std::string& value) const {
+    const SShard& shard{this->shard(STR_HASH(value))};
+    core::CScopedFastLock lock(shard.s_Mutex);
+    return shard.s_Strings.find(value, STR_HASH, STR_EQUAL) != shard.s_Strings.end();
 }
 
 void CStringStore::clearEverythingTestOnly() {
     // For tests that assert on memory usage it's important that these
     // containers get returned to the state of a default constructed container
-    TStoredStringPtrUSet emptySet;
-    emptySet.swap(m_Strings);
-    TStrVec emptyVec;
-    emptyVec.swap(m_Removed);
-    m_StoredStringsMemUse = 0;
+    for (auto& shard : m_Shards) {
+        TStoredStringPtrUSet emptySet;
+        emptySet.swap(shard.s_Strings);
+        TStrVec emptyVec;
+        emptyVec.swap(shard.s_Removed);
+        shard.s_StoredStringsMemUse = 0;
+    }
+}
+
+void CStringStore::SShard::startWriting() {
+    s_Writing.fetch_add(1);
+    while (s_Reading.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void CStringStore::SShard::stopWriting() {
+    s_Writing.fetch_sub(1, std::memory_order_release);
+}
+
+void CStringStore::SShard::releaseIfEmpty() {
+    if (s_Strings.empty()) {
+        TStoredStringPtrUSet empty;
+        empty.swap(s_Strings);
+    }
+}
+
+std::size_t CStringStore::SShard::stringsMemoryUsage() const {
+    // An empty set has no buckets allocated, since we release them when
+    // a shard is emptied, so most shards of a small store cost nothing.
+    return s_Strings.empty() ? 0 : core::memory::dynamicSize(s_Strings);
 }
 
 } // model
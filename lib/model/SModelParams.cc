@@ -55,6 +55,7 @@ SModelParams::SModelParams(core_t::TTime bucketLength)
       s_SamplingAgeCutoff(SAMPLING_AGE_CUTOFF_DEFAULT),
       s_PruneWindowScaleMinimum(CAnomalyDetectorModelConfig::DEFAULT_PRUNE_WINDOW_SCALE_MINIMUM),
       s_PruneWindowScaleMaximum(CAnomalyDetectorModelConfig::DEFAULT_PRUNE_WINDOW_SCALE_MAXIMUM),
+      s_ModelSpillDirectory(),
       s_DetectionRules(EMPTY_RULES), s_ScheduledEvents(EMPTY_SCHEDULED_EVENTS),
       s_InfluenceCutoff(CAnomalyDetectorModelConfig::DEFAULT_INFLUENCE_CUTOFF),
       s_MinimumToFuzzyDeduplicate(10000), s_CacheProbabilities(true),
@@ -21,6 +21,7 @@
 #include <boost/unordered_map.hpp>
 
 #include <set>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(CBucketQueueTest)
 
@@ -97,6 +98,43 @@ BOOST_AUTO_TEST_CASE(testClear) {
     BOOST_REQUIRE_EQUAL(3, queue.size());
 }
 
+BOOST_AUTO_TEST_CASE(testRecycle) {
+    // Test recycling matches pushing empty items and reuses the storage
+    // of the earliest bucket.
+
+    using TIntVec = std::vector<int>;
+
+    CBucketQueue<TIntVec> queue(1, 5, 0);
+    CBucketQueue<TIntVec> expected(1, 5, 0);
+    for (int i = 0; i < 2; ++i) {
+        queue.get(0).push_back(i);
+        expected.get(0).push_back(i);
+    }
+    queue.get(0).reserve(100);
+
+    auto reset = [](TIntVec& item) { item.clear(); };
+    queue.recycle(5, reset);
+    expected.push(TIntVec{}, 5);
+    queue.get(5).push_back(5);
+    expected.get(5).push_back(5);
+    BOOST_REQUIRE_EQUAL(expected.size(), queue.size());
+    BOOST_REQUIRE_EQUAL(expected.latestBucketEnd(), queue.latestBucketEnd());
+    BOOST_TEST_REQUIRE((expected.get(0) == queue.get(0)));
+    BOOST_TEST_REQUIRE((expected.get(5) == queue.get(5)));
+
+    // The bucket starting at 10 reuses the storage of the bucket at 0.
+    queue.recycle(10, reset);
+    expected.push(TIntVec{}, 10);
+    BOOST_TEST_REQUIRE(queue.get(10).empty());
+    BOOST_TEST_REQUIRE(queue.get(10).capacity() >= 100);
+    BOOST_TEST_REQUIRE((expected.get(5) == queue.get(5)));
+
+    // Earlier times are ignored.
+    queue.recycle(3, reset);
+    BOOST_REQUIRE_EQUAL(expected.latestBucketEnd(), queue.latestBucketEnd());
+    BOOST_TEST_REQUIRE((expected.get(5) == queue.get(5)));
+}
+
 BOOST_AUTO_TEST_CASE(testIterators) {
     using TStringQueueItr = CBucketQueue<std::string>::iterator;
 
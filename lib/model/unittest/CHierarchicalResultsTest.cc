@@ -1955,4 +1955,56 @@ BOOST_AUTO_TEST_CASE(testShouldWritePartition) {
         limits, results, *extract.partitionNodes()[1], false));
 }
 
+BOOST_AUTO_TEST_CASE(testMerge) {
+
+    // Check that merging results built separately in order is equivalent
+    // to adding them all to one object.
+
+    static const std::string PART1("PART1");
+    static const std::string part1("part1");
+    static const std::string part2("part2");
+    static const std::string PERS("PERS");
+    static const std::string VAL1("VAL1");
+    static const std::string FUNC("mean");
+    static const ml::model::function_t::EFunction function(
+        ml::model::function_t::E_IndividualMetricMean);
+
+    auto addPartition1 = [&](model::CHierarchicalResults& results) {
+        addResult(1, false, FUNC, function, PART1, part1, PERS, "pers1", VAL1, 0.01, results);
+        addResult(1, false, FUNC, function, PART1, part1, PERS, "pers2", VAL1, 0.2, results);
+        results.addInfluencer(PERS);
+    };
+    auto addPartition2 = [&](model::CHierarchicalResults& results) {
+        addResult(1, false, FUNC, function, PART1, part2, PERS, "pers1", VAL1, 0.5, results);
+        addResult(1, false, FUNC, function, PART1, part2, PERS, "pers3", VAL1, 0.001, results);
+        results.addInfluencer(PERS);
+    };
+
+    model::CHierarchicalResults expected;
+    addPartition1(expected);
+    addPartition2(expected);
+    expected.buildHierarchy();
+
+    model::CHierarchicalResults merged;
+    model::CHierarchicalResults partition1;
+    model::CHierarchicalResults partition2;
+    addPartition1(partition1);
+    addPartition2(partition2);
+    merged.merge(std::move(partition1));
+    merged.merge(std::move(partition2));
+    merged.buildHierarchy();
+
+    BOOST_TEST_REQUIRE(partition1.empty());
+    BOOST_TEST_REQUIRE(partition2.empty());
+    BOOST_REQUIRE_EQUAL(expected.resultCount(), merged.resultCount());
+    BOOST_REQUIRE_EQUAL(expected.print(), merged.print());
+
+    CPrinter expectedPrinter;
+    CPrinter mergedPrinter;
+    expected.postorderDepthFirst(expectedPrinter);
+    merged.postorderDepthFirst(mergedPrinter);
+    LOG_DEBUG(<< "\nhierarchy:\n" << mergedPrinter.result());
+    BOOST_REQUIRE_EQUAL(expectedPrinter.result(), mergedPrinter.result());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
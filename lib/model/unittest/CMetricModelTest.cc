@@ -1263,6 +1263,87 @@ BOOST_FIXTURE_TEST_CASE(testPrune, CTestFixture) {
                         clonedModelHolder->dataGatherer().numberActivePeople());
 }
 
+BOOST_FIXTURE_TEST_CASE(testSpillPrunedModels, CTestFixture) {
+    // Test that if a spill directory is configured the models of pruned
+    // people are restored when they reappear.
+
+    const core_t::TTime startTime{1346968800};
+    const core_t::TTime bucketLength{3600};
+
+    SModelParams params(bucketLength);
+    model_t::TFeatureVec features{model_t::E_IndividualMeanByPerson};
+
+    CModelFactory::TDataGathererPtr gatherer;
+    CModelFactory::TModelPtr model_;
+    params.s_ModelSpillDirectory = ".";
+    this->makeModelT<CMetricModelFactory>(params, features, startTime,
+                                          model_t::E_MetricOnline, gatherer, model_);
+    auto* model = dynamic_cast<CMetricModel*>(model_.get());
+    BOOST_TEST_REQUIRE(model);
+
+    // The same data without pruning.
+    CModelFactory::TDataGathererPtr expectedGatherer;
+    CModelFactory::TModelPtr expectedModel_;
+    params.s_ModelSpillDirectory.clear();
+    this->makeModelT<CMetricModelFactory>(params, features, startTime, model_t::E_MetricOnline,
+                                          expectedGatherer, expectedModel_);
+    auto* expectedModel = dynamic_cast<CMetricModel*>(expectedModel_.get());
+    BOOST_TEST_REQUIRE(expectedModel);
+
+    test::CRandomNumbers rng;
+    TDoubleVec samples;
+
+    auto addBucket = [&](core_t::TTime time, const TStrVec& people) {
+        for (const auto& person : people) {
+            rng.generateNormalSamples(10.0, 4.0, 1, samples);
+            for (auto& gatherer_ : {std::ref(gatherer), std::ref(expectedGatherer)}) {
+                this->addPerson(person, gatherer_);
+                this->addArrival(SMessage(time + bucketLength / 2, person, samples[0]),
+                                 gatherer_);
+            }
+        }
+        model->sample(time, time + bucketLength, m_ResourceMonitor);
+        expectedModel->sample(time, time + bucketLength, m_ResourceMonitor);
+    };
+
+    // "p1" stops sending data half way through.
+    core_t::TTime time{startTime};
+    for (std::size_t i = 0; i < 200; ++i, time += bucketLength) {
+        addBucket(time, i < 100 ? TStrVec{"p1", "p2"} : TStrVec{"p2"});
+    }
+
+    model->prune(50);
+    BOOST_TEST_REQUIRE(gatherer->isPersonActive(0) == false);
+    BOOST_TEST_REQUIRE(gatherer->isPersonActive(1));
+
+    addBucket(time, TStrVec{"p1", "p2"});
+
+    std::size_t pid;
+    BOOST_TEST_REQUIRE(gatherer->personId("p1", pid));
+    std::size_t expectedPid;
+    BOOST_TEST_REQUIRE(expectedGatherer->personId("p1", expectedPid));
+    BOOST_REQUIRE_EQUAL(expectedModel->firstBucketTimes()[expectedPid],
+                        model->firstBucketTimes()[pid]);
+
+    // The data gatherer's state for "p1" isn't spilled so the models aren't
+    // identical, but without restoring the model "p1" would have a new model
+    // which can't predict anything yet.
+    auto weights = maths_t::CUnitWeights::unit<TDouble2Vec>(1);
+    auto expectedInterval =
+        expectedModel->details()
+            ->model(model_t::E_IndividualMeanByPerson, expectedPid)
+            ->confidenceInterval(time, 90.0, weights);
+    auto interval = model->details()
+                        ->model(model_t::E_IndividualMeanByPerson, pid)
+                        ->confidenceInterval(time, 90.0, weights);
+    BOOST_REQUIRE_EQUAL(3, interval.size());
+    for (std::size_t i = 0; i < 3; ++i) {
+        LOG_DEBUG(<< "expected = " << expectedInterval[i][0] << ", actual = " << interval[i][0]);
+        BOOST_TEST_REQUIRE(std::fabs(expectedInterval[i][0] - interval[i][0]) <
+                           0.01 * std::fabs(expectedInterval[i][0]));
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(testKey, CTestFixture) {
     function_t::TFunctionVec countFunctions{
         function_t::E_IndividualMetric, function_t::E_IndividualMetricMean,
@@ -1847,6 +1928,65 @@ BOOST_FIXTURE_TEST_CASE(testCorrelatePersist, CTestFixture) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(testCloneForPersistenceIsUnchangedByUpdates, CTestFixture) {
+
+    // The copy made for persistence shares the person models with the original
+    // until they're modified. Check that updating the original doesn't change
+    // the state of the copy.
+
+    const core_t::TTime startTime{0};
+    const core_t::TTime bucketLength{600};
+
+    SModelParams params(bucketLength);
+    this->makeModel(params, {model_t::E_IndividualMeanByPerson}, startTime);
+    this->addPerson("p1", m_Gatherer);
+    this->addPerson("p2", m_Gatherer);
+
+    test::CRandomNumbers rng;
+    TDoubleVec samples;
+
+    auto addBuckets = [&](core_t::TTime begin, core_t::TTime end, const TStrVec& people) {
+        for (core_t::TTime bucket = begin; bucket < end; bucket += bucketLength) {
+            rng.generateNormalSamples(10.0, 3.0, 10, samples);
+            for (std::size_t i = 0; i < samples.size(); ++i) {
+                for (const auto& person : people) {
+                    this->addArrival(SMessage(bucket + 60 * static_cast<core_t::TTime>(i),
+                                              person, samples[i]),
+                                     m_Gatherer);
+                }
+            }
+            m_Model->sample(bucket, bucket + bucketLength, m_ResourceMonitor);
+        }
+    };
+    auto persist = [](const CAnomalyDetectorModel& model) {
+        std::string result;
+        core::CRapidXmlStatePersistInserter inserter("root");
+        model.acceptPersistInserter(inserter);
+        inserter.toXml(result);
+        return result;
+    };
+
+    addBuckets(startTime, startTime + 100 * bucketLength, {"p1", "p2"});
+
+    std::string expectedState{persist(*m_Model)};
+    CModelFactory::TModelPtr clone{m_Model->cloneForPersistence()};
+    BOOST_REQUIRE_EQUAL(expectedState, persist(*clone));
+
+    // Modify only some of the models.
+    addBuckets(startTime + 100 * bucketLength, startTime + 150 * bucketLength, {"p1"});
+    BOOST_TEST_REQUIRE(persist(*m_Model) != expectedState);
+    BOOST_REQUIRE_EQUAL(expectedState, persist(*clone));
+
+    // Modify all the models.
+    addBuckets(startTime + 150 * bucketLength, startTime + 200 * bucketLength, {"p1", "p2"});
+    BOOST_REQUIRE_EQUAL(expectedState, persist(*clone));
+
+    // Dropping the copy leaves the original intact.
+    std::uint64_t checksum{m_Model->checksum()};
+    clone.reset();
+    BOOST_REQUIRE_EQUAL(checksum, m_Model->checksum());
+}
+
 BOOST_FIXTURE_TEST_CASE(testSummaryCountZeroRecordsAreIgnored, CTestFixture) {
     core_t::TTime startTime(100);
     core_t::TTime bucketLength(100);
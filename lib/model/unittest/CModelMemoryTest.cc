@@ -12,6 +12,7 @@
 #include <core/CMemoryDef.h>
 
 #include <maths/common/CBasicStatistics.h>
+#include <maths/common/CModel.h>
 
 #include <model/CAnomalyDetectorModel.h>
 #include <model/CDataGatherer.h>
@@ -38,6 +39,13 @@ namespace {
 using TDoubleVec = std::vector<double>;
 using TSizeVec = std::vector<std::size_t>;
 
+//! Exposes the feature models for testing.
+class CFeatureModelsAccess : public CAnomalyDetectorModel {
+public:
+    using CAnomalyDetectorModel::SFeatureModels;
+};
+using TFeatureModels = CFeatureModelsAccess::SFeatureModels;
+
 std::size_t addPerson(const std::string& p, const CModelFactory::TDataGathererPtr& gatherer) {
     CDataGatherer::TStrCPtrVec person;
     person.push_back(&p);
@@ -176,4 +184,75 @@ BOOST_AUTO_TEST_CASE(testOnlineMetricModel) {
     BOOST_REQUIRE_EQUAL(model.computeMemoryUsage(), memoryUsage->usage());
 }
 
+BOOST_AUTO_TEST_CASE(testIncrementalMemoryUsage) {
+
+    // Test that the memory usage of the feature models, which is maintained
+    // as they change, matches a full computation as models are added, updated,
+    // shared with copies being persisted and replaced.
+
+    using TDouble2Vec = core::CSmallVector<double, 2>;
+    using TDouble2VecWeightsAryVec = std::vector<maths_t::TDouble2VecWeightsAry>;
+
+    core_t::TTime bucketLength{600};
+    SModelParams params(bucketLength);
+    auto interimBucketCorrector = std::make_shared<CInterimBucketCorrector>(bucketLength);
+    CMetricModelFactory factory(params, interimBucketCorrector);
+    TFeatureModels models{
+        model_t::E_IndividualMeanByPerson,
+        factory.defaultFeatureModel(model_t::E_IndividualMeanByPerson,
+                                    bucketLength, 0.4, true)};
+
+    auto expectedMemoryUsage = [&] {
+        std::size_t result{core::memory::dynamicSize(models.s_NewModel)};
+        result += sizeof(CAnomalyDetectorModel::TMathsModelSPtr) *
+                  models.s_Models.capacity();
+        result += sizeof(CAnomalyDetectorModel::TMathsModelWPtr) *
+                  models.s_CopiedModels.capacity();
+        result += core::memory::dynamicSize(models.s_ModelMemoryUsages);
+        result += core::memory::dynamicSize(models.s_ChangedModels);
+        for (const auto& model : models.s_Models) {
+            result += sizeof(long) + core::memory::staticSize(*model) +
+                      core::memory::dynamicSize(*model);
+        }
+        return result;
+    };
+
+    test::CRandomNumbers rng;
+
+    TDouble2VecWeightsAryVec weights{maths_t::CUnitWeights::unit<TDouble2Vec>(1)};
+    maths::common::CModelAddSamplesParams addSamplesParams;
+    addSamplesParams.isInteger(false)
+        .propagationInterval(1.0)
+        .trendWeights(weights)
+        .priorWeights(weights);
+
+    std::vector<TFeatureModels> copies;
+    TSizeVec ids;
+    TDoubleVec values;
+    core_t::TTime time{0};
+    for (std::size_t i = 0; i < 200; ++i, time += bucketLength) {
+        if (i < 100 && i % 2 == 0) {
+            models.addModel(models.s_NewModel->clone(models.s_Models.size()));
+        }
+        rng.generateUniformSamples(0, models.s_Models.size(), 5, ids);
+        rng.generateNormalSamples(5.0 + static_cast<double>(i % 10), 2.0, ids.size(), values);
+        for (std::size_t j = 0; j < ids.size(); ++j) {
+            models.modelToModify(ids[j])->addSamples(
+                addSamplesParams, {core::make_triple(time, TDouble2Vec{values[j]},
+                                                     std::size_t{0})});
+        }
+        if (i % 40 == 10) {
+            copies.push_back(models.cloneForPersistence(true));
+        } else if (i % 40 == 20) {
+            copies.clear();
+        }
+        if (i == 150) {
+            models.replaceModel(3, models.s_NewModel->clone(3));
+        }
+
+        std::size_t memoryUsage{models.memoryUsage()};
+        BOOST_REQUIRE_EQUAL(expectedMemoryUsage(), memoryUsage);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
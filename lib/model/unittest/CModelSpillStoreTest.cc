@@ -0,0 +1,147 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License
+ * 2.0 and the following additional limitation. Functionality enabled by the
+ * files subject to the Elastic License 2.0 may only be used in production when
+ * invoked by an Elasticsearch process with a license key installed that permits
+ * use of machine learning features. You may not use this file except in
+ * compliance with the Elastic License 2.0 and the foregoing additional
+ * limitation.
+ */
+
+#include <core/CLogger.h>
+#include <core/CMemoryDef.h>
+
+#include <model/CModelSpillStore.h>
+
+#include <test/CRandomNumbers.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CModelSpillStoreTest)
+
+using namespace ml;
+
+namespace {
+using TSizeVec = std::vector<std::size_t>;
+using TStrVec = std::vector<std::string>;
+
+bool exists(const std::string& fileName) {
+    return std::ifstream{fileName}.is_open();
+}
+
+TStrVec randomStates(std::size_t n, std::size_t length) {
+    test::CRandomNumbers rng;
+    TStrVec result;
+    TSizeVec digits;
+    for (std::size_t i = 0; i < n; ++i) {
+        rng.generateUniformSamples(0, 10, length, digits);
+        std::string state;
+        for (auto digit : digits) {
+            state += static_cast<char>('0' + digit);
+        }
+        result.push_back(std::move(state));
+    }
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(testSpillAndRehydrate) {
+    std::string fileName;
+    {
+        model::CModelSpillStore store{"."};
+        fileName = store.fileName();
+        BOOST_TEST_REQUIRE(exists(fileName));
+
+        TStrVec states(randomStates(10, 1000));
+        for (std::size_t i = 0; i < states.size(); ++i) {
+            BOOST_TEST_REQUIRE(store.spill("p" + std::to_string(i), states[i]));
+        }
+        BOOST_REQUIRE_EQUAL(10, store.size());
+        BOOST_TEST_REQUIRE(store.contains("p3"));
+        BOOST_TEST_REQUIRE(store.contains("p10") == false);
+
+        // The state should be compressed.
+        LOG_DEBUG(<< "file size = " << store.fileSize());
+        BOOST_TEST_REQUIRE(store.fileSize() < 10 * 1000);
+
+        // Spilling the same key replaces its state.
+        BOOST_TEST_REQUIRE(store.spill("p3", "foo"));
+        BOOST_REQUIRE_EQUAL(10, store.size());
+
+        std::string state;
+        BOOST_TEST_REQUIRE(store.rehydrate("p3", state));
+        BOOST_REQUIRE_EQUAL("foo", state);
+        BOOST_TEST_REQUIRE(store.contains("p3") == false);
+        BOOST_TEST_REQUIRE(store.rehydrate("p3", state) == false);
+
+        for (std::size_t i = 0; i < states.size(); ++i) {
+            if (i != 3) {
+                BOOST_TEST_REQUIRE(store.rehydrate("p" + std::to_string(i), state));
+                BOOST_REQUIRE_EQUAL(states[i], state);
+            }
+        }
+        BOOST_REQUIRE_EQUAL(0, store.size());
+        BOOST_REQUIRE_EQUAL(0, store.fileSize());
+    }
+
+    // The file should be removed with the store.
+    BOOST_TEST_REQUIRE(exists(fileName) == false);
+}
+
+BOOST_AUTO_TEST_CASE(testCompaction) {
+    // Test that the file doesn't grow without bound when entries are
+    // repeatedly spilled and rehydrated.
+
+    model::CModelSpillStore store{"."};
+
+    TStrVec states(randomStates(20, 100000));
+    for (std::size_t i = 0; i < 10; ++i) {
+        BOOST_TEST_REQUIRE(store.spill("p" + std::to_string(i), states[i]));
+    }
+    std::uint64_t maximumFileSize{0};
+    std::string state;
+    for (std::size_t round = 0; round < 50; ++round) {
+        std::size_t i{round % 10};
+        BOOST_TEST_REQUIRE(store.rehydrate("p" + std::to_string(i), state));
+        BOOST_REQUIRE_EQUAL(states[(round / 10) % 2 == 0 ? i : i + 10], state);
+        BOOST_TEST_REQUIRE(store.spill("p" + std::to_string(i),
+                                       states[(round / 10) % 2 == 0 ? i + 10 : i]));
+        maximumFileSize = std::max(maximumFileSize, store.fileSize());
+    }
+    LOG_DEBUG(<< "maximum file size = " << maximumFileSize);
+    BOOST_REQUIRE_EQUAL(10, store.size());
+    BOOST_TEST_REQUIRE(maximumFileSize < 15 * 100000);
+
+    for (std::size_t i = 0; i < 10; ++i) {
+        BOOST_TEST_REQUIRE(store.rehydrate("p" + std::to_string(i), state));
+        BOOST_REQUIRE_EQUAL(states[i + 10], state);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMemoryUsage) {
+    // Only the index should count towards the memory used.
+
+    model::CModelSpillStore store{"."};
+    std::size_t emptyMemoryUsage{core::memory::dynamicSize(store)};
+
+    TStrVec states(randomStates(10, 100000));
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        BOOST_TEST_REQUIRE(store.spill("p" + std::to_string(i), states[i]));
+    }
+    std::size_t memoryUsage{core::memory::dynamicSize(store)};
+    LOG_DEBUG(<< "memory usage = " << memoryUsage);
+    BOOST_TEST_REQUIRE(memoryUsage > emptyMemoryUsage);
+    BOOST_TEST_REQUIRE(memoryUsage < 10000);
+
+    core::CMemoryUsage mem;
+    store.debugMemoryUsage(mem.addChild());
+    BOOST_REQUIRE_EQUAL(memoryUsage, mem.usage());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
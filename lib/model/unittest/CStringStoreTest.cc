@@ -132,11 +132,11 @@ BOOST_FIXTURE_TEST_CASE(testStringStore, CTestFixture) {
         BOOST_REQUIRE_EQUAL(pG.get(), pG2.get());
         BOOST_REQUIRE_EQUAL(*pG, *pG2);
 
-        BOOST_REQUIRE_EQUAL(1, CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(1, CStringStore::names().size());
     }
-    BOOST_REQUIRE_EQUAL(1, CStringStore::names().m_Strings.size());
-    CStringStore::names().pruneNotThreadSafe();
-    BOOST_REQUIRE_EQUAL(0, CStringStore::names().m_Strings.size());
+    BOOST_REQUIRE_EQUAL(1, CStringStore::names().size());
+    CStringStore::names().prune();
+    BOOST_REQUIRE_EQUAL(0, CStringStore::names().size());
 
     {
         LOG_DEBUG(<< "Testing multi-threaded");
@@ -160,10 +160,10 @@ BOOST_FIXTURE_TEST_CASE(testStringStore, CTestFixture) {
         }
         LOG_DEBUG(<< "unique counts = " << uniques.size());
 
-        BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().m_Strings.size());
-        CStringStore::names().pruneNotThreadSafe();
-        BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().m_Strings.size());
-        BOOST_REQUIRE_EQUAL(0, CStringStore::influencers().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().size());
+        CStringStore::names().prune();
+        BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().size());
+        BOOST_REQUIRE_EQUAL(0, CStringStore::influencers().size());
 
         for (std::size_t i = 0; i < threads.size(); ++i) {
             // Propagate problems to main testing thread
@@ -173,11 +173,11 @@ BOOST_FIXTURE_TEST_CASE(testStringStore, CTestFixture) {
             threads[i]->clearPtrs();
         }
 
-        BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().m_Strings.size());
-        CStringStore::names().pruneNotThreadSafe();
-        BOOST_REQUIRE_EQUAL(0, CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().size());
+        CStringStore::names().prune();
+        BOOST_REQUIRE_EQUAL(0, CStringStore::names().size());
         threads.clear();
-        BOOST_REQUIRE_EQUAL(0, CStringStore::names().m_Strings.size());
+        BOOST_REQUIRE_EQUAL(0, CStringStore::names().size());
     }
     {
         LOG_DEBUG(<< "Testing multi-threaded string duplication rate");
@@ -210,16 +210,57 @@ BOOST_FIXTURE_TEST_CASE(testStringStore, CTestFixture) {
             threads[i]->uniques(uniques);
         }
         LOG_DEBUG(<< "unique counts = " << uniques.size());
-        BOOST_TEST_REQUIRE(uniques.size() < 20000);
+        // Contention must not cause strings to be duplicated.
+        BOOST_REQUIRE_EQUAL(lotsOfStrings.size(), uniques.size());
 
         // Tidy up
         for (std::size_t i = 0; i < threads.size(); ++i) {
             threads[i]->clearPtrs();
         }
-        CStringStore::names().pruneNotThreadSafe();
+        CStringStore::names().prune();
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(testConcurrentPrune, CTestFixture) {
+    // Test pruning while other threads are getting strings.
+
+    TStrVec strings;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        strings.push_back(core::CStringUtils::typeToString(i));
+    }
+
+    using TThreadPtr = std::shared_ptr<CStringThread>;
+    using TThreadVec = std::vector<TThreadPtr>;
+    TThreadVec threads;
+    for (std::size_t i = 0; i < 8; ++i) {
+        threads.emplace_back(new CStringThread(i * 100, strings));
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        BOOST_TEST_REQUIRE(threads[i]->start());
+    }
+    for (std::size_t i = 0; i < 200; ++i) {
+        CStringStore::names().prune();
+        CStringStore::names().remove(strings[i]);
+        CStringStore::names().pruneRemoved();
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        BOOST_TEST_REQUIRE(threads[i]->waitForFinish());
+    }
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->propagateLastDetectedMismatch();
+    }
+
+    // The strings the threads still reference must not have been pruned.
+    BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().size());
+    CStringStore::names().prune();
+    BOOST_REQUIRE_EQUAL(strings.size(), CStringStore::names().size());
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->clearPtrs();
+    }
+    CStringStore::names().prune();
+    BOOST_REQUIRE_EQUAL(0, CStringStore::names().size());
+}
+
 BOOST_FIXTURE_TEST_CASE(testMemUsage, CTestFixture) {
     std::string shortStr("short");
     std::string longStr("much much longer than the short string");
@@ -240,7 +281,7 @@ BOOST_FIXTURE_TEST_CASE(testMemUsage, CTestFixture) {
 
         // This pruning should have no effect, as there are external pointers to
         // the contents
-        CStringStore::names().pruneNotThreadSafe();
+        CStringStore::names().prune();
         BOOST_REQUIRE_EQUAL(inUseMemUse, CStringStore::names().memoryUsage());
     }
 
@@ -249,7 +290,7 @@ BOOST_FIXTURE_TEST_CASE(testMemUsage, CTestFixture) {
     BOOST_REQUIRE_EQUAL(inUseMemUse, CStringStore::names().memoryUsage());
 
     // There are no external references, so this should remove values
-    CStringStore::names().pruneNotThreadSafe();
+    CStringStore::names().prune();
     std::size_t prunedMemUse = CStringStore::names().memoryUsage();
     LOG_DEBUG(<< "Pruned memory usage: " << prunedMemUse);
     BOOST_TEST_REQUIRE(prunedMemUse < inUseMemUse - shortStr.length() - longStr.length());